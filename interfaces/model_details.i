@@ -40,6 +40,8 @@ typedef struct {
   double  cv_fact;
   double  nc_fact;
   double  sfact;
+  int     num_threads;
+  int     bpp_mt_length;
   const int     rtype[8];
   const short   alias[MAXALPHA+1];
   const int const pair[MAXALPHA+1][MAXALPHA+1];
@@ -79,7 +81,9 @@ typedef struct {
     const int     ribo            = vrna_md_defaults_ribo_get(),
     const double  cv_fact         = vrna_md_defaults_cv_fact_get(),
     const double  nc_fact         = vrna_md_defaults_nc_fact_get(),
-    const double  sfact           = vrna_md_defaults_sfact_get())
+    const double  sfact           = vrna_md_defaults_sfact_get(),
+    const int     num_threads     = vrna_md_defaults_num_threads_get(),
+    const int     bpp_mt_length   = vrna_md_defaults_bpp_mt_length_get())
   {
     vrna_md_t *md       = (vrna_md_t *)vrna_alloc(sizeof(vrna_md_t));
     md->temperature     = temperature;
@@ -106,6 +110,8 @@ typedef struct {
     md->cv_fact         = cv_fact;
     md->nc_fact         = nc_fact;
     md->sfact           = sfact;
+    md->num_threads     = num_threads;
+    md->bpp_mt_length   = bpp_mt_length;
 
     vrna_md_update(md);
 
@@ -164,6 +170,8 @@ typedef struct {
     out << ", cv_fact: " << $self->cv_fact ;
     out << ", nc_fact: " << $self->nc_fact ;
     out << ", sfact: " << $self->sfact ;
+    out << ", num_threads: " << $self->num_threads ;
+    out << ", bpp_mt_length: " << $self->bpp_mt_length ;
     out << " }";
 
     return std::string(out.str());
@@ -108,4 +108,8 @@ def __repr__(self):
 %constant unsigned int MOVESET_NO_LP      = VRNA_MOVESET_NO_LP;
 %constant unsigned int MOVESET_DEFAULT    = VRNA_MOVESET_DEFAULT;
 
+%ignore vrna_move_apply_zobrist;
+%ignore vrna_move_zobrist;
+%ignore vrna_move_apply_pk;
+
 %include  <ViennaRNA/landscape/move.h>
@@ -295,6 +295,35 @@ std::vector<vrna_path_t> my_get_path(std::string seq, std::string s1, std::strin
       return v;
   }
 
+#ifdef SWIGPYTHON
+%feature("autodoc") path_findpath_saddle_matrix;
+%feature("kwargs") path_findpath_saddle_matrix;
+#endif
+
+  std::vector<std::vector<int> >
+  path_findpath_saddle_matrix(std::vector<std::string> structures,
+                              int                      width = 1,
+                              int                      maxE = INT_MAX - 1)
+  {
+    std::vector<std::vector<int> >  S;
+    /* convert std::vector<std::string> to vector<const char *> */
+    std::vector<const char*>        v;
+    std::transform(structures.begin(), structures.end(), std::back_inserter(v), convert_vecstring2veccharcp);
+    v.push_back(NULL); /* mark end of structures */
+
+    int k   = (int)structures.size();
+    int *s  = vrna_path_findpath_saddle_matrix($self, (const char **)&v[0], width, maxE);
+
+    if (s) {
+      for (int a = 0; a < k; a++)
+        S.push_back(std::vector<int>(s + a * k, s + (a + 1) * k));
+
+      free(s);
+    }
+
+    return S;
+  }
+
 #ifdef SWIGPYTHON
 %feature("autodoc") path_direct;
 %feature("kwargs") path_direct;
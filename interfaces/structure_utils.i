@@ -32,6 +32,13 @@
 %ignore vrna_db_flatten;
 %ignore vrna_db_flatten_to;
 %ignore vrna_db_from_WUSS;
+%ignore vrna_pt_pack;
+%ignore vrna_pt_unpack;
+%ignore vrna_pt_pack_size;
+%ignore vrna_pt_pack_cmp;
+%ignore vrna_pt_pack_toggle;
+%ignore vrna_pt_zobrist;
+%ignore vrna_bp_zobrist;
 
 
 /************************************/
@@ -4119,7 +4119,7 @@ update_TwoDfold_params(TwoDfold_vars *vars)
 
   set_model_details(&md);
 
-  free(vars->compatibility->params);
+  vrna_params_free(vars->compatibility->params);
   vars->compatibility->params = vrna_params(&md);
 
   crosslink(vars);
@@ -64,6 +64,19 @@ typedef struct {
   double      **pUH;
 } helper_arrays;
 
+/*
+ *  Memory blocks of the banded matrices for the global partition
+ *  function. Rows are offset pointers into these blocks, so we keep
+ *  the base pointers for releasing them
+ */
+typedef struct {
+  FLT_OR_DBL  *pR;
+  FLT_OR_DBL  *qb;
+  FLT_OR_DBL  *qm;
+  FLT_OR_DBL  *outside_ml;
+  char        *ptype;
+} global_dp_blocks;
+
 /* soft constraint contributions function (interior-loops) */
 typedef FLT_OR_DBL (sc_int)(vrna_fold_compound_t *,
                             int,
@@ -142,6 +155,40 @@ probability_correction(vrna_fold_compound_t *vc,
                        int                  i);
 
 
+PRIVATE void
+allocate_dp_matrices_global(vrna_fold_compound_t  *fc,
+                            FLT_OR_DBL            **outside_ml,
+                            global_dp_blocks      *blocks);
+
+
+PRIVATE void
+free_dp_matrices_global(vrna_fold_compound_t  *fc,
+                        global_dp_blocks      *blocks);
+
+
+PRIVATE int
+fill_arrays_global(vrna_fold_compound_t *fc);
+
+
+PRIVATE FLT_OR_DBL
+exp_ext_stem_global(vrna_fold_compound_t  *fc,
+                    int                   i,
+                    int                   j);
+
+
+PRIVATE void
+exterior_global(vrna_fold_compound_t  *fc,
+                double                *lq5,
+                double                *lq3);
+
+
+PRIVATE void
+compute_probs_global(vrna_fold_compound_t *fc,
+                     FLT_OR_DBL           **outside_ml,
+                     double               *lq5,
+                     double               *lq3);
+
+
 #if 0
 PRIVATE vrna_ep_t *
 get_deppp(vrna_fold_compound_t  *vc,
@@ -947,6 +994,117 @@ vrna_probs_window(vrna_fold_compound_t        *vc,
 }
 
 
+PUBLIC float
+vrna_pf_window_global(vrna_fold_compound_t        *fc,
+                      char                        *structure,
+                      vrna_probs_window_callback  *cb,
+                      void                        *data)
+{
+  int               i, j, n, winSize;
+  float             free_energy;
+  double            *lq5, *lq3, *pup, *pdown;
+  FLT_OR_DBL        **pR, **outside_ml;
+  vrna_exp_param_t  *pf_params;
+  vrna_md_t         *md;
+  global_dp_blocks  blocks;
+
+  free_energy = (float)(INF / 100.);
+
+  if (!fc)
+    return free_energy;
+
+  md = &(fc->params->model_details);
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (md->gquad) ||
+      (md->circ) ||
+      (fc->sc) ||
+      (fc->domains_up) ||
+      ((fc->hc) && (fc->hc->f))) {
+    vrna_message_warning("vrna_pf_window_global@LPfold.c: "
+                         "Comparative predictions, G-Quadruplexes, circular RNAs, "
+                         "soft constraints, unstructured domains, and hard constraint "
+                         "callbacks are not supported");
+    return free_energy;
+  }
+
+  if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_PF | VRNA_OPTION_WINDOW)) {
+    vrna_message_warning("vrna_pf_window_global@LPfold.c: "
+                         "Failed to prepare vrna_fold_compound");
+    return free_energy;
+  }
+
+  n           = (int)fc->length;
+  winSize     = fc->window_size;
+  pf_params   = fc->exp_params;
+  md          = &(pf_params->model_details);
+  pR          = fc->exp_matrices->pR;
+  outside_ml  = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *) * (n + 2));
+  lq5         = (double *)vrna_alloc(sizeof(double) * (n + 2));
+  lq3         = (double *)vrna_alloc(sizeof(double) * (n + 2));
+
+  /* keep all rows of the banded matrices, since the outside recursions span the entire sequence */
+  allocate_dp_matrices_global(fc, outside_ml, &blocks);
+
+  if (fill_arrays_global(fc)) {
+    exterior_global(fc, lq5, lq3);
+
+    if (lq5[n] == -INFINITY) {
+      vrna_message_warning("vrna_pf_window_global@LPfold.c: "
+                           "no valid structure compatible with the constraints");
+    } else {
+      free_energy = (float)((-lq5[n] - n * log(pf_params->pf_scale)) *
+                            pf_params->kT / 1000.0);
+
+      if ((md->compute_bpp) &&
+          (!cb) &&
+          (!structure)) {
+        vrna_message_warning("vrna_pf_window_global@LPfold.c: "
+                             "Base pair probabilities are only reported through a callback, "
+                             "or as pseudo-bracket string. Skipping their computation");
+      } else if (md->compute_bpp) {
+        compute_probs_global(fc, outside_ml, lq5, lq3);
+
+        if (cb)
+          for (i = 1; i <= n; i++)
+            cb(pR[i], MIN2(i + winSize, n), i, winSize, VRNA_PROBS_WINDOW_BPP, data);
+
+        if (structure) {
+          float P[3];
+
+          pup   = (double *)vrna_alloc(sizeof(double) * (n + 2));
+          pdown = (double *)vrna_alloc(sizeof(double) * (n + 2));
+
+          for (i = 1; i <= n; i++)
+            for (j = i + 1; j <= MIN2(i + winSize - 1, n); j++) {
+              pup[i]    += pR[i][j];
+              pdown[j]  += pR[i][j];
+            }
+
+          for (i = 1; i <= n; i++) {
+            P[0]              = (float)(1. - pup[i] - pdown[i]);
+            P[1]              = (float)pup[i];
+            P[2]              = (float)pdown[i];
+            structure[i - 1]  = vrna_bpp_symbol(P);
+          }
+          structure[n] = '\0';
+
+          free(pup);
+          free(pdown);
+        }
+      }
+    }
+  }
+
+  free_dp_matrices_global(fc, &blocks);
+  free(outside_ml);
+  free(lq5);
+  free(lq3);
+
+  return free_energy;
+}
+
+
 PRIVATE FLT_OR_DBL
 sc_contribution(vrna_fold_compound_t  *vc,
                 int                   i,
@@ -1376,6 +1534,381 @@ make_ptypes(vrna_fold_compound_t  *vc,
 }
 
 
+PRIVATE void
+allocate_dp_matrices_global(vrna_fold_compound_t  *fc,
+                            FLT_OR_DBL            **outside_ml,
+                            global_dp_blocks      *blocks)
+{
+  int           i, n, winSize;
+  size_t        size;
+  vrna_mx_pf_t  *mx;
+
+  n       = (int)fc->length;
+  winSize = fc->window_size;
+  mx      = fc->exp_matrices;
+
+  /*
+   *  In contrast to init_dp_matrices(), we reserve memory for all
+   *  rows at once. Thus, the memory requirements grow with
+   *  length * winSize instead of winSize * winSize. Each matrix
+   *  occupies a single block where row i starts at offset
+   *  (i - 1) * (winSize + 1) and is addressed by j in [i, i + winSize]
+   */
+  size                = (size_t)n * (size_t)(winSize + 1);
+  blocks->pR          = (FLT_OR_DBL *)vrna_alloc(size * sizeof(FLT_OR_DBL));
+  blocks->qb          = (FLT_OR_DBL *)vrna_alloc(size * sizeof(FLT_OR_DBL));
+  blocks->qm          = (FLT_OR_DBL *)vrna_alloc(size * sizeof(FLT_OR_DBL));
+  blocks->outside_ml  = (FLT_OR_DBL *)vrna_alloc(size * sizeof(FLT_OR_DBL));
+  blocks->ptype       = (char *)vrna_alloc(size * sizeof(char));
+
+  for (i = 1; i <= n; i++) {
+    size                    = (size_t)(i - 1) * (size_t)(winSize + 1);
+    mx->pR[i]               = blocks->pR + size - i;
+    mx->qb_local[i]         = blocks->qb + size - i;
+    mx->qm_local[i]         = blocks->qm + size - i;
+    outside_ml[i]           = blocks->outside_ml + size - i;
+    fc->ptype_local[i]      = blocks->ptype + size - i;
+    fc->hc->matrix_local[i] = (unsigned char *)vrna_alloc((winSize + 1) * sizeof(unsigned char));
+  }
+
+  /* fill the constraints in the same order as for the sliding window */
+  for (i = 1; i <= n; i++) {
+    make_ptypes(fc, i);
+    vrna_hc_update(fc, i, VRNA_CONSTRAINT_WINDOW_UPDATE_5);
+  }
+}
+
+
+PRIVATE void
+free_dp_matrices_global(vrna_fold_compound_t  *fc,
+                        global_dp_blocks      *blocks)
+{
+  int           i, n;
+  vrna_mx_pf_t  *mx;
+
+  n   = (int)fc->length;
+  mx  = fc->exp_matrices;
+
+  for (i = 1; i <= n; i++) {
+    free(fc->hc->matrix_local[i]);
+    mx->pR[i]               = NULL;
+    mx->qb_local[i]         = NULL;
+    mx->qm_local[i]         = NULL;
+    fc->hc->matrix_local[i] = NULL;
+    fc->ptype_local[i]      = NULL;
+  }
+
+  free(blocks->pR);
+  free(blocks->qb);
+  free(blocks->qm);
+  free(blocks->outside_ml);
+  free(blocks->ptype);
+}
+
+
+PRIVATE int
+fill_arrays_global(vrna_fold_compound_t *fc)
+{
+  int                 i, j, n, winSize, turn;
+  FLT_OR_DBL          qbt1, **qb, **qm, max_real;
+  vrna_mx_pf_aux_ml_t aux_mx_ml;
+
+  n         = (int)fc->length;
+  winSize   = fc->window_size;
+  turn      = fc->exp_params->model_details.min_loop_size;
+  qb        = fc->exp_matrices->qb_local;
+  qm        = fc->exp_matrices->qm_local;
+  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  aux_mx_ml = vrna_exp_E_ml_fast_init(fc);
+
+  /* same column-wise order as in vrna_probs_window(), but without the exterior loop */
+  for (j = turn + 2; j <= n; j++) {
+    for (i = j - turn - 1; i >= MAX2(1, (j - winSize + 1)); i--) {
+      qbt1 = 0.;
+
+      if (fc->hc->matrix_local[i][j - i]) {
+        qbt1  += vrna_exp_E_hp_loop(fc, i, j);
+        qbt1  += vrna_exp_E_int_loop(fc, i, j);
+        qbt1  += vrna_exp_E_mb_loop_fast(fc, i, j, aux_mx_ml);
+      }
+
+      qb[i][j]  = qbt1;
+      qm[i][j]  = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
+
+      if ((qb[i][j] >= max_real) || (qm[i][j] >= max_real)) {
+        vrna_message_warning("vrna_pf_window_global@LPfold.c: "
+                             "overflow while computing partition function for segment [%d,%d]\n"
+                             "use larger pf_scale",
+                             i,
+                             j);
+        vrna_exp_E_ml_fast_free(aux_mx_ml);
+        return 0;
+      }
+    }
+
+    vrna_exp_E_ml_fast_rotate(aux_mx_ml);
+  }
+
+  vrna_exp_E_ml_fast_free(aux_mx_ml);
+
+  return 1;
+}
+
+
+PRIVATE FLT_OR_DBL
+exp_ext_stem_global(vrna_fold_compound_t  *fc,
+                    int                   i,
+                    int                   j)
+{
+  short     *S1, *S2;
+  int       n;
+  vrna_md_t *md;
+
+  n   = (int)fc->length;
+  S1  = fc->sequence_encoding;
+  S2  = fc->sequence_encoding2;
+  md  = &(fc->exp_params->model_details);
+
+  return vrna_exp_E_ext_stem(vrna_get_ptype_md(S2[i], S2[j], md),
+                             (i > 1) ? S1[i - 1] : -1,
+                             (j < n) ? S1[j + 1] : -1,
+                             fc->exp_params);
+}
+
+
+/*
+ *  Global exterior loop of the entire sequence, i.e. the partition
+ *  functions lq5[j] = log(Q[1,j]) and lq3[i] = log(Q[i,n]). Since
+ *  Q[1,n] easily exceeds the range of floating point numbers for long
+ *  sequences, we store them as logarithms and combine the at most
+ *  winSize terms of each recursion step relative to their maximum
+ */
+PRIVATE void
+exterior_global(vrna_fold_compound_t  *fc,
+                double                *lq5,
+                double                *lq3)
+{
+  unsigned char **hc_mx;
+  int           i, j, n, winSize, turn, *hc_up;
+  double        m, q;
+  FLT_OR_DBL    **qb, *scale;
+
+  n       = (int)fc->length;
+  winSize = fc->window_size;
+  turn    = fc->exp_params->model_details.min_loop_size;
+  qb      = fc->exp_matrices->qb_local;
+  scale   = fc->exp_matrices->scale;
+  hc_mx   = fc->hc->matrix_local;
+  hc_up   = fc->hc->up_ext;
+
+  lq5[0] = 0.;
+  for (j = 1; j <= n; j++) {
+    m = (hc_up[j] > 0) ? lq5[j - 1] : -INFINITY;
+    for (i = MAX2(1, j - winSize + 1); i < j - turn; i++)
+      if ((qb[i][j] > 0.) && (hc_mx[i][j - i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP))
+        m = MAX2(m, lq5[i - 1]);
+
+    if (m == -INFINITY) {
+      lq5[j] = -INFINITY;
+      continue;
+    }
+
+    q = (hc_up[j] > 0) ? exp(lq5[j - 1] - m) * scale[1] : 0.;
+    for (i = MAX2(1, j - winSize + 1); i < j - turn; i++)
+      if ((qb[i][j] > 0.) && (hc_mx[i][j - i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP))
+        q += exp(lq5[i - 1] - m) * qb[i][j] * exp_ext_stem_global(fc, i, j);
+
+    lq5[j] = (q > 0.) ? m + log(q) : -INFINITY;
+  }
+
+  lq3[n + 1] = 0.;
+  for (i = n; i >= 1; i--) {
+    m = (hc_up[i] > 0) ? lq3[i + 1] : -INFINITY;
+    for (j = i + turn + 1; j <= MIN2(n, i + winSize - 1); j++)
+      if ((qb[i][j] > 0.) && (hc_mx[i][j - i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP))
+        m = MAX2(m, lq3[j + 1]);
+
+    if (m == -INFINITY) {
+      lq3[i] = -INFINITY;
+      continue;
+    }
+
+    q = (hc_up[i] > 0) ? exp(lq3[i + 1] - m) * scale[1] : 0.;
+    for (j = i + turn + 1; j <= MIN2(n, i + winSize - 1); j++)
+      if ((qb[i][j] > 0.) && (hc_mx[i][j - i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP))
+        q += exp(lq3[j + 1] - m) * qb[i][j] * exp_ext_stem_global(fc, i, j);
+
+    lq3[i] = (q > 0.) ? m + log(q) : -INFINITY;
+  }
+}
+
+
+/*
+ *  Outside recursions for the banded global partition function. We first
+ *  accumulate the outside partition functions (divided by Q[1,n]) of each
+ *  pair (k,l) in pR[k][l] and finally multiply by qb[k][l]. Pairs are
+ *  processed with decreasing l such that all enclosing pairs are final
+ *  once we reach (k,l). Interior loop contributions are pushed from each
+ *  finished pair to its enclosed pairs, while multibranch loop contributions
+ *  are collected for the current l from the enclosing pairs (i,j) through
+ *
+ *    ml_a[i] = sum_j outside_ml[i][j] * expMLbase[j - l - 1]
+ *    ml_b[i] = sum_j outside_ml[i][j] * qm[l + 1][j - 1]
+ *
+ *  where outside_ml[i][j] is the outside partition function of (i,j) times
+ *  the Boltzmann factor for closing a multibranch loop.
+ */
+PRIVATE void
+compute_probs_global(vrna_fold_compound_t *fc,
+                     FLT_OR_DBL           **outside_ml,
+                     double               *lq5,
+                     double               *lq3)
+{
+  unsigned char     **hc_mx, hc_kl;
+  short             *S1, *S2;
+  int               i, j, k, l, p, q, n, winSize, turn, u1, u2, type, type2, noclose,
+                    last_p, *rtype, *hc_up_int, *hc_up_ml, up_ok;
+  FLT_OR_DBL        **qb, **qm, **pR, *scale, *expMLbase, *ml_a, *ml_b, out, ml,
+                    qml, q_temp;
+  vrna_exp_param_t  *pf_params;
+  vrna_md_t         *md;
+
+  n         = (int)fc->length;
+  winSize   = fc->window_size;
+  pf_params = fc->exp_params;
+  md        = &(pf_params->model_details);
+  turn      = md->min_loop_size;
+  rtype     = &(md->rtype[0]);
+  S1        = fc->sequence_encoding;
+  S2        = fc->sequence_encoding2;
+  qb        = fc->exp_matrices->qb_local;
+  qm        = fc->exp_matrices->qm_local;
+  pR        = fc->exp_matrices->pR;
+  scale     = fc->exp_matrices->scale;
+  expMLbase = fc->exp_matrices->expMLbase;
+  hc_mx     = fc->hc->matrix_local;
+  hc_up_int = fc->hc->up_int;
+  hc_up_ml  = fc->hc->up_ml;
+  ml_a      = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+  ml_b      = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+
+  for (l = n; l > turn + 1; l--) {
+    /* collect multibranch loop contributions of all pairs (i,j) with j > l */
+    for (i = MAX2(1, l - winSize + 2); i < l - turn - 1; i++) {
+      ml_a[i] = ml_b[i] = 0.;
+
+      for (j = l + 1; j <= MIN2(n, i + winSize - 1); j++) {
+        if (outside_ml[i][j] == 0.)
+          continue;
+
+        if (j - l - 1 <= hc_up_ml[l + 1])
+          ml_a[i] += outside_ml[i][j] * expMLbase[j - l - 1];
+
+        ml_b[i] += outside_ml[i][j] * qm[l + 1][j - 1];
+      }
+    }
+
+    for (k = l - turn - 1; k >= MAX2(1, l - winSize + 1); k--) {
+      hc_kl = hc_mx[k][l - k];
+
+      if (qb[k][l] == 0.) {
+        pR[k][l] = 0.;
+        continue;
+      }
+
+      type  = vrna_get_ptype_md(S2[k], S2[l], md);
+      out   = pR[k][l]; /* interior loop contributions */
+
+      /* exterior loop */
+      if (hc_kl & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP)
+        out += exp(lq5[k - 1] + lq3[l + 1] - lq5[n]) *
+               exp_ext_stem_global(fc, k, l);
+
+      /* multibranch loop */
+      if (hc_kl & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
+        ml    = 0.;
+        up_ok = 1;
+        for (i = k - 1; i >= MAX2(1, l - winSize + 2); i--) {
+          if ((i + 1 < k) && (hc_up_ml[i + 1] < k - i - 1))
+            up_ok = 0;
+
+          qml = (i + 1 < k) ? qm[i + 1][k - 1] : 0.;
+          ml  += qml * (ml_a[i] + ml_b[i]);
+          if (up_ok)
+            ml += expMLbase[k - i - 1] * ml_b[i];
+        }
+
+        out += ml * exp_E_MLstem(type, S1[k - 1], S1[l + 1], pf_params);
+      }
+
+      pR[k][l]          = out;
+      outside_ml[k][l]  = 0.;
+
+      if (out == 0.)
+        continue;
+
+      if (hc_kl & VRNA_CONSTRAINT_CONTEXT_MB_LOOP)
+        outside_ml[k][l] = out *
+                           pf_params->expMLclosing *
+                           scale[2] *
+                           exp_E_MLstem(rtype[type], S1[l - 1], S1[k + 1], pf_params);
+
+      /* push interior loop contributions to all enclosed pairs (p,q) */
+      if (!(hc_kl & VRNA_CONSTRAINT_CONTEXT_INT_LOOP))
+        continue;
+
+      noclose = ((md->noGUclosure) && ((type == 3) || (type == 4))) ? 1 : 0;
+      last_p  = MIN2(k + MAXLOOP + 1, l - turn - 2);
+
+      for (p = k + 1; p <= last_p; p++) {
+        u1 = p - k - 1;
+        if ((u1 > 0) && (hc_up_int[k + 1] < u1))
+          break;
+
+        for (q = l - 1; q > p + turn; q--) {
+          u2 = l - q - 1;
+          if (u1 + u2 > MAXLOOP)
+            break;
+
+          if ((u2 > 0) && (hc_up_int[q + 1] < u2))
+            break;
+
+          if ((qb[p][q] == 0.) ||
+              (!(hc_mx[p][q - p] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC)))
+            continue;
+
+          type2 = rtype[vrna_get_ptype_md(S2[p], S2[q], md)];
+
+          if ((u1 + u2 > 0) &&
+              ((noclose) || ((md->noGUclosure) && ((type2 == 3) || (type2 == 4)))))
+            continue;
+
+          q_temp = exp_E_IntLoop(u1,
+                                 u2,
+                                 type,
+                                 type2,
+                                 S1[k + 1],
+                                 S1[l - 1],
+                                 S1[p - 1],
+                                 S1[q + 1],
+                                 pf_params);
+
+          pR[p][q] += out * q_temp * scale[u1 + u2 + 2];
+        }
+      }
+    }
+  }
+
+  /* turn outside partition functions into probabilities */
+  for (k = 1; k <= n; k++)
+    for (l = k + turn + 1; l <= MIN2(n, k + winSize - 1); l++)
+      pR[k][l] *= qb[k][l];
+
+  free(ml_a);
+  free(ml_b);
+}
+
+
 #if 0
 PRIVATE vrna_ep_t *
 get_deppp(vrna_fold_compound_t  *vc,
@@ -14,8 +14,14 @@
 #include <string.h>
 #include <float.h>
 #include <math.h>
+#include <stdint.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/structures.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/loops/all.h"
@@ -23,6 +29,7 @@
 #include "ViennaRNA/constraints/hard.h"
 #include "ViennaRNA/constraints/soft.h"
 #include "ViennaRNA/alphabet.h"
+#include "ViennaRNA/datastructures/hash_tables.h"
 #include "ViennaRNA/boltzmann_sampling.h"
 
 #include "ViennaRNA/loops/external_sc_pf.inc"
@@ -31,6 +38,14 @@
 
 #include "ViennaRNA/data_structures_nonred.inc"
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/wavefront.inc"
+
 /*
  #################################
  # PREPROCESSOR DEFININTIONS     #
@@ -67,8 +82,44 @@ struct vrna_pbacktrack_memory_s {
   NR_NODE           *root_node;
   NR_NODE           *current_node;
   struct nr_memory  *memory_dat;
+  vrna_hash_table_t drawn;      /* structures drawn concurrently so far */
+  int               drawn_pk;   /* whether drawn structures are stored as packed keys */
+  int               concurrent; /* whether samples are still drawn concurrently */
+#ifdef _OPENMP
+  omp_lock_t        lock;     /* serializes concurrent sampling rounds on the same memory tree */
+#endif
+};
+
+/*
+ * Random number stream of a single thread. If active, each sample is drawn
+ * from its own 48-bit linear congruential sequence whose start is derived
+ * from the seed and the index of the sample. Thus, samples are reproducible
+ * irrespective of the number of threads and the order they are processed in.
+ */
+struct sample_rng {
+  int           active;
+  uint64_t      seed;
+  unsigned int  sample;   /* index of the next sample */
+  uint64_t      state;
+};
+
+/* samples buffered by a single thread */
+struct sample_buffer {
+  unsigned int  num;
+  char          **list;
+};
+
+/* forward samples of the sequential non-redundant backtracking not drawn concurrently before */
+struct sample_filter {
+  vrna_pbacktrack_mem_t             nr_mem;
+  vrna_boltzmann_sampling_callback  *cb;
+  void                              *data;
+  unsigned int                      accepted;
 };
 
+#define RNG_MASK            ((((uint64_t)1) << 48) - 1)
+#define SAMPLES_PER_CHUNK   32
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -103,6 +154,15 @@ PRIVATE char  *info_no_circ =
   "No implementation for circular RNAs available.";
 
 
+PRIVATE struct sample_rng rng = {
+  0, 0, 0, 0
+};
+
+#ifdef _OPENMP
+#pragma omp threadprivate(rng)
+#endif
+
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -110,7 +170,8 @@ PRIVATE char  *info_no_circ =
  */
 
 PRIVATE struct vrna_pbacktrack_memory_s *
-nr_init(vrna_fold_compound_t *fc);
+nr_init(vrna_fold_compound_t  *fc,
+        int                   num_threads);
 
 
 PRIVATE struct sc_wrappers *
@@ -181,6 +242,69 @@ pbacktrack_circ(vrna_fold_compound_t              *fc,
                 void                              *data);
 
 
+PRIVATE void
+prepare_q1k_qln(vrna_fold_compound_t *fc);
+
+
+#ifdef _OPENMP
+PRIVATE unsigned int
+pbacktrack_parallel(vrna_fold_compound_t              *fc,
+                    unsigned int                      length,
+                    unsigned int                      num_samples,
+                    vrna_boltzmann_sampling_callback  *bs_cb,
+                    void                              *data,
+                    int                               num_threads);
+
+
+PRIVATE void
+store_sample(const char *structure,
+             void       *data);
+
+
+PRIVATE unsigned int
+pbacktrack_nr_concurrent(vrna_fold_compound_t             *fc,
+                         unsigned int                     length,
+                         unsigned int                     num_samples,
+                         vrna_boltzmann_sampling_callback *bs_cb,
+                         void                             *data,
+                         vrna_pbacktrack_mem_t            nr_mem,
+                         int                              num_threads);
+
+
+PRIVATE void *
+nr_drawn_entry(vrna_pbacktrack_mem_t  nr_mem,
+               const char             *structure);
+
+
+PRIVATE int
+nr_drawn_insert(vrna_pbacktrack_mem_t nr_mem,
+                const char            *structure);
+
+
+PRIVATE void
+filter_drawn(const char *structure,
+             void       *data);
+
+
+PRIVATE int
+free_drawn_entry(void *hash_entry);
+
+
+PRIVATE int
+free_drawn_pk_entry(void *hash_entry);
+
+
+#endif
+
+
+PRIVATE INLINE void
+sample_rng_next(void);
+
+
+PRIVATE INLINE double
+sample_urn(void);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -195,7 +319,8 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
                            vrna_pbacktrack_mem_t            *nr_mem,
                            unsigned int                     options)
 {
-  unsigned int i = 0;
+  unsigned int  i = 0;
+  int           num_threads;
 
   if (fc) {
     vrna_mx_pf_t *matrices = fc->exp_matrices;
@@ -217,13 +342,37 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
       } else if (!nr_mem) {
         vrna_message_warning("vrna_pbacktrack5*(): Pointer to nr_mem must not be NULL!");
       } else {
-        if (*nr_mem == NULL)
-          *nr_mem = nr_init(fc);
+        num_threads = wavefront_threads(fc, &(fc->exp_params->model_details));
 
+        /* concurrent calls must not create different memory trees */
+#ifdef _OPENMP
+#pragma omp critical (pbacktrack_nr_init)
+#endif
+        {
+          if (*nr_mem == NULL)
+            *nr_mem = nr_init(fc, num_threads);
+        }
+
+#ifdef _OPENMP
+        omp_set_lock(&((*nr_mem)->lock));
+
+        if ((*nr_mem)->drawn)
+          i = pbacktrack_nr_concurrent(fc, length, num_samples, bs_cb, data, *nr_mem, num_threads);
+        else
+#endif
         i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, *nr_mem);
 
+#ifdef _OPENMP
+        omp_unset_lock(&((*nr_mem)->lock));
+#endif
+
         /* print warning if we've aborted backtracking too early */
-        if ((i > 0) && (i < num_samples)) {
+        if ((i > 0) && (i < num_samples) && ((*nr_mem)->drawn)) {
+          vrna_message_warning("vrna_pbacktrack5*(): "
+                               "Stopped non-redundant backtracking after %d samples"
+                               " due to numeric instabilities!",
+                               i);
+        } else if ((i > 0) && (i < num_samples)) {
           vrna_message_warning("vrna_pbacktrack5*(): "
                                "Stopped non-redundant backtracking after %d samples"
                                " due to numeric instabilities!\n"
@@ -234,10 +383,18 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
                                fc->exp_matrices->q[fc->iindx[1] - length]);
         }
       }
-    } else if (fc->exp_params->model_details.circ) {
-      i = pbacktrack_circ(fc, num_samples, bs_cb, data);
     } else {
-      i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, NULL);
+      num_threads = wavefront_threads(fc, &(fc->exp_params->model_details));
+
+#ifdef _OPENMP
+      if (num_threads > 1)
+        i = pbacktrack_parallel(fc, length, num_samples, bs_cb, data, num_threads);
+      else
+#endif
+      if (fc->exp_params->model_details.circ)
+        i = pbacktrack_circ(fc, num_samples, bs_cb, data);
+      else
+        i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, NULL);
     }
   }
 
@@ -253,6 +410,10 @@ vrna_pbacktrack_mem_free(struct vrna_pbacktrack_memory_s *s)
     free_all_nr(s->current_node);
 #else
     free_all_nrll(&(s->memory_dat));
+#endif
+    vrna_ht_free(s->drawn);
+#ifdef _OPENMP
+    omp_destroy_lock(&(s->lock));
 #endif
     free(s);
   }
@@ -289,7 +450,8 @@ sc_free(struct sc_wrappers *sc_wrap)
 
 
 PRIVATE struct vrna_pbacktrack_memory_s *
-nr_init(vrna_fold_compound_t *fc)
+nr_init(vrna_fold_compound_t  *fc,
+        int                   num_threads)
 {
   size_t                          block_size;
   double                          pf;
@@ -311,6 +473,32 @@ nr_init(vrna_fold_compound_t *fc)
 #endif
 
   s->current_node = s->root_node;
+  s->drawn        = NULL;
+  s->drawn_pk     = 0;
+  s->concurrent   = 0;
+
+#ifdef _OPENMP
+  omp_init_lock(&(s->lock));
+
+  if (num_threads > 1) {
+    /* pair tables can not represent G-Quadruplexes, so we resort to dot-bracket keys for them */
+    if (fc->exp_params->model_details.gquad) {
+      s->drawn = vrna_ht_init(14,
+                              &vrna_ht_db_comp,
+                              &vrna_ht_db_hash_func,
+                              &free_drawn_entry);
+    } else {
+      s->drawn = vrna_ht_init(14,
+                              &vrna_ht_pk_comp,
+                              &vrna_ht_pk_hash_func,
+                              &free_drawn_pk_entry);
+      s->drawn_pk = 1;
+    }
+
+    s->concurrent = 1;
+  }
+
+#endif
 
   return s;
 }
@@ -326,40 +514,22 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
                 struct vrna_pbacktrack_memory_s   *nr_mem)
 {
   char                *pstruc;
-  unsigned int        i, n;
-  int                 ret, pf_overflow, is_dup, *my_iindx;
-  FLT_OR_DBL          *q1k, *qln, *q;
-  vrna_mx_pf_t        *matrices;
+  unsigned int        i;
+  int                 ret, pf_overflow, is_dup;
   struct sc_wrappers  *sc_wrap;
 
   i           = 0;
   pf_overflow = 0;
   sc_wrap     = sc_init(vc);
 
-  n         = vc->length;
-  my_iindx  = vc->iindx;
-  matrices  = vc->exp_matrices;
-  q         = matrices->q;
-  q1k       = matrices->q1k;
-  qln       = matrices->qln;
-
-  if (!(q1k && qln)) {
-    matrices->q1k = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
-    matrices->qln = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
-    q1k           = matrices->q1k;
-    qln           = matrices->qln;
-    for (i = 1; i <= n; i++) {
-      q1k[i]  = q[my_iindx[1] - i];
-      qln[i]  = q[my_iindx[i] - n];
-    }
-    q1k[0]      = 1.0;
-    qln[n + 1]  = 1.0;
-  }
+  prepare_q1k_qln(vc);
 
   for (i = 0; i < num_samples; i++) {
     is_dup  = 1;
     pstruc  = vrna_alloc((length + 1) * sizeof(char));
 
+    sample_rng_next();
+
     memset(pstruc, '.', sizeof(char) * length);
 
     if (nr_mem)
@@ -412,6 +582,346 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
 }
 
 
+PRIVATE void
+prepare_q1k_qln(vrna_fold_compound_t *fc)
+{
+  unsigned int  i, n;
+  int           *my_iindx;
+  FLT_OR_DBL    *q1k, *qln, *q;
+  vrna_mx_pf_t  *matrices;
+
+  n         = fc->length;
+  my_iindx  = fc->iindx;
+  matrices  = fc->exp_matrices;
+  q         = matrices->q;
+  q1k       = matrices->q1k;
+  qln       = matrices->qln;
+
+  if (!(q1k && qln)) {
+    matrices->q1k = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
+    matrices->qln = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+    q1k           = matrices->q1k;
+    qln           = matrices->qln;
+    for (i = 1; i <= n; i++) {
+      q1k[i]  = q[my_iindx[1] - i];
+      qln[i]  = q[my_iindx[i] - n];
+    }
+    q1k[0]      = 1.0;
+    qln[n + 1]  = 1.0;
+  }
+}
+
+
+#ifdef _OPENMP
+/*
+ *  Draw samples with multiple threads. The samples are split into chunks that
+ *  are processed independently, each sample with its own random number stream.
+ *  The callback, however, is executed in the order of the samples, such that
+ *  the output is identical for any number of threads.
+ */
+PRIVATE unsigned int
+pbacktrack_parallel(vrna_fold_compound_t              *fc,
+                    unsigned int                      length,
+                    unsigned int                      num_samples,
+                    vrna_boltzmann_sampling_callback  *bs_cb,
+                    void                              *data,
+                    int                               num_threads)
+{
+  unsigned int  count, num_chunks;
+  int           c, stop, circ;
+  uint64_t      seed;
+
+  /* seed all random number streams from the global random number generator */
+  seed  = (uint64_t)(vrna_urn() * 4294967296.) << 32;
+  seed  ^= (uint64_t)(vrna_urn() * 4294967296.);
+
+  count       = 0;
+  stop        = 0;
+  circ        = fc->exp_params->model_details.circ;
+  num_chunks  = (num_samples + SAMPLES_PER_CHUNK - 1) / SAMPLES_PER_CHUNK;
+
+  if (!circ)
+    prepare_q1k_qln(fc);
+
+#pragma omp parallel for ordered schedule(dynamic, 1) num_threads(num_threads)
+  for (c = 0; c < (int)num_chunks; c++) {
+    unsigned int          first, size, drawn, k;
+    int                   halt;
+    struct sample_buffer  buffer;
+
+    first       = (unsigned int)c * SAMPLES_PER_CHUNK;
+    size        = MIN2(SAMPLES_PER_CHUNK, num_samples - first);
+    drawn       = 0;
+    buffer.num  = 0;
+    buffer.list = (char **)vrna_alloc(sizeof(char *) * size);
+
+#pragma omp atomic read
+    halt = stop;
+
+    if (!halt) {
+      rng.active  = 1;
+      rng.seed    = seed;
+      rng.sample  = first;
+
+      if (circ)
+        drawn = pbacktrack_circ(fc, size, &store_sample, (void *)&buffer);
+      else
+        drawn = wrap_pbacktrack(fc, length, size, &store_sample, (void *)&buffer, NULL);
+
+      rng.active = 0;
+    }
+
+#pragma omp ordered
+    {
+#pragma omp atomic read
+      halt = stop;
+
+      if (!halt) {
+        if (bs_cb)
+          for (k = 0; k < buffer.num; k++)
+            bs_cb(buffer.list[k], data);
+
+        count += drawn;
+
+        /* backtracking failed, so we must not report any subsequent samples */
+        if (drawn < size) {
+#pragma omp atomic write
+          stop = 1;
+        }
+      }
+    }
+
+    for (k = 0; k < buffer.num; k++)
+      free(buffer.list[k]);
+
+    free(buffer.list);
+  }
+
+  return count;
+}
+
+
+PRIVATE void
+store_sample(const char *structure,
+             void       *data)
+{
+  struct sample_buffer *buffer = (struct sample_buffer *)data;
+
+  buffer->list[buffer->num++] = strdup(structure);
+}
+
+
+/*
+ *  Draw non-redundant samples concurrently. Since sampling without replacement
+ *  is equivalent to sampling with replacement where repeatedly drawn structures
+ *  are discarded, we draw regular samples in parallel and reject all structures
+ *  drawn before. As soon as most samples of a round are rejected, i.e. the
+ *  samples drawn so far cover a large fraction of the ensemble, we switch to
+ *  the sequential non-redundant backtracking, which then only has to reject
+ *  the structures drawn during the concurrent phase.
+ */
+PRIVATE unsigned int
+pbacktrack_nr_concurrent(vrna_fold_compound_t             *fc,
+                         unsigned int                     length,
+                         unsigned int                     num_samples,
+                         vrna_boltzmann_sampling_callback *bs_cb,
+                         void                             *data,
+                         vrna_pbacktrack_mem_t            nr_mem,
+                         int                              num_threads)
+{
+  unsigned int          count, round, drawn, accepted, k;
+  struct sample_buffer  buffer;
+  struct sample_filter  filter;
+
+  count = 0;
+
+  while ((nr_mem->concurrent) && (count < num_samples)) {
+    round       = num_samples - count;
+    accepted    = 0;
+    buffer.num  = 0;
+    buffer.list = (char **)vrna_alloc(sizeof(char *) * round);
+
+    drawn = pbacktrack_parallel(fc, length, round, &store_sample, (void *)&buffer, num_threads);
+
+    for (k = 0; k < buffer.num; k++) {
+      if (nr_drawn_insert(nr_mem, buffer.list[k])) {
+        if (bs_cb)
+          bs_cb(buffer.list[k], data);
+
+        accepted++;
+      }
+
+      free(buffer.list[k]);
+    }
+
+    free(buffer.list);
+
+    count += accepted;
+
+    /* backtracking failed */
+    if (drawn < round)
+      return count;
+
+    if (2 * accepted < round)
+      nr_mem->concurrent = 0;
+  }
+
+  filter.nr_mem = nr_mem;
+  filter.cb     = bs_cb;
+  filter.data   = data;
+
+  while (count < num_samples) {
+    round           = num_samples - count;
+    filter.accepted = 0;
+
+    drawn = wrap_pbacktrack(fc, length, round, &filter_drawn, (void *)&filter, nr_mem);
+
+    count += filter.accepted;
+
+    /* non-redundant backtracking stopped prematurely */
+    if (drawn < round)
+      break;
+  }
+
+  return count;
+}
+
+
+/*
+ *  create a hash table entry for a drawn structure, i.e. either a compact
+ *  packed key of its pair table, or a copy of its dot-bracket string
+ */
+PRIVATE void *
+nr_drawn_entry(vrna_pbacktrack_mem_t  nr_mem,
+               const char             *structure)
+{
+  short               *pt;
+  vrna_ht_entry_pk_t  *entry_pk;
+  vrna_ht_entry_db_t  *entry_db;
+
+  if (nr_mem->drawn_pk) {
+    pt                = vrna_ptable(structure);
+    entry_pk          = (vrna_ht_entry_pk_t *)vrna_alloc(sizeof(vrna_ht_entry_pk_t));
+    entry_pk->key     = vrna_pt_pack(pt);
+    entry_pk->energy  = 0.;
+
+    free(pt);
+
+    return (void *)entry_pk;
+  }
+
+  entry_db            = (vrna_ht_entry_db_t *)vrna_alloc(sizeof(vrna_ht_entry_db_t));
+  entry_db->structure = strdup(structure);
+  entry_db->energy    = 0.;
+
+  return (void *)entry_db;
+}
+
+
+/* store a concurrently drawn structure, unless it has been drawn before */
+PRIVATE int
+nr_drawn_insert(vrna_pbacktrack_mem_t nr_mem,
+                const char            *structure)
+{
+  void *entry;
+
+  entry = nr_drawn_entry(nr_mem, structure);
+
+  if (vrna_ht_get(nr_mem->drawn, entry)) {
+    if (nr_mem->drawn_pk)
+      free_drawn_pk_entry(entry);
+    else
+      free_drawn_entry(entry);
+
+    return 0;
+  }
+
+  vrna_ht_insert(nr_mem->drawn, entry);
+
+  return 1;
+}
+
+
+PRIVATE void
+filter_drawn(const char *structure,
+             void       *data)
+{
+  int                   found;
+  void                  *entry;
+  struct sample_filter  *filter;
+
+  filter  = (struct sample_filter *)data;
+  entry   = nr_drawn_entry(filter->nr_mem, structure);
+  found   = (vrna_ht_get(filter->nr_mem->drawn, entry) != NULL);
+
+  if (filter->nr_mem->drawn_pk)
+    free_drawn_pk_entry(entry);
+  else
+    free_drawn_entry(entry);
+
+  if (found)
+    return;
+
+  if (filter->cb)
+    filter->cb(structure, filter->data);
+
+  filter->accepted++;
+}
+
+
+PRIVATE int
+free_drawn_entry(void *hash_entry)
+{
+  free(((vrna_ht_entry_db_t *)hash_entry)->structure);
+  free(hash_entry);
+
+  return 0;
+}
+
+
+PRIVATE int
+free_drawn_pk_entry(void *hash_entry)
+{
+  free(((vrna_ht_entry_pk_t *)hash_entry)->key);
+  free(hash_entry);
+
+  return 0;
+}
+
+
+#endif
+
+
+PRIVATE INLINE void
+sample_rng_next(void)
+{
+  uint64_t z;
+
+  if (rng.active) {
+    /* splitmix64 finalizer to decorrelate the streams of subsequent samples */
+    z         = rng.seed + (uint64_t)(rng.sample + 1) * 0x9E3779B97F4A7C15ULL;
+    z         = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z         = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z         ^= z >> 31;
+    rng.state = z & RNG_MASK;
+    rng.sample++;
+  }
+}
+
+
+/* uniform random number in [0,1) from the current stream, same recurrence as erand48() */
+PRIVATE INLINE double
+sample_urn(void)
+{
+  if (rng.active) {
+    rng.state = (0x5DEECE66DULL * rng.state + 0xBULL) & RNG_MASK;
+    return (double)rng.state / (double)(RNG_MASK + 1);
+  }
+
+  return vrna_urn();
+}
+
+
 /* backtrack one external */
 PRIVATE int
 backtrack_ext_loop(int                              init_val,
@@ -525,7 +1035,7 @@ backtrack_ext_loop(int                              init_val,
             return 0;
         }
 
-        r       = vrna_urn() * (q1k[j] - fbd);
+        r       = sample_urn() * (q1k[j] - fbd);
         q_temp  = q1k[j - 1] * scale[1];
 
         if (sc_wrapper_ext->red_ext)
@@ -573,7 +1083,7 @@ backtrack_ext_loop(int                              init_val,
             (*q_remain);
     }
 
-    r = vrna_urn() * (q1k[j] - q_temp - fbd);
+    r = sample_urn() * (q1k[j] - q_temp - fbd);
     u = j - 1;
     i = 2;
 
@@ -673,7 +1183,7 @@ backtrack_ext_loop(int                              init_val,
                 (*q_remain);
         }
 
-        r       = vrna_urn() * (qln[i] - fbd);
+        r       = sample_urn() * (qln[i] - fbd);
         q_temp  = qln[i + 1] * scale[1];
 
         if (sc_wrapper_ext->red_ext)
@@ -721,7 +1231,7 @@ backtrack_ext_loop(int                              init_val,
             (*q_remain);
     }
 
-    r = vrna_urn() * (qln[i] - q_temp - fbd);
+    r = sample_urn() * (qln[i] - q_temp - fbd);
     for (qt = 0, j = i + 1; j <= length; j++) {
       ij            = my_iindx[i] - j;
       hc_decompose  = hard_constraints[n * i + j];
@@ -887,7 +1397,7 @@ backtrack_qm(int                              i,
             (*q_remain);
     }
 
-    r = vrna_urn() * (qm[my_iindx[i] - j] - fbd);
+    r = sample_urn() * (qm[my_iindx[i] - j] - fbd);
     if (current_node) {
       fbds = NR_GET_WEIGHT(*current_node, memorized_node_cur, NRT_QM_UNPAIR, i, 0) *
              qm[my_iindx[i] - j] /
@@ -1119,7 +1629,7 @@ backtrack_qm1(int                             i,
           (*q_remain);
   }
 
-  r   = vrna_urn() * (qm1[jindx[j] + i] - fbd);
+  r   = sample_urn() * (qm1[jindx[j] + i] - fbd);
   ii  = my_iindx[i];
   for (qt = 0., l = j; l > i + turn; l--) {
     il = jindx[l] + i;
@@ -1212,7 +1722,7 @@ backtrack_qm2(int                   k,
   turn          = vc->exp_params->model_details.min_loop_size;
   sc_wrapper_ml = &(sc_wrap->sc_wrapper_ml);
 
-  r = vrna_urn() * qm2[k];
+  r = sample_urn() * qm2[k];
   /* we have to search for our barrier u between qm1 and qm1  */
   if (sc_wrapper_ml->decomp_ml) {
     for (qom2t = 0., u = k + turn + 1; u < n - turn - 1; u++) {
@@ -1364,7 +1874,7 @@ backtrack(int                             i,
     pstruc[i - 1] = '(';
     pstruc[j - 1] = ')';
 
-    r     = vrna_urn() * (qbr - fbd);
+    r     = sample_urn() * (qbr - fbd);
     qbt1  = 0.;
 
     hc_decompose = hard_constraints[n * i + j];
@@ -1713,13 +2223,15 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
     /* initialize pstruct with single bases  */
     memset(pstruc, '.', sizeof(char) * n);
 
+    sample_rng_next();
+
     qt = 1.0 * scale[n];
 
     /* add soft constraints for open chain configuration */
     if (sc_wrapper_ext->red_up)
       qt *= sc_wrapper_ext->red_up(1, n, sc_wrapper_ext);
 
-    r = vrna_urn() * qo;
+    r = sample_urn() * qo;
 
     /* open chain? */
     if (qt > r)
@@ -1834,7 +2346,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
     {
       /* as we reach this part, we have to search for our barrier between qm and qm2  */
       qt  = 0.;
-      r   = vrna_urn() * qmo;
+      r   = sample_urn() * qmo;
       if (sc_wrapper_ml->decomp_ml) {
         for (k = turn + 2; k < n - 2 * turn - 3; k++) {
           qt += qm[my_iindx[1] - k] *
@@ -15,6 +15,14 @@
  *  @{
  *  @brief  Functions to draw random structure samples from the ensemble according to their
  *          equilibrium probability
+ *
+ *  Samples are drawn in parallel if the fold compound was created with #vrna_md_t.num_threads > 1.
+ *  In that case, each sample uses its own stream of random numbers, which is derived from the
+ *  global random number generator (see vrna_urn()). Thus, the samples are reproducible and
+ *  independent of the actual number of threads, but differ from those obtained with a single
+ *  thread. In non-redundant sampling mode, the samples are drawn concurrently as long as only
+ *  few of them are rejected for being drawn before. Once the samples cover a large fraction
+ *  of the ensemble, the sampling proceeds sequentially.
  */
 
 
@@ -46,6 +54,9 @@
  * @parblock
  * This function will be called for each secondary structure that has been successfully backtraced
  * from the partition function DP matrices.
+ *
+ * If the samples are drawn with multiple threads, i.e. #vrna_md_t.num_threads > 1,
+ * this function is still called for one structure at a time and in order of the samples.
  * @endparblock
  *
  * @see vrna_pbacktrack5_cb(), vrna_pbacktrack_cb(), vrna_pbacktrack5_resume_cb(),
@@ -69,6 +80,9 @@ typedef void (vrna_boltzmann_sampling_callback)(const char  *stucture,
  *  @note Do not forget to release memory occupied by this data structure before
  *        losing its context! Use vrna_pbacktrack_mem_free().
  *
+ *  @note The data structure may be shared among multiple threads. Sampling rounds
+ *        that use the same memory are then executed one after another.
+ *
  *  @see  vrna_pbacktrack5_resume(), vrna_pbacktrack_resume(), vrna_pbacktrack5_resume_cb(),
  *        vrna_pbacktrack_resume_cb(), vrna_pbacktrack_mem_free()
  */
@@ -928,7 +928,7 @@ vrna_subopt_zuker(vrna_fold_compound_t *vc)
   vrna_mx_mfe_t   *matrices;
   vrna_md_t       *md;
 
-  md    = &(vc->params->model_details);
+  md    = &(vrna_params_unshare(vc)->model_details);
   turn  = md->min_loop_size;
 
   /* do some magic to re-use cofold code although vc is single sequence */
@@ -1117,7 +1117,7 @@ wrap_cofold(const char    *string,
 
   if (parameters) {
     /* replace params if necessary */
-    free(vc->params);
+    vrna_params_free(vc->params);
     vc->params = P;
   } else {
     free(P);
@@ -1203,7 +1203,7 @@ wrap_zukersubopt(const char   *string,
 
   if (parameters) {
     /* replace params if necessary */
-    free(vc->params);
+    vrna_params_free(vc->params);
     vc->params = P;
   } else {
     free(P);
@@ -1311,7 +1311,7 @@ update_cofold_params(void)
     v = backward_compat_compound;
 
     if (v->params)
-      free(v->params);
+      vrna_params_free(v->params);
 
     set_model_details(&md);
     v->params = vrna_params(&md);
@@ -1328,7 +1328,7 @@ update_cofold_params_par(vrna_param_t *parameters)
     v = backward_compat_compound;
 
     if (v->params)
-      free(v->params);
+      vrna_params_free(v->params);
 
     if (parameters) {
       v->params = vrna_params_copy(parameters);
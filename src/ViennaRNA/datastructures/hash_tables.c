@@ -1,107 +1,204 @@
 /* Taken from the barriers tool and modified by GE. */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
 
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+
+#if VRNA_WITH_PTHREADS
+# include <pthread.h>
+#endif
 
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/structures.h"
 #include "ViennaRNA/datastructures/hash_tables.h"
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/*
+ *  The hash table uses open addressing with linear probing. Each slot
+ *  stores the pointer to the entry together with its (mixed) hash value,
+ *  such that the compare callback is only executed for entries whose
+ *  hash values match. Whenever the load factor exceeds HT_MAX_LOAD, a
+ *  new table of twice the size is allocated and the entries are moved
+ *  incrementally, i.e. HT_MIGRATE_STEPS slots of the old table are
+ *  processed with each insertion. Until then, look-ups consult both
+ *  tables.
+ *
+ *  Concurrent hash tables consist of HT_STRIPES independent shards,
+ *  each protected by its own lock. The shard of an entry is determined
+ *  by the upper bits of its hash value.
+ */
+#define HT_KEY_SPACE      0xFFFFFFFFUL  /* size passed to the hash function callback */
+#define HT_MIN_BITS       4
+#define HT_MAX_LOAD_NUM   3             /* maximum load factor of 3/4 */
+#define HT_MAX_LOAD_DEN   4
+#define HT_MIGRATE_STEPS  64
+#define HT_STRIPE_BITS    6
+#define HT_DELETED        ((void *)&ht_deleted_marker)
+
+static char ht_deleted_marker;
+
+typedef struct {
+  void          **entries;  /* pointers to entries, NULL for empty and HT_DELETED for removed ones */
+  uint32_t      *hashes;    /* mixed hash values of the entries */
+  unsigned long size;       /* number of slots, always a power of 2 */
+  unsigned long used;       /* number of non-empty slots, including removed ones */
+  unsigned long live;       /* number of entries */
+} ht_slots_t;
+
+typedef struct {
+  ht_slots_t      tab;        /* current table */
+  ht_slots_t      old;        /* previous table while entries are migrated, or empty */
+  unsigned long   migrate;    /* next slot of the previous table to migrate */
+  unsigned long   collisions;
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_t mtx;
+#endif
+} ht_shard_t;
 
 struct vrna_hash_table_s {
   unsigned int                      hash_bits;
-  unsigned long                     Hash_size;
-  /* must be power of 2^hash_bits -1 (example: HASHSIZE 67108864 -1 = 2^26 -1 )*/
-  void                              **Hash_table;
-  unsigned long                     Collisions;
+  unsigned int                      shard_bits;
+  unsigned int                      concurrent;
+  ht_shard_t                        *shards;
   vrna_callback_ht_compare_entries  *Compare_function;
   vrna_callback_ht_hash_function    *Hash_function;
   vrna_callback_ht_free_entry       *Free_hash_entry;
 };
 
 
-typedef struct vrna_hash_entry_list_s {
-  unsigned long length;
-  unsigned long allocated_length;
-  void **hash_entries;
-} vrna_hash_entry_list_t;
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE struct vrna_hash_table_s *
+ht_init(unsigned int                      hash_bits,
+        unsigned int                      shard_bits,
+        vrna_callback_ht_compare_entries  *compare_function,
+        vrna_callback_ht_hash_function    *hash_function,
+        vrna_callback_ht_free_entry       *free_hash_entry);
 
-/* ----------------------------------------------------------------- */
 
+PRIVATE int
+slots_init(ht_slots_t     *s,
+           unsigned long  size);
+
+
+PRIVATE void
+slots_free(ht_slots_t *s);
+
+
+PRIVATE long
+slots_find(struct vrna_hash_table_s *ht,
+           ht_slots_t               *s,
+           void                     *x,
+           uint32_t                 h);
+
+
+PRIVATE unsigned long
+slots_put(ht_slots_t  *s,
+          void        *x,
+          uint32_t    h);
+
+
+PRIVATE void
+shard_migrate(ht_shard_t    *shard,
+              unsigned long steps);
+
+
+PRIVATE void
+shard_grow(ht_shard_t *shard);
+
+
+PRIVATE INLINE uint32_t
+ht_hash(struct vrna_hash_table_s  *ht,
+        void                      *x);
+
+
+PRIVATE INLINE ht_shard_t *
+ht_shard(struct vrna_hash_table_s *ht,
+         uint32_t                 h);
+
+
+PRIVATE INLINE void
+shard_lock(struct vrna_hash_table_s *ht,
+           ht_shard_t               *shard);
+
+
+PRIVATE INLINE void
+shard_unlock(struct vrna_hash_table_s *ht,
+             ht_shard_t               *shard);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
 PUBLIC struct vrna_hash_table_s *
 vrna_ht_init(unsigned int                     hash_bits,
              vrna_callback_ht_compare_entries *compare_function,
              vrna_callback_ht_hash_function   *hash_function,
              vrna_callback_ht_free_entry      *free_hash_entry)
 {
-  struct vrna_hash_table_s *ht = NULL;
-
-  if (hash_bits > 0) {
-    ht = (struct vrna_hash_table_s *)vrna_alloc(sizeof(struct vrna_hash_table_s));
-
-    ht->hash_bits = hash_bits;
-    /* must be power of 2^hash_bits -1 (example: HASHSIZE 67108864 -1 = 2^26 -1 )
-     * if we want to use '&' instead of modulo '%' for limiting the hash value. */
-    ht->Hash_size   = (((unsigned long)1 << hash_bits) - 1);
-    ht->Hash_table  = calloc((ht->Hash_size + 1), sizeof(void *));
-    if(!ht->Hash_table){
-    	fprintf(stderr,"Error: could not allocate space for the hash table!\n");
-    	free(ht);
-    	return NULL;
-    }
-    ht->Collisions  = 0;
+  return ht_init(hash_bits,
+                 0,
+                 compare_function,
+                 hash_function,
+                 free_hash_entry);
+}
 
-    if ((!compare_function) &&
-        (!hash_function) &&
-        (!free_hash_entry)) {
-      /*
-       *  Fall-back to expect dot-bracket structure string and
-       *  free energy value as entries in hash table, i.e. pointers
-       *  to vrna_ht_entry_db_t
-       */
-      ht->Compare_function  = &vrna_ht_db_comp;
-      ht->Hash_function     = &vrna_ht_db_hash_func;
-      ht->Free_hash_entry   = &vrna_ht_db_free_entry;
-    } else if ((compare_function) &&
-               (hash_function) &&
-               (free_hash_entry)) {
-      /* Bind user-defined compare, free, and hash functions */
-      ht->Compare_function  = compare_function;
-      ht->Hash_function     = hash_function;
-      ht->Free_hash_entry   = free_hash_entry;
-    } else {
-      /*
-       *  One of the function pointers is missing, so we don't initialize
-       *  anything!
-       */
-      free(ht);
-      ht = NULL;
-    }
-  }
 
-  return ht;
+PUBLIC struct vrna_hash_table_s *
+vrna_ht_init_concurrent(unsigned int                      hash_bits,
+                        vrna_callback_ht_compare_entries  *compare_function,
+                        vrna_callback_ht_hash_function    *hash_function,
+                        vrna_callback_ht_free_entry       *free_hash_entry)
+{
+  return ht_init(hash_bits,
+                 HT_STRIPE_BITS,
+                 compare_function,
+                 hash_function,
+                 free_hash_entry);
 }
 
 
 unsigned long
 vrna_ht_size(struct vrna_hash_table_s *ht)
 {
+  unsigned int  i;
+  unsigned long size = 0;
+
   if (ht)
-    return ht->Hash_size;
+    for (i = 0; i < (1U << ht->shard_bits); i++)
+      size += ht->shards[i].tab.size;
 
-  return 0L;
+  return size;
 }
 
 
 unsigned long
 vrna_ht_collisions(struct vrna_hash_table_s *ht)
 {
+  unsigned int  i;
+  unsigned long collisions = 0;
+
   if (ht)
-    return ht->Collisions;
+    for (i = 0; i < (1U << ht->shard_bits); i++)
+      collisions += ht->shards[i].collisions;
 
-  return 0L;
+  return collisions;
 }
 
 
@@ -109,27 +206,32 @@ PUBLIC void *
 vrna_ht_get(struct vrna_hash_table_s  *ht,
             void                      *x)             /* returns NULL unless x is in the hash */
 {
-  unsigned int hashval;
+  uint32_t    h;
+  long        pos;
+  void        *entry;
+  ht_shard_t  *shard;
+
+  entry = NULL;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if(hashval >= ht->Hash_size){
-      fprintf(stderr,"Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return NULL;
+    h     = ht_hash(ht, x);
+    shard = ht_shard(ht, h);
+
+    shard_lock(ht, shard);
+
+    pos = slots_find(ht, &(shard->tab), x, h);
+    if (pos >= 0) {
+      entry = shard->tab.entries[pos];
+    } else if (shard->old.entries) {
+      pos = slots_find(ht, &(shard->old), x, h);
+      if (pos >= 0)
+        entry = shard->old.entries[pos];
     }
 
-    vrna_hash_entry_list_t *entries =  ht->Hash_table[hashval];
-    if(entries){
-      int i;
-      for(i=0; i < entries->length; i++){
-        if(ht->Compare_function(x, entries->hash_entries[i]) == 0){
-          //found the same entry
-          return entries->hash_entries[i]; /* success */
-        }
-      }
-    }
+    shard_unlock(ht, shard);
   }
-  return NULL;
+
+  return entry;
 }
 
 
@@ -137,52 +239,34 @@ vrna_ht_get(struct vrna_hash_table_s  *ht,
 
 PUBLIC int
 vrna_ht_insert(struct vrna_hash_table_s *ht,
-               void                     *x)         /* returns 1 if x already was in the hash */
+               void                     *x)
 {
-  unsigned int hashval;
+  uint32_t    h;
+  ht_shard_t  *shard;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if(hashval >= ht->Hash_size){
-      fprintf(stderr,"Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return -1; /* failure */;
-    }
-    else {
-      vrna_hash_entry_list_t *entries = (vrna_hash_entry_list_t *)ht->Hash_table[hashval];
-      if(entries){
-        //at first test if the entry is already in the list.
-        int i;
-        for(i=0; i < entries->length; i++){
-          if(ht->Compare_function(x, entries->hash_entries[i]) == 0){
-            //found the same entry
-            return 0; /* success */
-          }
-        }
-
-        ht->Collisions++;
-        //append the entry to the list with same hash values.
-        if(i >= entries->length){
-          if(i >= entries->allocated_length){
-            //we have to extend the list.
-            entries->allocated_length += 100;
-            entries->hash_entries = vrna_realloc(entries->hash_entries, entries->allocated_length*sizeof(void*));
-          }
-          entries->hash_entries[entries->length] = x;
-          entries->length++;
-        }
-      }
-      else{
-        //allocate new list and insert the value
-    	entries = malloc(sizeof(vrna_hash_entry_list_t));
-        entries->allocated_length = 2;
-        entries->hash_entries = vrna_alloc(entries->allocated_length*sizeof(void*));
-        entries->hash_entries[0] = x;
-        entries->length = 1;
-        ht->Hash_table[hashval] = entries;
-      }
-      return 0; /* success */
+    h     = ht_hash(ht, x);
+    shard = ht_shard(ht, h);
+
+    shard_lock(ht, shard);
+
+    if (shard->old.entries)
+      shard_migrate(shard, HT_MIGRATE_STEPS);
+
+    /* nothing to do if the entry is already in the hash table */
+    if ((slots_find(ht, &(shard->tab), x, h) < 0) &&
+        ((!shard->old.entries) || (slots_find(ht, &(shard->old), x, h) < 0))) {
+      if ((shard->tab.used + 1) * HT_MAX_LOAD_DEN > shard->tab.size * HT_MAX_LOAD_NUM)
+        shard_grow(shard);
+
+      shard->collisions += slots_put(&(shard->tab), x, h);
     }
+
+    shard_unlock(ht, shard);
+
+    return 0; /* success */
   }
+
   return -1; /* failure */
 }
 
@@ -190,23 +274,30 @@ vrna_ht_insert(struct vrna_hash_table_s *ht,
 PUBLIC void
 vrna_ht_clear(struct vrna_hash_table_s *ht)
 {
-  unsigned int i;
+  unsigned int  i;
+  unsigned long k;
+  ht_shard_t    *shard;
 
   if (ht) {
-    for (i = 0; i < ht->Hash_size + 1; i++) {
-      vrna_hash_entry_list_t *entries = ht->Hash_table[i];
-      if (entries) {
-        int i;
-        for(i=0; i < entries->length; i++){
-          ht->Free_hash_entry(entries->hash_entries[i]);
-          entries->hash_entries[i] = NULL;
-        }
-        free(entries->hash_entries);
-        free(entries);
-      }
-    }
+    for (i = 0; i < (1U << ht->shard_bits); i++) {
+      shard = ht->shards + i;
 
-    ht->Collisions = 0;
+      for (k = 0; k < shard->tab.size; k++)
+        if ((shard->tab.entries[k]) && (shard->tab.entries[k] != HT_DELETED))
+          ht->Free_hash_entry(shard->tab.entries[k]);
+
+      for (k = shard->migrate; k < shard->old.size; k++)
+        if ((shard->old.entries[k]) && (shard->old.entries[k] != HT_DELETED))
+          ht->Free_hash_entry(shard->old.entries[k]);
+
+      slots_free(&(shard->old));
+      shard->migrate = 0;
+
+      memset(shard->tab.entries, 0, sizeof(void *) * shard->tab.size);
+      shard->tab.used   = 0;
+      shard->tab.live   = 0;
+      shard->collisions = 0;
+    }
   }
 }
 
@@ -214,9 +305,21 @@ vrna_ht_clear(struct vrna_hash_table_s *ht)
 PUBLIC void
 vrna_ht_free(struct vrna_hash_table_s *ht)
 {
+  unsigned int i;
+
   if (ht) {
     vrna_ht_clear(ht);
-    free(ht->Hash_table);
+
+    for (i = 0; i < (1U << ht->shard_bits); i++) {
+      slots_free(&(ht->shards[i].tab));
+#if VRNA_WITH_PTHREADS
+      if (ht->concurrent)
+        pthread_mutex_destroy(&(ht->shards[i].mtx));
+
+#endif
+    }
+
+    free(ht->shards);
     free(ht);
   }
 }
@@ -229,36 +332,286 @@ vrna_ht_remove(struct vrna_hash_table_s *ht,
                void                     *x)
 {
   /* doesn't free anything ! */
-  unsigned int hashval;
+  uint32_t    h;
+  long        pos;
+  ht_shard_t  *shard;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if(hashval >= ht->Hash_size){
-      fprintf(stderr,"Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return;
+    h     = ht_hash(ht, x);
+    shard = ht_shard(ht, h);
+
+    shard_lock(ht, shard);
+
+    /* mark the slot as removed to keep the probe sequences of other entries intact */
+    pos = slots_find(ht, &(shard->tab), x, h);
+    if (pos >= 0) {
+      shard->tab.entries[pos] = HT_DELETED;
+      shard->tab.live--;
+    } else if (shard->old.entries) {
+      pos = slots_find(ht, &(shard->old), x, h);
+      if (pos >= 0) {
+        shard->old.entries[pos] = HT_DELETED;
+        shard->old.live--;
+      }
     }
-    vrna_hash_entry_list_t *entries =  ht->Hash_table[hashval];
-    if(entries){
-      int i;
-      for(i=0; i < entries->length; i++){
-        if(ht->Compare_function(x, entries->hash_entries[i]) == 0){
-          //found the same entry --> shift the list to the left in order to delete the value.
-          int size_rest = entries->length-i-1;
-          if(size_rest <= 0){
-            entries->hash_entries[i] = 0;
-          }
-          else{
-            void *offset = entries->hash_entries+i;
-            void *next_entry = entries->hash_entries+i+1;
-            memcpy(offset,next_entry, size_rest*sizeof(void*));
-          }
-          entries->hash_entries[entries->length-1] = NULL;
-          entries->length--;
-          return; /* success */
-        }
+
+    shard_unlock(ht, shard);
+  }
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE struct vrna_hash_table_s *
+ht_init(unsigned int                      hash_bits,
+        unsigned int                      shard_bits,
+        vrna_callback_ht_compare_entries  *compare_function,
+        vrna_callback_ht_hash_function    *hash_function,
+        vrna_callback_ht_free_entry       *free_hash_entry)
+{
+  unsigned int              i, bits;
+  struct vrna_hash_table_s  *ht = NULL;
+
+  if (hash_bits > 0) {
+    ht = (struct vrna_hash_table_s *)vrna_alloc(sizeof(struct vrna_hash_table_s));
+
+    ht->hash_bits   = hash_bits;
+    ht->shard_bits  = shard_bits;
+    ht->concurrent  = (shard_bits > 0) ? 1 : 0;
+
+    if ((!compare_function) &&
+        (!hash_function) &&
+        (!free_hash_entry)) {
+      /*
+       *  Fall-back to expect dot-bracket structure string and
+       *  free energy value as entries in hash table, i.e. pointers
+       *  to vrna_ht_entry_db_t
+       */
+      ht->Compare_function  = &vrna_ht_db_comp;
+      ht->Hash_function     = &vrna_ht_db_hash_func;
+      ht->Free_hash_entry   = &vrna_ht_db_free_entry;
+    } else if ((compare_function) &&
+               (hash_function) &&
+               (free_hash_entry)) {
+      /* Bind user-defined compare, free, and hash functions */
+      ht->Compare_function  = compare_function;
+      ht->Hash_function     = hash_function;
+      ht->Free_hash_entry   = free_hash_entry;
+    } else {
+      /*
+       *  One of the function pointers is missing, so we don't initialize
+       *  anything!
+       */
+      free(ht);
+      return NULL;
+    }
+
+    /* the initial size of 2^hash_bits slots is distributed among all shards */
+    bits = (hash_bits > shard_bits + HT_MIN_BITS) ? hash_bits - shard_bits : HT_MIN_BITS;
+
+    ht->shards = (ht_shard_t *)vrna_alloc(sizeof(ht_shard_t) * (1U << shard_bits));
+
+    for (i = 0; i < (1U << shard_bits); i++) {
+      if (!slots_init(&(ht->shards[i].tab), 1UL << bits)) {
+        fprintf(stderr, "Error: could not allocate space for the hash table!\n");
+        while (i > 0)
+          slots_free(&(ht->shards[--i].tab));
+
+        free(ht->shards);
+        free(ht);
+        return NULL;
       }
+
+#if VRNA_WITH_PTHREADS
+      if (ht->concurrent)
+        pthread_mutex_init(&(ht->shards[i].mtx), NULL);
+
+#endif
     }
   }
+
+  return ht;
+}
+
+
+PRIVATE int
+slots_init(ht_slots_t     *s,
+           unsigned long  size)
+{
+  s->entries  = (void **)calloc(size, sizeof(void *));
+  s->hashes   = (uint32_t *)malloc(sizeof(uint32_t) * size);
+  s->size     = size;
+  s->used     = 0;
+  s->live     = 0;
+
+  if ((!s->entries) || (!s->hashes)) {
+    slots_free(s);
+    return 0;
+  }
+
+  return 1;
+}
+
+
+PRIVATE void
+slots_free(ht_slots_t *s)
+{
+  free(s->entries);
+  free(s->hashes);
+  s->entries  = NULL;
+  s->hashes   = NULL;
+  s->size     = 0;
+  s->used     = 0;
+  s->live     = 0;
+}
+
+
+PRIVATE long
+slots_find(struct vrna_hash_table_s *ht,
+           ht_slots_t               *s,
+           void                     *x,
+           uint32_t                 h)
+{
+  unsigned long pos, mask;
+  void          *e;
+
+  mask = s->size - 1;
+
+  for (pos = h & mask; (e = s->entries[pos]) != NULL; pos = (pos + 1) & mask)
+    if ((e != HT_DELETED) &&
+        (s->hashes[pos] == h) &&
+        (ht->Compare_function(x, e) == 0))
+      return (long)pos;
+
+  return -1;
+}
+
+
+/* insert an entry that is known to be absent, returns the number of occupied slots probed */
+PRIVATE unsigned long
+slots_put(ht_slots_t  *s,
+          void        *x,
+          uint32_t    h)
+{
+  unsigned long pos, mask, probes;
+
+  mask = s->size - 1;
+
+  for (probes = 0, pos = h & mask;
+       (s->entries[pos]) && (s->entries[pos] != HT_DELETED);
+       pos = (pos + 1) & mask)
+    probes++;
+
+  if (!s->entries[pos])
+    s->used++;
+
+  s->entries[pos] = x;
+  s->hashes[pos]  = h;
+  s->live++;
+
+  return probes;
+}
+
+
+PRIVATE void
+shard_migrate(ht_shard_t    *shard,
+              unsigned long steps)
+{
+  void *e;
+
+  for (; (steps > 0) && (shard->migrate < shard->old.size); steps--, shard->migrate++) {
+    e = shard->old.entries[shard->migrate];
+    if ((e) && (e != HT_DELETED)) {
+      slots_put(&(shard->tab), e, shard->old.hashes[shard->migrate]);
+      /* keep the probe sequences within the previous table intact */
+      shard->old.entries[shard->migrate] = HT_DELETED;
+      shard->old.live--;
+    }
+  }
+
+  if (shard->migrate == shard->old.size) {
+    slots_free(&(shard->old));
+    shard->migrate = 0;
+  }
+}
+
+
+PRIVATE void
+shard_grow(ht_shard_t *shard)
+{
+  unsigned long size;
+
+  /* finish any pending migration first */
+  if (shard->old.entries)
+    shard_migrate(shard, shard->old.size);
+
+  /* tables that are mostly filled with removed entries are rebuilt at the same size */
+  size = shard->tab.size;
+  if (shard->tab.live * 2 >= size)
+    size *= 2;
+
+  shard->old      = shard->tab;
+  shard->migrate  = 0;
+
+  if (!slots_init(&(shard->tab), size))
+    vrna_message_error("vrna_ht_insert: could not allocate space for the hash table!");
+
+  shard_migrate(shard, HT_MIGRATE_STEPS);
+}
+
+
+PRIVATE INLINE uint32_t
+ht_hash(struct vrna_hash_table_s  *ht,
+        void                      *x)
+{
+  uint32_t h = (uint32_t)ht->Hash_function(x, HT_KEY_SPACE);
+
+  /* murmur3 finalizer to spread hash functions with poor low order bits */
+  h ^= h >> 16;
+  h *= 0x85ebca6bU;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+
+  return h;
+}
+
+
+PRIVATE INLINE ht_shard_t *
+ht_shard(struct vrna_hash_table_s *ht,
+         uint32_t                 h)
+{
+  if (ht->shard_bits == 0)
+    return ht->shards;
+
+  return ht->shards + (h >> (32 - ht->shard_bits));
+}
+
+
+PRIVATE INLINE void
+shard_lock(struct vrna_hash_table_s *ht,
+           ht_shard_t               *shard)
+{
+#if VRNA_WITH_PTHREADS
+  if (ht->concurrent)
+    pthread_mutex_lock(&(shard->mtx));
+
+#endif
+}
+
+
+PRIVATE INLINE void
+shard_unlock(struct vrna_hash_table_s *ht,
+             ht_shard_t               *shard)
+{
+#if VRNA_WITH_PTHREADS
+  if (ht->concurrent)
+    pthread_mutex_unlock(&(shard->mtx));
+
+#endif
 }
 
 
@@ -400,3 +753,30 @@ vrna_ht_db_free_entry(void *hash_entry)
   free(((vrna_ht_entry_db_t *)hash_entry)->structure);
   return 0;
 }
+
+
+PUBLIC int
+vrna_ht_pk_comp(void  *x,
+                void  *y)
+{
+  return vrna_pt_pack_cmp(((vrna_ht_entry_pk_t *)x)->key,
+                          ((vrna_ht_entry_pk_t *)y)->key);
+}
+
+
+PUBLIC unsigned int
+vrna_ht_pk_hash_func(void           *x,
+                     unsigned long  hashtable_size)
+{
+  uint64_t h = ((vrna_ht_entry_pk_t *)x)->key[0];
+
+  return (unsigned int)((h ^ (h >> 32)) % hashtable_size);
+}
+
+
+PUBLIC int
+vrna_ht_pk_free_entry(void *hash_entry)
+{
+  free(((vrna_ht_entry_pk_t *)hash_entry)->key);
+  return 0;
+}
@@ -1,6 +1,8 @@
 #ifndef VIENNA_RNA_PACKAGE_HASH_UTIL_H
 #define VIENNA_RNA_PACKAGE_HASH_UTIL_H
 
+#include <stdint.h>
+
 /* Taken from the barriers tool and modified by GE. */
 
 /**
@@ -21,6 +23,10 @@
  *  Here, we provide an abstract implementation of a hash table interface
  *  and a concrete implementation for pairs of secondary structure and
  *  corresponding free energy value.
+ *
+ *  Hash tables use open addressing and grow automatically whenever they
+ *  become too crowded. Entries are moved to the enlarged table incrementally,
+ *  such that no single insertion has to re-hash the entire table.
  */
 
 /**
@@ -48,10 +54,15 @@ typedef int (vrna_callback_ht_compare_entries)(void *x,
 
 /**
  *  @brief  Callback function to generate a hash key, i.e. hash function
+ *
+ *  Since hash tables grow dynamically, the value passed as @p hashtable_size
+ *  is the size of the key space, i.e. @f$ 2^{32} - 1 @f$, rather than the
+ *  actual number of slots.
+ *
  *  @see    vrna_ht_init(), vrna_ht_db_hash_func()
  *  @param  x               A hash table entry
- *  @param  hashtable_size  The size of the hash table
- *  @return                 The hash table key for entry @p x
+ *  @param  hashtable_size  The size of the key space
+ *  @return                 The hash table key for entry @p x (smaller than @p hashtable_size)
  */
 typedef unsigned int (vrna_callback_ht_hash_function)(void          *x,
                                                       unsigned long hashtable_size);
@@ -70,7 +81,8 @@ typedef int (vrna_callback_ht_free_entry)(void *x);
  *  @brief  Get an initialized hash table
  *
  *  This function returns a ready-to-use hash table with pre-allocated
- *  memory for a particular number of entries.
+ *  memory for a particular number of entries. The table grows automatically
+ *  if more entries are inserted.
  *
  *  @note
  *  @parblock
@@ -82,10 +94,9 @@ typedef int (vrna_callback_ht_free_entry)(void *x);
  *
  *  arguments.
  *  @endparblock
- *  @warning  If @p hash_bits is larger than 27 you have to compile it with
- *            the flag gcc -mcmodel=large.
+ *  @see  vrna_ht_init_concurrent()
  *
- *  @param  b                 Number of bits for the hash table. This determines the size (@f$2^b -1@f$).
+ *  @param  b                 Number of bits for the hash table. This determines the initial size (@f$2^b@f$).
  *  @param  compare_function  A function pointer to compare any two entries in the hash table (may be @p NULL)
  *  @param  hash_function     A function pointer to retrieve the hash value of any entry (may be @p NULL)
  *  @param  free_hash_entry   A function pointer to free the memory occupied by any entry (may be @p NULL)
@@ -98,11 +109,38 @@ vrna_ht_init(unsigned int                     b,
              vrna_callback_ht_free_entry      *free_hash_entry);
 
 
+/**
+ *  @brief  Get an initialized hash table that supports concurrent access
+ *
+ *  Same as vrna_ht_init() but the hash table is split into a number of
+ *  independent stripes, each protected by its own lock. This allows for
+ *  concurrent calls to vrna_ht_get(), vrna_ht_insert(), and vrna_ht_remove()
+ *  from multiple threads.
+ *
+ *  @note   Concurrent access requires POSIX threads support at compile time.
+ *          vrna_ht_clear() and vrna_ht_free() must not be called concurrently
+ *          with any other function that accesses the same hash table.
+ *
+ *  @see  vrna_ht_init()
+ *
+ *  @param  b                 Number of bits for the hash table. This determines the initial size (@f$2^b@f$).
+ *  @param  compare_function  A function pointer to compare any two entries in the hash table (may be @p NULL)
+ *  @param  hash_function     A function pointer to retrieve the hash value of any entry (may be @p NULL)
+ *  @param  free_hash_entry   A function pointer to free the memory occupied by any entry (may be @p NULL)
+ *  @return                   An initialized, empty hash table, or @p NULL on any error
+ */
+vrna_hash_table_t
+vrna_ht_init_concurrent(unsigned int                      b,
+                        vrna_callback_ht_compare_entries  *compare_function,
+                        vrna_callback_ht_hash_function    *hash_function,
+                        vrna_callback_ht_free_entry       *free_hash_entry);
+
+
 /**
  *  @brief  Get the size of the hash table
  *
  *  @param  ht  The hash table
- *  @return     The size of the hash table, i.e. the maximum number of entries
+ *  @return     The current size of the hash table, i.e. the number of available slots
  */
 unsigned long
 vrna_ht_size(vrna_hash_table_t ht);
@@ -142,9 +180,10 @@ vrna_ht_get(vrna_hash_table_t ht,
  *
  *  Writes the pointer to your hash entry into the table.
  *
- *  @warning  In case of collisions, this function simply
+ *  @note     In case of collisions, this function simply
  *            increments the hash key until a free entry in
- *            the hash table is found.
+ *            the hash table is found. The hash table is enlarged
+ *            automatically if it becomes too crowded.
  *
  *  @see vrna_ht_init(), vrna_hash_delete(), vrna_ht_clear()
  *
@@ -274,6 +313,69 @@ int vrna_ht_db_free_entry(void *hash_entry);
 /* End of dot-bracket interface */
 /**@}*/
 
+
+/**
+ *  @name Packed structure / Free Energy entries
+ *  @{
+ */
+
+/**
+ *  @brief  Hash table entry for packed structure keys
+ *  @see  vrna_pt_pack(), vrna_ht_init(), vrna_ht_pk_comp(), vrna_ht_pk_hash_func(), vrna_ht_pk_free_entry()
+ */
+typedef struct {
+  uint64_t  *key;   /**< A secondary structure packed with vrna_pt_pack() */
+  float     energy; /**< The free energy of the structure */
+} vrna_ht_entry_pk_t;
+
+
+/**
+ *  @brief  Hash table entry comparison for packed structure keys
+ *
+ *  @see #vrna_ht_entry_pk_t, vrna_pt_pack_cmp(), vrna_ht_pk_hash_func(), vrna_ht_pk_free_entry()
+ *
+ *  @param  x   A hash table entry of type #vrna_ht_entry_pk_t
+ *  @param  y   A hash table entry of type #vrna_ht_entry_pk_t
+ *  @return     -1 if x is smaller, +1 if x is larger than y. 0 if both are equal.
+ */
+int
+vrna_ht_pk_comp(void  *x,
+                void  *y);
+
+
+/**
+ *  @brief  Hash function for packed structure keys
+ *
+ *  Since packed structure keys already contain the Zobrist hash of
+ *  the structure, this function merely folds it into the key space
+ *  of the hash table.
+ *
+ *  @see  #vrna_ht_entry_pk_t, vrna_pt_pack(), vrna_ht_pk_comp(), vrna_ht_pk_free_entry()
+ *
+ *  @param  x               A hash table entry to compute the key for
+ *  @param  hashtable_size  The size of the hash table
+ *  @return                 The hash key for entry @p x
+ */
+unsigned int
+vrna_ht_pk_hash_func(void           *x,
+                     unsigned long  hashtable_size);
+
+
+/**
+ *  @brief  Free memory occupied by the key of a packed structure hash entry
+ *
+ *  @see  #vrna_ht_entry_pk_t, vrna_ht_pk_comp(), vrna_ht_pk_hash_func()
+ *
+ *  @param  hash_entry  The hash entry to remove from memory
+ *  @return             0 on success
+ */
+int
+vrna_ht_pk_free_entry(void *hash_entry);
+
+
+/* End of packed structure interface */
+/**@}*/
+
 /**
  *  @}
  */
@@ -676,8 +676,11 @@ get_mx_alloc_vector(vrna_md_t       *md_p,
 
   /* matrices for circular folding ? */
   if (md_p->circ) {
-    md_p->uniq_ML = 1; /* we need unique ML arrays for circular folding */
-    v             |= ALLOC_CIRC;
+    /* we need unique ML arrays for circular folding (model details may be shared, so only write if necessary) */
+    if (!md_p->uniq_ML)
+      md_p->uniq_ML = 1;
+
+    v |= ALLOC_CIRC;
   }
 
   /* unique ML decomposition ? */
@@ -708,6 +711,8 @@ mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
   vars->fM2 = NULL;
   vars->ggg = NULL;
 
+  vars->fML_tmp = NULL;
+
   if (alloc_vector & ALLOC_F5)
     vars->f5 = (int *)vrna_alloc(sizeof(int) * lin_size);
 
@@ -720,8 +725,10 @@ mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
   if (alloc_vector & ALLOC_C)
     vars->c = (int *)vrna_alloc(sizeof(int) * size);
 
-  if (alloc_vector & ALLOC_FML)
-    vars->fML = (int *)vrna_alloc(sizeof(int) * size);
+  if (alloc_vector & ALLOC_FML) {
+    vars->fML     = (int *)vrna_alloc(sizeof(int) * size);
+    vars->fML_tmp = (int *)vrna_alloc(sizeof(int) * lin_size);
+  }
 
   if (alloc_vector & ALLOC_UNIQ)
     vars->fM1 = (int *)vrna_alloc(sizeof(int) * size);
@@ -745,6 +752,7 @@ mfe_matrices_free_default(vrna_mx_mfe_t *self)
   free(self->fM1);
   free(self->fM2);
   free(self->ggg);
+  free(self->fML_tmp);
 }
 
 
@@ -762,6 +770,7 @@ mfe_matrices_alloc_window(vrna_mx_mfe_t *vars,
   vars->c_local   = NULL;
   vars->fML_local = NULL;
   vars->ggg_local = NULL;
+  vars->fML_tmp   = NULL;
 
   if (alloc_vector & ALLOC_F3)
     vars->f3_local = (int *)vrna_alloc(sizeof(int) * lin_size);
@@ -769,8 +778,10 @@ mfe_matrices_alloc_window(vrna_mx_mfe_t *vars,
   if (alloc_vector & ALLOC_C)
     vars->c_local = (int **)vrna_alloc(sizeof(int *) * lin_size);
 
-  if (alloc_vector & ALLOC_FML)
+  if (alloc_vector & ALLOC_FML) {
     vars->fML_local = (int **)vrna_alloc(sizeof(int *) * lin_size);
+    vars->fML_tmp   = (int *)vrna_alloc(sizeof(int) * lin_size);
+  }
 }
 
 
@@ -783,6 +794,7 @@ mfe_matrices_free_window(vrna_mx_mfe_t  *self,
   free(self->fML_local);
   free(self->ggg_local);
   free(self->f3_local);
+  free(self->fML_tmp);
 }
 
 
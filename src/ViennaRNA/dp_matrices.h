@@ -196,6 +196,8 @@ struct {
 };
 };
 #endif
+
+  int *fML_tmp; /**<  @brief  Scratch column for multibranch loop decompositions (length + 2 entries) */
 };
 
 /**
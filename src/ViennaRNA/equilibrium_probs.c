@@ -29,7 +29,12 @@
 #include "ViennaRNA/part_func.h"
 #include "ViennaRNA/equilibrium_probs.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/loops/external_hc.inc"
+#include "ViennaRNA/wavefront.inc"
 
 /*
  #################################
@@ -154,6 +159,15 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
                      int                  *ov);
 
 
+PRIVATE void
+compute_bpp_internal_pair(vrna_fold_compound_t  *fc,
+                          int                   k,
+                          int                   l,
+                          vrna_ep_t             **bp_correction,
+                          int                   *corr_cnt,
+                          int                   *corr_size);
+
+
 PRIVATE void
 compute_bpp_internal_comparative(vrna_fold_compound_t *fc,
                                  int                  l,
@@ -190,6 +204,21 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
                                     int                   *ov);
 
 
+PRIVATE void
+compute_bpp_outside_mt(vrna_fold_compound_t *fc,
+                       int                  num_threads,
+                       helper_arrays        *ml_helpers,
+                       FLT_OR_DBL           *Qmax,
+                       int                  *ov);
+
+
+PRIVATE void
+compute_bpp_multibranch_mt(vrna_fold_compound_t *fc,
+                           int                  l,
+                           helper_arrays        *ml_helpers,
+                           FLT_OR_DBL           *prm_MLb);
+
+
 PRIVATE FLT_OR_DBL
 contrib_ext_pair(vrna_fold_compound_t *fc,
                  unsigned int         i,
@@ -219,6 +248,7 @@ vrna_pr_structure(vrna_fold_compound_t  *fc,
 
     if (fc->params->model_details.dangles % 2) {
       /* only compute probabilities with dangles = 2 || 0 */
+      vrna_params_unshare(fc);
       int dang_bak = fc->params->model_details.dangles;
       fc->params->model_details.dangles = 2;
       e                                 = (double)vrna_eval_structure(fc, structure);
@@ -559,7 +589,7 @@ PRIVATE int
 pf_create_bppm(vrna_fold_compound_t *vc,
                char                 *structure)
 {
-  int               n, i, j, l, ij, *pscore, *jindx, ov = 0;
+  int               n, i, j, l, ij, *pscore, *jindx, ov = 0, num_threads;
   FLT_OR_DBL        Qmax = 0;
   FLT_OR_DBL        *qb, *G, *probs;
   FLT_OR_DBL        *q1k, *qln;
@@ -646,16 +676,16 @@ pf_create_bppm(vrna_fold_compound_t *vc,
     compute_bpp_external(vc);
 
     /* 2. all cases where base pair (k,l) is enclosed by another pair (i,j) */
-    l = n;
-    compute_bpp_int(vc,
-                    l,
-                    &bp_correction,
-                    &corr_cnt,
-                    &corr_size,
-                    &Qmax,
-                    &ov);
-
-    for (l = n - 1; l > turn + 1; l--) {
+    num_threads = (vc->type == VRNA_FC_TYPE_SINGLE) ? wavefront_threads_outside(vc, md) : 1;
+
+    if (num_threads > 1) {
+      compute_bpp_outside_mt(vc,
+                             num_threads,
+                             ml_helpers,
+                             &Qmax,
+                             &ov);
+    } else {
+      l = n;
       compute_bpp_int(vc,
                       l,
                       &bp_correction,
@@ -664,11 +694,21 @@ pf_create_bppm(vrna_fold_compound_t *vc,
                       &Qmax,
                       &ov);
 
-      compute_bpp_mul(vc,
-                      l,
-                      ml_helpers,
-                      &Qmax,
-                      &ov);
+      for (l = n - 1; l > turn + 1; l--) {
+        compute_bpp_int(vc,
+                        l,
+                        &bp_correction,
+                        &corr_cnt,
+                        &corr_size,
+                        &Qmax,
+                        &ov);
+
+        compute_bpp_mul(vc,
+                        l,
+                        ml_helpers,
+                        &Qmax,
+                        &ov);
+      }
     }
 
     if (vc->type == VRNA_FC_TYPE_SINGLE) {
@@ -1028,15 +1068,66 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
                      int                  *corr_size,
                      FLT_OR_DBL           *Qmax,
                      int                  *ov)
+{
+  int               k, kl, *my_iindx, turn;
+  FLT_OR_DBL        *qb, *probs;
+  double            max_real;
+  vrna_md_t         *md;
+
+  my_iindx  = fc->iindx;
+  md        = &(fc->exp_params->model_details);
+  turn      = md->min_loop_size;
+  qb        = fc->exp_matrices->qb;
+  probs     = fc->exp_matrices->probs;
+  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+
+  /* 2. bonding k,l as substem of 2:loop enclosed by i,j */
+  for (k = 1; k < l - turn; k++) {
+    kl = my_iindx[k] - l;
+
+    if (qb[kl] == 0.)
+      continue;
+
+    compute_bpp_internal_pair(fc, k, l, bp_correction, corr_cnt, corr_size);
+
+    if (probs[kl] > (*Qmax)) {
+      (*Qmax) = probs[kl];
+      if ((*Qmax) > max_real / 10.)
+        vrna_message_warning("P close to overflow: %d %d %g %g\n",
+                             k, l, probs[kl], qb[kl]);
+    }
+
+    if (probs[kl] >= max_real) {
+      (*ov)++;
+      probs[kl] = FLT_MAX;
+    }
+  }
+
+  if (md->gquad)
+    compute_gquad_prob_internal(fc, l);
+}
+
+
+/*
+ *  Add the contributions of all interior loops (i,j) that
+ *  enclose the pair (k,l) to probs[kl]. This only requires
+ *  the outside probabilities of pairs (i,j) with j > l.
+ */
+PRIVATE void
+compute_bpp_internal_pair(vrna_fold_compound_t  *fc,
+                          int                   k,
+                          int                   l,
+                          vrna_ep_t             **bp_correction,
+                          int                   *corr_cnt,
+                          int                   *corr_size)
 {
   unsigned char     type, type_2;
   char              *ptype;
   short             *S1;
   unsigned int      *sn;
-  int               i, j, k, n, ij, kl, u1, u2, *my_iindx, *jindx, *rtype,
-                    turn, with_ud, *hc_up_int;
+  int               i, j, n, ij, kl, u1, u2, *my_iindx, *jindx, *rtype,
+                    with_ud, *hc_up_int;
   FLT_OR_DBL        temp, tmp2, *qb, *probs, *scale;
-  double            max_real;
   vrna_exp_param_t  *pf_params;
   vrna_md_t         *md;
   vrna_hc_t         *hc;
@@ -1051,7 +1142,6 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
   jindx       = fc->jindx;
   pf_params   = fc->exp_params;
   md          = &(pf_params->model_details);
-  turn        = md->min_loop_size;
   rtype       = &(md->rtype[0]);
   hc          = fc->hc;
   sc          = fc->sc;
@@ -1063,137 +1153,114 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
   probs = fc->exp_matrices->probs;
   scale = fc->exp_matrices->scale;
 
-  max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  kl = my_iindx[k] - l;
 
-  /* 2. bonding k,l as substem of 2:loop enclosed by i,j */
-  for (k = 1; k < l - turn; k++) {
-    kl = my_iindx[k] - l;
+  if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+    type_2 = rtype[vrna_get_ptype(jindx[l] + k, ptype)];
 
-    if (qb[kl] == 0.)
-      continue;
+    for (i = MAX2(1, k - MAXLOOP - 1); i <= k - 1; i++) {
+      u1 = k - i - 1;
+      if (hc_up_int[i + 1] < u1)
+        continue;
 
-    if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
-      type_2 = rtype[vrna_get_ptype(jindx[l] + k, ptype)];
+      for (j = l + 1; j <= MIN2(l + MAXLOOP - k + i + 2, n); j++) {
+        ij = my_iindx[i] - j;
 
-      for (i = MAX2(1, k - MAXLOOP - 1); i <= k - 1; i++) {
-        u1 = k - i - 1;
-        if (hc_up_int[i + 1] < u1)
+        if (probs[ij] == 0.)
           continue;
 
-        for (j = l + 1; j <= MIN2(l + MAXLOOP - k + i + 2, n); j++) {
-          ij = my_iindx[i] - j;
-
-          if (probs[ij] == 0.)
-            continue;
-
-          u2 = j - l - 1;
-
-          if (hc_up_int[l + 1] < u2)
-            break;
+        u2 = j - l - 1;
+
+        if (hc_up_int[l + 1] < u2)
+          break;
+
+        if (hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+          int jij = jindx[j] + i;
+          type = vrna_get_ptype(jij, ptype);
+
+          if ((sn[k] == sn[i]) &&
+              (sn[j] == sn[l])) {
+            tmp2 = probs[ij]
+                   * scale[u1 + u2 + 2]
+                   * exp_E_IntLoop(u1,
+                                   u2,
+                                   type,
+                                   type_2,
+                                   S1[i + 1],
+                                   S1[j - 1],
+                                   S1[k - 1],
+                                   S1[l + 1],
+                                   pf_params);
 
-          if (hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
-            int jij = jindx[j] + i;
-            type = vrna_get_ptype(jij, ptype);
-
-            if ((sn[k] == sn[i]) &&
-                (sn[j] == sn[l])) {
-              tmp2 = probs[ij]
-                     * scale[u1 + u2 + 2]
-                     * exp_E_IntLoop(u1,
-                                     u2,
-                                     type,
-                                     type_2,
-                                     S1[i + 1],
-                                     S1[j - 1],
-                                     S1[k - 1],
-                                     S1[l + 1],
-                                     pf_params);
+            if (sc) {
+              if (sc->exp_energy_up)
+                tmp2 *= sc->exp_energy_up[i + 1][u1]
+                        * sc->exp_energy_up[l + 1][u2];
 
-              if (sc) {
-                if (sc->exp_energy_up)
-                  tmp2 *= sc->exp_energy_up[i + 1][u1]
-                          * sc->exp_energy_up[l + 1][u2];
-
-                if (sc->exp_energy_bp)
-                  tmp2 *= sc->exp_energy_bp[jij];
-
-                if (sc->exp_energy_stack) {
-                  if ((i + 1 == k) && (j - 1 == l)) {
-                    tmp2 *= sc->exp_energy_stack[i]
-                            * sc->exp_energy_stack[k]
-                            * sc->exp_energy_stack[l]
-                            * sc->exp_energy_stack[j];
-                  }
+              if (sc->exp_energy_bp)
+                tmp2 *= sc->exp_energy_bp[jij];
+
+              if (sc->exp_energy_stack) {
+                if ((i + 1 == k) && (j - 1 == l)) {
+                  tmp2 *= sc->exp_energy_stack[i]
+                          * sc->exp_energy_stack[k]
+                          * sc->exp_energy_stack[l]
+                          * sc->exp_energy_stack[j];
                 }
-
-                if (sc->exp_f)
-                  tmp2 *= sc->exp_f(i, j, k, l, VRNA_DECOMP_PAIR_IL, sc->data);
               }
 
-              if (with_ud) {
-                FLT_OR_DBL qql, qqr;
+              if (sc->exp_f)
+                tmp2 *= sc->exp_f(i, j, k, l, VRNA_DECOMP_PAIR_IL, sc->data);
+            }
 
-                qql = qqr = 0.;
+            if (with_ud) {
+              FLT_OR_DBL qql, qqr;
 
-                if (u1 > 0) {
-                  qql = domains_up->exp_energy_cb(fc,
-                                                  i + 1, k - 1,
-                                                  VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
-                                                  domains_up->data);
-                }
+              qql = qqr = 0.;
 
-                if (u2 > 0) {
-                  qqr = domains_up->exp_energy_cb(fc,
-                                                  l + 1, j - 1,
-                                                  VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
-                                                  domains_up->data);
-                }
+              if (u1 > 0) {
+                qql = domains_up->exp_energy_cb(fc,
+                                                i + 1, k - 1,
+                                                VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
+                                                domains_up->data);
+              }
 
-                temp  = tmp2;
-                tmp2  += temp * qql;
-                tmp2  += temp * qqr;
-                tmp2  += temp * qql * qqr;
+              if (u2 > 0) {
+                qqr = domains_up->exp_energy_cb(fc,
+                                                l + 1, j - 1,
+                                                VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
+                                                domains_up->data);
               }
 
-              if (sc && sc->exp_f && sc->bt) {
-                /* store probability correction for auxiliary pairs in interior loop motif */
-                vrna_basepair_t *ptr, *aux_bps;
-                aux_bps = sc->bt(i, j, k, l, VRNA_DECOMP_PAIR_IL, sc->data);
-                for (ptr = aux_bps; ptr && ptr->i != 0; ptr++) {
-                  (*bp_correction)[*corr_cnt].i     = ptr->i;
-                  (*bp_correction)[*corr_cnt].j     = ptr->j;
-                  (*bp_correction)[(*corr_cnt)++].p = tmp2 * qb[kl];
-                  if ((*corr_cnt) == (*corr_size)) {
-                    (*corr_size)      += 5;
-                    (*bp_correction)  = vrna_realloc(*bp_correction,
-                                                     sizeof(vrna_ep_t) * (*corr_size));
-                  }
+              temp  = tmp2;
+              tmp2  += temp * qql;
+              tmp2  += temp * qqr;
+              tmp2  += temp * qql * qqr;
+            }
+
+            if (sc && sc->exp_f && sc->bt) {
+              /* store probability correction for auxiliary pairs in interior loop motif */
+              vrna_basepair_t *ptr, *aux_bps;
+              aux_bps = sc->bt(i, j, k, l, VRNA_DECOMP_PAIR_IL, sc->data);
+              for (ptr = aux_bps; ptr && ptr->i != 0; ptr++) {
+                (*bp_correction)[*corr_cnt].i     = ptr->i;
+                (*bp_correction)[*corr_cnt].j     = ptr->j;
+                (*bp_correction)[(*corr_cnt)++].p = tmp2 * qb[kl];
+                if ((*corr_cnt) == (*corr_size)) {
+                  (*corr_size)      += 5;
+                  (*bp_correction)  = vrna_realloc(*bp_correction,
+                                                   sizeof(vrna_ep_t) * (*corr_size));
                 }
-                free(aux_bps);
               }
-
-              probs[kl] += tmp2;
+              free(aux_bps);
             }
+
+            probs[kl] += tmp2;
           }
         }
       }
     }
-
-    if (probs[kl] > (*Qmax)) {
-      (*Qmax) = probs[kl];
-      if ((*Qmax) > max_real / 10.)
-        vrna_message_warning("P close to overflow: %d %d %g %g\n",
-                             k, l, probs[kl], qb[kl]);
-    }
-
-    if (probs[kl] >= max_real) {
-      (*ov)++;
-      probs[kl] = FLT_MAX;
-    }
   }
-
-  if (md->gquad)
-    compute_gquad_prob_internal(fc, l);
 }
 
 
@@ -1623,6 +1690,306 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
 }
 
 
+/*
+ *  Multi-threaded outside recursion for single sequences
+ *
+ *  The outside probability of a pair (k,l) only depends on
+ *  pairs (i,j) with j > l. Hence, all pairs of a particular
+ *  row l can be processed concurrently once the rows l + 1, ..., n
+ *  are finished. Within a row, the interior loop contributions
+ *  are independent of each other. The multibranch loop helper
+ *  arrays, however, are chained through the running sum prm_MLb.
+ *  We therefore split the multibranch loop part of each row into
+ *  an independent computation of the prml and prm_l entries, a
+ *  cheap sequential prefix pass that stores all intermediate
+ *  values of prm_MLb, and an independent final accumulation step.
+ *  This way, all additions are carried out in the same order as
+ *  in the sequential implementation and the results are identical.
+ */
+PRIVATE void
+compute_bpp_outside_mt(vrna_fold_compound_t *fc,
+                       int                  num_threads,
+                       helper_arrays        *ml_helpers,
+                       FLT_OR_DBL           *Qmax,
+                       int                  *ov)
+{
+  int         n, k, l, kl, turn, with_gquad, *my_iindx;
+  FLT_OR_DBL  *qb, *G, *probs, *prm_MLb;
+  double      max_real;
+  vrna_md_t   *md;
+
+  n           = (int)fc->length;
+  my_iindx    = fc->iindx;
+  md          = &(fc->exp_params->model_details);
+  turn        = md->min_loop_size;
+  with_gquad  = md->gquad;
+  qb          = fc->exp_matrices->qb;
+  G           = fc->exp_matrices->G;
+  probs       = fc->exp_matrices->probs;
+  max_real    = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  prm_MLb     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(num_threads) private(k, l, kl)
+#endif
+  {
+    for (l = n; l > turn + 1; l--) {
+      /* 2. bonding k,l as substem of 2:loop enclosed by i,j */
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 8)
+#endif
+      for (k = 1; k < l - turn; k++)
+        if (qb[my_iindx[k] - l] != 0.)
+          compute_bpp_internal_pair(fc, k, l, NULL, NULL, NULL);
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+      {
+        if (with_gquad)
+          compute_gquad_prob_internal(fc, l);
+      }
+
+      /* 3. bonding k,l as substem of multi-loop enclosed by i,j */
+      if (l < n)
+        compute_bpp_multibranch_mt(fc, l, ml_helpers, prm_MLb);
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+      {
+        for (k = 1; k < l - turn; k++) {
+          kl = my_iindx[k] - l;
+          if ((qb[kl] == 0.) && ((!with_gquad) || (G[kl] == 0.)))
+            continue;
+
+          if (probs[kl] > (*Qmax)) {
+            (*Qmax) = probs[kl];
+            if ((*Qmax) > max_real / 10.)
+              vrna_message_warning("P close to overflow: %d %d %g %g\n",
+                                   k, l, probs[kl], qb[kl]);
+          }
+
+          if (probs[kl] >= max_real) {
+            (*ov)++;
+            probs[kl] = FLT_MAX;
+          }
+        }
+      }
+    }
+  }
+
+  free(prm_MLb);
+}
+
+
+/*
+ *  Multibranch loop part of the outside recursion for row l. This
+ *  function must be called by all threads of the enclosing parallel
+ *  region, since it contains work-sharing constructs.
+ */
+PRIVATE void
+compute_bpp_multibranch_mt(vrna_fold_compound_t *fc,
+                           int                  l,
+                           helper_arrays        *ml_helpers,
+                           FLT_OR_DBL           *prm_MLb)
+{
+  unsigned char     tt;
+  char              *ptype;
+  short             *S, *S1, s5, s3;
+  unsigned int      *sn;
+  int               i, j, k, n, ii, ij, kl, lj, turn, *my_iindx, *jindx,
+                    *rtype, with_gquad;
+  FLT_OR_DBL        temp, ppp, mlb, prmt, prmt1, *qb, *probs, *qm, *G, *scale,
+                    *expMLbase, expMLclosing, expMLstem, *prm_l, *prm_l1, *prml;
+  vrna_exp_param_t  *pf_params;
+  vrna_md_t         *md;
+  vrna_hc_t         *hc;
+  vrna_sc_t         *sc;
+
+  n             = (int)fc->length;
+  S             = fc->sequence_encoding2;
+  S1            = fc->sequence_encoding;
+  sn            = fc->strand_number;
+  my_iindx      = fc->iindx;
+  jindx         = fc->jindx;
+  pf_params     = fc->exp_params;
+  md            = &(pf_params->model_details);
+  turn          = md->min_loop_size;
+  rtype         = &(md->rtype[0]);
+  ptype         = fc->ptype;
+  qb            = fc->exp_matrices->qb;
+  qm            = fc->exp_matrices->qm;
+  G             = fc->exp_matrices->G;
+  probs         = fc->exp_matrices->probs;
+  scale         = fc->exp_matrices->scale;
+  expMLbase     = fc->exp_matrices->expMLbase;
+  expMLclosing  = pf_params->expMLclosing;
+  hc            = fc->hc;
+  sc            = fc->sc;
+  with_gquad    = md->gquad;
+  expMLstem     = (with_gquad) ? exp_E_MLstem(0, -1, -1, pf_params) : 0;
+  prm_l         = ml_helpers->prm_l;
+  prm_l1        = ml_helpers->prm_l1;
+  prml          = ml_helpers->prml;
+
+  if (sn[l + 1] != sn[l]) {
+#ifdef _OPENMP
+#pragma omp single
+#endif
+    {
+      /* set prm_l to 0 to get prm_l1 in the next round to be 0 */
+      for (i = 0; i <= n; i++)
+        prm_l[i] = 0;
+
+      rotate_ml_helper_arrays_outer(ml_helpers);
+    }
+
+    return;
+  }
+
+  /* pairs (i, j) with i = k - 1 that enclose a multibranch loop with left-most stem (k, l) */
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 8)
+#endif
+  for (k = 2; k < l - turn; k++) {
+    i     = k - 1;
+    prmt  = prmt1 = 0.0;
+
+    ij  = my_iindx[i] - (l + 2);
+    lj  = my_iindx[l + 1] - (l + 1);
+    s3  = S1[i + 1];
+    if (sn[k] == sn[i]) {
+      for (j = l + 2; j <= n; j++, ij--, lj--) {
+        if ((hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) &&
+            (sn[j] == sn[j - 1])) {
+          tt  = vrna_get_ptype_md(S[j], S[i], md);
+          ppp = probs[ij]
+                * exp_E_MLstem(tt, S1[j - 1], s3, pf_params)
+                * qm[lj];
+
+          if ((sc) && (sc->exp_energy_bp))
+            ppp *= sc->exp_energy_bp[jindx[j] + i];
+
+          prmt += ppp;
+        }
+      }
+
+      ii  = my_iindx[i];
+      tt  = vrna_get_ptype(jindx[l + 1] + i, ptype);
+      tt  = rtype[tt];
+      if (hc->mx[(l + 1) * n + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+        prmt1 = probs[ii - (l + 1)]
+                * expMLclosing
+                * exp_E_MLstem(tt,
+                               S1[l],
+                               S1[i + 1],
+                               pf_params);
+
+        if ((sc) && (sc->exp_energy_bp))
+          prmt1 *= sc->exp_energy_bp[jindx[l + 1] + i];
+      }
+    }
+
+    prmt *= expMLclosing;
+
+    prml[i] = prmt;
+
+    /* l+1 is unpaired */
+    if (hc->up_ml[l + 1]) {
+      ppp = prm_l1[i] * expMLbase[1];
+      if ((sc) && (sc->exp_energy_up))
+        ppp *= sc->exp_energy_up[l + 1][1];
+
+      prm_l[i] = ppp + prmt1;
+    } else {
+      /* skip configuration where l+1 is unpaired */
+      prm_l[i] = prmt1;
+    }
+  }
+
+  /* sequential prefix pass for the multibranch loop parts left of k */
+#ifdef _OPENMP
+#pragma omp single
+#endif
+  {
+    mlb = 0.;
+
+    for (k = 2; k < l - turn; k++) {
+      i = k - 1;
+
+      /* i is unpaired */
+      if (hc->up_ml[i]) {
+        ppp = mlb * expMLbase[1];
+        if ((sc) && (sc->exp_energy_up))
+          ppp *= sc->exp_energy_up[i][1];
+
+        mlb = ppp + prml[i];
+      } else {
+        /* skip all configurations where i is unpaired */
+        mlb = prml[i];
+      }
+
+      prm_MLb[k]  = mlb;
+      prml[i]     = prml[i] + prm_l[i];
+    }
+  }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 8)
+#endif
+  for (k = 2; k < l - turn; k++) {
+    kl  = my_iindx[k] - l;
+    tt  = ptype[jindx[l] + k];
+
+    if (with_gquad) {
+      if ((!tt) && (G[kl] == 0.))
+        continue;
+    } else {
+      if (qb[kl] == 0.)
+        continue;
+    }
+
+    if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
+      temp = prm_MLb[k];
+
+      if (sn[k] == sn[k - 1]) {
+        for (i = 1; i <= k - 2; i++)
+          if (sn[i + 1] == sn[i])
+            temp += prml[i] *
+                    qm[my_iindx[i + 1] - (k - 1)];
+      }
+
+      s5  = ((k > 1) && (sn[k] == sn[k - 1])) ? S1[k - 1] : -1;
+      s3  = ((l < n) && (sn[l + 1] == sn[l])) ? S1[l + 1] : -1;
+
+      if (with_gquad) {
+        if (tt)
+          temp *= exp_E_MLstem(tt, s5, s3, pf_params) *
+                  scale[2];
+        else
+          temp *= G[kl] *
+                  expMLstem *
+                  scale[2];
+      } else {
+        if (tt == 0)
+          tt = 7;
+
+        temp *= exp_E_MLstem(tt, s5, s3, pf_params) *
+                scale[2];
+      }
+
+      probs[kl] += temp;
+    }
+  }
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+  rotate_ml_helper_arrays_outer(ml_helpers);
+}
+
+
 PRIVATE void
 compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
                                     int                   l,
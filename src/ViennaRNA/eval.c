@@ -41,6 +41,7 @@
 #include "ViennaRNA/eval.h"
 
 #include "ViennaRNA/color_output.inc"
+#include "ViennaRNA/loops/cache.inc"
 
 /*
  #################################
@@ -210,19 +211,16 @@ PUBLIC float
 vrna_eval_covar_structure(vrna_fold_compound_t  *vc,
                           const char            *structure)
 {
-  int   res, gq, *loop_idx;
+  int   res, *loop_idx;
   short *pt;
 
-  pt                              = vrna_ptable(structure);
-  res                             = 0;
-  gq                              = vc->params->model_details.gquad;
-  vc->params->model_details.gquad = 0;
+  pt  = vrna_ptable(structure);
+  res = 0;
 
   if (vc->type == VRNA_FC_TYPE_COMPARATIVE) {
     res = covar_energy_of_struct_pt(vc, pt);
 
-    vc->params->model_details.gquad = gq;
-    if (gq) {
+    if (vc->params->model_details.gquad) {
       loop_idx  = vrna_loopidx_from_ptable(pt);
       res       -= covar_en_corr_of_loop_gquad(vc,
                                                1,
@@ -256,6 +254,11 @@ vrna_eval_structure_pt_v(vrna_fold_compound_t *vc,
       return INF;
     }
 
+    if (vc->params->model_details.gquad)
+      vrna_message_warning("vrna_eval_*_pt: No gquadruplex support!\n"
+                           "Ignoring potential gquads in structure!\n"
+                           "Use e.g. vrna_eval_structure() instead!");
+
     vrna_cstr_t output_stream = vrna_cstr(vc->length, (file) ? file : stdout);
     e = eval_pt(vc, pt, output_stream, verbosity_level);
     vrna_cstr_fflush(output_stream);
@@ -535,9 +538,8 @@ wrap_eval_structure(vrna_fold_compound_t  *vc,
   int   res, gq, L, l[3];
   float energy;
 
-  energy                          = (float)INF / 100.;
-  gq                              = vc->params->model_details.gquad;
-  vc->params->model_details.gquad = 0;
+  energy  = (float)INF / 100.;
+  gq      = vc->params->model_details.gquad;
 
   switch (vc->type) {
     case VRNA_FC_TYPE_SINGLE:
@@ -546,8 +548,6 @@ wrap_eval_structure(vrna_fold_compound_t  *vc,
       else
         res = eval_pt(vc, pt, output_stream, verbosity);
 
-      vc->params->model_details.gquad = gq;
-
       if (gq && (parse_gquad(structure, &L, l) > 0)) {
         if (verbosity > 0)
           vrna_cstr_print_eval_sd_corr(output_stream);
@@ -564,8 +564,6 @@ wrap_eval_structure(vrna_fold_compound_t  *vc,
       else
         res = eval_pt(vc, pt, output_stream, verbosity);
 
-      vc->params->model_details.gquad = gq;
-
       if (gq && (parse_gquad(structure, &L, l) > 0)) {
         if (verbosity > 0)
           vrna_cstr_print_eval_sd_corr(output_stream);
@@ -605,11 +603,6 @@ eval_pt(vrna_fold_compound_t  *vc,
   length  = vc->length;
   sn      = vc->strand_number;
 
-  if (vc->params->model_details.gquad)
-    vrna_message_warning("vrna_eval_*_pt: No gquadruplex support!\n"
-                         "Ignoring potential gquads in structure!\n"
-                         "Use e.g. vrna_eval_structure() instead!");
-
   vrna_sc_prepare(vc, VRNA_OPTION_MFE);
 
   energy = vc->params->model_details.backtrack_type == 'M' ?
@@ -661,11 +654,6 @@ eval_circ_pt(vrna_fold_compound_t *vc,
   sc      = (vc->type == VRNA_FC_TYPE_SINGLE) ? vc->sc : NULL;
   scs     = (vc->type == VRNA_FC_TYPE_COMPARATIVE) ? vc->scs : NULL;
 
-  if (P->model_details.gquad)
-    vrna_message_warning("vrna_eval_*_pt: No gquadruplex support!\n"
-                         "Ignoring potential gquads in structure!\n"
-                         "Use e.g. vrna_eval_structure() instead!");
-
   vrna_sc_prepare(vc, VRNA_OPTION_MFE);
 
   /* evaluate all stems in exterior loop */
@@ -1154,19 +1142,20 @@ energy_of_extLoop_pt(vrna_fold_compound_t *vc,
                      int                  i,
                      const short          *pt)
 {
-  unsigned int  *sn;
-  int           energy, mm5, mm3, bonus, p, q, q_prev, length, dangle_model, n_seq, ss, u,
-                start;
-  short         *s, *s1, **S, **S5, **S3;
-  unsigned int  **a2s;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
-  vrna_sc_t     *sc, **scs;
+  unsigned int            *sn;
+  int                     energy, mm5, mm3, bonus, p, q, q_prev, length, dangle_model, n_seq,
+                          ss, u, start;
+  short                   *s, *s1, **S, **S5, **S3;
+  unsigned int            **a2s;
+  vrna_param_t            *P;
+  vrna_md_t               *md;
+  vrna_sc_t               *sc, **scs;
+  const vrna_loop_cache_t *cache;
 
 
   /* helper variables for dangles == 1 case */
-  int           E3_available;   /* energy of 5' part where 5' mismatch is available for current stem */
-  int           E3_occupied;    /* energy of 5' part where 5' mismatch is unavailable for current stem */
+  int                     E3_available; /* energy of 5' part where 5' mismatch is available for current stem */
+  int                     E3_occupied;  /* energy of 5' part where 5' mismatch is unavailable for current stem */
 
 
   /* initialize vars */
@@ -1184,6 +1173,7 @@ energy_of_extLoop_pt(vrna_fold_compound_t *vc,
   a2s           = (vc->type == VRNA_FC_TYPE_SINGLE) ? NULL : vc->a2s;
   n_seq         = (vc->type == VRNA_FC_TYPE_SINGLE) ? 1 : vc->n_seq;
   scs           = (vc->type == VRNA_FC_TYPE_SINGLE) ? NULL : vc->scs;
+  cache         = (vc->type == VRNA_FC_TYPE_SINGLE) ? loop_cache_mfe(vc) : NULL;
 
   energy  = 0;
   bonus   = 0;
@@ -1249,14 +1239,14 @@ energy_of_extLoop_pt(vrna_fold_compound_t *vc,
         switch (dangle_model) {
           /* no dangles */
           case 0:
-            energy += vrna_E_ext_stem(tt, -1, -1, P);
+            energy += E_ext_stem_cached(tt, -1, -1, P, cache);
             break;
 
           /* the beloved double dangles */
           case 2:
             mm5     = ((sn[p - 1] == sn[p]) && (p > 1))       ? s1[p - 1] : -1;
             mm3     = ((sn[q] == sn[q + 1]) && (q < length))  ? s1[q + 1] : -1;
-            energy  += vrna_E_ext_stem(tt, mm5, mm3, P);
+            energy  += E_ext_stem_cached(tt, mm5, mm3, P, cache);
             break;
 
           default:
@@ -1270,12 +1260,12 @@ energy_of_extLoop_pt(vrna_fold_compound_t *vc,
             mm5 = ((sn[p - 1] == sn[p]) && (p > 1) && !pt[p - 1])       ? s1[p - 1] : -1;
             mm3 = ((sn[q] == sn[q + 1]) && (q < length) && !pt[q + 1])  ? s1[q + 1] : -1;
             tmp = MIN2(
-              E3_occupied + vrna_E_ext_stem(tt, -1, mm3, P),
-              E3_available + vrna_E_ext_stem(tt, mm5, mm3, P)
+              E3_occupied + E_ext_stem_cached(tt, -1, mm3, P, cache),
+              E3_available + E_ext_stem_cached(tt, mm5, mm3, P, cache)
               );
             E3_available = MIN2(
-              E3_occupied + vrna_E_ext_stem(tt, -1, -1, P),
-              E3_available + vrna_E_ext_stem(tt, mm5, -1, P)
+              E3_occupied + E_ext_stem_cached(tt, -1, -1, P, cache),
+              E3_available + E_ext_stem_cached(tt, mm5, -1, P, cache)
               );
             E3_occupied = tmp;
           }
@@ -1373,24 +1363,25 @@ energy_of_ml_pt(vrna_fold_compound_t  *vc,
                 int                   i,
                 const short           *pt)
 {
-  unsigned int  *sn;
-  int           energy, cx_energy, tmp, tmp2, best_energy = INF, bonus, *idx, dangle_model,
-                logML, circular, *rtype, ss, n, n_seq;
-  int           i1, j, p, q, q_prev, q_prev2, u, uu, x, type, count, mm5, mm3, tt, ld5, new_cx,
-                dang5, dang3, dang;
-  int           e_stem, e_stem5, e_stem3, e_stem53;
-  int           mlintern[NBPAIRS + 1];
-  short         *s, *s1, **S, **S5, **S3;
-  unsigned int  **a2s;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
-  vrna_sc_t     *sc, **scs;
+  unsigned int            *sn;
+  int                     energy, cx_energy, tmp, tmp2, best_energy = INF, bonus, *idx,
+                          dangle_model, logML, circular, *rtype, ss, n, n_seq;
+  int                     i1, j, p, q, q_prev, q_prev2, u, uu, x, type, count, mm5, mm3, tt, ld5,
+                          new_cx, dang5, dang3, dang;
+  int                     e_stem, e_stem5, e_stem3, e_stem53;
+  int                     mlintern[NBPAIRS + 1];
+  short                   *s, *s1, **S, **S5, **S3;
+  unsigned int            **a2s;
+  vrna_param_t            *P;
+  vrna_md_t               *md;
+  vrna_sc_t               *sc, **scs;
+  const vrna_loop_cache_t *cache;
 
   /* helper variables for dangles == 1|5 case */
-  int           E_mm5_available;    /* energy of 5' part where 5' mismatch of current stem is available */
-  int           E_mm5_occupied;     /* energy of 5' part where 5' mismatch of current stem is unavailable */
-  int           E2_mm5_available;   /* energy of 5' part where 5' mismatch of current stem is available with possible 3' dangle for enclosing pair (i,j) */
-  int           E2_mm5_occupied;    /* energy of 5' part where 5' mismatch of current stem is unavailable with possible 3' dangle for enclosing pair (i,j) */
+  int                     E_mm5_available;  /* energy of 5' part where 5' mismatch of current stem is available */
+  int                     E_mm5_occupied;   /* energy of 5' part where 5' mismatch of current stem is unavailable */
+  int                     E2_mm5_available; /* energy of 5' part where 5' mismatch of current stem is available with possible 3' dangle for enclosing pair (i,j) */
+  int                     E2_mm5_occupied;  /* energy of 5' part where 5' mismatch of current stem is unavailable with possible 3' dangle for enclosing pair (i,j) */
 
   n   = vc->length;
   sn  = vc->strand_number;
@@ -1411,6 +1402,7 @@ energy_of_ml_pt(vrna_fold_compound_t  *vc,
   a2s           = (vc->type == VRNA_FC_TYPE_SINGLE) ? NULL : vc->a2s;
   n_seq         = (vc->type == VRNA_FC_TYPE_SINGLE) ? 1 : vc->n_seq;
   scs           = (vc->type == VRNA_FC_TYPE_SINGLE) ? NULL : vc->scs;
+  cache         = (vc->type == VRNA_FC_TYPE_SINGLE) ? loop_cache_mfe(vc) : NULL;
 
   bonus = 0;
 
@@ -1514,7 +1506,7 @@ energy_of_ml_pt(vrna_fold_compound_t  *vc,
             if (tt == 0)
               tt = 7;
 
-            energy += E_MLstem(tt, -1, -1, P);
+            energy += E_MLstem_cached(tt, -1, -1, P, cache);
 
             /* seek to the next stem */
             p       = q + 1;
@@ -1535,10 +1527,10 @@ energy_of_ml_pt(vrna_fold_compound_t  *vc,
             if (tt == 0)
               tt = 7;
 
-            energy += E_MLstem(tt, -1, -1, P);
+            energy += E_MLstem_cached(tt, -1, -1, P, cache);
           } else {
             /* virtual closing pair */
-            energy += E_MLstem(0, -1, -1, P);
+            energy += E_MLstem_cached(0, -1, -1, P, cache);
           }
 
           break;
@@ -1609,7 +1601,7 @@ energy_of_ml_pt(vrna_fold_compound_t  *vc,
 
             mm5     = sn[p - 1] == sn[p] ? s1[p - 1] : -1;
             mm3     = sn[q] == sn[q + 1] ? s1[q + 1] : -1;
-            energy  += E_MLstem(tt, mm5, mm3, P);
+            energy  += E_MLstem_cached(tt, mm5, mm3, P, cache);
 
             /* seek to the next stem */
             p       = q + 1;
@@ -1630,10 +1622,10 @@ energy_of_ml_pt(vrna_fold_compound_t  *vc,
 
             mm5     = sn[j - 1] == sn[j] ? s1[j - 1] : -1;
             mm3     = sn[i] == sn[i + 1] ? s1[i + 1] : -1;
-            energy  += E_MLstem(tt, mm5, mm3, P);
+            energy  += E_MLstem_cached(tt, mm5, mm3, P, cache);
           } else {
             /* virtual closing pair */
-            energy += E_MLstem(0, -1, -1, P);
+            energy += E_MLstem_cached(0, -1, -1, P, cache);
           }
 
           break;
@@ -1835,10 +1827,10 @@ energy_of_ml_pt(vrna_fold_compound_t  *vc,
 
         mm5       = ((sn[p - 1] == sn[p]) && !pt[p - 1])  ? s1[p - 1] : -1;
         mm3       = ((sn[q] == sn[q + 1]) && !pt[q + 1])  ? s1[q + 1] : -1;
-        e_stem    = E_MLstem(tt, -1, -1, P);
-        e_stem5   = E_MLstem(tt, mm5, -1, P);
-        e_stem3   = E_MLstem(tt, -1, mm3, P);
-        e_stem53  = E_MLstem(tt, mm5, mm3, P);
+        e_stem    = E_MLstem_cached(tt, -1, -1, P, cache);
+        e_stem5   = E_MLstem_cached(tt, mm5, -1, P, cache);
+        e_stem3   = E_MLstem_cached(tt, -1, mm3, P, cache);
+        e_stem53  = E_MLstem_cached(tt, mm5, mm3, P, cache);
 
         tmp   = E_mm5_occupied + e_stem3;
         tmp   = MIN2(tmp, E_mm5_available + e_stem53);
@@ -1889,13 +1881,13 @@ energy_of_ml_pt(vrna_fold_compound_t  *vc,
           E2_mm5_occupied   = E2_mm5_available;
         }
 
-        e_stem    = E_MLstem(type, -1, -1, P);
-        e_stem5   = E_MLstem(type, mm5, -1, P);
-        e_stem3   = E_MLstem(type, -1, mm3, P);
-        e_stem53  = E_MLstem(type, mm5, mm3, P);
+        e_stem    = E_MLstem_cached(type, -1, -1, P, cache);
+        e_stem5   = E_MLstem_cached(type, mm5, -1, P, cache);
+        e_stem3   = E_MLstem_cached(type, -1, mm3, P, cache);
+        e_stem53  = E_MLstem_cached(type, mm5, mm3, P, cache);
       } else {
         /* virtual closing pair */
-        e_stem = e_stem5 = e_stem3 = e_stem53 = E_MLstem(0, -1, -1, P);
+        e_stem = e_stem5 = e_stem3 = e_stem53 = E_MLstem_cached(0, -1, -1, P, cache);
       }
 
       /* now lets see how we get the minimum including the enclosing stem */
@@ -187,7 +187,7 @@ wrap_fold(const char    *string,
 
   if (parameters) {
     /* replace params if necessary */
-    free(vc->params);
+    vrna_params_free(vc->params);
     vc->params = P;
   } else {
     free(P);
@@ -82,6 +82,12 @@ sanitize_bp_span(vrna_fold_compound_t *fc,
                  unsigned int         options);
 
 
+PRIVATE void
+rebind_bp_span(vrna_md_t    *md,
+               unsigned int length,
+               unsigned int length_max);
+
+
 PRIVATE void
 add_params(vrna_fold_compound_t *fc,
            vrna_md_t            *md_p,
@@ -116,10 +122,11 @@ vrna_fold_compound_free(vrna_fold_compound_t *fc)
     vrna_mx_pf_free(fc);
     free(fc->iindx);
     free(fc->jindx);
-    free(fc->params);
+    vrna_params_free(fc->params);
     free(fc->exp_params);
 
     vrna_hc_free(fc->hc);
+    vrna_loop_cache_free(fc);
     vrna_ud_remove(fc);
     vrna_sequence_remove_all(fc);
 
@@ -478,6 +485,120 @@ vrna_fold_compound_TwoD(const char    *sequence,
 }
 
 
+PUBLIC int
+vrna_fold_compound_rebind(vrna_fold_compound_t  *fc,
+                          const char            *sequence)
+{
+  unsigned int  length, length_max;
+  vrna_md_t     *md_p;
+  vrna_param_t  *P;
+
+  if ((!fc) ||
+      (!sequence) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands != 1) ||
+      (!fc->hc) ||
+      (fc->hc->type == VRNA_HC_WINDOW) ||
+      (strchr(sequence, '&')))
+    return 0;
+
+  length = strlen(sequence);
+
+  if ((length == 0) ||
+      (length > vrna_sequence_length_max(VRNA_OPTION_DEFAULT)))
+    return 0;
+
+  /* remove everything that depends on the previous sequence */
+  vrna_sequence_remove_all(fc);
+  vrna_sc_remove(fc);
+  vrna_loop_cache_free(fc);
+  free(fc->sequence);
+  free(fc->sequence_encoding);
+  free(fc->sequence_encoding2);
+
+  fc->sequence            = NULL;
+  fc->sequence_encoding   = NULL;
+  fc->sequence_encoding2  = NULL;
+
+  if (length != fc->length) {
+    free(fc->iindx);
+    free(fc->jindx);
+    fc->iindx = vrna_idx_row_wise(length);
+    fc->jindx = vrna_idx_col_wise(length);
+  }
+
+  /*
+   *  adapt the length dependent model settings. To keep the energy
+   *  parameters valid, we must apply identical changes to the model
+   *  details of both, free energies and Boltzmann factors
+   */
+  length_max = fc->length;
+
+  if (fc->matrices)
+    length_max = MAX2(length_max, fc->matrices->length);
+
+  if (fc->exp_matrices)
+    length_max = MAX2(length_max, fc->exp_matrices->length);
+
+  /* keep energy parameters shared if the caller opted in via vrna_params_share() */
+  P = fc->params;
+
+  rebind_bp_span(&(vrna_params_unshare(fc)->model_details), length, length_max);
+
+  if (P != fc->params)
+    vrna_params_share(fc);
+
+  if (fc->exp_params)
+    rebind_bp_span(&(fc->exp_params->model_details), length, length_max);
+
+  /* add the new sequence */
+  fc->length = 0;
+  vrna_sequence_add(fc, sequence, VRNA_SEQUENCE_RNA);
+  vrna_sequence_prepare(fc);
+
+  md_p = &(fc->params->model_details);
+
+  if (fc->ptype) {
+    free(fc->ptype);
+    fc->ptype = vrna_ptypes(fc->sequence_encoding2, md_p);
+  }
+
+  if (fc->ptype_pf_compat) {
+    free(fc->ptype_pf_compat);
+    fc->ptype_pf_compat = get_ptypes(fc->sequence_encoding2, md_p, 1);
+  }
+
+  /* reset hard constraints to default */
+  vrna_hc_init(fc);
+
+  /* G-quadruplex energies are sequence dependent and not re-computed by vrna_mx_prepare() */
+  if ((fc->matrices) &&
+      (fc->matrices->type == VRNA_MX_DEFAULT) &&
+      (fc->matrices->ggg)) {
+    free(fc->matrices->ggg);
+    fc->matrices->ggg = NULL;
+    if ((md_p->gquad) && (fc->matrices->length >= length))
+      fc->matrices->ggg = get_gquad_matrix(fc->sequence_encoding2, fc->params);
+  }
+
+  /*
+   *  Note, that DP matrices stay attached. They will be re-used as long
+   *  as their size suffices, or re-allocated by vrna_mx_prepare() otherwise.
+   *  The Boltzmann factor scaling arrays, however, must cover the new
+   *  sequence right away, since they may be re-scaled before the next
+   *  call to vrna_mx_prepare()
+   */
+  if (fc->exp_matrices) {
+    if (fc->exp_matrices->length < length)
+      vrna_mx_pf_add(fc, fc->exp_matrices->type, VRNA_OPTION_PF);
+    else
+      vrna_exp_params_rescale(fc, NULL);
+  }
+
+  return 1;
+}
+
+
 PUBLIC void
 vrna_fold_compound_add_auxdata(vrna_fold_compound_t       *fc,
                                void                       *data,
@@ -547,6 +668,9 @@ vrna_fold_compound_prepare(vrna_fold_compound_t *fc,
   /* Add DP matrices, if not they are not present or do not fit current settings */
   vrna_mx_prepare(fc, options);
 
+  /* pre-compute sequence specific loop energies */
+  vrna_loop_cache_prepare(fc, options);
+
   return ret;
 }
 
@@ -582,6 +706,25 @@ sanitize_bp_span(vrna_fold_compound_t *fc,
 }
 
 
+PRIVATE void
+rebind_bp_span(vrna_md_t    *md,
+               unsigned int length,
+               unsigned int length_max)
+{
+  /*
+   *  An unrestricted base pair span has been set to the length of the
+   *  longest sequence bound so far, while a user-defined restriction is
+   *  always shorter. We keep the latter as it is, even if it exceeds the
+   *  new sequence length, since it must still apply for any longer
+   *  sequence bound later on.
+   */
+  if ((md->max_bp_span <= 0) || (md->max_bp_span >= (int)length_max))
+    md->max_bp_span = MAX2(md->max_bp_span, (int)length);
+
+  md->window_size = (int)length;
+}
+
+
 PRIVATE void
 add_params(vrna_fold_compound_t *fc,
            vrna_md_t            *md_p,
@@ -593,7 +736,7 @@ add_params(vrna_fold_compound_t *fc,
    */
   if (fc->params) {
     if (memcmp(md_p, &(fc->params->model_details), sizeof(vrna_md_t)) != 0) {
-      free(fc->params);
+      vrna_params_free(fc->params);
       fc->params = NULL;
     }
   }
@@ -903,6 +1046,7 @@ nullify(vrna_fold_compound_t *fc)
     fc->domains_struc = NULL;
     fc->domains_up    = NULL;
     fc->aux_grammar   = NULL;
+    fc->loop_cache    = NULL;
 
     switch (fc->type) {
       case VRNA_FC_TYPE_SINGLE:
@@ -112,6 +112,8 @@ typedef void (vrna_callback_recursion_status)(unsigned char status,
 #include <ViennaRNA/zscore.h>
 #endif
 
+#include <ViennaRNA/loops/cache.h>
+
 
 /**
  *  @brief  An enumerator that is used to specify the type of a #vrna_fold_compound_t
@@ -165,7 +167,11 @@ struct vrna_fc_s {
   vrna_mx_mfe_t     *matrices;      /**<  @brief  The MFE DP matrices */
   vrna_mx_pf_t      *exp_matrices;  /**<  @brief  The PF DP matrices  */
 
-  vrna_param_t      *params;        /**<  @brief  The precomputed free energy contributions for each type of loop */
+  vrna_param_t      *params;        /**<  @brief  The precomputed free energy contributions for each type of loop
+                                     *    @note   Private to the fold compound unless shared via vrna_params_share(),
+                                     *            in which case vrna_params_unshare() must be called before modifying
+                                     *            them in place
+                                     */
   vrna_exp_param_t  *exp_params;    /**<  @brief  The precomputed free energy contributions as Boltzmann factors  */
 
   int               *iindx;         /**<  @brief  DP matrix accessor  */
@@ -344,6 +350,11 @@ struct {
   /**
    *  @}
    */
+
+  /* sequence specific loop energy look-up tables */
+  vrna_loop_cache_t *loop_cache;  /**<  @brief  Pre-computed loop energies for the current sequence
+                                   *    @see vrna_loop_cache_prepare()
+                                   */
 };
 
 
@@ -500,6 +511,37 @@ vrna_fold_compound_prepare(vrna_fold_compound_t *fc,
                            unsigned int         options);
 
 
+/**
+ *  @brief  Bind a new sequence to an existing #vrna_fold_compound_t
+ *
+ *  This function replaces the sequence of a single sequence #vrna_fold_compound_t
+ *  while keeping the energy parameters, the DP matrices, and any attached callbacks
+ *  or auxiliary data. DP matrices are re-used for all subsequent predictions as long
+ *  as they are large enough, and are only re-allocated for sequences longer than any
+ *  sequence seen before. This amortizes the setup costs when many (short) sequences
+ *  are processed with the same model settings.
+ *
+ *  @note Hard and soft constraints are reset to their defaults, and the
+ *        Boltzmann factor scaling (pf_scale) is left untouched. Use
+ *        vrna_exp_params_rescale() to adapt the latter to the new sequence.
+ *        Fold compounds for multiple strands, alignments, or sliding-window
+ *        predictions can not be re-bound.
+ *
+ *  @note A maximum base pair span is retained for all subsequent sequences. However,
+ *        if it exceeded the length of the sequence the #vrna_fold_compound_t has
+ *        been created for, it has already been reset to unrestricted upon creation.
+ *
+ *  @see  vrna_fold_compound(), vrna_fold_batch(), vrna_pf_fold_batch()
+ *
+ *  @param  fc        The #vrna_fold_compound_t the new sequence will be bound to
+ *  @param  sequence  The new RNA sequence
+ *  @return           1 on success, 0 if the sequence could not be bound
+ */
+int
+vrna_fold_compound_rebind(vrna_fold_compound_t  *fc,
+                          const char            *sequence);
+
+
 /**
  *  @brief  Free memory occupied by a #vrna_fold_compound_t
  *
@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <stdint.h>
 
 #include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/model.h"
@@ -20,15 +21,18 @@
 #include "ViennaRNA/utils/structures.h"
 #include "ViennaRNA/landscape/findpath.h"
 
-
-#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
-
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
 #endif
 
+#include "ViennaRNA/wavefront.inc"
+
 #define LOOP_EN
 
 #define   PATH_DIRECT_FINDPATH     1U
@@ -43,15 +47,71 @@ typedef struct move {
   int E;
 } move_t;
 
+typedef struct path_workspace path_workspace_t;
+
 /**
- *  @brief
+ *  @brief  A candidate intermediate, i.e. a beam entry plus one move
  */
-typedef struct intermediate {
-  short   *pt;      /**<  @brief  pair table */
-  int     Sen;      /**<  @brief  saddle energy so far */
-  int     curr_en;  /**<  @brief  current energy */
-  move_t  *moves;   /**<  @brief  remaining moves to target */
-} intermediate_t;
+typedef struct candidate {
+  int               Sen;      /**<  @brief  saddle energy so far */
+  int               curr_en;  /**<  @brief  current energy */
+  int               parent;   /**<  @brief  index of the beam entry this candidate originates from */
+  int               move;     /**<  @brief  index of the move applied to the parent */
+  path_workspace_t  *ws;      /**<  @brief  the workspace, required to compare candidates */
+} candidate_t;
+
+/**
+ *  @brief  Diff record of a beam entry, used to reconstruct the final path
+ */
+typedef struct trace {
+  int parent; /**<  @brief  index of the entry in the previous beam */
+  int move;   /**<  @brief  index of the move that lead to this entry */
+  int E;      /**<  @brief  energy of the entry */
+} trace_t;
+
+/**
+ *  @brief  Memory used throughout a single breadth-first search
+ *
+ *  All memory is allocated once per search. Intermediate structures are
+ *  identified by the set of moves that have been applied to the start
+ *  structure, since each move adds or removes a distinct base pair.
+ */
+struct path_workspace {
+  int           length;       /**<  @brief  sequence length */
+  int           dist;         /**<  @brief  number of moves, i.e. base pair distance */
+  int           maxl;         /**<  @brief  maximum beam size */
+  int           words;        /**<  @brief  number of 64bit words in a move set */
+  int           num_threads;  /**<  @brief  number of threads to expand the beam */
+
+  const short   *pt1;         /**<  @brief  start structure */
+  const short   *pt2;         /**<  @brief  target structure */
+  move_t        *moves;       /**<  @brief  list of all moves */
+  int           *del_move;    /**<  @brief  index of the delete move for each nucleotide, or -1 */
+  int           *ins_move;    /**<  @brief  index of the insert move for each nucleotide, or -1 */
+  uint64_t      *keys;        /**<  @brief  Zobrist hash keys of the moves */
+
+  int           beam_size;    /**<  @brief  number of entries in the current beam */
+  short         *pt;          /**<  @brief  pair tables of the current beam */
+  uint64_t      *bits;        /**<  @brief  move sets of the current beam */
+  uint64_t      *hash;        /**<  @brief  hash values of the current beam */
+  int           *Sen;         /**<  @brief  saddle energies of the current beam */
+  int           *curr_en;     /**<  @brief  energies of the current beam */
+  short         *pt_next;
+  uint64_t      *bits_next;
+  uint64_t      *hash_next;
+  int           *Sen_next;
+  int           *curr_en_next;
+
+  candidate_t   *cand;        /**<  @brief  candidates, dist entries per beam entry */
+  int           *cand_num;    /**<  @brief  number of candidates per beam entry */
+  candidate_t   *uniq;        /**<  @brief  candidates after removing duplicates */
+  int           *table;       /**<  @brief  open addressing hash table of indices into uniq */
+  unsigned int  table_mask;
+
+  trace_t       *trace;       /**<  @brief  diff records, maxl entries per distance class */
+  int           *loopidx;     /**<  @brief  loop index buffer, one per thread */
+  int           *stack;       /**<  @brief  stack buffer for the loop index, one per thread */
+};
 
 
 struct vrna_path_options_s {
@@ -96,18 +156,9 @@ PRIVATE vrna_fold_compound_t  *backward_compat_compound = NULL;
  # PRIVATE FUNCTION DECLARATIONS #
  #################################
  */
-PRIVATE move_t *
-copy_moves(move_t *mvs);
-
-
 PRIVATE int
-compare_ptable(const void *A,
-               const void *B);
-
-
-PRIVATE int
-compare_energy(const void *A,
-               const void *B);
+compare_candidates(const void *A,
+                   const void *B);
 
 
 PRIVATE int
@@ -115,10 +166,6 @@ compare_moves_when(const void *A,
                    const void *B);
 
 
-PRIVATE void
-free_intermediate(intermediate_t *i);
-
-
 #ifdef TEST_FINDPATH
 
 /* TEST_FINDPATH, COFOLD */
@@ -136,12 +183,57 @@ find_path_once(vrna_fold_compound_t *vc,
                int                  maxE);
 
 
+PRIVATE int
+search_path(vrna_fold_compound_t  *vc,
+            const short           *pt1,
+            const short           *pt2,
+            int                   e1,
+            int                   maxl,
+            int                   maxE,
+            int                   num_threads,
+            int                   *dist,
+            move_t                **moves);
+
+
+PRIVATE int
+saddle_ub(vrna_fold_compound_t  *vc,
+          const short           *pt1,
+          const short           *pt2,
+          int                   e1,
+          int                   e2,
+          int                   width,
+          int                   maxE);
+
+
+PRIVATE path_workspace_t *
+workspace_init(vrna_fold_compound_t *vc,
+               const short          *pt1,
+               const short          *pt2,
+               int                  e1,
+               int                  maxl,
+               int                  num_threads);
+
+
+PRIVATE void
+workspace_free(path_workspace_t *ws);
+
+
 PRIVATE int
 try_moves(vrna_fold_compound_t  *vc,
-          intermediate_t        c,
+          path_workspace_t      *ws,
+          int                   c,
           int                   maxE,
-          intermediate_t        *next,
-          int                   dist);
+          int                   thread);
+
+
+PRIVATE int
+remove_duplicates(path_workspace_t *ws);
+
+
+PRIVATE void
+next_beam(path_workspace_t  *ws,
+          int               num,
+          int               d);
 
 
 /*
@@ -239,6 +331,89 @@ vrna_path_findpath_saddle_ub(vrna_fold_compound_t *vc,
 }
 
 
+PUBLIC int *
+vrna_path_findpath_saddle_matrix(vrna_fold_compound_t *fc,
+                                 const char           **structures,
+                                 int                  width,
+                                 int                  maxE)
+{
+  int   a, b, c, d, k, n, v, num_threads, *S, *en;
+  short **pt;
+
+  if ((!fc) || (!structures))
+    return NULL;
+
+  n = (int)fc->length;
+
+  for (k = 0; structures[k]; k++)
+    if (strlen(structures[k]) != (size_t)n) {
+      vrna_message_warning("vrna_path_findpath_saddle_matrix: "
+                           "length of structure %d does not match length of sequence",
+                           k);
+      return NULL;
+    }
+
+  S   = (int *)vrna_alloc(sizeof(int) * (k * k + 1));
+  pt  = (short **)vrna_alloc(sizeof(short *) * (k + 1));
+  en  = (int *)vrna_alloc(sizeof(int) * (k + 1));
+
+  /* pair tables and energies are computed only once per structure */
+  for (a = 0; a < k; a++) {
+    pt[a]         = vrna_ptable(structures[a]);
+    en[a]         = vrna_eval_structure_pt(fc, pt[a]);
+    S[a * k + a]  = en[a];
+  }
+
+  num_threads = wavefront_threads(fc, &(fc->params->model_details));
+
+  /*
+   *  Process the pairs (a, b) in waves of increasing index distance d = b - a.
+   *  All pairs of a wave are independent of each other, and the saddles of
+   *  all pairs (a, c) and (c, b) with a < c < b are already known. These
+   *  yield upper bounds for the saddle between a and b that are used to
+   *  prune the search for a direct path. Since the bounds do not depend on
+   *  the order in which the pairs of a wave are processed, the result does
+   *  not depend on the number of threads.
+   */
+  for (d = 1; d < k; d++) {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1) private(b, c, v) \
+    if ((num_threads > 1) && (k - d > 1))
+#endif
+    for (a = 0; a < k - d; a++) {
+      int bound = maxE;
+
+      b = a + d;
+
+      for (c = a + 1; c < b; c++) {
+        v = MAX2(S[a * k + c], S[c * k + b]);
+        if (v < bound)
+          bound = v;
+      }
+
+      S[a * k + b] = S[b * k + a] = saddle_ub(fc, pt[a], pt[b], en[a], en[b], width, bound);
+    }
+  }
+
+  /* finally, also consider paths via structures outside the index range */
+  for (c = 0; c < k; c++)
+    for (a = 0; a < k; a++)
+      for (b = a + 1; b < k; b++) {
+        v = MAX2(S[a * k + c], S[c * k + b]);
+        if (v < S[a * k + b])
+          S[a * k + b] = S[b * k + a] = v;
+      }
+
+  for (a = 0; a < k; a++)
+    free(pt[a]);
+
+  free(pt);
+  free(en);
+
+  return S;
+}
+
+
 PUBLIC vrna_path_t *
 vrna_path_findpath(vrna_fold_compound_t *fc,
                    const char           *s1,
@@ -604,68 +779,359 @@ usage(void)
  # STATIC helper functions below #
  #################################
  */
+PRIVATE path_workspace_t *
+workspace_init(vrna_fold_compound_t *vc,
+               const short          *pt1,
+               const short          *pt2,
+               int                  e1,
+               int                  maxl,
+               int                  num_threads)
+{
+  int               i, len, dist, cap;
+  unsigned int      table_size;
+  path_workspace_t  *ws;
+
+  len = (int)pt1[0];
+  ws  = (path_workspace_t *)vrna_alloc(sizeof(path_workspace_t));
+
+  ws->length    = len;
+  ws->maxl      = maxl;
+  ws->pt1       = pt1;
+  ws->pt2       = pt2;
+  ws->moves     = (move_t *)vrna_alloc(sizeof(move_t) * (len + 1)); /* bp_dist < n */
+  ws->del_move  = (int *)vrna_alloc(sizeof(int) * (len + 1));
+  ws->ins_move  = (int *)vrna_alloc(sizeof(int) * (len + 1));
+
+  for (i = 0; i <= len; i++)
+    ws->del_move[i] = ws->ins_move[i] = -1;
+
+  for (dist = 0, i = 1; i <= len; i++) {
+    if (pt1[i] != pt2[i]) {
+      if (i < pt1[i]) {
+        /* need to delete this pair */
+        ws->moves[dist].i     = -i;
+        ws->moves[dist].j     = -pt1[i];
+        ws->moves[dist].when  = 0;
+        ws->del_move[i]       = ws->del_move[pt1[i]] = dist++;
+      }
+
+      if (i < pt2[i]) {
+        /* need to insert this pair */
+        ws->moves[dist].i     = i;
+        ws->moves[dist].j     = pt2[i];
+        ws->moves[dist].when  = 0;
+        ws->ins_move[i]       = ws->ins_move[pt2[i]] = dist++;
+      }
+    }
+  }
+
+  ws->dist  = dist;
+  ws->words = dist / 64 + 1;
+  ws->keys  = (uint64_t *)vrna_alloc(sizeof(uint64_t) * (dist + 1));
+
+  /* hash values of intermediates equal their structure fingerprints, see vrna_pt_zobrist() */
+  for (i = 0; i < dist; i++)
+    ws->keys[i] = vrna_bp_zobrist(abs(ws->moves[i].i), abs(ws->moves[i].j));
+
+  ws->num_threads = MAX2(1, num_threads);
+
+  cap = MAX2(1, maxl * dist);
+
+  ws->pt            = (short *)vrna_alloc(sizeof(short) * (len + 1) * maxl);
+  ws->pt_next       = (short *)vrna_alloc(sizeof(short) * (len + 1) * maxl);
+  ws->bits          = (uint64_t *)vrna_alloc(sizeof(uint64_t) * ws->words * maxl);
+  ws->bits_next     = (uint64_t *)vrna_alloc(sizeof(uint64_t) * ws->words * maxl);
+  ws->hash          = (uint64_t *)vrna_alloc(sizeof(uint64_t) * maxl);
+  ws->hash_next     = (uint64_t *)vrna_alloc(sizeof(uint64_t) * maxl);
+  ws->Sen           = (int *)vrna_alloc(sizeof(int) * maxl);
+  ws->Sen_next      = (int *)vrna_alloc(sizeof(int) * maxl);
+  ws->curr_en       = (int *)vrna_alloc(sizeof(int) * maxl);
+  ws->curr_en_next  = (int *)vrna_alloc(sizeof(int) * maxl);
+  ws->cand          = (candidate_t *)vrna_alloc(sizeof(candidate_t) * cap);
+  ws->cand_num      = (int *)vrna_alloc(sizeof(int) * maxl);
+  ws->uniq          = (candidate_t *)vrna_alloc(sizeof(candidate_t) * cap);
+  ws->trace         = (trace_t *)vrna_alloc(sizeof(trace_t) * cap);
+  ws->loopidx       = (int *)vrna_alloc(sizeof(int) * (len + 2) * ws->num_threads);
+  ws->stack         = (int *)vrna_alloc(sizeof(int) * (len + 1) * ws->num_threads);
+
+  for (table_size = 2; table_size < 2 * (unsigned int)cap; table_size *= 2);
+
+  ws->table       = (int *)vrna_alloc(sizeof(int) * table_size);
+  ws->table_mask  = table_size - 1;
+
+  /* the start structure is the only entry of the initial beam */
+  memcpy(ws->pt, pt1, sizeof(short) * (len + 1));
+  ws->hash[0]   = vrna_pt_zobrist(pt1);
+  ws->Sen[0]    = ws->curr_en[0] = (e1 == INT_MAX) ? vrna_eval_structure_pt(vc, pt1) : e1;
+  ws->beam_size = 1;
+
+  return ws;
+}
+
+
+PRIVATE void
+workspace_free(path_workspace_t *ws)
+{
+  free(ws->moves);
+  free(ws->del_move);
+  free(ws->ins_move);
+  free(ws->keys);
+  free(ws->pt);
+  free(ws->pt_next);
+  free(ws->bits);
+  free(ws->bits_next);
+  free(ws->hash);
+  free(ws->hash_next);
+  free(ws->Sen);
+  free(ws->Sen_next);
+  free(ws->curr_en);
+  free(ws->curr_en_next);
+  free(ws->cand);
+  free(ws->cand_num);
+  free(ws->uniq);
+  free(ws->trace);
+  free(ws->loopidx);
+  free(ws->stack);
+  free(ws->table);
+  free(ws);
+}
+
+
+/* same as vrna_loopidx_from_ptable() but with pre-allocated memory */
+PRIVATE void
+loop_index(const short  *pt,
+           int          *loop,
+           int          *stack)
+{
+  int i, hx, l, nl, length;
+
+  length  = pt[0];
+  hx      = l = nl = 0;
+
+  for (i = 1; i <= length; i++) {
+    if ((pt[i] != 0) && (i < pt[i])) {
+      /* ( */
+      nl++;
+      l           = nl;
+      stack[hx++] = i;
+    }
+
+    loop[i] = l;
+
+    if ((pt[i] != 0) && (i > pt[i])) {
+      /* ) */
+      --hx;
+      if (hx > 0)
+        l = loop[stack[hx - 1]];  /* index of enclosing loop   */
+      else
+        l = 0;                    /* external loop has index 0 */
+    }
+  }
+  loop[0] = nl;
+}
+
+
 PRIVATE int
 try_moves(vrna_fold_compound_t  *vc,
-          intermediate_t        c,
+          path_workspace_t      *ws,
+          int                   c,
           int                   maxE,
-          intermediate_t        *next,
-          int                   dist)
+          int                   thread)
 {
-  int     *loopidx, len, num_next = 0, en, oldE;
-  move_t  *mv;
-  short   *pt;
-
-  len     = c.pt[0];
-  loopidx = vrna_loopidx_from_ptable(c.pt);
-  oldE    = c.Sen;
-  for (mv = c.moves; mv->i != 0; mv++) {
-    int i, j;
-    if (mv->when > 0)
+  int         m, i, j, len, num_next, en, oldE, *loopidx;
+  short       *pt;
+  uint64_t    *bits;
+  candidate_t *next;
+
+  len       = ws->length;
+  pt        = ws->pt + c * (len + 1);
+  bits      = ws->bits + c * ws->words;
+  loopidx   = ws->loopidx + thread * (len + 2);
+  next      = ws->cand + c * ws->dist;
+  oldE      = ws->Sen[c];
+  num_next  = 0;
+
+  loop_index(pt, loopidx, ws->stack + thread * (len + 1));
+
+  for (m = 0; m < ws->dist; m++) {
+    if (bits[m / 64] & ((uint64_t)1 << (m % 64)))
+      continue; /* move has already been applied */
+
+    i = ws->moves[m].i;
+    j = ws->moves[m].j;
+
+    /* insert moves require that i and j are unpaired and belong to the same loop */
+    if ((j > 0) &&
+        ((loopidx[i] != loopidx[j]) || (pt[i] != 0) || (pt[j] != 0)))
       continue;
 
-    i   = mv->i;
-    j   = mv->j;
-    pt  = (short *)vrna_alloc(sizeof(short) * (len + 1));
-    memcpy(pt, c.pt, (len + 1) * sizeof(short));
+#ifdef LOOP_EN
+    en = ws->curr_en[c] + vrna_eval_move_pt(vc, pt, i, j);
+#else
     if (j < 0) {
-      /*it's a delete move */
-      pt[-i]  = 0;
-      pt[-j]  = 0;
+      pt[-i] = pt[-j] = 0;
+      en = vrna_eval_structure_pt(vc, pt);
+      pt[-i] = -j;
+      pt[-j] = -i;
     } else {
-      /* insert move */
-      if ((loopidx[i] == loopidx[j]) && /* i and j belong to same loop */
-          (pt[i] == 0) && (pt[j] == 0)  /* ... and are unpaired */
-          ) {
-        pt[i] = j;
-        pt[j] = i;
-      } else {
-        free(pt);
-        continue; /* llegal move, try next; */
-      }
+      pt[i] = j;
+      pt[j] = i;
+      en = vrna_eval_structure_pt(vc, pt);
+      pt[i] = pt[j] = 0;
     }
 
-#ifdef LOOP_EN
-    en = c.curr_en + vrna_eval_move_pt(vc, c.pt, i, j);
-#else
-    en = vrna_eval_structure_pt(vc, pt);
 #endif
     if (en < maxE) {
       next[num_next].Sen      = (en > oldE) ? en : oldE;
       next[num_next].curr_en  = en;
-      next[num_next].pt       = pt;
-      mv->when                = dist;
-      mv->E                   = en;
-      next[num_next++].moves  = copy_moves(c.moves);
-      mv->when                = 0;
-    } else {
-      free(pt);
+      next[num_next].parent   = c;
+      next[num_next].move     = m;
+      next[num_next++].ws     = ws;
     }
   }
-  free(loopidx);
+
   return num_next;
 }
 
 
+PRIVATE uint64_t
+candidate_word(path_workspace_t   *ws,
+               const candidate_t  *c,
+               int                w)
+{
+  uint64_t word = ws->bits[c->parent * ws->words + w];
+
+  if (c->move / 64 == w)
+    word ^= (uint64_t)1 << (c->move % 64);
+
+  return word;
+}
+
+
+PRIVATE int
+same_structure(path_workspace_t   *ws,
+               const candidate_t  *a,
+               const candidate_t  *b)
+{
+  int w;
+
+  for (w = 0; w < ws->words; w++)
+    if (candidate_word(ws, a, w) != candidate_word(ws, b, w))
+      return 0;
+
+  return 1;
+}
+
+
+PRIVATE int
+remove_duplicates(path_workspace_t *ws)
+{
+  int           c, k, total, num;
+  unsigned int  size, pos;
+  uint64_t      h;
+  candidate_t   *cand, *u;
+
+  for (total = c = 0; c < ws->beam_size; c++)
+    total += ws->cand_num[c];
+
+  /* only use (and reset) as much of the hash table as required */
+  for (size = 2; size < 2 * (unsigned int)total; size *= 2);
+
+  for (pos = 0; pos < size; pos++)
+    ws->table[pos] = -1;
+
+  /*
+   *  go through the candidates in the order they have been generated and
+   *  keep the first one with lowest saddle and current energy for each
+   *  intermediate structure
+   */
+  for (num = c = 0; c < ws->beam_size; c++) {
+    for (k = 0; k < ws->cand_num[c]; k++) {
+      cand  = ws->cand + c * ws->dist + k;
+      h     = ws->hash[c] ^ ws->keys[cand->move];
+
+      for (pos = (unsigned int)(h & (size - 1)); ws->table[pos] != -1; pos = (pos + 1) & (size - 1)) {
+        u = ws->uniq + ws->table[pos];
+        if (((ws->hash[u->parent] ^ ws->keys[u->move]) == h) &&
+            (same_structure(ws, u, cand)))
+          break;
+      }
+
+      if (ws->table[pos] == -1) {
+        ws->table[pos]  = num;
+        ws->uniq[num++] = *cand;
+      } else if ((cand->Sen < u->Sen) ||
+                 ((cand->Sen == u->Sen) && (cand->curr_en < u->curr_en))) {
+        *u = *cand;
+      }
+    }
+  }
+
+  return num;
+}
+
+
+PRIVATE void
+next_beam(path_workspace_t  *ws,
+          int               num,
+          int               d)
+{
+  int         r, i, j, len, words;
+  short       *pt, *tmp_pt;
+  uint64_t    *tmp_u;
+  int         *tmp_i;
+  candidate_t *u;
+  trace_t     *trace;
+
+  len   = ws->length;
+  words = ws->words;
+  trace = ws->trace + (d - 1) * ws->maxl;
+
+  for (r = 0; r < num; r++) {
+    u   = ws->uniq + r;
+    pt  = ws->pt_next + r * (len + 1);
+    i   = ws->moves[u->move].i;
+    j   = ws->moves[u->move].j;
+
+    memcpy(pt, ws->pt + u->parent * (len + 1), sizeof(short) * (len + 1));
+    if (j < 0) {
+      pt[-i]  = 0;
+      pt[-j]  = 0;
+    } else {
+      pt[i] = j;
+      pt[j] = i;
+    }
+
+    memcpy(ws->bits_next + r * words, ws->bits + u->parent * words, sizeof(uint64_t) * words);
+    ws->bits_next[r * words + u->move / 64] |= (uint64_t)1 << (u->move % 64);
+    ws->hash_next[r]    = ws->hash[u->parent] ^ ws->keys[u->move];
+    ws->Sen_next[r]     = u->Sen;
+    ws->curr_en_next[r] = u->curr_en;
+
+    trace[r].parent = u->parent;
+    trace[r].move   = u->move;
+    trace[r].E      = u->curr_en;
+  }
+
+  tmp_pt            = ws->pt;
+  ws->pt            = ws->pt_next;
+  ws->pt_next       = tmp_pt;
+  tmp_u             = ws->bits;
+  ws->bits          = ws->bits_next;
+  ws->bits_next     = tmp_u;
+  tmp_u             = ws->hash;
+  ws->hash          = ws->hash_next;
+  ws->hash_next     = tmp_u;
+  tmp_i             = ws->Sen;
+  ws->Sen           = ws->Sen_next;
+  ws->Sen_next      = tmp_i;
+  tmp_i             = ws->curr_en;
+  ws->curr_en       = ws->curr_en_next;
+  ws->curr_en_next  = tmp_i;
+  ws->beam_size     = num;
+}
+
+
 PRIVATE int
 find_path_once(vrna_fold_compound_t *vc,
                short                *pt1,
@@ -673,129 +1139,199 @@ find_path_once(vrna_fold_compound_t *vc,
                int                  maxl,
                int                  maxE)
 {
-  move_t          *mlist;
-  int             i, len, d, dist = 0, result;
-  short           *pt;
-  intermediate_t  *current, *next;
+  return search_path(vc,
+                     pt1,
+                     pt2,
+                     INT_MAX,
+                     maxl,
+                     maxE,
+                     wavefront_threads(vc, &(vc->params->model_details)),
+                     &BP_dist,
+                     &path);
+}
 
-  len = (int)pt1[0];
-  pt  = vrna_ptable_copy(pt1);
 
-  mlist = (move_t *)vrna_alloc(sizeof(move_t) * len); /* bp_dist < n */
+/*
+ *  Breadth-first search for a direct path from pt1 to pt2 that does not
+ *  touch any global variables. The moves of the best path are only
+ *  reconstructed if @p moves is not NULL.
+ */
+PRIVATE int
+search_path(vrna_fold_compound_t  *vc,
+            const short           *pt1,
+            const short           *pt2,
+            int                   e1,
+            int                   maxl,
+            int                   maxE,
+            int                   num_threads,
+            int                   *dist,
+            move_t                **moves)
+{
+  int               c, d, r, num, result;
+  path_workspace_t  *ws;
+  trace_t           *t;
 
-  for (i = 1; i <= len; i++) {
-    if (pt[i] != pt2[i]) {
-      if (i < pt[i]) {
-        /* need to delete this pair */
-        mlist[dist].i       = -i;
-        mlist[dist].j       = -pt[i];
-        mlist[dist++].when  = 0;
-      }
+  ws      = workspace_init(vc, pt1, pt2, e1, maxl, num_threads);
+  result  = INT_MAX;
 
-      if (i < pt2[i]) {
-        /* need to insert this pair */
-        mlist[dist].i       = i;
-        mlist[dist].j       = pt2[i];
-        mlist[dist++].when  = 0;
-      }
-    }
-  }
+  if (dist)
+    *dist = ws->dist;
 
-  BP_dist           = dist;
-  current           = (intermediate_t *)vrna_alloc(sizeof(intermediate_t) * (maxl + 1));
-  current[0].pt     = pt;
-  current[0].Sen    = current[0].curr_en = vrna_eval_structure_pt(vc, pt);
-  current[0].moves  = mlist;
-  next              = (intermediate_t *)vrna_alloc(sizeof(intermediate_t) * (dist * maxl + 1));
+  if (moves)
+    *moves = NULL;
 
-  for (d = 1; d <= dist; d++) {
+  for (d = 1; d <= ws->dist; d++) {
     /* go through the distance classes */
-    int             c, u, num_next = 0;
-    intermediate_t  *cc;
-
-    for (c = 0; current[c].pt != NULL; c++)
-      num_next += try_moves(vc, current[c], maxE, next + num_next, d);
-    if (num_next == 0) {
-      for (cc = current; cc->pt != NULL; cc++)
-        free_intermediate(cc);
-      current[0].Sen = INT_MAX;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(ws->num_threads) schedule(dynamic, 1) \
+    if ((ws->num_threads > 1) && (ws->beam_size > 1))
+#endif
+    for (c = 0; c < ws->beam_size; c++) {
+      int thread = 0;
+#ifdef _OPENMP
+      thread = omp_get_thread_num();
+#endif
+      ws->cand_num[c] = try_moves(vc, ws, c, maxE, thread);
+    }
+
+    num = remove_duplicates(ws);
+
+    if (num == 0) {
+      ws->beam_size = 0;
       break;
     }
 
-    /* remove duplicates via sort|uniq
-     * if this becomes a bottleneck we can use a hash instead */
-    qsort(next, num_next, sizeof(intermediate_t), compare_ptable);
-    for (u = 0, c = 1; c < num_next; c++) {
-      if (memcmp(next[u].pt, next[c].pt, sizeof(short) * len) != 0)
-        next[++u] = next[c];
-      else
-        free_intermediate(next + c);
+    /* keep the maxl best candidates */
+    qsort(ws->uniq, num, sizeof(candidate_t), compare_candidates);
+    next_beam(ws, MIN2(num, maxl), d);
+  }
+
+  if (ws->beam_size > 0) {
+    result = ws->Sen[0];
+
+    if (moves) {
+      /* reconstruct the moves of the best path from the diff records */
+      *moves = (move_t *)vrna_alloc(sizeof(move_t) * (ws->dist + 1));
+      memcpy(*moves, ws->moves, sizeof(move_t) * ws->dist);
+
+      for (r = 0, d = ws->dist; d > 0; d--) {
+        t                       = ws->trace + (d - 1) * maxl + r;
+        (*moves)[t->move].when  = d;
+        (*moves)[t->move].E     = t->E;
+        r                       = t->parent;
+      }
     }
-    num_next = u + 1;
-    qsort(next, num_next, sizeof(intermediate_t), compare_energy);
-    /* free the old stuff */
-    for (cc = current; cc->pt != NULL; cc++)
-      free_intermediate(cc);
-    for (u = 0; u < maxl && u < num_next; u++)
-      current[u] = next[u];
-    for (; u < num_next; u++)
-      free_intermediate(next + u);
-    num_next = 0;
   }
-  free(next);
-  path    = current[0].moves;
-  result  = current[0].Sen;
-  free(current[0].pt);
-  free(current);
-  return result;
-}
 
+  workspace_free(ws);
 
-PRIVATE void
-free_intermediate(intermediate_t *i)
-{
-  free(i->pt);
-  free(i->moves);
-  i->pt     = NULL;
-  i->moves  = NULL;
-  i->Sen    = INT_MAX;
+  return result;
 }
 
 
+/*
+ *  Same as vrna_path_findpath_saddle_ub() but for pair tables with
+ *  known energies, and without touching any global variables
+ */
 PRIVATE int
-compare_ptable(const void *A,
-               const void *B)
+saddle_ub(vrna_fold_compound_t  *vc,
+          const short           *pt1,
+          const short           *pt2,
+          int                   e1,
+          int                   e2,
+          int                   width,
+          int                   maxE)
 {
-  intermediate_t  *a, *b;
-  int             c;
+  int         maxl, saddleE, e;
+  const short *ptr;
 
-  a = (intermediate_t *)A;
-  b = (intermediate_t *)B;
+  maxl = 1;
+  do {
+    if (maxl > width)
+      maxl = width;
 
-  c = memcmp(a->pt, b->pt, a->pt[0] * sizeof(short));
-  if (c != 0)
-    return c;
+    saddleE = search_path(vc, pt1, pt2, e1, maxl, maxE, 1, NULL, NULL);
+    if (saddleE < maxE)
+      maxE = saddleE;
 
-  if ((a->Sen - b->Sen) != 0)
-    return a->Sen - b->Sen;
+    ptr   = pt1;
+    pt1   = pt2;
+    pt2   = ptr;
+    e     = e1;
+    e1    = e2;
+    e2    = e;
+    maxl  *= 2;
+  } while (maxl < 2 * width);
 
-  return a->curr_en - b->curr_en;
+  return maxE;
 }
 
 
+/*
+ *  Order candidates by saddle energy, current energy, and finally by their
+ *  pair tables (in terms of memcmp()), just like sorting the pair tables
+ *  themselves would do. The first position where the pair tables of two
+ *  different candidates differ is the smallest 5' position of all moves
+ *  that are applied to only one of them.
+ */
 PRIVATE int
-compare_energy(const void *A,
-               const void *B)
+compare_candidates(const void *A,
+                   const void *B)
 {
-  intermediate_t *a, *b;
+  const candidate_t *a, *b;
+  path_workspace_t  *ws;
+  int               w, m, k, mv;
+  short             va, vb;
+  uint64_t          diff;
 
-  a = (intermediate_t *)A;
-  b = (intermediate_t *)B;
+  a = (const candidate_t *)A;
+  b = (const candidate_t *)B;
 
   if ((a->Sen - b->Sen) != 0)
     return a->Sen - b->Sen;
 
-  return a->curr_en - b->curr_en;
+  if ((a->curr_en - b->curr_en) != 0)
+    return a->curr_en - b->curr_en;
+
+  ws = a->ws;
+
+  for (w = 0; w < ws->words; w++) {
+    diff = candidate_word(ws, a, w) ^ candidate_word(ws, b, w);
+    if (diff)
+      break;
+  }
+
+  if (w == ws->words)
+    return 0;
+
+  for (m = 64 * w; !(diff & 1); diff >>= 1, m++);
+
+  k = -ws->moves[m].i;
+  if (k < 0)
+    k = -k;
+
+  /* determine the pairing partner of k in both candidates */
+  mv  = ws->del_move[k];
+  va  = vb = 0;
+
+  if (ws->pt1[k] != 0) {
+    if ((mv < 0) || !(candidate_word(ws, a, mv / 64) & ((uint64_t)1 << (mv % 64))))
+      va = ws->pt1[k];
+
+    if ((mv < 0) || !(candidate_word(ws, b, mv / 64) & ((uint64_t)1 << (mv % 64))))
+      vb = ws->pt1[k];
+  }
+
+  mv = ws->ins_move[k];
+  if (mv >= 0) {
+    if ((va == 0) && (candidate_word(ws, a, mv / 64) & ((uint64_t)1 << (mv % 64))))
+      va = ws->pt2[k];
+
+    if ((vb == 0) && (candidate_word(ws, b, mv / 64) & ((uint64_t)1 << (mv % 64))))
+      vb = ws->pt2[k];
+  }
+
+  return memcmp(&va, &vb, sizeof(short));
 }
 
 
@@ -812,17 +1348,6 @@ compare_moves_when(const void *A,
 }
 
 
-PRIVATE move_t *
-copy_moves(move_t *mvs)
-{
-  move_t *new;
-
-  new = (move_t *)vrna_alloc(sizeof(move_t) * (BP_dist + 1));
-  memcpy(new, mvs, sizeof(move_t) * (BP_dist + 1));
-  return new;
-}
-
-
 /*
  *###########################################
  *# deprecated functions below              #
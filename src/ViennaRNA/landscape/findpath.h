@@ -92,6 +92,43 @@ vrna_path_findpath_saddle_ub(vrna_fold_compound_t *fc,
                              int                  maxE);
 
 
+/**
+ *  @brief Compute the saddle energies between all pairs of a set of structures
+ *
+ *  This function computes a matrix of saddle energies between all pairs of
+ *  the structures in @p structures, e.g. a set of local minima as required
+ *  to construct barrier trees or rate matrices. Pair tables and free energies
+ *  of the structures are computed only once and all searches share the same
+ *  #vrna_fold_compound_t.
+ *
+ *  Saddles that are already known provide upper bounds for others, since
+ *  a refolding path from @f$ a @f$ to @f$ b @f$ may pass through any
+ *  intermediate structure @f$ c @f$ of the set. These bounds are used to
+ *  prune the search for direct paths via vrna_path_findpath_saddle_ub().
+ *  Consequently, each entry of the resulting matrix holds the lowest saddle
+ *  energy found for either the direct path or any path through other
+ *  structures of the set. The diagonal holds the free energies of the
+ *  structures themselves.
+ *
+ *  Pairs of structures are distributed among #vrna_md_t.num_threads OpenMP
+ *  threads. The result does not depend on the number of threads.
+ *
+ *  @see  vrna_path_findpath_saddle_ub(), vrna_path_findpath_saddle()
+ *
+ *  @param fc         The #vrna_fold_compound_t with precomputed sequence encoding and model details
+ *  @param structures A @em NULL terminated list of @f$ k @f$ structures in dot-bracket notation
+ *  @param width      A number specifying how many strutures are being kept at each step during the search
+ *  @param maxE       An upper bound for the saddle point energies in 10cal/mol
+ *  @returns          A @f$ k \times k @f$ matrix of saddle energies (in 10cal/mol) in row-major order,
+ *                    or @em NULL on error. Entries without any path below @p maxE are set to @p maxE.
+ */
+int *
+vrna_path_findpath_saddle_matrix(vrna_fold_compound_t *fc,
+                                 const char           **structures,
+                                 int                  width,
+                                 int                  maxE);
+
+
 /**
  *  @brief Find refolding path between 2 structures (search only direct path)
  *
@@ -1,10 +1,47 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/structures.h"
 #include "ViennaRNA/landscape/move.h"
 
 
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE void
+move_apply(short              *pt,
+           const vrna_move_t  *m,
+           uint64_t           *hash,
+           uint64_t           *packed);
+
+
+PRIVATE uint64_t
+move_zobrist(const short        *pt,
+             const vrna_move_t  *m);
+
+
+PRIVATE uint64_t
+pair_zobrist(int  i,
+             int  j);
+
+
+PRIVATE void
+move_pack(const short       *pt,
+          const vrna_move_t *m,
+          uint64_t          *packed);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+
+
 PUBLIC vrna_move_t
 vrna_move_init(int  pos_5,
                int  pos_3)
@@ -33,36 +70,44 @@ PUBLIC void
 vrna_move_apply(short             *pt,
                 const vrna_move_t *m)
 {
-  /* deletion */
-  if (vrna_move_is_removal(m)) {
-    pt[-m->pos_5] = 0;
-    pt[-m->pos_3] = 0;
-  } else if (vrna_move_is_insertion(m)) {
-    pt[m->pos_5]  = m->pos_3;
-    pt[m->pos_3]  = m->pos_5;
-  } else
-  /* shift right */
-  if (m->pos_5 > 0 && m->pos_3 < 0) {
-    short previousPairedPosition = pt[m->pos_5];
-    pt[previousPairedPosition] = 0;
-    short newPairedPosition = -m->pos_3;
-    pt[m->pos_5]          = newPairedPosition;
-    pt[newPairedPosition] = m->pos_5;
-  } else
+  move_apply(pt, m, NULL, NULL);
+}
 
-  /* shift left */
-  if (m->pos_5 < 0 && m->pos_3 > 0) {
-    short previousPairedPosition = pt[m->pos_3];
-    pt[previousPairedPosition] = 0;
-    short newPairedPosition = -m->pos_5;
-    pt[m->pos_3]          = newPairedPosition;
-    pt[newPairedPosition] = m->pos_3;
+
+PUBLIC void
+vrna_move_apply_zobrist(short             *pt,
+                        const vrna_move_t *m,
+                        uint64_t          *hash)
+{
+  move_apply(pt, m, hash, NULL);
+}
+
+
+PUBLIC void
+vrna_move_apply_pk(short              *pt,
+                   const vrna_move_t  *m,
+                   uint64_t           *packed)
+{
+  move_apply(pt, m, NULL, packed);
+}
+
+
+PUBLIC uint64_t
+vrna_move_zobrist(const short       *pt,
+                  const vrna_move_t *m)
+{
+  uint64_t h = 0;
+
+  if ((pt) && (m)) {
+    h = move_zobrist(pt, m);
+
+    /* successive moves are evaluated with respect to pt */
+    if (m->next != NULL)
+      for (vrna_move_t *move = m->next; move->pos_5 != 0; move++)
+        h ^= vrna_move_zobrist(pt, move);
   }
 
-  /* apply successive moves if m.next is a list */
-  if (m->next != NULL)
-    for (vrna_move_t *move = m->next; move->pos_5 != 0; move++)
-      vrna_move_apply(pt, move);
+  return h;
 }
 
 
@@ -183,3 +228,109 @@ vrna_move_compare(const vrna_move_t *a,
 
   return 0;
 }
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE void
+move_apply(short              *pt,
+           const vrna_move_t  *m,
+           uint64_t           *hash,
+           uint64_t           *packed)
+{
+  /* update the fingerprint and packed key before the pair table changes */
+  if (hash)
+    *hash ^= move_zobrist(pt, m);
+
+  if (packed)
+    move_pack(pt, m, packed);
+
+  /* deletion */
+  if (vrna_move_is_removal(m)) {
+    pt[-m->pos_5] = 0;
+    pt[-m->pos_3] = 0;
+  } else if (vrna_move_is_insertion(m)) {
+    pt[m->pos_5]  = m->pos_3;
+    pt[m->pos_3]  = m->pos_5;
+  } else
+  /* shift right */
+  if (m->pos_5 > 0 && m->pos_3 < 0) {
+    short previousPairedPosition = pt[m->pos_5];
+    pt[previousPairedPosition] = 0;
+    short newPairedPosition = -m->pos_3;
+    pt[m->pos_5]          = newPairedPosition;
+    pt[newPairedPosition] = m->pos_5;
+  } else
+
+  /* shift left */
+  if (m->pos_5 < 0 && m->pos_3 > 0) {
+    short previousPairedPosition = pt[m->pos_3];
+    pt[previousPairedPosition] = 0;
+    short newPairedPosition = -m->pos_5;
+    pt[m->pos_3]          = newPairedPosition;
+    pt[newPairedPosition] = m->pos_3;
+  }
+
+  /* apply successive moves if m.next is a list */
+  if (m->next != NULL)
+    for (vrna_move_t *move = m->next; move->pos_5 != 0; move++)
+      move_apply(pt, move, hash, packed);
+}
+
+
+/* change of the Zobrist hash induced by a single move, ignoring successive moves */
+PRIVATE uint64_t
+move_zobrist(const short        *pt,
+             const vrna_move_t  *m)
+{
+  if (vrna_move_is_removal(m))
+    return pair_zobrist(-m->pos_5, -m->pos_3);
+
+  if (vrna_move_is_insertion(m))
+    return pair_zobrist(m->pos_5, m->pos_3);
+
+  /* shift right */
+  if (m->pos_5 > 0 && m->pos_3 < 0)
+    return pair_zobrist(m->pos_5, pt[m->pos_5]) ^
+           pair_zobrist(m->pos_5, -m->pos_3);
+
+  /* shift left */
+  if (m->pos_5 < 0 && m->pos_3 > 0)
+    return pair_zobrist(m->pos_3, pt[m->pos_3]) ^
+           pair_zobrist(m->pos_3, -m->pos_5);
+
+  return 0;
+}
+
+
+PRIVATE uint64_t
+pair_zobrist(int  i,
+             int  j)
+{
+  return (i < j) ? vrna_bp_zobrist(i, j) : vrna_bp_zobrist(j, i);
+}
+
+
+/* update of a packed structure key induced by a single move, ignoring successive moves */
+PRIVATE void
+move_pack(const short       *pt,
+          const vrna_move_t *m,
+          uint64_t          *packed)
+{
+  if (vrna_move_is_removal(m)) {
+    vrna_pt_pack_toggle(packed, -m->pos_5, -m->pos_3);
+  } else if (vrna_move_is_insertion(m)) {
+    vrna_pt_pack_toggle(packed, m->pos_5, m->pos_3);
+  } else if (m->pos_5 > 0 && m->pos_3 < 0) {
+    /* shift right */
+    vrna_pt_pack_toggle(packed, m->pos_5, pt[m->pos_5]);
+    vrna_pt_pack_toggle(packed, m->pos_5, -m->pos_3);
+  } else if (m->pos_5 < 0 && m->pos_3 > 0) {
+    /* shift left */
+    vrna_pt_pack_toggle(packed, m->pos_3, pt[m->pos_3]);
+    vrna_pt_pack_toggle(packed, m->pos_3, -m->pos_5);
+  }
+}
@@ -1,6 +1,8 @@
 #ifndef VIENNA_RNA_PACKAGE_MOVE_H
 #define VIENNA_RNA_PACKAGE_MOVE_H
 
+#include <stdint.h>
+
 
 /**
  *  @file     ViennaRNA/landscape/move.h
@@ -117,6 +119,74 @@ vrna_move_apply_db(char               *structure,
                    const vrna_move_t  *m);
 
 
+/**
+ * @brief Apply a particular move / transition to a secondary structure and update its fingerprint
+ *
+ * Same as vrna_move_apply() but additionally updates the 64bit Zobrist hash
+ * @p hash of the structure in constant time per insertion, deletion, or shift.
+ * The fingerprint of the initial structure is obtained from vrna_pt_zobrist()
+ * and equals the first word of a key created by vrna_pt_pack(). It may serve
+ * as hash value of the structure, but does not identify the structure by
+ * itself. To look up structures in hash tables with packed keys, e.g. via
+ * vrna_ht_pk_hash_func(), maintain the entire key with vrna_move_apply_pk()
+ * instead.
+ *
+ * @see vrna_move_apply(), vrna_move_zobrist(), vrna_pt_zobrist(), vrna_pt_pack(),
+ *      vrna_move_apply_pk()
+ *
+ * @param[in,out] pt    The pair table representation of the secondary structure
+ * @param[in]     m     The move to apply
+ * @param[in,out] hash  The Zobrist hash of the structure (may be @p NULL)
+ */
+void
+vrna_move_apply_zobrist(short             *pt,
+                        const vrna_move_t *m,
+                        uint64_t          *hash);
+
+
+/**
+ * @brief Apply a particular move / transition to a secondary structure and update its packed key
+ *
+ * Same as vrna_move_apply() but additionally updates the packed structure
+ * key @p packed, as obtained from vrna_pt_pack(), in constant time per
+ * insertion, deletion, or shift. This includes the Zobrist hash in its
+ * first word. Hence, the key may be used to probe hash tables of packed
+ * structure keys, e.g. visited sets created with vrna_ht_pk_comp() and
+ * vrna_ht_pk_hash_func(), without re-packing the structure after each move.
+ *
+ * @see vrna_move_apply(), vrna_pt_pack(), vrna_pt_pack_toggle(), #vrna_ht_entry_pk_t
+ *
+ * @param[in,out] pt      The pair table representation of the secondary structure
+ * @param[in]     m       The move to apply
+ * @param[in,out] packed  The packed key of the structure (may be @p NULL)
+ */
+void
+vrna_move_apply_pk(short              *pt,
+                   const vrna_move_t  *m,
+                   uint64_t           *packed);
+
+
+/**
+ * @brief Get the change of the Zobrist hash of a structure induced by a move
+ *
+ * This function does not modify the structure. The fingerprint of the
+ * neighbor structure obtained by applying @p m to @p pt is the exclusive
+ * or of the fingerprint of @p pt and the return value.
+ *
+ * @note  Successive moves in @p m->next are evaluated with respect to @p pt
+ *        as well, i.e. they must not depend on each other.
+ *
+ * @see vrna_move_apply_zobrist(), vrna_pt_zobrist()
+ *
+ * @param pt  The pair table representation of the secondary structure
+ * @param m   The move
+ * @return    The value to XOR with the fingerprint of @p pt to obtain the fingerprint of its neighbor
+ */
+uint64_t
+vrna_move_zobrist(const short       *pt,
+                  const vrna_move_t *m);
+
+
 /**
  *  @brief  Test whether a move is a base pair removal
  *
@@ -0,0 +1,368 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/datastructures/basic.h"
+#include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/constraints/hard.h"
+#include "ViennaRNA/alphabet.h"
+#include "ViennaRNA/loops/hairpin.h"
+#include "ViennaRNA/loops/internal.h"
+#include "ViennaRNA/loops/multibranch.h"
+#include "ViennaRNA/loops/external.h"
+#include "ViennaRNA/loops/cache.h"
+
+/* number of entries of the pair type resolved tables */
+#define STEM_SIZE       ((NBPAIRS + 1) * VRNA_LOOP_CACHE_STEM_DIM * VRNA_LOOP_CACHE_STEM_DIM)
+#define MISMATCH_SIZE   ((NBPAIRS + 1) * 5 * 5)
+#define INT11_SIZE      (NBPAIRS * NBPAIRS * 4 * 4)
+#define INT21_SIZE      (NBPAIRS * NBPAIRS * 4 * 4 * 4)
+#define INT22_SIZE      (NBPAIRS * NBPAIRS * 4 * 4 * 4 * 4)
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+
+PRIVATE void *
+aligned_block(size_t  size,
+              void    **mem);
+
+
+PRIVATE size_t
+aligned_size(size_t size);
+
+
+PRIVATE void *
+carve(char    **block,
+      size_t  size);
+
+
+PRIVATE void
+hp_tables(vrna_fold_compound_t  *fc,
+          vrna_loop_cache_t     *cache);
+
+
+PRIVATE void
+exp_hp_tables(vrna_fold_compound_t  *fc,
+              vrna_loop_cache_t     *cache);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC int
+vrna_loop_cache_prepare(vrna_fold_compound_t  *fc,
+                        unsigned int          options)
+{
+  vrna_loop_cache_t *cache;
+
+  if ((!fc) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (options & VRNA_OPTION_WINDOW) ||
+      (!fc->hc) ||
+      (fc->hc->type == VRNA_HC_WINDOW))
+    return 0;
+
+  cache = fc->loop_cache;
+
+  /* tables of a previous sequence are of no use */
+  if ((cache) && (cache->length != fc->length)) {
+    vrna_loop_cache_free(fc);
+    cache = NULL;
+  }
+
+  if (!cache) {
+    cache           = (vrna_loop_cache_t *)vrna_alloc(sizeof(vrna_loop_cache_t));
+    cache->length   = fc->length;
+    fc->loop_cache  = cache;
+  }
+
+  if ((options & VRNA_OPTION_MFE) && (fc->params))
+    hp_tables(fc, cache);
+
+  if ((options & VRNA_OPTION_PF) && (fc->exp_params))
+    exp_hp_tables(fc, cache);
+
+  return 1;
+}
+
+
+PUBLIC void
+vrna_loop_cache_free(vrna_fold_compound_t *fc)
+{
+  if ((fc) && (fc->loop_cache)) {
+    free(fc->loop_cache->mem);
+    free(fc->loop_cache->exp_mem);
+    free(fc->loop_cache);
+    fc->loop_cache = NULL;
+  }
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE void *
+aligned_block(size_t  size,
+              void    **mem)
+{
+  uintptr_t p;
+
+  *mem  = vrna_alloc(size + VRNA_LOOP_CACHE_ALIGNMENT);
+  p     = ((uintptr_t)(*mem) + VRNA_LOOP_CACHE_ALIGNMENT - 1) &
+          ~((uintptr_t)VRNA_LOOP_CACHE_ALIGNMENT - 1);
+
+  return (void *)p;
+}
+
+
+PRIVATE size_t
+aligned_size(size_t size)
+{
+  return (size + VRNA_LOOP_CACHE_ALIGNMENT - 1) &
+         ~((size_t)VRNA_LOOP_CACHE_ALIGNMENT - 1);
+}
+
+
+/* hand out the next table of an aligned memory block, such that it starts at a cache line */
+PRIVATE void *
+carve(char    **block,
+      size_t  size)
+{
+  void *table = (void *)(*block);
+
+  *block += aligned_size(size);
+
+  return table;
+}
+
+
+PRIVATE void
+hp_tables(vrna_fold_compound_t  *fc,
+          vrna_loop_cache_t     *cache)
+{
+  char          *sequence, *block;
+  short         *S, *S2;
+  unsigned int  i, j, u, n, w;
+  int           *hp, *hp_size, type, t, t2, a, b, c, d, k;
+  size_t        rows;
+  vrna_param_t  *P;
+  vrna_md_t     *md;
+
+  n         = fc->length;
+  w         = VRNA_LOOP_CACHE_HP_WIDTH;
+  sequence  = fc->sequence;
+  S         = fc->sequence_encoding;
+  S2        = fc->sequence_encoding2;
+  P         = fc->params;
+  md        = &(P->model_details);
+
+  free(cache->mem);
+
+  /*
+   *  the pair type resolved tables come first, followed by one row of
+   *  hairpin loops per 5' position, and the size dependent contributions
+   */
+  rows  = sizeof(int) * (n + 1) * w;
+  block = (char *)aligned_block(aligned_size(sizeof(int) * STEM_SIZE) * 2 +
+                                aligned_size(sizeof(int) * MISMATCH_SIZE) * 3 +
+                                aligned_size(sizeof(int) * INT11_SIZE) +
+                                aligned_size(sizeof(int) * INT21_SIZE) +
+                                aligned_size(sizeof(int) * INT22_SIZE) +
+                                rows + sizeof(int) * (n + 1),
+                                &(cache->mem));
+
+  cache->ml_stem      = (int *)carve(&block, sizeof(int) * STEM_SIZE);
+  cache->ext_stem     = (int *)carve(&block, sizeof(int) * STEM_SIZE);
+  cache->mismatchI    = (int *)carve(&block, sizeof(int) * MISMATCH_SIZE);
+  cache->mismatch1nI  = (int *)carve(&block, sizeof(int) * MISMATCH_SIZE);
+  cache->mismatch23I  = (int *)carve(&block, sizeof(int) * MISMATCH_SIZE);
+  cache->int11        = (int *)carve(&block, sizeof(int) * INT11_SIZE);
+  cache->int21        = (int *)carve(&block, sizeof(int) * INT21_SIZE);
+  cache->int22        = (int *)carve(&block, sizeof(int) * INT22_SIZE);
+  hp                  = (int *)carve(&block, rows);
+  hp_size             = hp + (n + 1) * w;
+
+  for (t = 0; t <= NBPAIRS; t++) {
+    for (a = -1; a < 5; a++)
+      for (b = -1; b < 5; b++) {
+        k                   = (t * VRNA_LOOP_CACHE_STEM_DIM + a + 1) * VRNA_LOOP_CACHE_STEM_DIM + b + 1;
+        cache->ml_stem[k]   = E_MLstem(t, a, b, P);
+        cache->ext_stem[k]  = vrna_E_ext_stem(t, a, b, P);
+      }
+
+    for (a = 0; a < 5; a++)
+      for (b = 0; b < 5; b++) {
+        k                     = (t * 5 + a) * 5 + b;
+        cache->mismatchI[k]   = P->mismatchI[t][a][b];
+        cache->mismatch1nI[k] = P->mismatch1nI[t][a][b];
+        cache->mismatch23I[k] = P->mismatch23I[t][a][b];
+      }
+  }
+
+  /* interior loop tables are restricted to nucleotides A, C, G, and U */
+  for (k = t = 0; t < NBPAIRS; t++)
+    for (t2 = 0; t2 < NBPAIRS; t2++)
+      for (a = 0; a < 4; a++)
+        for (b = 0; b < 4; b++, k++)
+          cache->int11[k] = P->int11[t + 1][t2 + 1][a + 1][b + 1];
+
+  for (k = t = 0; t < NBPAIRS; t++)
+    for (t2 = 0; t2 < NBPAIRS; t2++)
+      for (a = 0; a < 4; a++)
+        for (b = 0; b < 4; b++)
+          for (c = 0; c < 4; c++, k++)
+            cache->int21[k] = P->int21[t + 1][t2 + 1][a + 1][b + 1][c + 1];
+
+  for (k = t = 0; t < NBPAIRS; t++)
+    for (t2 = 0; t2 < NBPAIRS; t2++)
+      for (a = 0; a < 4; a++)
+        for (b = 0; b < 4; b++)
+          for (c = 0; c < 4; c++)
+            for (d = 0; d < 4; d++, k++)
+              cache->int22[k] = P->int22[t + 1][t2 + 1][a + 1][b + 1][c + 1][d + 1];
+
+  for (u = 0; u <= n; u++)
+    hp_size[u] = (u <= 30) ?
+                 P->hairpin[u] :
+                 P->hairpin[30] + (int)(P->lxc * log(u / 30.));
+
+  for (u = 0; u < w; u++)
+    hp[u] = INF;
+
+  for (i = 1; i <= n; i++)
+    for (u = 0; u < w; u++) {
+      j = i + u + 1;
+      if (j > n) {
+        hp[i * w + u] = INF;
+      } else {
+        type          = vrna_get_ptype_md(S2[i], S2[j], md);
+        hp[i * w + u] = E_Hairpin(u, type, S[i + 1], S[j - 1], sequence + i - 1, P);
+      }
+    }
+
+  cache->P        = P;
+  cache->P_id     = P->id;
+  cache->hp       = hp;
+  cache->hp_size  = hp_size;
+}
+
+
+PRIVATE void
+exp_hp_tables(vrna_fold_compound_t  *fc,
+              vrna_loop_cache_t     *cache)
+{
+  char              *sequence, *block;
+  short             *S, *S2;
+  unsigned int      i, j, u, n, w;
+  int               type, t, t2, a, b, c, d, k;
+  size_t            rows;
+  double            *exp_hp_size;
+  FLT_OR_DBL        *exp_hp;
+  vrna_exp_param_t  *P;
+  vrna_md_t         *md;
+
+  n         = fc->length;
+  w         = VRNA_LOOP_CACHE_HP_WIDTH;
+  sequence  = fc->sequence;
+  S         = fc->sequence_encoding;
+  S2        = fc->sequence_encoding2;
+  P         = fc->exp_params;
+  md        = &(P->model_details);
+
+  free(cache->exp_mem);
+
+  rows  = sizeof(FLT_OR_DBL) * (n + 1) * w;
+  block = (char *)aligned_block(aligned_size(sizeof(double) * STEM_SIZE) +
+                                aligned_size(sizeof(double) * MISMATCH_SIZE) * 3 +
+                                aligned_size(sizeof(double) * INT11_SIZE) +
+                                aligned_size(sizeof(double) * INT21_SIZE) +
+                                aligned_size(sizeof(double) * INT22_SIZE) +
+                                aligned_size(rows) + sizeof(double) * (n + 1),
+                                &(cache->exp_mem));
+
+  cache->exp_ml_stem      = (double *)carve(&block, sizeof(double) * STEM_SIZE);
+  cache->exp_mismatchI    = (double *)carve(&block, sizeof(double) * MISMATCH_SIZE);
+  cache->exp_mismatch1nI  = (double *)carve(&block, sizeof(double) * MISMATCH_SIZE);
+  cache->exp_mismatch23I  = (double *)carve(&block, sizeof(double) * MISMATCH_SIZE);
+  cache->exp_int11        = (double *)carve(&block, sizeof(double) * INT11_SIZE);
+  cache->exp_int21        = (double *)carve(&block, sizeof(double) * INT21_SIZE);
+  cache->exp_int22        = (double *)carve(&block, sizeof(double) * INT22_SIZE);
+  exp_hp                  = (FLT_OR_DBL *)carve(&block, rows);
+  exp_hp_size             = (double *)block;
+
+  for (t = 0; t <= NBPAIRS; t++) {
+    for (a = -1; a < 5; a++)
+      for (b = -1; b < 5; b++) {
+        k                     = (t * VRNA_LOOP_CACHE_STEM_DIM + a + 1) * VRNA_LOOP_CACHE_STEM_DIM + b + 1;
+        cache->exp_ml_stem[k] = (double)exp_E_MLstem(t, a, b, P);
+      }
+
+    for (a = 0; a < 5; a++)
+      for (b = 0; b < 5; b++) {
+        k                         = (t * 5 + a) * 5 + b;
+        cache->exp_mismatchI[k]   = P->expmismatchI[t][a][b];
+        cache->exp_mismatch1nI[k] = P->expmismatch1nI[t][a][b];
+        cache->exp_mismatch23I[k] = P->expmismatch23I[t][a][b];
+      }
+  }
+
+  for (k = t = 0; t < NBPAIRS; t++)
+    for (t2 = 0; t2 < NBPAIRS; t2++)
+      for (a = 0; a < 4; a++)
+        for (b = 0; b < 4; b++, k++)
+          cache->exp_int11[k] = P->expint11[t + 1][t2 + 1][a + 1][b + 1];
+
+  for (k = t = 0; t < NBPAIRS; t++)
+    for (t2 = 0; t2 < NBPAIRS; t2++)
+      for (a = 0; a < 4; a++)
+        for (b = 0; b < 4; b++)
+          for (c = 0; c < 4; c++, k++)
+            cache->exp_int21[k] = P->expint21[t + 1][t2 + 1][a + 1][b + 1][c + 1];
+
+  for (k = t = 0; t < NBPAIRS; t++)
+    for (t2 = 0; t2 < NBPAIRS; t2++)
+      for (a = 0; a < 4; a++)
+        for (b = 0; b < 4; b++)
+          for (c = 0; c < 4; c++)
+            for (d = 0; d < 4; d++, k++)
+              cache->exp_int22[k] = P->expint22[t + 1][t2 + 1][a + 1][b + 1][c + 1][d + 1];
+
+  /* same operations as in exp_E_Hairpin() to obtain identical Boltzmann factors */
+  for (u = 0; u <= n; u++)
+    exp_hp_size[u] = (u <= 30) ?
+                     P->exphairpin[u] :
+                     P->exphairpin[30] * exp(-(P->lxc * log(u / 30.)) * 10. / P->kT);
+
+  for (u = 0; u < w; u++)
+    exp_hp[u] = 0.;
+
+  for (i = 1; i <= n; i++)
+    for (u = 0; u < w; u++) {
+      j = i + u + 1;
+      if (j > n) {
+        exp_hp[i * w + u] = 0.;
+      } else {
+        type              = vrna_get_ptype_md(S2[i], S2[j], md);
+        exp_hp[i * w + u] = exp_E_Hairpin(u, type, S[i + 1], S[j - 1], sequence + i - 1, P);
+      }
+    }
+
+  cache->exp_P        = P;
+  cache->exp_P_id     = P->id;
+  cache->exp_hp       = exp_hp;
+  cache->exp_hp_size  = exp_hp_size;
+}
@@ -0,0 +1,156 @@
+#ifndef VIENNA_RNA_PACKAGE_LOOPS_CACHE_H
+#define VIENNA_RNA_PACKAGE_LOOPS_CACHE_H
+
+/**
+ *  @brief  Typename for the sequence specific loop energy cache #vrna_loop_cache_s
+ *  @ingroup  eval_loops
+ */
+typedef struct vrna_loop_cache_s vrna_loop_cache_t;
+
+#include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/params/basic.h>
+
+/**
+ *
+ *  @file     ViennaRNA/loops/cache.h
+ *  @ingroup  eval, eval_loops
+ *  @brief    Sequence specific look-up tables of loop free energies
+ */
+
+/**
+ *
+ *  @addtogroup   eval_loops
+ *  @{
+ */
+
+
+/**
+ *  @brief  Number of hairpin loop sizes stored for each 5' position in the loop energy cache
+ *
+ *  Hairpin loops of size @f$u < @f$ #VRNA_LOOP_CACHE_HP_WIDTH are tabulated explicitly. A
+ *  row of the table, i.e. all hairpins closed by a pair @f$(i,j)@f$ with fixed @f$i@f$,
+ *  spans exactly two cache lines of 64 bytes for free energies.
+ */
+#define VRNA_LOOP_CACHE_HP_WIDTH  32
+
+
+/**
+ *  @brief  Alignment of the loop energy cache tables in bytes
+ */
+#define VRNA_LOOP_CACHE_ALIGNMENT 64
+
+
+/**
+ *  @brief  Number of neighbor states of a stem in the loop energy cache
+ *
+ *  A stem is either not affected by its 5' (3') neighbor, i.e. the neighbor is passed
+ *  as @f$-1@f$ to the energy evaluation, or the neighbor is one of the 5 nucleotide
+ *  encodings.
+ */
+#define VRNA_LOOP_CACHE_STEM_DIM  6
+
+
+/**
+ *  @brief  Sequence specific look-up tables of loop free energies
+ *
+ *  The tables are derived from the energy parameters and the sequence bound to a
+ *  #vrna_fold_compound_t, and replace the repeated evaluation of the loop energy model,
+ *  i.e. loop size extrapolation and the look-up of special hairpin loops, by a single
+ *  memory access. The free energies and Boltzmann factors of hairpin loops of size
+ *  @f$u < @f$ #VRNA_LOOP_CACHE_HP_WIDTH closed by pair @f$(i,j = i + u + 1)@f$ are stored
+ *  at position @f$i \cdot @f$ #VRNA_LOOP_CACHE_HP_WIDTH @f$ + u@f$ of #vrna_loop_cache_s.hp
+ *  and #vrna_loop_cache_s.exp_hp, respectively. Larger hairpin loops are composed of the
+ *  size dependent contribution in #vrna_loop_cache_s.hp_size or #vrna_loop_cache_s.exp_hp_size,
+ *  and the terminal mismatch energy. Boltzmann factors are unscaled.
+ *
+ *  In addition, the parameters of interior loops, and the complete contributions of
+ *  multibranch and exterior loop stems are resolved by pair type. Stem contributions
+ *  combine the mismatch or dangle energy with the terminal AU/GU and multibranch
+ *  penalties into a single entry at position
+ *  @f$(t \cdot @f$ #VRNA_LOOP_CACHE_STEM_DIM @f$ + s_5 + 1) \cdot @f$ #VRNA_LOOP_CACHE_STEM_DIM @f$ + s_3 + 1@f$
+ *  for pair type @f$t@f$ and 5' and 3' neighbor encodings @f$s_5@f$ and @f$s_3@f$. The
+ *  mismatch tables of interior loops are indexed like the respective parameter arrays, i.e.
+ *  @f$(t \cdot 5 + s_i) \cdot 5 + s_j@f$. The 1x1, 2x1, and 2x2 interior loop tables only
+ *  cover the pair types @f$1 \leq t \leq @f$ #NBPAIRS and the nucleotides A, C,
+ *  G, and U, such that each table of a pair of pair types occupies a contiguous block of
+ *  16, 64, or 256 entries. This reduces the memory footprint of these tables by a factor
+ *  of about 3 compared to the energy parameter arrays.
+ *
+ *  @see  vrna_loop_cache_prepare(), vrna_loop_cache_free()
+ */
+struct vrna_loop_cache_s {
+  unsigned int            length;           /**< @brief  The sequence length the tables have been computed for */
+
+  const vrna_param_t      *P;               /**< @brief  The free energy parameters the tables have been computed from */
+  int                     P_id;             /**< @brief  The identifier of #vrna_loop_cache_s.P at the time the tables have been computed */
+  int                     *hp;              /**< @brief  Free energies of hairpin loops of size @f$u < @f$ #VRNA_LOOP_CACHE_HP_WIDTH */
+  int                     *hp_size;         /**< @brief  Size dependent free energies of hairpin loops of size @f$0 \leq u \leq n@f$ */
+  int                     *ml_stem;         /**< @brief  Free energies of multibranch loop stems */
+  int                     *ext_stem;        /**< @brief  Free energies of exterior loop stems */
+  int                     *mismatchI;       /**< @brief  Terminal mismatch energies of generic interior loops */
+  int                     *mismatch1nI;     /**< @brief  Terminal mismatch energies of 1xn interior loops */
+  int                     *mismatch23I;     /**< @brief  Terminal mismatch energies of 2x3 interior loops */
+  int                     *int11;           /**< @brief  Free energies of 1x1 interior loops */
+  int                     *int21;           /**< @brief  Free energies of 2x1 interior loops */
+  int                     *int22;           /**< @brief  Free energies of 2x2 interior loops */
+
+  const vrna_exp_param_t  *exp_P;           /**< @brief  The Boltzmann factors the tables have been computed from */
+  int                     exp_P_id;         /**< @brief  The identifier of #vrna_loop_cache_s.exp_P at the time the tables have been computed */
+  FLT_OR_DBL              *exp_hp;          /**< @brief  Boltzmann factors of hairpin loops of size @f$u < @f$ #VRNA_LOOP_CACHE_HP_WIDTH */
+  double                  *exp_hp_size;     /**< @brief  Size dependent Boltzmann factors of hairpin loops of size @f$0 \leq u \leq n@f$ */
+  double                  *exp_ml_stem;     /**< @brief  Boltzmann factors of multibranch loop stems */
+  double                  *exp_mismatchI;   /**< @brief  Terminal mismatch Boltzmann factors of generic interior loops */
+  double                  *exp_mismatch1nI; /**< @brief  Terminal mismatch Boltzmann factors of 1xn interior loops */
+  double                  *exp_mismatch23I; /**< @brief  Terminal mismatch Boltzmann factors of 2x3 interior loops */
+  double                  *exp_int11;       /**< @brief  Boltzmann factors of 1x1 interior loops */
+  double                  *exp_int21;       /**< @brief  Boltzmann factors of 2x1 interior loops */
+  double                  *exp_int22;       /**< @brief  Boltzmann factors of 2x2 interior loops */
+
+  void                    *mem;             /**< @brief  The memory block holding the free energy tables */
+  void                    *exp_mem;         /**< @brief  The memory block holding the Boltzmann factor tables */
+};
+
+
+/**
+ *  @brief  Compute the sequence specific loop energy tables of a fold compound
+ *
+ *  This function (re-)computes the free energy tables if @p options contains
+ *  #VRNA_OPTION_MFE, and the Boltzmann factor tables if @p options contains
+ *  #VRNA_OPTION_PF, from the energy parameters currently attached to @p fc.
+ *  It is called by vrna_fold_compound_prepare() and, hence, rarely required to be
+ *  called directly. Tables are available for fold compounds of type #VRNA_FC_TYPE_SINGLE
+ *  in global folding mode only, i.e. neither for sequence alignments, nor for sliding
+ *  window predictions.
+ *
+ *  @see  vrna_loop_cache_free(), #vrna_loop_cache_s
+ *
+ *  @param  fc      The fold compound
+ *  @param  options The options that specify the tables to compute
+ *  @return         Non-zero if the tables have been computed, 0 otherwise
+ */
+int
+vrna_loop_cache_prepare(vrna_fold_compound_t  *fc,
+                        unsigned int          options);
+
+
+/**
+ *  @brief  Remove the sequence specific loop energy tables from a fold compound
+ *
+ *  Subsequent energy evaluations fall back to the energy parameters of @p fc until the
+ *  tables are re-computed. This function is called whenever the energy parameters or
+ *  the sequence of a fold compound change.
+ *
+ *  @see  vrna_loop_cache_prepare()
+ *
+ *  @param  fc  The fold compound
+ */
+void
+vrna_loop_cache_free(vrna_fold_compound_t *fc);
+
+
+/**
+ * @}
+ */
+
+#endif
@@ -2305,18 +2305,15 @@ add_f5_gquad(vrna_fold_compound_t       *fc,
              struct default_data        *hc_dat_local,
              struct sc_wrapper_f5       *sc_wrapper)
 {
-  int e, i, ij, *indx, turn, *f5, *ggg;
+  int e, ij, *indx, turn, *f5, *ggg;
 
   indx  = fc->jindx;
   f5    = fc->matrices->f5;
   ggg   = fc->matrices->ggg;
   turn  = fc->params->model_details.min_loop_size;
-  ij    = indx[j] + j - turn - 1;
-  e     = INF;
 
-  for (i = j - turn - 1; i > 1; i--, ij--)
-    if ((f5[i - 1] != INF) && (ggg[ij] != INF))
-      e = MIN2(e, f5[i - 1] + ggg[ij]);
+  /* gquads [i,j] with 1 < i < j - turn */
+  e = vrna_fun_zip_add_min(f5 + 1, ggg + indx[j] + 2, j - turn - 2);
 
   ij  = indx[j] + 1;
   e   = MIN2(e, ggg[ij]);
@@ -2332,18 +2329,17 @@ add_f3_gquad(vrna_fold_compound_t       *fc,
              struct default_data        *hc_dat_local,
              struct sc_wrapper_f3       *sc_wrapper)
 {
-  int e, j, length, turn, *f3, *ggg, maxdist;
+  int e, max_j, length, turn, *f3, *ggg, maxdist;
 
   length  = (int)fc->length;
   maxdist = fc->window_size;
   f3      = fc->matrices->f3_local;
   ggg     = fc->matrices->ggg_local[i];
   turn    = fc->params->model_details.min_loop_size;
-  e       = INF;
+  max_j   = MIN2(length - 1, i + maxdist);
 
-  for (j = i + turn + 1; (j < length) && (j <= i + maxdist); j++)
-    if ((f3[j + 1] != INF) && (ggg[j - i] != INF))
-      e = MIN2(e, f3[j + 1] + ggg[j - i]);
+  /* gquads [i,j] with i + turn < j < length */
+  e = vrna_fun_zip_add_min(f3 + i + turn + 2, ggg + turn + 1, max_j - i - turn);
 
   if (length <= i + maxdist)
     e = MIN2(e, ggg[length - i]);
@@ -716,7 +716,7 @@ BT_ext_loop_f3(vrna_fold_compound_t *fc,
   char                      **ptype;
   short                     mm5, mm3, *S1;
   unsigned int              type;
-  int                       length, fij, fj, ii, u, *f3, **c, **ggg,
+  int                       length, fij, fj, ii, u, max_u, *f3, **c, **ggg,
                             dangle_model, turn, with_gquad, en;
   vrna_param_t              *P;
   vrna_md_t                 *md;
@@ -768,6 +768,9 @@ BT_ext_loop_f3(vrna_fold_compound_t *fc,
     return 1;
   }
 
+  /* the DP matrices only hold pairs (ii, u) within the window */
+  max_u = MIN2(maxdist, ii + fc->window_size);
+
   /*
    *  must have found a decomposition
    *  i is paired. Find pairing partner
@@ -775,7 +778,7 @@ BT_ext_loop_f3(vrna_fold_compound_t *fc,
   switch (dangle_model) {
     /* no dangles */
     case 0:
-      for (u = maxdist; u > ii + turn; u--) {
+      for (u = max_u; u > ii + turn; u--) {
         if (with_gquad) {
           if (fij == ggg[ii][u - ii] + f3[u + 1]) {
             *i  = *j = -1;
@@ -809,7 +812,7 @@ BT_ext_loop_f3(vrna_fold_compound_t *fc,
     /* dangles on both sides */
     case 2:
       mm5 = (ii > 1) ? S1[ii - 1] : -1;
-      for (u = maxdist; u > ii + turn; u--) {
+      for (u = max_u; u > ii + turn; u--) {
         if (with_gquad) {
           if (fij == ggg[ii][u - ii] + f3[u + 1]) {
             *i  = *j = -1;
@@ -843,7 +846,7 @@ BT_ext_loop_f3(vrna_fold_compound_t *fc,
 
     default:
       mm5 = S1[ii];
-      for (u = maxdist; u > ii + turn; u--) {
+      for (u = max_u; u > ii + turn; u--) {
         if (with_gquad) {
           if (fij == ggg[ii][u - ii] + f3[u + 1]) {
             *i  = *j = -1;
@@ -1024,7 +1027,7 @@ BT_ext_loop_f3_comparative(vrna_fold_compound_t *fc,
 {
   short                     **S, **S5, **S3;
   unsigned int              type, ss, n_seq, **a2s;
-  int                       n, fij, cc, fj, ii, u, *f3, **c, **ggg,
+  int                       n, fij, cc, fj, ii, u, max_u, *f3, **c, **ggg,
                             dangle_model, turn, with_gquad;
   vrna_param_t              *P;
   vrna_md_t                 *md;
@@ -1082,6 +1085,9 @@ BT_ext_loop_f3_comparative(vrna_fold_compound_t *fc,
     return 1;
   }
 
+  /* the DP matrices only hold pairs (ii, u) within the window */
+  max_u = MIN2(maxdist, ii + fc->window_size);
+
   /*
    *  must have found a decomposition
    *  i is paired. Find pairing partner
@@ -1089,7 +1095,7 @@ BT_ext_loop_f3_comparative(vrna_fold_compound_t *fc,
   switch (dangle_model) {
     /* no dangles */
     case 0:
-      for (u = maxdist; u > ii + turn; u--) {
+      for (u = max_u; u > ii + turn; u--) {
         if (with_gquad) {
           if (fij == ggg[ii][u - ii] + f3[u + 1]) {
             *i  = *j = -1;
@@ -1119,7 +1125,7 @@ BT_ext_loop_f3_comparative(vrna_fold_compound_t *fc,
 
     /* dangles on both sides */
     case 2:
-      for (u = maxdist; u > ii + turn; u--) {
+      for (u = max_u; u > ii + turn; u--) {
         if (with_gquad) {
           if (fij == ggg[ii][u - ii] + f3[u + 1]) {
             *i  = *j = -1;
@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/external.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -545,12 +546,15 @@ split_ext_fast(vrna_fold_compound_t       *fc,
    *  increases speed. However, once we check for the split point between
    *  strands in hard constraints, we have to think of something else...
    */
-  if ((evaluate == &hc_default) || (evaluate == &hc_default_window)) {
-    for (k = j; k > i; k--) {
-      qbt += q[ij1] *
-             qqq[k];
-      ij1 -= factor;
-    }
+  if (evaluate == &hc_default) {
+    /* q[-(k - 1)] runs backwards while qqq[k] runs forward */
+    qbt += vrna_fun_zip_mult_sum_rev(qqq + i + 1,
+                                     q + ij1,
+                                     j - i);
+  } else if (evaluate == &hc_default_window) {
+    qbt += vrna_fun_zip_mult_sum(q + i,
+                                 qqq + i + 1,
+                                 j - i);
   } else {
     for (k = j; k > i; k--)
       if (evaluate(i, j, k - 1, k, VRNA_DECOMP_EXT_EXT_EXT, hc_dat_local)) {
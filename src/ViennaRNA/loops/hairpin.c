@@ -224,6 +224,7 @@ vrna_eval_hp_loop(vrna_fold_compound_t  *fc,
   vrna_param_t          *P;
   vrna_md_t             *md;
   vrna_ud_t             *domains_up;
+  vrna_loop_cache_t     *cache;
   struct sc_wrapper_hp  sc_wrapper;
 
   P           = fc->params;
@@ -250,7 +251,18 @@ vrna_eval_hp_loop(vrna_fold_compound_t  *fc,
       if (noGUclosure && ((type == 3) || (type == 4)))
         break;
 
-      e = E_Hairpin(u, type, S[i + 1], S[j - 1], fc->sequence + i - 1, P);
+      cache = fc->loop_cache;
+
+      if ((cache) &&
+          (cache->P == P) &&
+          (cache->P_id == P->id)) {
+        if (u < VRNA_LOOP_CACHE_HP_WIDTH)
+          e = cache->hp[i * VRNA_LOOP_CACHE_HP_WIDTH + u];
+        else
+          e = cache->hp_size[u] + P->mismatchH[type][S[i + 1]][S[j - 1]];
+      } else {
+        e = E_Hairpin(u, type, S[i + 1], S[j - 1], fc->sequence + i - 1, P);
+      }
 
       break;
 
@@ -191,6 +191,7 @@ exp_eval_hp_loop(vrna_fold_compound_t *fc,
   vrna_exp_param_t          *P;
   vrna_md_t                 *md;
   vrna_ud_t                 *domains_up;
+  vrna_loop_cache_t         *cache;
   struct sc_wrapper_exp_hp  sc_wrapper;
 
   P           = fc->exp_params;
@@ -214,7 +215,18 @@ exp_eval_hp_loop(vrna_fold_compound_t *fc,
 
       if (sn[j] == sn[i]) {
         /* regular hairpin loop */
-        q = exp_E_Hairpin(u, type, S[i + 1], S[j - 1], fc->sequence + i - 1, P);
+        cache = fc->loop_cache;
+
+        if ((cache) &&
+            (cache->exp_P == P) &&
+            (cache->exp_P_id == P->id)) {
+          if (u < VRNA_LOOP_CACHE_HP_WIDTH)
+            q = cache->exp_hp[i * VRNA_LOOP_CACHE_HP_WIDTH + u];
+          else
+            q = (FLT_OR_DBL)(cache->exp_hp_size[u] * P->expmismatchH[type][S[i + 1]][S[j - 1]]);
+        } else {
+          q = exp_E_Hairpin(u, type, S[i + 1], S[j - 1], fc->sequence + i - 1, P);
+        }
       } else {
         /*
          * hairpin-like exterior loop (for cofolding)
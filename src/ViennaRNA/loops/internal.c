@@ -17,6 +17,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/internal.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 
 #ifdef __GNUC__
@@ -27,6 +28,7 @@
 
 #include "internal_hc.inc"
 #include "internal_sc.inc"
+#include "cache.inc"
 
 /*
  #################################
@@ -54,6 +56,21 @@ E_stack(vrna_fold_compound_t  *fc,
         int                   j);
 
 
+PRIVATE INLINE int
+vectorize_u1_start(int u2);
+
+
+PRIVATE int
+E_internal_loop_generic_row(vrna_fold_compound_t  *fc,
+                            int                   i,
+                            int                   j,
+                            int                   k,
+                            int                   l,
+                            int                   last_k,
+                            unsigned int          type,
+                            unsigned char         *hc_mx_l);
+
+
 PRIVATE INLINE int
 eval_int_loop(vrna_fold_compound_t  *fc,
               int                   i,
@@ -152,11 +169,13 @@ eval_int_loop(vrna_fold_compound_t  *fc,
   short                 *S, *S2, **SS, **S5, **S3;
   vrna_param_t          *P;
   vrna_md_t             *md;
-  vrna_ud_t             *domains_up;
-  struct sc_wrapper_int sc_wrapper;
+  vrna_ud_t               *domains_up;
+  const vrna_loop_cache_t *cache;
+  struct sc_wrapper_int   sc_wrapper;
 
   n_seq       = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   P           = fc->params;
+  cache       = loop_cache_mfe(fc);
   md          = &(P->model_details);
   sn          = fc->strand_number;
   ss          = fc->strand_start;
@@ -188,7 +207,9 @@ eval_int_loop(vrna_fold_compound_t  *fc,
 
         if ((sn[i] == sn[k]) && (sn[l] == sn[j])) {
           /* regular interior loop */
-          energy = E_IntLoop(u1, u2, type, type2, S[i + 1], S[j - 1], S[k - 1], S[l + 1], P);
+          energy = E_IntLoop_cached(u1, u2, type, type2,
+                                    S[i + 1], S[j - 1], S[k - 1], S[l + 1],
+                                    P, cache);
         } else {
           /* interior loop like cofold structure */
           short Si, Sj;
@@ -267,12 +288,14 @@ eval_ext_int_loop(vrna_fold_compound_t  *fc,
   short                 *S, *S2, **SS, **S5, **S3;
   vrna_param_t          *P;
   vrna_md_t             *md;
-  vrna_ud_t             *domains_up;
-  struct sc_wrapper_int sc_wrapper;
+  vrna_ud_t               *domains_up;
+  const vrna_loop_cache_t *cache;
+  struct sc_wrapper_int   sc_wrapper;
 
   n           = fc->length;
   n_seq       = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   P           = fc->params;
+  cache       = loop_cache_mfe(fc);
   md          = &(P->model_details);
   S           = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding : NULL;
   S2          = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding2 : NULL;
@@ -301,7 +324,9 @@ eval_ext_int_loop(vrna_fold_compound_t  *fc,
         u3  = n - l;
 
         /* regular interior loop */
-        energy = E_IntLoop(u2, u1 + u3, type, type2, S[j + 1], S[i - 1], S[k - 1], S[l + 1], P);
+        energy = E_IntLoop_cached(u2, u1 + u3, type, type2,
+                                  S[j + 1], S[i - 1], S[k - 1], S[l + 1],
+                                  P, cache);
 
         break;
 
@@ -370,15 +395,17 @@ E_internal_loop(vrna_fold_compound_t  *fc,
                         *hc_up, **c_local, **ggg_local;
   vrna_param_t          *P;
   vrna_md_t             *md;
-  vrna_ud_t             *domains_up;
-  struct default_data   hc_dat_local;
-  eval_hc               *evaluate;
-  struct sc_wrapper_int sc_wrapper;
+  vrna_ud_t               *domains_up;
+  const vrna_loop_cache_t *cache;
+  struct default_data     hc_dat_local;
+  eval_hc                 *evaluate;
+  struct sc_wrapper_int   sc_wrapper;
 
   evaluate = prepare_hc_default(fc, &hc_dat_local);
   init_sc_wrapper(fc, &sc_wrapper);
 
-  e = INF;
+  e     = INF;
+  cache = loop_cache_mfe(fc);
 
   n               = fc->length;
   sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
@@ -413,7 +440,8 @@ E_internal_loop(vrna_fold_compound_t  *fc,
 
   if (hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
     unsigned int  type, type2, has_nick, *tt;
-    int           k, l, kl, last_k, first_l, u1, u2, turn, noGUclosure;
+    int           k, l, kl, last_k, last_k_scalar, first_l, u1, u2, turn, noGUclosure,
+                  vectorize;
 
     has_nick    = sn[i] != sn[j] ? 1 : 0;
     turn        = md->min_loop_size;
@@ -428,6 +456,18 @@ E_internal_loop(vrna_fold_compound_t  *fc,
 
     noclose = ((noGUclosure) && (type == 3 || type == 4)) ? 1 : 0;
 
+    /*
+     *  generic interior loops of single sequences without any
+     *  soft constraints or hard constraints callback are evaluated
+     *  row-wise using the SIMD enabled vrna_fun_zip_add_min()
+     */
+    vectorize = ((fc->type == VRNA_FC_TYPE_SINGLE) &&
+                 (!sliding_window) &&
+                 (!has_nick) &&
+                 (!with_ud) &&
+                 (!sc_wrapper.pair) &&
+                 (!fc->hc->f)) ? 1 : 0;
+
     if (fc->type == VRNA_FC_TYPE_COMPARATIVE) {
       tt = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
       for (s = 0; s < n_seq; s++)
@@ -465,7 +505,9 @@ E_internal_loop(vrna_fold_compound_t  *fc,
                                     md->dangles,
                                     P);
               } else {
-                eee += E_IntLoop(0, 0, type, type2, S[i + 1], S[j - 1], S[i], S[j], P);
+                eee += E_IntLoop_cached(0, 0, type, type2,
+                                        S[i + 1], S[j - 1], S[i], S[j],
+                                        P, cache);
               }
 
               break;
@@ -538,7 +580,9 @@ E_internal_loop(vrna_fold_compound_t  *fc,
                                         md->dangles,
                                         P);
                   } else {
-                    eee += E_IntLoop(u1, 0, type, type2, S[i + 1], S[j - 1], S[k - 1], S[l + 1], P);
+                    eee += E_IntLoop_cached(u1, 0, type, type2,
+                                            S[i + 1], S[j - 1], S[k - 1], S[l + 1],
+                                            P, cache);
                   }
 
                   break;
@@ -617,7 +661,9 @@ E_internal_loop(vrna_fold_compound_t  *fc,
                                         md->dangles,
                                         P);
                   } else {
-                    eee += E_IntLoop(0, u2, type, type2, S[i + 1], S[j - 1], S[k - 1], S[l + 1], P);
+                    eee += E_IntLoop_cached(0, u2, type, type2,
+                                            S[i + 1], S[j - 1], S[k - 1], S[l + 1],
+                                            P, cache);
                   }
 
                   break;
@@ -670,13 +716,16 @@ E_internal_loop(vrna_fold_compound_t  *fc,
         if (last_k > i + 1 + hc_up[i + 1])
           last_k = i + 1 + hc_up[i + 1];
 
+        /* leave special cases, i.e. 1x1, 1x2, 2x2, and 2x3 loops, to the scalar implementation */
+        last_k_scalar = (vectorize) ? MIN2(last_k, i + vectorize_u1_start(u2)) : last_k;
+
         u1  = 1;
         k   = i + 2;
         kl  = (sliding_window) ? 0 : idx[l] + k;
 
         hc_mx += n * l;
 
-        for (; k <= last_k; k++, u1++, kl++) {
+        for (; k <= last_k_scalar; k++, u1++, kl++) {
           hc_decompose = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[k];
 
           if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
@@ -706,7 +755,9 @@ E_internal_loop(vrna_fold_compound_t  *fc,
                                         md->dangles,
                                         P);
                   } else {
-                    eee += E_IntLoop(u1, u2, type, type2, S[i + 1], S[j - 1], S[k - 1], S[l + 1], P);
+                    eee += E_IntLoop_cached(u1, u2, type, type2,
+                                            S[i + 1], S[j - 1], S[k - 1], S[l + 1],
+                                            P, cache);
                   }
 
                   break;
@@ -755,6 +806,11 @@ E_internal_loop(vrna_fold_compound_t  *fc,
           }
         }
 
+        if (k <= last_k) {
+          eee = E_internal_loop_generic_row(fc, i, j, k, l, last_k, type, hc_mx);
+          e   = MIN2(e, eee);
+        }
+
         hc_mx -= n * l;
       }
 
@@ -813,6 +869,95 @@ E_internal_loop(vrna_fold_compound_t  *fc,
 }
 
 
+/*
+ *  First size u1 of the 5' unpaired stretch of an interior loop
+ *  with 3' unpaired stretch of size u2 (u1, u2 > 0) that is neither
+ *  a 1x1, 1x2, 2x2, nor 2x3 loop. From here on, the loop energy
+ *  decomposes into a size dependent term and two mismatch terms.
+ */
+PRIVATE INLINE int
+vectorize_u1_start(int u2)
+{
+  switch (u2) {
+    case 1:
+      return 3;
+    case 2:
+      return 4;
+    case 3:
+      return 3;
+    default:
+      return 2;
+  }
+}
+
+
+/*
+ *  Minimum free energy of all generic interior loops (i,j,k',l)
+ *  with k <= k' <= last_k enclosed by (i,j) for a single sequence
+ *  without soft constraints. Since all candidates share the same
+ *  3' unpaired stretch, we linearize the size dependent energy
+ *  contributions and the enclosed pair mismatch energies into a
+ *  small buffer and let the (SIMD) vrna_fun_zip_add_min() compute
+ *  the minimum with the consecutive entries c[kl] of matrix row l.
+ */
+PRIVATE int
+E_internal_loop_generic_row(vrna_fold_compound_t  *fc,
+                            int                   i,
+                            int                   j,
+                            int                   k,
+                            int                   l,
+                            int                   last_k,
+                            unsigned int          type,
+                            unsigned char         *hc_mx_l)
+{
+  char                    *ptype;
+  short                   *S;
+  int                     e, u1, u2, t, count, type2, kl, noGUclosure, *rtype, *c,
+                          (*mismatch)[5][5], buffer[MAXLOOP + 1];
+  vrna_param_t            *P;
+  const vrna_loop_cache_t *cache;
+
+  P           = fc->params;
+  S           = fc->sequence_encoding;
+  ptype       = fc->ptype;
+  c           = fc->matrices->c;
+  rtype       = &(P->model_details.rtype[0]);
+  noGUclosure = P->model_details.noGUclosure;
+  u1          = k - i - 1;
+  u2          = j - l - 1;
+  count       = last_k - k + 1;
+  kl          = fc->jindx[l] + k;
+  cache       = loop_cache_mfe(fc);
+
+  if (cache)
+    mismatch = (int (*)[5][5])((u2 == 1) ? cache->mismatch1nI : cache->mismatchI);
+  else
+    mismatch = (u2 == 1) ? P->mismatch1nI : P->mismatchI;
+
+  for (t = 0; t < count; t++, u1++) {
+    buffer[t] = INF;
+
+    if (hc_mx_l[k + t] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+      type2 = rtype[vrna_get_ptype(kl + t, ptype)];
+
+      if ((noGUclosure) && (type2 == 3 || type2 == 4))
+        continue;
+
+      buffer[t] = P->internal_loop[u1 + u2] +
+                  MIN2(MAX_NINIO, abs(u1 - u2) * P->ninio[2]) +
+                  mismatch[type2][S[l + 1]][S[k + t - 1]];
+    }
+  }
+
+  e = vrna_fun_zip_add_min(c + kl, buffer, count);
+
+  if (e != INF)
+    e += mismatch[type][S[i + 1]][S[j - 1]];
+
+  return e;
+}
+
+
 PRIVATE int
 E_ext_internal_loop(vrna_fold_compound_t  *fc,
                     int                   i,
@@ -17,6 +17,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/internal.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 
 #ifdef __GNUC__
@@ -27,6 +28,7 @@
 
 #include "internal_hc.inc"
 #include "internal_sc_pf.inc"
+#include "cache.inc"
 
 /*
  #################################
@@ -54,6 +56,16 @@ exp_E_interior_loop(vrna_fold_compound_t  *fc,
                     int                   l);
 
 
+PRIVATE FLT_OR_DBL
+exp_E_internal_loop_generic_row(vrna_fold_compound_t  *fc,
+                                int                   i,
+                                int                   j,
+                                int                   k,
+                                int                   first_l,
+                                unsigned int          type,
+                                unsigned char         *hc_mx_k);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -114,6 +126,7 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
                             with_gquad, with_ud;
   FLT_OR_DBL                qbt1, q_temp, *qb, **qb_local, *G, *scale;
   vrna_exp_param_t          *pf_params;
+  const vrna_loop_cache_t   *cache;
   vrna_md_t                 *md;
   vrna_ud_t                 *domains_up;
   eval_hc                   *evaluate;
@@ -144,6 +157,7 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
   hc_mx_local = (sliding_window) ? fc->hc->matrix_local : NULL;
   hc_up       = fc->hc->up_int;
   pf_params   = fc->exp_params;
+  cache       = loop_cache_pf(fc);
   md          = &(pf_params->model_details);
   with_gquad  = md->gquad;
   domains_up  = fc->domains_up;
@@ -161,13 +175,24 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
   /* CONSTRAINED INTERIOR LOOP start */
   if (hc_decompose_ij & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
     unsigned int  type, type2, *tt;
-    int           k, l, kl, last_k, first_l, u1, u2, turn, noGUclosure;
+    int           k, l, kl, last_k, first_l, u1, u2, turn, noGUclosure, vectorize;
 
     turn        = md->min_loop_size;
     noGUclosure = md->noGUclosure;
     tt          = NULL;
     type        = 0;
 
+    /*
+     *  generic interior loops of single sequences without any
+     *  soft constraints or hard constraints callback are accumulated
+     *  row-wise using the SIMD enabled vrna_fun_zip_mult_sum()
+     */
+    vectorize = ((fc->type == VRNA_FC_TYPE_SINGLE) &&
+                 (!sliding_window) &&
+                 (!with_ud) &&
+                 (!sc_wrapper.pair) &&
+                 (!fc->hc->f)) ? 1 : 0;
+
     if (fc->type == VRNA_FC_TYPE_SINGLE)
       type = sliding_window ?
              vrna_get_ptype_window(i, j + i, ptype_local) :
@@ -198,15 +223,16 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
                     rtype[vrna_get_ptype_window(k, l + k, ptype_local)] :
                     rtype[vrna_get_ptype(kl, ptype)];
 
-            q_temp *= exp_E_IntLoop(0,
-                                    0,
-                                    type,
-                                    type2,
-                                    S1[i + 1],
-                                    S1[j - 1],
-                                    S1[k - 1],
-                                    S1[l + 1],
-                                    pf_params);
+            q_temp *= exp_E_IntLoop_cached(0,
+                                           0,
+                                           type,
+                                           type2,
+                                           S1[i + 1],
+                                           S1[j - 1],
+                                           S1[k - 1],
+                                           S1[l + 1],
+                                           pf_params,
+                                           cache);
 
             break;
 
@@ -273,15 +299,16 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
                 if ((noGUclosure) && (type2 == 3 || type2 == 4))
                   continue;
 
-                q_temp *= exp_E_IntLoop(u1,
-                                        0,
-                                        type,
-                                        type2,
-                                        S1[i + 1],
-                                        S1[j - 1],
-                                        S1[k - 1],
-                                        S1[l + 1],
-                                        pf_params);
+                q_temp *= exp_E_IntLoop_cached(u1,
+                                               0,
+                                               type,
+                                               type2,
+                                               S1[i + 1],
+                                               S1[j - 1],
+                                               S1[k - 1],
+                                               S1[l + 1],
+                                               pf_params,
+                                               cache);
 
                 break;
 
@@ -355,15 +382,16 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
                 if ((noGUclosure) && (type2 == 3 || type2 == 4))
                   continue;
 
-                q_temp *= exp_E_IntLoop(0,
-                                        u2,
-                                        type,
-                                        type2,
-                                        S1[i + 1],
-                                        S1[j - 1],
-                                        S1[k - 1],
-                                        S1[l + 1],
-                                        pf_params);
+                q_temp *= exp_E_IntLoop_cached(0,
+                                               u2,
+                                               type,
+                                               type2,
+                                               S1[i + 1],
+                                               S1[j - 1],
+                                               S1[k - 1],
+                                               S1[l + 1],
+                                               pf_params,
+                                               cache);
 
                 break;
 
@@ -427,6 +455,11 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
         if (first_l < ss[sn[j]])
           first_l = ss[sn[j]];
 
+        if (vectorize) {
+          qbt1 += exp_E_internal_loop_generic_row(fc, i, j, k, first_l, type, hc_mx + n * k);
+          continue;
+        }
+
         u2 = 1;
 
         hc_mx += n * k;
@@ -451,15 +484,16 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
                 if ((noGUclosure) && (type2 == 3 || type2 == 4))
                   continue;
 
-                q_temp *= exp_E_IntLoop(u1,
-                                        u2,
-                                        type,
-                                        type2,
-                                        S1[i + 1],
-                                        S1[j - 1],
-                                        S1[k - 1],
-                                        S1[l + 1],
-                                        pf_params);
+                q_temp *= exp_E_IntLoop_cached(u1,
+                                               u2,
+                                               type,
+                                               type2,
+                                               S1[i + 1],
+                                               S1[j - 1],
+                                               S1[k - 1],
+                                               S1[l + 1],
+                                               pf_params,
+                                               cache);
 
                 break;
 
@@ -557,6 +591,73 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
 }
 
 
+/*
+ *  Boltzmann weights of all interior loops (i,j,k,l') enclosed by (i,j)
+ *  with fixed k and first_l <= l' <= j - 2 for a single sequence without
+ *  soft constraints. Matrix entries qb[iindx[k] - l'] of row k are
+ *  consecutive in memory, so we collect the loop contributions in a small
+ *  buffer and let the (SIMD) vrna_fun_zip_mult_sum() do the accumulation.
+ */
+PRIVATE FLT_OR_DBL
+exp_E_internal_loop_generic_row(vrna_fold_compound_t  *fc,
+                                int                   i,
+                                int                   j,
+                                int                   k,
+                                int                   first_l,
+                                unsigned int          type,
+                                unsigned char         *hc_mx_k)
+{
+  char                    *ptype;
+  short                   *S1;
+  unsigned int            type2;
+  int                     l, u1, u2, count, noGUclosure, *rtype, *jindx, *hc_up;
+  FLT_OR_DBL              *qb, *scale, buffer[MAXLOOP + 1];
+  vrna_exp_param_t        *pf_params;
+  const vrna_loop_cache_t *cache;
+
+  pf_params   = fc->exp_params;
+  cache       = loop_cache_pf(fc);
+  S1          = fc->sequence_encoding;
+  ptype       = fc->ptype;
+  jindx       = fc->jindx;
+  hc_up       = fc->hc->up_int;
+  qb          = fc->exp_matrices->qb;
+  scale       = fc->exp_matrices->scale;
+  rtype       = &(pf_params->model_details.rtype[0]);
+  noGUclosure = pf_params->model_details.noGUclosure;
+  u1          = k - i - 1;
+  count       = 0;
+
+  for (l = j - 2, u2 = 1; l >= first_l; l--, u2++, count++) {
+    if (hc_up[l + 1] < u2)
+      break;
+
+    buffer[count] = 0.;
+
+    if (hc_mx_k[l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+      type2 = rtype[vrna_get_ptype(jindx[l] + k, ptype)];
+
+      if ((noGUclosure) && (type2 == 3 || type2 == 4))
+        continue;
+
+      buffer[count] = exp_E_IntLoop_cached(u1,
+                                           u2,
+                                           type,
+                                           type2,
+                                           S1[i + 1],
+                                           S1[j - 1],
+                                           S1[k - 1],
+                                           S1[l + 1],
+                                           pf_params,
+                                           cache) *
+                      scale[u1 + u2 + 2];
+    }
+  }
+
+  /* qb[iindx[k] - l] for l = j - 2, j - 3, ..., j - 1 - count */
+  return vrna_fun_zip_mult_sum(qb + fc->iindx[k] - j + 2, buffer, count);
+}
+
 PRIVATE FLT_OR_DBL
 exp_E_ext_int_loop(vrna_fold_compound_t *fc,
                    int                  i,
@@ -570,6 +671,7 @@ exp_E_ext_int_loop(vrna_fold_compound_t *fc,
                             u1_local, u2_local, u3_local;
   FLT_OR_DBL                q, q_temp, *qb, *scale;
   vrna_exp_param_t          *pf_params;
+  const vrna_loop_cache_t   *cache;
   vrna_md_t                 *md;
   vrna_ud_t                 *domains_up;
   eval_hc                   *evaluate;
@@ -590,6 +692,7 @@ exp_E_ext_int_loop(vrna_fold_compound_t *fc,
   hc_mx       = fc->hc->mx;
   hc_up       = fc->hc->up_int;
   pf_params   = fc->exp_params;
+  cache       = loop_cache_pf(fc);
   md          = &(pf_params->model_details);
   turn        = md->min_loop_size;
   type        = 0;
@@ -647,15 +750,16 @@ exp_E_ext_int_loop(vrna_fold_compound_t *fc,
 
               /* regular interior loop */
               q_temp *=
-                exp_E_IntLoop(u2,
-                              u1 + u3,
-                              type,
-                              type2,
-                              S[j + 1],
-                              S[i - 1],
-                              S[k - 1],
-                              S[l + 1],
-                              pf_params);
+                exp_E_IntLoop_cached(u2,
+                                     u1 + u3,
+                                     type,
+                                     type2,
+                                     S[j + 1],
+                                     S[i - 1],
+                                     S[k - 1],
+                                     S[l + 1],
+                                     pf_params,
+                                     cache);
               break;
 
             case VRNA_FC_TYPE_COMPARATIVE:
@@ -743,6 +847,7 @@ exp_E_interior_loop(vrna_fold_compound_t  *fc,
   int                       u1, u2, *rtype, *jindx, *hc_up;
   FLT_OR_DBL                qbt1, q_temp, *scale;
   vrna_exp_param_t          *pf_params;
+  const vrna_loop_cache_t   *cache;
   vrna_md_t                 *md;
   vrna_ud_t                 *domains_up;
   eval_hc                   *evaluate;
@@ -765,6 +870,7 @@ exp_E_interior_loop(vrna_fold_compound_t  *fc,
   hc_mx_local = (sliding_window) ? fc->hc->matrix_local : NULL;
   hc_up       = fc->hc->up_int;
   pf_params   = fc->exp_params;
+  cache       = loop_cache_pf(fc);
   sn          = fc->strand_number;
   md          = &(pf_params->model_details);
   scale       = fc->exp_matrices->scale;
@@ -806,15 +912,16 @@ exp_E_interior_loop(vrna_fold_compound_t  *fc,
                 rtype[vrna_get_ptype_window(k, l, ptype_local)] :
                 rtype[vrna_get_ptype(jindx[l] + k, ptype)];
 
-        q_temp = exp_E_IntLoop(u1,
-                               u2,
-                               type,
-                               type2,
-                               S1[i + 1],
-                               S1[j - 1],
-                               S1[k - 1],
-                               S1[l + 1],
-                               pf_params);
+        q_temp = exp_E_IntLoop_cached(u1,
+                                      u2,
+                                      type,
+                                      type2,
+                                      S1[i + 1],
+                                      S1[j - 1],
+                                      S1[k - 1],
+                                      S1[l + 1],
+                                      pf_params,
+                                      cache);
 
         break;
 
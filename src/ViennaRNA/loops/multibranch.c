@@ -34,6 +34,7 @@
 
 #include "multibranch_hc.inc"
 #include "multibranch_sc.inc"
+#include "cache.inc"
 
 /*
  #################################
@@ -200,11 +201,12 @@ ml_pair_d0(vrna_fold_compound_t       *fc,
            struct default_data        *hc_wrapper,
            struct sc_wrapper_ml       *sc_wrapper)
 {
-  short         *S, **SS;
-  unsigned int  tt, s, n_seq;
-  int           e;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
+  short                   *S, **SS;
+  unsigned int            tt, s, n_seq;
+  int                     e;
+  vrna_param_t            *P;
+  const vrna_loop_cache_t *cache;
+  vrna_md_t               *md;
 
   e = INF;
 
@@ -212,8 +214,9 @@ ml_pair_d0(vrna_fold_compound_t       *fc,
     e = dmli1[j - 1];
 
     if (e != INF) {
-      P   = fc->params;
-      md  = &(P->model_details);
+      P     = fc->params;
+      cache = loop_cache_mfe(fc);
+      md    = &(P->model_details);
 
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
@@ -223,7 +226,7 @@ ml_pair_d0(vrna_fold_compound_t       *fc,
           if (md->noGUclosure && ((tt == 3) || (tt == 4)))
             return INF; /* not allowed */
 
-          e += E_MLstem(tt, -1, -1, P) +
+          e += E_MLstem_cached(tt, -1, -1, P, cache) +
                P->MLclosing;
           break;
 
@@ -288,11 +291,12 @@ ml_pair_d2(vrna_fold_compound_t       *fc,
            struct default_data        *hc_wrapper,
            struct sc_wrapper_ml       *sc_wrapper)
 {
-  short         *S, *S2, **SS, **S5, **S3, si1, sj1;
-  unsigned int  tt, strands, *sn, s, n_seq;
-  int           e;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
+  short                   *S, *S2, **SS, **S5, **S3, si1, sj1;
+  unsigned int            tt, strands, *sn, s, n_seq;
+  int                     e;
+  vrna_param_t            *P;
+  const vrna_loop_cache_t *cache;
+  vrna_md_t               *md;
 
   e = INF;
 
@@ -300,8 +304,9 @@ ml_pair_d2(vrna_fold_compound_t       *fc,
     e = dmli1[j - 1];
 
     if (e != INF) {
-      P   = fc->params;
-      md  = &(P->model_details);
+      P     = fc->params;
+      cache = loop_cache_mfe(fc);
+      md    = &(P->model_details);
 
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
@@ -317,7 +322,7 @@ ml_pair_d2(vrna_fold_compound_t       *fc,
           si1 = ((strands == 1) || (sn[i] == sn[i + 1])) ? S[i + 1] : -1;
           sj1 = ((strands == 1) || (sn[j - 1] == sn[j])) ? S[j - 1] : -1;
 
-          e += E_MLstem(tt, sj1, si1, P) +
+          e += E_MLstem_cached(tt, sj1, si1, P, cache) +
                P->MLclosing;
           break;
 
@@ -354,11 +359,12 @@ ml_pair5(vrna_fold_compound_t       *fc,
          struct default_data        *hc_wrapper,
          struct sc_wrapper_ml       *sc_wrapper)
 {
-  short         *S, *S2, **SS, **S3, si1;
-  unsigned int  tt, strands, *sn, n_seq, s;
-  int           e;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
+  short                   *S, *S2, **SS, **S3, si1;
+  unsigned int            tt, strands, *sn, n_seq, s;
+  int                     e;
+  vrna_param_t            *P;
+  const vrna_loop_cache_t *cache;
+  vrna_md_t               *md;
 
   e = INF;
 
@@ -366,8 +372,9 @@ ml_pair5(vrna_fold_compound_t       *fc,
     e = dmli2[j - 1];
 
     if (e != INF) {
-      P   = fc->params;
-      md  = &(P->model_details);
+      P     = fc->params;
+      cache = loop_cache_mfe(fc);
+      md    = &(P->model_details);
 
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
@@ -382,7 +389,7 @@ ml_pair5(vrna_fold_compound_t       *fc,
 
           si1 = ((strands == 1) || (sn[i] == sn[i + 1])) ? S[i + 1] : -1;
 
-          e += E_MLstem(tt, -1, si1, P) +
+          e += E_MLstem_cached(tt, -1, si1, P, cache) +
                P->MLclosing +
                P->MLbase;
           break;
@@ -420,11 +427,12 @@ ml_pair3(vrna_fold_compound_t       *fc,
          struct default_data        *hc_wrapper,
          struct sc_wrapper_ml       *sc_wrapper)
 {
-  short         *S, *S2, **SS, **S5, sj1;
-  unsigned int  tt, strands, *sn, n_seq, s;
-  int           e;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
+  short                   *S, *S2, **SS, **S5, sj1;
+  unsigned int            tt, strands, *sn, n_seq, s;
+  int                     e;
+  vrna_param_t            *P;
+  const vrna_loop_cache_t *cache;
+  vrna_md_t               *md;
 
   e = INF;
 
@@ -432,8 +440,9 @@ ml_pair3(vrna_fold_compound_t       *fc,
     e = dmli1[j - 2];
 
     if (e != INF) {
-      P   = fc->params;
-      md  = &(P->model_details);
+      P     = fc->params;
+      cache = loop_cache_mfe(fc);
+      md    = &(P->model_details);
 
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
@@ -448,7 +457,7 @@ ml_pair3(vrna_fold_compound_t       *fc,
 
           sj1 = ((strands == 1) || (sn[j - 1] == sn[j])) ? S[j - 1] : -1;
 
-          e += E_MLstem(tt, sj1, -1, P) +
+          e += E_MLstem_cached(tt, sj1, -1, P, cache) +
                P->MLclosing +
                P->MLbase;
           break;
@@ -487,11 +496,12 @@ ml_pair53(vrna_fold_compound_t      *fc,
           struct default_data       *hc_wrapper,
           struct sc_wrapper_ml      *sc_wrapper)
 {
-  short         *S, *S2, **SS, **S3, **S5, si1, sj1;
-  unsigned int  tt, strands, *sn, n_seq, s;
-  int           e;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
+  short                   *S, *S2, **SS, **S3, **S5, si1, sj1;
+  unsigned int            tt, strands, *sn, n_seq, s;
+  int                     e;
+  vrna_param_t            *P;
+  const vrna_loop_cache_t *cache;
+  vrna_md_t               *md;
 
   e = INF;
 
@@ -499,8 +509,9 @@ ml_pair53(vrna_fold_compound_t      *fc,
     e = dmli2[j - 2];
 
     if (e != INF) {
-      P   = fc->params;
-      md  = &(P->model_details);
+      P     = fc->params;
+      cache = loop_cache_mfe(fc);
+      md    = &(P->model_details);
 
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
@@ -516,7 +527,7 @@ ml_pair53(vrna_fold_compound_t      *fc,
           si1 = ((strands == 1) || (sn[i] == sn[i + 1])) ? S[i + 1] : -1;
           sj1 = ((strands == 1) || (sn[j - 1] == sn[j])) ? S[j - 1] : -1;
 
-          e += E_MLstem(tt, sj1, si1, P) +
+          e += E_MLstem_cached(tt, sj1, si1, P, cache) +
                P->MLclosing +
                2 * P->MLbase;
           break;
@@ -555,6 +566,7 @@ E_mb_loop_fake(vrna_fold_compound_t *fc,
   unsigned int              strands, *sn;
   int                       decomp, en, e, *fC, dangle_model, tt, noGUclosure;
   vrna_param_t              *P;
+  const vrna_loop_cache_t   *cache;
   vrna_md_t                 *md;
   vrna_callback_hc_evaluate *evaluate;
   struct default_data       hc_dat_local;
@@ -565,6 +577,7 @@ E_mb_loop_fake(vrna_fold_compound_t *fc,
   sn            = fc->strand_number;
   fC            = fc->matrices->fc;
   P             = fc->params;
+  cache         = loop_cache_mfe(fc);
   md            = &(P->model_details);
   noGUclosure   = md->noGUclosure;
   dangle_model  = md->dangles;
@@ -595,15 +608,15 @@ E_mb_loop_fake(vrna_fold_compound_t *fc,
                fC[j - 1];
       switch (dangle_model) {
         case 0:
-          decomp += vrna_E_ext_stem(tt, -1, -1, P);
+          decomp += E_ext_stem_cached(tt, -1, -1, P, cache);
           break;
 
         case 2:
-          decomp += vrna_E_ext_stem(tt, S_j1, S_i1, P);
+          decomp += E_ext_stem_cached(tt, S_j1, S_i1, P, cache);
           break;
 
         default:
-          decomp += vrna_E_ext_stem(tt, -1, -1, P);
+          decomp += E_ext_stem_cached(tt, -1, -1, P, cache);
           break;
       }
     }
@@ -615,7 +628,7 @@ E_mb_loop_fake(vrna_fold_compound_t *fc,
       if ((fC[i + 2] != INF) && (fC[j - 1] != INF)) {
         en = fC[i + 2] +
              fC[j - 1] +
-             vrna_E_ext_stem(tt, -1, S_i1, P);
+             E_ext_stem_cached(tt, -1, S_i1, P, cache);
         decomp = MIN2(decomp, en);
       }
     }
@@ -624,7 +637,7 @@ E_mb_loop_fake(vrna_fold_compound_t *fc,
       if ((fC[i + 1] != INF) && (fC[j - 2] != INF)) {
         en = fC[i + 1] +
              fC[j - 2] +
-             vrna_E_ext_stem(tt, S_j1, -1, P);
+             E_ext_stem_cached(tt, S_j1, -1, P, cache);
         decomp = MIN2(decomp, en);
       }
     }
@@ -633,7 +646,7 @@ E_mb_loop_fake(vrna_fold_compound_t *fc,
       if ((fC[i + 2] != INF) && (fC[j - 2] != INF)) {
         en = fC[i + 2] +
              fC[j - 2] +
-             vrna_E_ext_stem(tt, S_j1, S_i1, P);
+             E_ext_stem_cached(tt, S_j1, S_i1, P, cache);
         decomp = MIN2(decomp, en);
       }
     }
@@ -907,13 +920,14 @@ extend_fm_3p(int                        i,
              struct default_data        *hc_dat_local,
              struct sc_wrapper_ml       *sc_wrapper)
 {
-  short         *S, **SS, **S5, **S3;
-  unsigned int  *sn, n_seq, s, sliding_window;
-  int           en, en2, length, *indx, *c, **c_local, **fm_local, *ggg, **ggg_local, ij, type,
-                dangle_model, with_gquad, e, u, k, cnt, with_ud;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
-  vrna_ud_t     *domains_up;
+  short                   *S, **SS, **S5, **S3;
+  unsigned int            *sn, n_seq, s, sliding_window;
+  int                     en, en2, length, *indx, *c, **c_local, **fm_local, *ggg, **ggg_local,
+                          ij, type, dangle_model, with_gquad, e, u, k, cnt, with_ud;
+  vrna_param_t            *P;
+  const vrna_loop_cache_t *cache;
+  vrna_md_t               *md;
+  vrna_ud_t               *domains_up;
 
   sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
   n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
@@ -931,6 +945,7 @@ extend_fm_3p(int                        i,
   ggg_local       = (sliding_window) ? fc->matrices->ggg_local : NULL;
   ij              = (sliding_window) ? 0 : indx[j] + i;
   P               = fc->params;
+  cache           = loop_cache_mfe(fc);
   md              = &(P->model_details);
   dangle_model    = md->dangles;
   with_gquad      = md->gquad;
@@ -954,9 +969,9 @@ extend_fm_3p(int                        i,
             ij,
             fc->ptype);
           if (dangle_model == 2)
-            en += E_MLstem(type, (i == 1) ? S[length] : S[i - 1], S[j + 1], P);
+            en += E_MLstem_cached(type, (i == 1) ? S[length] : S[i - 1], S[j + 1], P, cache);
           else
-            en += E_MLstem(type, -1, -1, P);
+            en += E_MLstem_cached(type, -1, -1, P, cache);
 
           break;
 
@@ -1054,6 +1069,7 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
   vrna_hc_t                 *hc;
   vrna_sc_t                 *sc;
   vrna_param_t              *P;
+  const vrna_loop_cache_t   *cache;
   vrna_md_t                 *md;
   vrna_ud_t                 *domains_up;
   vrna_callback_hc_evaluate *evaluate;
@@ -1081,6 +1097,7 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
   fm            = (sliding_window) ? NULL : fc->matrices->fML;
   fm_local      = (sliding_window) ? fc->matrices->fML_local : NULL;
   P             = fc->params;
+  cache         = loop_cache_mfe(fc);
   md            = &(P->model_details);
   ij            = (sliding_window) ? 0 : indx[j] + i;
   dangle_model  = md->dangles;
@@ -1171,7 +1188,7 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
               (sliding_window) ? vrna_get_ptype_window(i + 1, j, ptype_local) : vrna_get_ptype(
                 ij + 1,
                 ptype);
-            en += E_MLstem(type, mm5, -1, P);
+            en += E_MLstem_cached(type, mm5, -1, P, cache);
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
@@ -1202,7 +1219,7 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
                                                        ptype_local) : vrna_get_ptype(
                 indx[j - 1] + i,
                 ptype);
-            en += E_MLstem(type, -1, mm3, P);
+            en += E_MLstem_cached(type, -1, mm3, P, cache);
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
@@ -1233,7 +1250,7 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
                                                        ptype_local) : vrna_get_ptype(
                 indx[j - 1] + i + 1,
                 ptype);
-            en += E_MLstem(type, mm5, mm3, P);
+            en += E_MLstem_cached(type, mm5, mm3, P, cache);
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
@@ -1261,33 +1278,27 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
   /* use fmi pointer that we may extend to include hard/soft constraints if necessary */
   int *fmi_tmp = fmi;
 
-  if (hc->f) {
-    fmi_tmp = (int *)vrna_alloc(sizeof(int) * (j - i + 2));
-    fmi_tmp -= i;
+  if ((hc->f) || (sc_wrapper.decomp_ml)) {
+    /*
+     *  use the scratch column of the DP matrices. This is safe, since
+     *  the parallel matrix fill is not used with any of the callbacks
+     */
+    fmi_tmp = fc->matrices->fML_tmp - i;
 
     /* copy data */
     for (k = i + 1 + turn; k <= j - 2 - turn; k++)
       fmi_tmp[k] = fmi[k];
 
     /* mask unavailable decompositions */
-    for (k = i + 1 + turn; k <= j - 2 - turn; k++)
-      if (!hc->f(i, j, k, k + 1, VRNA_DECOMP_ML_ML_ML, hc->data))
-        fmi_tmp[k] = INF;
-  }
-
-  if (sc_wrapper.decomp_ml) {
-    if (fmi_tmp == fmi) {
-      fmi_tmp = (int *)vrna_alloc(sizeof(int) * (j - i + 2));
-      fmi_tmp -= i;
-
-      /* copy data */
+    if (hc->f)
       for (k = i + 1 + turn; k <= j - 2 - turn; k++)
-        fmi_tmp[k] = fmi[k];
-    }
+        if (!hc->f(i, j, k, k + 1, VRNA_DECOMP_ML_ML_ML, hc->data))
+          fmi_tmp[k] = INF;
 
-    for (k = i + 1 + turn; k <= j - 2 - turn; k++)
-      if (fmi_tmp[k] != INF)
-        fmi_tmp[k] += sc_wrapper.decomp_ml(i, j, k, k + 1, &sc_wrapper);
+    if (sc_wrapper.decomp_ml)
+      for (k = i + 1 + turn; k <= j - 2 - turn; k++)
+        if (fmi_tmp[k] != INF)
+          fmi_tmp[k] += sc_wrapper.decomp_ml(i, j, k, k + 1, &sc_wrapper);
   }
 
   /* modular decomposition -------------------------------*/
@@ -1335,11 +1346,6 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
 
   /* end modular decomposition -------------------------------*/
 
-  if (fmi_tmp != fmi) {
-    fmi_tmp += i;
-    free(fmi_tmp);
-  }
-
   dmli[j] = decomp;               /* store for use in fast ML decompositon */
 
   e = MIN2(e, decomp);
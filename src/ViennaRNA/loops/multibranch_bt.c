@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/multibranch.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -28,6 +29,7 @@
 
 #include "multibranch_hc.inc"
 #include "multibranch_sc.inc"
+#include "cache.inc"
 
 /*
  #################################
@@ -113,6 +115,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
   int                       length, ii, jj, k, en, fij, fi, *my_c, *my_fc, *my_ggg,
                             *idx, with_gquad, dangle_model, turn, type;
   vrna_param_t              *P;
+  const vrna_loop_cache_t   *cache;
   vrna_md_t                 *md;
   vrna_sc_t                 *sc;
   vrna_callback_hc_evaluate *evaluate;
@@ -120,6 +123,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
 
   length        = fc->length;
   P             = fc->params;
+  cache         = loop_cache_mfe(fc);
   md            = &(P->model_details);
   sn            = fc->strand_number;
   se            = fc->strand_end;
@@ -174,7 +178,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
           if (evaluate(ii, jj, k, k + 1, VRNA_DECOMP_EXT_STEM_EXT, &hc_dat_local)) {
             type = vrna_get_ptype(idx[k] + ii, ptype);
 
-            if (fij == my_fc[k + 1] + my_c[idx[k] + ii] + vrna_E_ext_stem(type, -1, -1, P)) {
+            if (fij == my_fc[k + 1] + my_c[idx[k] + ii] + E_ext_stem_cached(type, -1, -1, P, cache)) {
               bp_stack[++(*stack_count)].i  = ii;
               bp_stack[(*stack_count)].j    = k;
               *u                            = k + 1;
@@ -200,7 +204,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
             mm3   = (sn[k] == sn[k + 1]) ? S1[k + 1] : -1;
             type  = vrna_get_ptype(idx[k] + ii, ptype);
 
-            if (fij == my_fc[k + 1] + my_c[idx[k] + ii] + vrna_E_ext_stem(type, mm5, mm3, P)) {
+            if (fij == my_fc[k + 1] + my_c[idx[k] + ii] + E_ext_stem_cached(type, mm5, mm3, P, cache)) {
               bp_stack[++(*stack_count)].i  = ii;
               bp_stack[(*stack_count)].j    = k;
               *u                            = k + 1;
@@ -224,7 +228,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
         for (k = ii + turn + 1; k <= jj; k++) {
           type = vrna_get_ptype(idx[k] + ii, ptype);
           if (evaluate(ii, jj, k, k + 1, VRNA_DECOMP_EXT_STEM_EXT, &hc_dat_local)) {
-            if (fij == my_fc[k + 1] + my_c[idx[k] + ii] + vrna_E_ext_stem(type, -1, -1, P)) {
+            if (fij == my_fc[k + 1] + my_c[idx[k] + ii] + E_ext_stem_cached(type, -1, -1, P, cache)) {
               bp_stack[++(*stack_count)].i  = ii;
               bp_stack[(*stack_count)].j    = k;
               *u                            = k + 1;
@@ -241,7 +245,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
               if (sc->energy_up)
                 en += sc->energy_up[k + 1][1];
 
-            if (fij == my_fc[k + 2] + en + vrna_E_ext_stem(type, -1, mm3, P)) {
+            if (fij == my_fc[k + 2] + en + E_ext_stem_cached(type, -1, mm3, P, cache)) {
               bp_stack[++(*stack_count)].i  = ii;
               bp_stack[(*stack_count)].j    = k;
               *u                            = k + 2;
@@ -269,7 +273,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
               if (sc->energy_up)
                 en += sc->energy_up[ii][1];
 
-            if (fij == en + my_fc[k + 1] + vrna_E_ext_stem(type, mm5, -1, P)) {
+            if (fij == en + my_fc[k + 1] + E_ext_stem_cached(type, mm5, -1, P, cache)) {
               bp_stack[++(*stack_count)].i  = ii + 1;
               bp_stack[(*stack_count)].j    = k;
               *u                            = k + 1;
@@ -289,7 +293,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
               if (sc->energy_up)
                 en += sc->energy_up[k + 1][1];
 
-            if (fij == en + my_fc[k + 2] + vrna_E_ext_stem(type, mm5, mm3, P)) {
+            if (fij == en + my_fc[k + 2] + E_ext_stem_cached(type, mm5, mm3, P, cache)) {
               bp_stack[++(*stack_count)].i  = ii + 1;
               bp_stack[(*stack_count)].j    = k;
               *u                            = k + 2;
@@ -348,7 +352,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
             if (sn[k] != sn[jj])
               en += P->DuplexInit;
 
-            if (fij == my_fc[k - 1] + en + vrna_E_ext_stem(type, -1, -1, P)) {
+            if (fij == my_fc[k - 1] + en + E_ext_stem_cached(type, -1, -1, P, cache)) {
               bp_stack[++(*stack_count)].i  = k;
               bp_stack[(*stack_count)].j    = jj;
               *u                            = k - 1;
@@ -378,7 +382,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
             if (sn[k] != sn[jj])
               en += P->DuplexInit;
 
-            if (fij == my_fc[k - 1] + en + vrna_E_ext_stem(type, mm5, mm3, P)) {
+            if (fij == my_fc[k - 1] + en + E_ext_stem_cached(type, mm5, mm3, P, cache)) {
               bp_stack[++(*stack_count)].i  = k;
               bp_stack[(*stack_count)].j    = jj;
               *u                            = k - 1;
@@ -407,7 +411,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
             if (sn[k] != sn[jj])
               en += P->DuplexInit;
 
-            if (fij == my_fc[k - 1] + en + vrna_E_ext_stem(type, -1, -1, P)) {
+            if (fij == my_fc[k - 1] + en + E_ext_stem_cached(type, -1, -1, P, cache)) {
               bp_stack[++(*stack_count)].i  = k;
               bp_stack[(*stack_count)].j    = jj;
               *u                            = k - 1;
@@ -431,7 +435,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
               if (sc->energy_up)
                 en += sc->energy_up[k - 1][1];
 
-            if (fij == my_fc[k - 2] + en + vrna_E_ext_stem(type, mm5, -1, P)) {
+            if (fij == my_fc[k - 2] + en + E_ext_stem_cached(type, mm5, -1, P, cache)) {
               bp_stack[++(*stack_count)].i  = k;
               bp_stack[(*stack_count)].j    = jj;
               *u                            = k - 2;
@@ -454,7 +458,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
               if (sc->energy_up)
                 en += sc->energy_up[jj][1];
 
-            if (fij == en + my_fc[k - 1] + vrna_E_ext_stem(type, -1, mm3, P)) {
+            if (fij == en + my_fc[k - 1] + E_ext_stem_cached(type, -1, mm3, P, cache)) {
               bp_stack[++(*stack_count)].i  = k;
               bp_stack[(*stack_count)].j    = jj - 1;
               *u                            = k - 1;
@@ -478,7 +482,7 @@ vrna_BT_mb_loop_fake(vrna_fold_compound_t *fc,
               if (sc->energy_up)
                 en += sc->energy_up[k - 1][1];
 
-            if (fij == my_fc[k - 2] + en + vrna_E_ext_stem(type, mm5, mm3, P)) {
+            if (fij == my_fc[k - 2] + en + E_ext_stem_cached(type, mm5, mm3, P, cache)) {
               bp_stack[++(*stack_count)].i  = k;
               bp_stack[(*stack_count)].j    = jj - 1;
               *u                            = k - 2;
@@ -515,6 +519,7 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
                             turn, *idx, with_gquad, dangle_model, *rtype, kk, cnt,
                             with_ud, type, type_2, en2, **c_local, **fML_local, **ggg_local;
   vrna_param_t              *P;
+  const vrna_loop_cache_t   *cache;
   vrna_md_t                 *md;
   vrna_ud_t                 *domains_up;
   vrna_callback_hc_evaluate *evaluate;
@@ -524,6 +529,7 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
   sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
   n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   P               = fc->params;
+  cache           = loop_cache_mfe(fc);
   md              = &(P->model_details);
   idx             = (sliding_window) ? NULL : fc->jindx;
   ptype           = (fc->type == VRNA_FC_TYPE_SINGLE) ? (sliding_window ? NULL : fc->ptype) : NULL;
@@ -738,7 +744,7 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
             type = (sliding_window) ? vrna_get_ptype_window(ii, jj, ptype_local) : vrna_get_ptype(
               ij,
               ptype);
-            en2 = E_MLstem(type, -1, -1, P);
+            en2 = E_MLstem_cached(type, -1, -1, P, cache);
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
@@ -768,7 +774,7 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
             type = (sliding_window) ? vrna_get_ptype_window(ii, jj, ptype_local) : vrna_get_ptype(
               ij,
               ptype);
-            en2 = E_MLstem(type, S1[ii - 1], S1[jj + 1], P);
+            en2 = E_MLstem_cached(type, S1[ii - 1], S1[jj + 1], P, cache);
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
@@ -798,7 +804,7 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
             type = (sliding_window) ? vrna_get_ptype_window(ii, jj, ptype_local) : vrna_get_ptype(
               ij,
               ptype);
-            en2 = E_MLstem(type, -1, -1, P);
+            en2 = E_MLstem_cached(type, -1, -1, P, cache);
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
@@ -829,7 +835,7 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
               (sliding_window) ? vrna_get_ptype_window(ii + 1, jj, ptype_local) : vrna_get_ptype(
                 ij + 1,
                 ptype);
-            en2 += E_MLstem(type, S1[ii], -1, P);
+            en2 += E_MLstem_cached(type, S1[ii], -1, P, cache);
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
@@ -864,7 +870,7 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
                                                        ptype_local) : vrna_get_ptype(
                 idx[jj - 1] + ii,
                 ptype);
-            en2 += E_MLstem(type, -1, S1[jj], P);
+            en2 += E_MLstem_cached(type, -1, S1[jj], P, cache);
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
@@ -899,7 +905,7 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
                                                        ptype_local) : vrna_get_ptype(
                 idx[jj - 1] + ii + 1,
                 ptype);
-            en2 += E_MLstem(type, S1[ii], S1[jj], P);
+            en2 += E_MLstem_cached(type, S1[ii], S1[jj], P, cache);
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
@@ -926,24 +932,58 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
   }
 
   /* 2. Test for possible split point */
-  for (u = ii + 1 + turn; u <= jj - 2 - turn; u++) {
-    if (evaluate(ii, jj, u, u + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
-      if (sliding_window)
-        en = fML_local[ii][u - ii] +
-             fML_local[u + 1][jj - (u + 1)];
-      else
-        en = my_fML[idx[u] + ii] +
-             my_fML[idx[jj] + u + 1];
-
-      if (sc_wrapper.decomp_ml)
-        en += sc_wrapper.decomp_ml(ii, jj, u, u + 1, &sc_wrapper);
-
-      if (fij == en) {
-        *i  = ii;
-        *j  = u;
-        *k  = u + 1;
-        *l  = jj;
-        return 1;
+  if ((!sliding_window) &&
+      (fc->matrices->fML_tmp) &&
+      (fc->strands == 1) &&
+      (!fc->hc->f) &&
+      (!sc_wrapper.decomp_ml) &&
+      (jj - ii - 2 * turn - 2 > 0)) {
+    /*
+     *  without soft constraints and with a single strand, all split points
+     *  are allowed by the hard constraints, so we can locate the first
+     *  optimal one with a vectorized argmin instead of a linear scan
+     */
+    int pos, *fML_tmp;
+
+    cnt     = jj - ii - 2 * turn - 2;
+    fML_tmp = fc->matrices->fML_tmp;
+
+    for (u = 0; u < cnt; u++)
+      fML_tmp[u] = my_fML[idx[ii + 1 + turn + u] + ii];
+
+    en = vrna_fun_zip_add_argmin(fML_tmp,
+                                 my_fML + idx[jj] + ii + turn + 2,
+                                 cnt,
+                                 &pos);
+
+    if ((fij == en) && (pos >= 0)) {
+      u   = ii + 1 + turn + pos;
+      *i  = ii;
+      *j  = u;
+      *k  = u + 1;
+      *l  = jj;
+      return 1;
+    }
+  } else {
+    for (u = ii + 1 + turn; u <= jj - 2 - turn; u++) {
+      if (evaluate(ii, jj, u, u + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
+        if (sliding_window)
+          en = fML_local[ii][u - ii] +
+               fML_local[u + 1][jj - (u + 1)];
+        else
+          en = my_fML[idx[u] + ii] +
+               my_fML[idx[jj] + u + 1];
+
+        if (sc_wrapper.decomp_ml)
+          en += sc_wrapper.decomp_ml(ii, jj, u, u + 1, &sc_wrapper);
+
+        if (fij == en) {
+          *i  = ii;
+          *j  = u;
+          *k  = u + 1;
+          *l  = jj;
+          return 1;
+        }
       }
     }
   }
@@ -1018,6 +1058,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
   int                       ij, p, q, r, e, tmp_en, *idx, turn, dangle_model,
                             *my_c, *my_fML, *my_fc, *rtype, type, type_2, **c_local, **fML_local;
   vrna_param_t              *P;
+  const vrna_loop_cache_t   *cache;
   vrna_md_t                 *md;
   vrna_sc_t                 *sc;
   vrna_callback_hc_evaluate *evaluate;
@@ -1035,6 +1076,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
   S5              = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S5;
   S3              = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
   P               = fc->params;
+  cache           = loop_cache_mfe(fc);
   md              = &(P->model_details);
   sn              = fc->strand_number;
   se              = fc->strand_end;
@@ -1078,19 +1120,19 @@ BT_mb_loop(vrna_fold_compound_t *fc,
 
       switch (dangle_model) {
         case 0:
-          if (en == e + vrna_E_ext_stem(type, -1, -1, P))
+          if (en == e + E_ext_stem_cached(type, -1, -1, P, cache))
             ii = p, jj = q;
 
           break;
 
         case 2:
-          if (en == e + vrna_E_ext_stem(type, s5, s3, P))
+          if (en == e + E_ext_stem_cached(type, s5, s3, P, cache))
             ii = p, jj = q;
 
           break;
 
         default:
-          if (en == e + vrna_E_ext_stem(type, -1, -1, P)) {
+          if (en == e + E_ext_stem_cached(type, -1, -1, P, cache)) {
             ii = p, jj = q;
             break;
           }
@@ -1105,7 +1147,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
                 e += sc->energy_bp[ij];
             }
 
-            if (en == e + vrna_E_ext_stem(type, -1, s3, P)) {
+            if (en == e + E_ext_stem_cached(type, -1, s3, P, cache)) {
               ii  = p + 1;
               jj  = q;
               break;
@@ -1122,7 +1164,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
                 e += sc->energy_bp[ij];
             }
 
-            if (en == e + vrna_E_ext_stem(type, s5, -1, P)) {
+            if (en == e + E_ext_stem_cached(type, s5, -1, P, cache)) {
               ii  = p;
               jj  = q - 1;
               break;
@@ -1139,7 +1181,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
                 e += sc->energy_bp[ij];
             }
 
-            if (en == e + vrna_E_ext_stem(type, s5, s3, P)) {
+            if (en == e + E_ext_stem_cached(type, s5, s3, P, cache)) {
               ii  = p + 1;
               jj  = q - 1;
               break;
@@ -1184,10 +1226,10 @@ BT_mb_loop(vrna_fold_compound_t *fc,
         P->MLclosing *
         n_seq;
 
-    if (dangles == 2) {
+    if (dangle_model == 2) {
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
-          e -= E_MLstem(type, s5, s3, P);
+          e -= E_MLstem_cached(type, s5, s3, P, cache);
           break;
 
         case VRNA_FC_TYPE_COMPARATIVE:
@@ -1198,7 +1240,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
     } else {
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
-          e -= E_MLstem(type, -1, -1, P);
+          e -= E_MLstem_cached(type, -1, -1, P, cache);
           break;
 
         case VRNA_FC_TYPE_COMPARATIVE:
@@ -1229,7 +1271,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
     }
   }
 
-  if (dangles % 2) { /* odd dangles need more special treatment */
+  if (dangle_model % 2) { /* odd dangles need more special treatment */
     if (evaluate(*i, *j, p + 1, q, VRNA_DECOMP_PAIR_ML, &hc_dat_local)) {
       e = en -
           (P->MLclosing + P->MLbase) *
@@ -1240,7 +1282,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
 
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
-          e -= E_MLstem(type, -1, s3, P);
+          e -= E_MLstem_cached(type, -1, s3, P, cache);
           break;
 
         case VRNA_FC_TYPE_COMPARATIVE:
@@ -1279,7 +1321,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
 
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
-          e -= E_MLstem(type, s5, -1, P);
+          e -= E_MLstem_cached(type, s5, -1, P, cache);
           break;
 
         case VRNA_FC_TYPE_COMPARATIVE:
@@ -1320,7 +1362,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
 
       switch (fc->type) {
         case VRNA_FC_TYPE_SINGLE:
-          e -= E_MLstem(type, s5, s3, P);
+          e -= E_MLstem_cached(type, s5, s3, P, cache);
           break;
 
         case VRNA_FC_TYPE_COMPARATIVE:
@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/multibranch.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -28,6 +29,7 @@
 
 #include "multibranch_hc.inc"
 #include "multibranch_sc_pf.inc"
+#include "cache.inc"
 
 struct vrna_mx_pf_aux_ml_s {
   FLT_OR_DBL  *qqm;
@@ -247,6 +249,7 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
   FLT_OR_DBL                qbt1, temp, qqqmmm, *qm, **qm_local, *scale, expMLclosing, *qqm1;
   vrna_hc_t                 *hc;
   vrna_exp_param_t          *pf_params;
+  const vrna_loop_cache_t   *cache;
   vrna_md_t                 *md;
   vrna_callback_hc_evaluate *evaluate;
   struct default_data       hc_dat_local;
@@ -268,6 +271,7 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
   qm_local        = (sliding_window) ? fc->exp_matrices->qm_local : NULL;
   scale           = fc->exp_matrices->scale;
   pf_params       = fc->exp_params;
+  cache           = loop_cache_pf(fc);
   md              = &(pf_params->model_details);
   ij              = (sliding_window) ? 0 : jindx[j] + i;
   sn              = fc->strand_number;
@@ -289,7 +293,7 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
         tt = (sliding_window) ?
              rtype[vrna_get_ptype_window(i, j + i, ptype_local)] :
              rtype[vrna_get_ptype(ij, ptype)];
-        qqqmmm *= exp_E_MLstem(tt, S1[j - 1], S1[i + 1], pf_params);
+        qqqmmm *= exp_E_MLstem_cached(tt, S1[j - 1], S1[i + 1], pf_params, cache);
 
         break;
 
@@ -337,9 +341,9 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
     k = i + 2;
 
     if (sliding_window) {
-      for (; k <= j - 1; k++, kl--)
-        temp += qm_local[i + 1][k - 1] *
-                qqm1_tmp[k];
+      temp += vrna_fun_zip_mult_sum(qm_local[i + 1] + k - 1,
+                                    qqm1_tmp + k,
+                                    j - k);
     } else {
       kl = my_iindx[i + 1] - (i + 1);
       /*
@@ -351,9 +355,14 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
         /* limit for-loop to last nucleotide of 5' part strand */
         int stop = MIN2(j - 1, se[sn[k - 1]]);
 
-        for (; k <= stop; k++, kl--)
-          temp += qm[kl] *
-                  qqm1_tmp[k];
+        if (k <= stop) {
+          /* qm[kl] runs backwards while qqm1_tmp[k] runs forward */
+          temp  += vrna_fun_zip_mult_sum_rev(qqm1_tmp + k,
+                                             qm + kl - (stop - k),
+                                             stop - k + 1);
+          kl    -= stop - k + 1;
+          k     = stop + 1;
+        }
 
         k++;
         kl--;
@@ -393,6 +402,7 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
                             *expMLbase, **qb_local, **qm_local, **G_local;
   vrna_md_t                 *md;
   vrna_exp_param_t          *pf_params;
+  const vrna_loop_cache_t   *cache;
   vrna_ud_t                 *domains_up;
   vrna_hc_t                 *hc;
   vrna_callback_hc_evaluate *evaluate;
@@ -421,6 +431,7 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   G_local         = (sliding_window) ? fc->exp_matrices->G_local : NULL;
   expMLbase       = fc->exp_matrices->expMLbase;
   pf_params       = fc->exp_params;
+  cache           = loop_cache_pf(fc);
   md              = &(pf_params->model_details);
   hc              = fc->hc;
   domains_up      = fc->domains_up;
@@ -484,10 +495,11 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
         S2    = fc->sequence_encoding2;
         type  = vrna_get_ptype_md(S2[i], S2[j], md);
 
-        qbt1 *= exp_E_MLstem(type,
-                             ((i > 1) || circular) ? S1[i - 1] : -1,
-                             ((j < n) || circular) ? S1[j + 1] : -1,
-                             pf_params);
+        qbt1 *= exp_E_MLstem_cached(type,
+                                    ((i > 1) || circular) ? S1[i - 1] : -1,
+                                    ((j < n) || circular) ? S1[j + 1] : -1,
+                                    pf_params,
+                                    cache);
 
         break;
 
@@ -556,18 +568,24 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   k     = j;
 
   if (sliding_window) {
-    for (; k > i; k--)
-      temp += qm_local[i][k - 1] *
-              qqm_tmp[k];
+    temp += vrna_fun_zip_mult_sum(qm_local[i] + i,
+                                  qqm_tmp + i + 1,
+                                  j - i);
   } else {
     kl = iidx[i] - j + 1; /* ii-k=[i,k-1] */
 
     while (1) {
       /* limit for-loop to first nucleotide of 3' part strand */
       int stop = MAX2(i, ss[sn[k]]);
-      for (; k > stop; k--, kl++)
-        temp += qm[kl] *
-                qqm_tmp[k];
+
+      if (k > stop) {
+        /* qm[kl] runs forward while qqm_tmp[k] runs backwards */
+        temp  += vrna_fun_zip_mult_sum_rev(qm + kl,
+                                           qqm_tmp + stop + 1,
+                                           k - stop);
+        kl    += k - stop;
+        k     = stop;
+      }
 
       k--;
       kl++;
@@ -623,12 +641,11 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
       qqm_tmp[k] *= sc_wrapper.red_ml(i, j, k, j, &sc_wrapper);
   }
 
-  ii = maxk - i; /* length of unpaired stretch */
-
   /* finally, decompose segment */
-  for (k = maxk; k > i; k--, ii--)
-    temp += expMLbase[ii] *
-            qqm_tmp[k];
+  if (maxk > i)
+    temp += vrna_fun_zip_mult_sum(expMLbase + 1,
+                                  qqm_tmp + i + 1,
+                                  maxk - i);
 
   if (with_ud) {
     ii = maxk - i; /* length of unpaired stretch */
@@ -24,6 +24,7 @@
 
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/structures.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/fold_vars.h"
@@ -36,6 +37,11 @@
 #include "ViennaRNA/loops/all.h"
 #include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/mfe.h"
+#include "ViennaRNA/mfe_window.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -45,6 +51,15 @@
 
 #define MAXSECTORS        500     /* dimension for a backtrack array */
 
+/*
+ *  number of anti-diagonals we keep for the DMLi and cc helper
+ *  values in the wavefront (anti-diagonal parallel) fill
+ */
+#define WAVEFRONT_DIAGONALS 5
+
+#include "ViennaRNA/wavefront.inc"
+#include "ViennaRNA/mfe_default.inc"
+
 struct aux_arrays {
   int *cc;    /* auxilary arrays for canonical structures     */
   int *cc1;   /* auxilary arrays for canonical structures     */
@@ -52,6 +67,8 @@ struct aux_arrays {
   int *DMLi;  /* DMLi[j] holds  MIN(fML[i,k]+fML[k+1,j])      */
   int *DMLi1; /*                MIN(fML[i+1,k]+fML[k+1,j])    */
   int *DMLi2; /*                MIN(fML[i+2,k]+fML[k+1,j])    */
+
+  struct default_kernel *dk;  /* specialized decompositions, or NULL */
 };
 
 
@@ -73,10 +90,42 @@ struct aux_arrays {
  #################################
  */
 
+PRIVATE float
+mfe_fill_backtrack(vrna_fold_compound_t *fc,
+                   int                  mutation,
+                   char                 *structure);
+
+
 PRIVATE int
 fill_arrays(vrna_fold_compound_t *fc);
 
 
+PRIVATE int
+fill_arrays_mutation(vrna_fold_compound_t *fc,
+                     int                  p);
+
+
+PRIVATE INLINE int
+ml_split(vrna_fold_compound_t *fc,
+         int                  i,
+         int                  j);
+
+
+PRIVATE void
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   num_threads,
+                      struct default_kernel *dk);
+
+
+PRIVATE INLINE void
+fill_cell_wavefront(vrna_fold_compound_t  *fc,
+                    int                   i,
+                    int                   j,
+                    struct aux_arrays     *aux,
+                    int                   **dml,
+                    int                   **cc);
+
+
 PRIVATE int
 postprocess_circular(vrna_fold_compound_t *fc,
                      sect                 bt_stack[],
@@ -107,6 +156,13 @@ decompose_pair(vrna_fold_compound_t *fc,
                struct aux_arrays    *aux);
 
 
+PRIVATE INLINE int
+decompose_ml_stems(vrna_fold_compound_t *fc,
+                   int                  i,
+                   int                  j,
+                   struct aux_arrays    *aux);
+
+
 PRIVATE INLINE struct aux_arrays *
 get_aux_arrays(unsigned int length);
 
@@ -129,79 +185,87 @@ PUBLIC float
 vrna_mfe(vrna_fold_compound_t *fc,
          char                 *structure)
 {
-  char            *ss;
-  int             length, energy, s;
-  float           mfe;
-  sect            bt_stack[MAXSECTORS]; /* stack of partial structures for backtracking */
-  vrna_bp_stack_t *bp;
-
-  s   = 0;
-  mfe = (float)(INF / 100.);
-
   if (fc) {
-    length = (int)fc->length;
+    /* sliding window fold compounds only provide banded DP matrices */
+    if ((fc->hc) && (fc->hc->type == VRNA_HC_WINDOW))
+      return vrna_mfe_window_global(fc, structure);
 
-    if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE)) {
-      vrna_message_warning("vrna_mfe@mfe.c: Failed to prepare vrna_fold_compound");
-      return mfe;
-    }
-
-    /* call user-defined recursion status callback function */
-    if (fc->stat_cb)
-      fc->stat_cb(VRNA_STATUS_MFE_PRE, fc->auxdata);
-
-    /* call user-defined grammar pre-condition callback function */
-    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
-      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_PRE, fc->aux_grammar->data);
+    return mfe_fill_backtrack(fc, 0, structure);
+  }
 
-    energy = fill_arrays(fc);
+  return (float)(INF / 100.);
+}
 
-    if (fc->params->model_details.circ)
-      energy = postprocess_circular(fc, bt_stack, &s);
 
-    if (structure && fc->params->model_details.backtrack) {
-      /* add a guess of how many G's may be involved in a G quadruplex */
-      bp = (vrna_bp_stack_t *)vrna_alloc(sizeof(vrna_bp_stack_t) * (4 * (1 + length / 2)));
+PUBLIC float
+vrna_mfe_mutate(vrna_fold_compound_t  *fc,
+                unsigned int          i,
+                char                  nucleotide,
+                char                  *structure)
+{
+  char  *sequence;
+  float mfe;
 
-      if (backtrack(fc, bp, bt_stack, s) != 0) {
-        ss = vrna_db_from_bp_stack(bp, length);
-        strncpy(structure, ss, length + 1);
-        free(ss);
-      } else {
-        memset(structure, '\0', sizeof(char) * (length + 1));
-      }
+  mfe = (float)(INF / 100.);
 
-      free(bp);
-    }
+  if ((!fc) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands != 1) ||
+      (!fc->hc) ||
+      (fc->hc->type == VRNA_HC_WINDOW) ||
+      (!fc->matrices) ||
+      (fc->matrices->type != VRNA_MX_DEFAULT) ||
+      (fc->matrices->length < fc->length)) {
+    vrna_message_warning("vrna_mfe_mutate@mfe.c: "
+                         "Fold compound requires DP matrices of a previous call to vrna_mfe()");
+    return mfe;
+  }
 
-    /* call user-defined recursion status callback function */
-    if (fc->stat_cb)
-      fc->stat_cb(VRNA_STATUS_MFE_POST, fc->auxdata);
+  if ((i < 1) || (i > fc->length) || (!isalpha(nucleotide))) {
+    vrna_message_warning("vrna_mfe_mutate@mfe.c: "
+                         "Invalid mutation %c at position %u",
+                         nucleotide,
+                         i);
+    return mfe;
+  }
 
-    /* call user-defined grammar post-condition callback function */
-    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
-      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_POST, fc->aux_grammar->data);
+  /*
+   *  any constraint bound to the current sequence would get lost
+   *  when re-binding the mutated one
+   */
+  if ((fc->hc->depot) ||
+      (fc->hc->f) ||
+      (fc->sc) ||
+      (fc->domains_up) ||
+      (fc->aux_grammar)) {
+    vrna_message_warning("vrna_mfe_mutate@mfe.c: "
+                         "Incremental re-computation not available for constrained fold compounds");
+    return mfe;
+  }
 
-    switch (fc->params->model_details.backtrack_type) {
-      case 'C':
-        mfe = (float)fc->matrices->c[fc->jindx[length] + 1] / 100.;
-        break;
+  sequence          = strdup(fc->sequence);
+  sequence[i - 1]   = toupper(nucleotide);
 
-      case 'M':
-        mfe = (float)fc->matrices->fML[fc->jindx[length] + 1] / 100.;
-        break;
+  if (!vrna_fold_compound_rebind(fc, sequence)) {
+    free(sequence);
+    return mfe;
+  }
 
-      default:
-        if (fc->type == VRNA_FC_TYPE_COMPARATIVE)
-          mfe = (float)energy / (100. * (float)fc->n_seq);
-        else
-          mfe = (float)energy / 100.;
+  free(sequence);
 
-        break;
-    }
-  }
+  /*
+   *  Without lonely pairs, the recursions require the optimal stacked pair
+   *  energies of all cells (i + 1, j - 1) which are not stored in any DP
+   *  matrix. For circular RNAs, and with dangles = 2, the mismatch energies
+   *  of cells (1, j) and (k, n) wrap around the sequence ends. Thus, we simply
+   *  re-compute everything in these cases
+   */
+  if ((fc->params->model_details.noLP) ||
+      (((fc->params->model_details.circ) || (fc->params->model_details.dangles == 2)) &&
+       ((i == 1) || (i == fc->length))))
+    return mfe_fill_backtrack(fc, 0, structure);
 
-  return mfe;
+  return mfe_fill_backtrack(fc, (int)i, structure);
 }
 
 
@@ -271,11 +335,92 @@ vrna_backtrack5(vrna_fold_compound_t  *fc,
  #####################################
  */
 
+PRIVATE float
+mfe_fill_backtrack(vrna_fold_compound_t *fc,
+                   int                  mutation,
+                   char                 *structure)
+{
+  char            *ss;
+  int             length, energy, s;
+  float           mfe;
+  sect            bt_stack[MAXSECTORS]; /* stack of partial structures for backtracking */
+  vrna_bp_stack_t *bp;
+
+  s       = 0;
+  mfe     = (float)(INF / 100.);
+  length  = (int)fc->length;
+
+  if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE)) {
+    vrna_message_warning("vrna_mfe@mfe.c: Failed to prepare vrna_fold_compound");
+    return mfe;
+  }
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_MFE_PRE, fc->auxdata);
+
+  /* call user-defined grammar pre-condition callback function */
+  if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+    fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_PRE, fc->aux_grammar->data);
+
+  if (mutation > 0)
+    energy = fill_arrays_mutation(fc, mutation);
+  else
+    energy = fill_arrays(fc);
+
+  if (fc->params->model_details.circ)
+    energy = postprocess_circular(fc, bt_stack, &s);
+
+  if (structure && fc->params->model_details.backtrack) {
+    /* add a guess of how many G's may be involved in a G quadruplex */
+    bp = (vrna_bp_stack_t *)vrna_alloc(sizeof(vrna_bp_stack_t) * (4 * (1 + length / 2)));
+
+    if (backtrack(fc, bp, bt_stack, s) != 0) {
+      ss = vrna_db_from_bp_stack(bp, length);
+      strncpy(structure, ss, length + 1);
+      free(ss);
+    } else {
+      memset(structure, '\0', sizeof(char) * (length + 1));
+    }
+
+    free(bp);
+  }
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_MFE_POST, fc->auxdata);
+
+  /* call user-defined grammar post-condition callback function */
+  if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+    fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_POST, fc->aux_grammar->data);
+
+  switch (fc->params->model_details.backtrack_type) {
+    case 'C':
+      mfe = (float)fc->matrices->c[fc->jindx[length] + 1] / 100.;
+      break;
+
+    case 'M':
+      mfe = (float)fc->matrices->fML[fc->jindx[length] + 1] / 100.;
+      break;
+
+    default:
+      if (fc->type == VRNA_FC_TYPE_COMPARATIVE)
+        mfe = (float)energy / (100. * (float)fc->n_seq);
+      else
+        mfe = (float)energy / 100.;
+
+      break;
+  }
+
+  return mfe;
+}
+
+
 /* fill DP matrices */
 PRIVATE int
 fill_arrays(vrna_fold_compound_t *fc)
 {
-  int               i, j, ij, length, turn, uniq_ML, *indx, *f5, *c, *fML, *fM1;
+  int               i, j, ij, length, turn, uniq_ML, num_threads, *indx, *f5, *c, *fML, *fM1;
   vrna_param_t      *P;
   vrna_mx_mfe_t     *matrices;
   vrna_ud_t         *domains_up;
@@ -296,6 +441,9 @@ fill_arrays(vrna_fold_compound_t *fc)
   /* allocate memory for all helper arrays */
   helper_arrays = get_aux_arrays(length);
 
+  /* decide once whether we may use the decompositions specialized for the default model */
+  helper_arrays->dk = default_kernel_init(fc);
+
   if ((turn < 0) || (turn > length))
     turn = length; /* does this make any sense? */
 
@@ -320,38 +468,259 @@ fill_arrays(vrna_fold_compound_t *fc)
     return 0;
   }
 
-  for (i = length - turn - 1; i >= 1; i--) {
-    for (j = i + turn + 1; j <= length; j++) {
-      ij = indx[j] + i;
+  num_threads = wavefront_threads(fc, &(P->model_details));
+
+  if (num_threads > 1) {
+    /* fill one anti-diagonal at a time, distributed over multiple threads */
+    fill_arrays_wavefront(fc, num_threads, helper_arrays->dk);
+  } else {
+    for (i = length - turn - 1; i >= 1; i--) {
+      for (j = i + turn + 1; j <= length; j++) {
+        ij = indx[j] + i;
+
+        /* decompose subsegment [i, j] with pair (i, j) */
+        c[ij] = decompose_pair(fc, i, j, helper_arrays);
+
+        /* decompose subsegment [i, j] that is multibranch loop part with at least one branch */
+        fML[ij] = decompose_ml_stems(fc, i, j, helper_arrays);
+
+        /* decompose subsegment [i, j] that is multibranch loop part with exactly one branch */
+        if (uniq_ML)
+          fM1[ij] = E_ml_rightmost_stem(i, j, fc);
+
+        if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux))
+          fc->aux_grammar->cb_aux(fc, i, j, fc->aux_grammar->data);
+      } /* end of j-loop */
+
+      rotate_aux_arrays(helper_arrays, length);
+    } /* end of i-loop */
+  }
 
-      /* decompose subsegment [i, j] with pair (i, j) */
-      c[ij] = decompose_pair(fc, i, j, helper_arrays);
+  /* calculate energies of 5' fragments */
+  (void)vrna_E_ext_loop_5(fc);
 
-      /* decompose subsegment [i, j] that is multibranch loop part with at least one branch */
-      fML[ij] = vrna_E_ml_stems_fast(fc, i, j, helper_arrays->Fmi, helper_arrays->DMLi);
+  /* clean up memory */
+  free_aux_arrays(helper_arrays);
+
+  return f5[length];
+}
+
+
+/*
+ *  Re-fill the DP matrices after the nucleotide at position p has been
+ *  replaced. A cell (i, j) depends on the nucleotides i - 1 to j + 1 (for
+ *  dangling ends) and the cells within [i, j] only. Hence, everything with
+ *  i > p + 1 or j < p - 1 remains valid, and we re-compute the remaining
+ *  cells in the same order as fill_arrays() does. The few values of the
+ *  auxiliary DMLi arrays that belong to unaffected cells but are required
+ *  by the multibranch loop decomposition are derived from the fML matrix.
+ */
+PRIVATE int
+fill_arrays_mutation(vrna_fold_compound_t *fc,
+                     int                  p)
+{
+  int               i, j, k, ij, length, turn, uniq_ML, i_start, j_start, *indx, *f5, *c,
+                    *fML, *fM1;
+  struct aux_arrays *helper_arrays;
+
+  length    = (int)fc->length;
+  indx      = fc->jindx;
+  uniq_ML   = fc->params->model_details.uniq_ML;
+  turn      = fc->params->model_details.min_loop_size;
+  f5        = fc->matrices->f5;
+  c         = fc->matrices->c;
+  fML       = fc->matrices->fML;
+  fM1       = fc->matrices->fM1;
+
+  if ((turn < 0) || (turn > length))
+    turn = length;
+
+  if (length <= turn)
+    return 0;
+
+  helper_arrays     = get_aux_arrays(length);
+  helper_arrays->dk = default_kernel_init(fc);
+
+  i_start = MIN2(p + 1, length - turn - 1);
+  j_start = MAX2(i_start + turn + 1, p - 1);
+
+  /* DMLi values of the two (unaffected) rows below the first row we re-compute */
+  for (j = MAX2(1, j_start - 2); j <= length; j++) {
+    helper_arrays->DMLi1[j] = ml_split(fc, i_start + 1, j);
+    helper_arrays->DMLi2[j] = ml_split(fc, i_start + 2, j);
+  }
+
+  for (i = i_start; i >= 1; i--) {
+    j_start = MAX2(i + turn + 1, p - 1);
+
+    /* collect the unaffected part of row i of fML */
+    for (k = i + turn + 1; k < j_start; k++)
+      helper_arrays->Fmi[k] = fML[indx[k] + i];
+
+    for (j = j_start; j <= length; j++) {
+      ij = indx[j] + i;
+
+      c[ij]   = decompose_pair(fc, i, j, helper_arrays);
+      fML[ij] = decompose_ml_stems(fc, i, j, helper_arrays);
 
-      /* decompose subsegment [i, j] that is multibranch loop part with exactly one branch */
       if (uniq_ML)
         fM1[ij] = E_ml_rightmost_stem(i, j, fc);
+    }
 
-      if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux))
-        fc->aux_grammar->cb_aux(fc, i, j, fc->aux_grammar->data);
-    } /* end of j-loop */
+    /* DMLi values of unaffected cells required for the next two rows */
+    for (j = MAX2(i + 1, j_start - 2); j < j_start; j++)
+      helper_arrays->DMLi[j] = ml_split(fc, i, j);
 
     rotate_aux_arrays(helper_arrays, length);
-  } /*
-     * end of i-loop
-     * calculate energies of 5' fragments
-     */
+  }
+
   (void)vrna_E_ext_loop_5(fc);
 
-  /* clean up memory */
   free_aux_arrays(helper_arrays);
 
   return f5[length];
 }
 
 
+/* MIN(fML[i,k] + fML[k+1,j]), i.e. the value the serial fill stores in DMLi[j] */
+PRIVATE INLINE int
+ml_split(vrna_fold_compound_t *fc,
+         int                  i,
+         int                  j)
+{
+  int k, e, en, turn, *indx, *fML;
+
+  indx  = fc->jindx;
+  fML   = fc->matrices->fML;
+  turn  = fc->params->model_details.min_loop_size;
+  e     = INF;
+
+  if ((i < 1) || (j > (int)fc->length))
+    return e;
+
+  for (k = i + turn + 1; k <= j - turn - 2; k++) {
+    if ((fML[indx[k] + i] != INF) && (fML[indx[j] + k + 1] != INF)) {
+      en  = fML[indx[k] + i] + fML[indx[j] + k + 1];
+      e   = MIN2(e, en);
+    }
+  }
+
+  return e;
+}
+
+
+/*
+ *  Fill the DP matrices c, fML, and fM1 anti-diagonal by anti-diagonal.
+ *
+ *  All cells (i, j) with the same span j - i only depend on cells with
+ *  smaller span. Hence, we may process each anti-diagonal in parallel.
+ *  The row-wise auxiliary arrays of the serial implementation are
+ *  replaced by per-thread copies that we populate from the matrices
+ *  and a small ring buffer of the last WAVEFRONT_DIAGONALS anti-diagonals
+ *  for the values that are not stored in any DP matrix (DMLi, and cc for
+ *  the --noLP case). This ensures identical results to the serial fill.
+ */
+PRIVATE void
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   num_threads,
+                      struct default_kernel *dk)
+{
+  int               d, i, t, length, turn, *dml[WAVEFRONT_DIAGONALS], *cc[WAVEFRONT_DIAGONALS];
+  struct aux_arrays **helper_arrays;
+
+  length  = (int)fc->length;
+  turn    = fc->params->model_details.min_loop_size;
+
+  for (t = 0; t < WAVEFRONT_DIAGONALS; t++) {
+    dml[t]  = (int *)vrna_alloc(sizeof(int) * (length + 2));
+    cc[t]   = (int *)vrna_alloc(sizeof(int) * (length + 2));
+    for (i = 0; i <= length + 1; i++)
+      dml[t][i] = cc[t][i] = INF;
+  }
+
+  helper_arrays = (struct aux_arrays **)vrna_alloc(sizeof(struct aux_arrays *) * num_threads);
+  for (t = 0; t < num_threads; t++) {
+    helper_arrays[t]      = get_aux_arrays(length);
+    helper_arrays[t]->dk  = dk;
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(num_threads) private(d, i)
+#endif
+  {
+    struct aux_arrays *aux;
+
+#ifdef _OPENMP
+    aux = helper_arrays[omp_get_thread_num()];
+#else
+    aux = helper_arrays[0];
+#endif
+
+    for (d = turn + 1; d < length; d++) {
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (i = 1; i <= length - d; i++)
+        fill_cell_wavefront(fc, i, i + d, aux, dml, cc);
+      /* implicit barrier at the end of the work-sharing loop */
+    }
+  }
+
+  for (t = 0; t < num_threads; t++) {
+    helper_arrays[t]->dk = NULL; /* owned by the caller */
+    free_aux_arrays(helper_arrays[t]);
+  }
+
+  for (t = 0; t < WAVEFRONT_DIAGONALS; t++) {
+    free(dml[t]);
+    free(cc[t]);
+  }
+
+  free(helper_arrays);
+}
+
+
+PRIVATE INLINE void
+fill_cell_wavefront(vrna_fold_compound_t  *fc,
+                    int                   i,
+                    int                   j,
+                    struct aux_arrays     *aux,
+                    int                   **dml,
+                    int                   **cc)
+{
+  int k, d, ij, turn, *indx, *fML;
+
+  d     = j - i;
+  indx  = fc->jindx;
+  ij    = indx[j] + i;
+  turn  = fc->params->model_details.min_loop_size;
+  fML   = fc->matrices->fML;
+
+  /* collect row i of fML, i.e. everything with span shorter than d */
+  for (k = i + turn + 1; k < j; k++)
+    aux->Fmi[k] = fML[indx[k] + i];
+
+  /* DMLi values of rows i + 1 and i + 2 that the multibranch loop decomposition requires */
+  aux->DMLi1[j - 1] = dml[(d + WAVEFRONT_DIAGONALS - 2) % WAVEFRONT_DIAGONALS][i + 1];
+  aux->DMLi1[j - 2] = dml[(d + WAVEFRONT_DIAGONALS - 3) % WAVEFRONT_DIAGONALS][i + 1];
+  aux->DMLi2[j - 1] = dml[(d + WAVEFRONT_DIAGONALS - 3) % WAVEFRONT_DIAGONALS][i + 2];
+  aux->DMLi2[j - 2] = dml[(d + WAVEFRONT_DIAGONALS - 4) % WAVEFRONT_DIAGONALS][i + 2];
+
+  /* stacked pair energies for --noLP */
+  aux->cc1[j - 1] = cc[(d + WAVEFRONT_DIAGONALS - 2) % WAVEFRONT_DIAGONALS][i + 1];
+  aux->cc[j]      = INF;
+
+  fc->matrices->c[ij] = decompose_pair(fc, i, j, aux);
+  fML[ij]             = decompose_ml_stems(fc, i, j, aux);
+
+  if (fc->params->model_details.uniq_ML)
+    fc->matrices->fM1[ij] = E_ml_rightmost_stem(i, j, fc);
+
+  dml[d % WAVEFRONT_DIAGONALS][i] = aux->DMLi[j];
+  cc[d % WAVEFRONT_DIAGONALS][i]  = aux->cc[j];
+}
+
+
 /* post-processing step for circular RNAs */
 PRIVATE int
 postprocess_circular(vrna_fold_compound_t *fc,
@@ -1748,6 +2117,9 @@ decompose_pair(vrna_fold_compound_t *fc,
   cc1           = aux->cc1;
   e             = INF;
 
+  if (aux->dk)
+    return default_decompose_pair(aux->dk, fc, i, j, DMLi1);
+
   /* do we evaluate this pair? */
   if (hc_decompose) {
     new_c = INF;
@@ -1799,6 +2171,19 @@ decompose_pair(vrna_fold_compound_t *fc,
 }
 
 
+PRIVATE INLINE int
+decompose_ml_stems(vrna_fold_compound_t *fc,
+                   int                  i,
+                   int                  j,
+                   struct aux_arrays    *aux)
+{
+  if (aux->dk)
+    return default_ml_stems(aux->dk, i, j, aux->Fmi, aux->DMLi);
+
+  return vrna_E_ml_stems_fast(fc, i, j, aux->Fmi, aux->DMLi);
+}
+
+
 PRIVATE INLINE struct aux_arrays *
 get_aux_arrays(unsigned int length)
 {
@@ -1811,6 +2196,7 @@ get_aux_arrays(unsigned int length)
   aux->DMLi   = (int *)vrna_alloc(sizeof(int) * (length + 1));  /* DMLi[j] holds  MIN(fML[i,k]+fML[k+1,j])      */
   aux->DMLi1  = (int *)vrna_alloc(sizeof(int) * (length + 1));  /*                MIN(fML[i+1,k]+fML[k+1,j])    */
   aux->DMLi2  = (int *)vrna_alloc(sizeof(int) * (length + 1));  /*                MIN(fML[i+2,k]+fML[k+1,j])    */
+  aux->dk     = NULL;
 
   /* prefill helper arrays */
   for (j = 0; j <= length; j++)
@@ -1848,5 +2234,6 @@ free_aux_arrays(struct aux_arrays *aux)
   free(aux->DMLi);
   free(aux->DMLi1);
   free(aux->DMLi2);
+  free(aux->dk);
   free(aux);
 }
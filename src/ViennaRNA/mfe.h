@@ -71,8 +71,13 @@
  *  @note This function is polymorphic. It accepts #vrna_fold_compound_t of type
  *        #VRNA_FC_TYPE_SINGLE, and #VRNA_FC_TYPE_COMPARATIVE.
  *
+ *  @note For a #vrna_fold_compound_t obtained with option #VRNA_OPTION_WINDOW, the
+ *        prediction uses banded DP matrices of width #vrna_md_t.window_size. See
+ *        vrna_mfe_window_global() for details.
+ *
  *  @see #vrna_fold_compound_t, vrna_fold_compound(), vrna_fold(), vrna_circfold(),
- *        vrna_fold_compound_comparative(), vrna_alifold(), vrna_circalifold()
+ *        vrna_fold_compound_comparative(), vrna_alifold(), vrna_circalifold(),
+ *        vrna_mfe_window_global()
  *
  *  @param vc             fold compound
  *  @param structure      A pointer to the character array where the
@@ -85,6 +90,42 @@ vrna_mfe(vrna_fold_compound_t *vc,
          char                 *structure);
 
 
+/**
+ *  @brief Introduce a point mutation and re-compute the MFE and an appropriate secondary structure
+ *
+ *  Replaces the nucleotide at position @p i of the sequence bound to @p fc by @p nucleotide
+ *  and updates the DP matrices accordingly. Since the optimal (sub-)structures of all
+ *  intervals that neither contain @p i nor any of its direct neighbors remain unchanged,
+ *  only the cells @f$(k, l)@f$ with @f$k \leq i + 1@f$ and @f$l \geq i - 1@f$ are
+ *  re-computed. Successive calls accumulate the mutations, i.e. to scan all single point
+ *  mutants, the original nucleotide must be restored by another call before the next
+ *  position is mutated. The result is identical to a call of vrna_mfe() for a freshly
+ *  created #vrna_fold_compound_t of the mutated sequence.
+ *
+ *  @pre  The DP matrices of @p fc must have been filled by a previous call to vrna_mfe(),
+ *        or vrna_mfe_mutate() for the current sequence and model settings.
+ *
+ *  @note This function only accepts #vrna_fold_compound_t of type #VRNA_FC_TYPE_SINGLE
+ *        for a single strand without hard-, soft-constraints, unstructured domains, or
+ *        auxiliary grammar extensions. With #vrna_md_t.noLP set, all DP matrices are re-filled
+ *        from scratch.
+ *
+ *  @see vrna_mfe(), vrna_fold_compound_rebind()
+ *
+ *  @param fc         fold compound with filled DP matrices
+ *  @param i          The position of the mutation (1-based)
+ *  @param nucleotide The new nucleotide at position @p i
+ *  @param structure  A pointer to the character array where the
+ *                    secondary structure in dot-bracket notation will be written to (Maybe NULL)
+ *  @return the minimum free energy (MFE) of the mutated sequence in kcal/mol
+ */
+float
+vrna_mfe_mutate(vrna_fold_compound_t  *fc,
+                unsigned int          i,
+                char                  nucleotide,
+                char                  *structure);
+
+
 /**
  *  @brief Compute the minimum free energy of two interacting RNA molecules
  *
@@ -161,6 +202,32 @@ vrna_circfold(const char  *sequence,
               char        *structure);
 
 
+/**
+ *  @brief  Compute Minimum Free Energies (MFE), and corresponding secondary structures for many RNA sequences
+ *
+ *  This simplified interface to vrna_mfe() predicts the MFE for each sequence of a @p NULL terminated
+ *  array of RNA sequences. In contrast to repeated calls of vrna_fold(), a single #vrna_fold_compound_t
+ *  is created and re-used for all sequences via vrna_fold_compound_rebind(). Energy parameters and
+ *  DP matrices are therefore prepared only once, which substantially reduces the setup costs when
+ *  many short sequences are processed.
+ *
+ *  If @p structures is not @p NULL, it must provide space for at least as many pointers as there
+ *  are sequences. Each slot will then receive a newly allocated dot-bracket string that must be
+ *  free'd by the caller.
+ *
+ *  @see vrna_fold(), vrna_mfe(), vrna_fold_compound_rebind(), vrna_pf_fold_batch()
+ *
+ *  @param sequences  A @p NULL terminated array of RNA sequences
+ *  @param md_p       Model details to use for all predictions (Maybe @p NULL for defaults)
+ *  @param structures An array of pointers where the MFE structures will be stored (Maybe @p NULL)
+ *  @return           An array of MFE values in kcal/mol, one for each sequence (or @p NULL on error)
+ */
+float *
+vrna_fold_batch(const char      **sequences,
+                const vrna_md_t *md_p,
+                char            **structures);
+
+
 /**
  *  @brief  Compute Minimum Free Energy (MFE), and a corresponding consensus secondary structure
  *          for an RNA sequence alignment using a comparative method
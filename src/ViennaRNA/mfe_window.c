@@ -159,6 +159,27 @@ rotate_constraints(vrna_fold_compound_t *fc,
                    int                  i);
 
 
+PRIVATE INLINE void
+allocate_dp_matrices_global(vrna_fold_compound_t  *fc,
+                            float                 **dm);
+
+
+PRIVATE INLINE void
+free_dp_matrices_global(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+fill_arrays_global(vrna_fold_compound_t *fc);
+
+
+PRIVATE float **
+get_distance_matrix(vrna_fold_compound_t *fc);
+
+
+PRIVATE void
+free_distance_matrix(float **dm);
+
+
 PRIVATE INLINE struct aux_arrays *
 get_aux_arrays(unsigned int maxdist);
 
@@ -253,6 +274,60 @@ vrna_mfe_window_cb(vrna_fold_compound_t     *vc,
 }
 
 
+PUBLIC float
+vrna_mfe_window_global(vrna_fold_compound_t *fc,
+                       char                 *structure)
+{
+  char      *ss;
+  int       energy, n_seq;
+  float     **dm, mfe;
+  vrna_md_t *md;
+
+  mfe = (float)(INF / 100.);
+
+  if (!fc)
+    return mfe;
+
+  md = &(fc->params->model_details);
+
+  if ((md->gquad) || (md->circ) || (md->backtrack_type != 'F')) {
+    vrna_message_warning("vrna_mfe_window_global@mfe_window.c: "
+                         "G-Quadruplexes, circular RNAs, and backtracking "
+                         "in c or fML are not supported");
+    return mfe;
+  }
+
+  if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW)) {
+    vrna_message_warning("vrna_mfe_window_global@mfe_window.c: "
+                         "Failed to prepare vrna_fold_compound");
+    return mfe;
+  }
+
+  n_seq = (fc->type == VRNA_FC_TYPE_COMPARATIVE) ? fc->n_seq : 1;
+  dm    = (fc->type == VRNA_FC_TYPE_COMPARATIVE) ? get_distance_matrix(fc) : NULL;
+
+  /* keep all rows of the banded matrices, since we backtrack through the entire sequence */
+  allocate_dp_matrices_global(fc, dm);
+
+  energy = fill_arrays_global(fc);
+
+  if (structure && md->backtrack) {
+    ss = backtrack(fc, 1, (int)fc->length);
+    memset(structure, '.', sizeof(char) * fc->length);
+    memcpy(structure, ss, sizeof(char) * strlen(ss));
+    structure[fc->length] = '\0';
+    free(ss);
+  }
+
+  free_dp_matrices_global(fc);
+  free_distance_matrix(dm);
+
+  mfe = (float)energy / (100. * (float)n_seq);
+
+  return mfe;
+}
+
+
 #ifdef VRNA_WITH_SVM
 
 PUBLIC float
@@ -578,6 +653,205 @@ rotate_constraints(vrna_fold_compound_t *fc,
 }
 
 
+PRIVATE INLINE void
+allocate_dp_matrices_global(vrna_fold_compound_t  *fc,
+                            float                 **dm)
+{
+  int       i, k, length, maxdist, **c, **fML;
+  vrna_hc_t *hc;
+  vrna_sc_t *sc;
+
+  length  = fc->length;
+  maxdist = MIN2(fc->window_size, length);
+  hc      = fc->hc;
+  c       = fc->matrices->c_local;
+  fML     = fc->matrices->fML_local;
+  sc      = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sc : NULL;
+
+  /*
+   *  In contrast to allocate_dp_matrices(), we reserve memory for
+   *  all rows at once. Thus, the memory requirements grow with
+   *  length * maxdist instead of maxdist * maxdist
+   */
+  for (i = length; i >= 0; i--) {
+    c[i]                = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+    fML[i]              = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+    hc->matrix_local[i] = (unsigned char *)vrna_alloc(sizeof(unsigned char) * (maxdist + 5));
+    if (fc->type == VRNA_FC_TYPE_SINGLE)
+      fc->ptype_local[i] = vrna_alloc(sizeof(char) * (maxdist + 5));
+    else if (fc->type == VRNA_FC_TYPE_COMPARATIVE)
+      fc->pscore_local[i] = vrna_alloc(sizeof(int) * (maxdist + 5));
+
+    for (k = 0; k < maxdist + 5; k++)
+      c[i][k] = fML[i][k] = INF;
+
+    if (sc) {
+      if (sc->energy_bp_local)
+        sc->energy_bp_local[i] = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+
+      if (sc->energy_up)
+        sc->energy_up[i] = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+    }
+  }
+
+  /* fill the constraints in the same order as for the sliding window */
+  switch (fc->type) {
+    case VRNA_FC_TYPE_SINGLE:
+      for (i = length; i > 0; i--) {
+        make_ptypes(fc, i);
+        vrna_hc_update(fc, i, VRNA_CONSTRAINT_WINDOW_UPDATE_3);
+        vrna_sc_update(fc, i, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW);
+      }
+      break;
+
+    case VRNA_FC_TYPE_COMPARATIVE:
+      for (i = length; i > 0; i--)
+        make_pscores(fc, i, dm);
+
+      for (i = length; i > 0; i--)
+        vrna_hc_update(fc, i, VRNA_CONSTRAINT_WINDOW_UPDATE_3);
+
+      break;
+  }
+}
+
+
+PRIVATE INLINE void
+free_dp_matrices_global(vrna_fold_compound_t *fc)
+{
+  int       i, length, **c, **fML;
+  vrna_hc_t *hc;
+  vrna_sc_t *sc;
+
+  length  = fc->length;
+  hc      = fc->hc;
+  c       = fc->matrices->c_local;
+  fML     = fc->matrices->fML_local;
+  sc      = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sc : NULL;
+
+  for (i = 0; i <= length; i++) {
+    if (fc->type == VRNA_FC_TYPE_SINGLE) {
+      free(fc->ptype_local[i]);
+      fc->ptype_local[i] = NULL;
+    } else if (fc->type == VRNA_FC_TYPE_COMPARATIVE) {
+      free(fc->pscore_local[i]);
+      fc->pscore_local[i] = NULL;
+    }
+
+    free(c[i]);
+    c[i] = NULL;
+    free(fML[i]);
+    fML[i] = NULL;
+    free(hc->matrix_local[i]);
+    hc->matrix_local[i] = NULL;
+
+    if (sc) {
+      if (sc->energy_up) {
+        free(sc->energy_up[i]);
+        sc->energy_up[i] = NULL;
+      }
+
+      if (sc->energy_bp_local) {
+        free(sc->energy_bp_local[i]);
+        sc->energy_bp_local[i] = NULL;
+      }
+    }
+  }
+}
+
+
+PRIVATE int
+fill_arrays_global(vrna_fold_compound_t *fc)
+{
+  int               i, j, length, maxdist, turn, **c, **fML, *f3;
+  struct aux_arrays *helper_arrays;
+
+  length  = fc->length;
+  maxdist = fc->window_size;
+  turn    = fc->params->model_details.min_loop_size;
+  c       = fc->matrices->c_local;
+  fML     = fc->matrices->fML_local;
+  f3      = fc->matrices->f3_local;
+
+  helper_arrays = get_aux_arrays(maxdist);
+
+  /* the unstructured 3' end, as in the sliding window approach */
+  for (i = length + 1; (i > length - turn - 1) && (i > 0); i--)
+    f3[i] = 0;
+
+  for (i = length - turn - 1; i >= 1; i--) {
+    for (j = i + turn + 1; j <= length && j <= i + maxdist; j++) {
+      c[i][j - i]   = decompose_pair(fc, i, j, helper_arrays);
+      fML[i][j - i] = vrna_E_ml_stems_fast(fc, i, j, helper_arrays->Fmi, helper_arrays->DMLi);
+
+      if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux))
+        fc->aux_grammar->cb_aux(fc, i, j, fc->aux_grammar->data);
+    }
+
+    /*
+     *  f3[i] is the MFE of the entire segment [i, n] subject to the
+     *  maximum base pair span, hence f3[1] is the global MFE
+     */
+    f3[i] = vrna_E_ext_loop_3(fc, i);
+
+    rotate_aux_arrays(helper_arrays, maxdist);
+  }
+
+  free_aux_arrays(helper_arrays);
+
+  return f3[1];
+}
+
+
+PRIVATE float **
+get_distance_matrix(vrna_fold_compound_t *fc)
+{
+  int       i, j;
+  float     **dm;
+  vrna_md_t *md;
+
+  int       olddm[7][7] = { { 0, 0, 0, 0, 0, 0, 0 },/* hamming distance between pairs */
+                            { 0, 0, 2, 2, 1, 2, 2 } /* CG */,
+                            { 0, 2, 0, 1, 2, 2, 2 } /* GC */,
+                            { 0, 2, 1, 0, 2, 1, 2 } /* GU */,
+                            { 0, 1, 2, 2, 0, 2, 1 } /* UG */,
+                            { 0, 2, 2, 1, 2, 0, 2 } /* AU */,
+                            { 0, 2, 2, 2, 1, 2, 0 } /* UA */ };
+
+  md = &(fc->params->model_details);
+
+  if (md->ribo) {
+    if (RibosumFile != NULL)
+      dm = readribosum(RibosumFile);
+    else
+      dm = get_ribosum((const char **)fc->sequences, fc->n_seq, fc->length);
+  } else {
+    /*use usual matrix*/
+    dm = (float **)vrna_alloc(7 * sizeof(float *));
+    for (i = 0; i < 7; i++) {
+      dm[i] = (float *)vrna_alloc(7 * sizeof(float));
+      for (j = 0; j < 7; j++)
+        dm[i][j] = (float)olddm[i][j];
+    }
+  }
+
+  return dm;
+}
+
+
+PRIVATE void
+free_distance_matrix(float **dm)
+{
+  int i;
+
+  if (dm) {
+    for (i = 0; i < 7; i++)
+      free(dm[i]);
+    free(dm);
+  }
+}
+
+
 PRIVATE int
 fill_arrays(vrna_fold_compound_t            *vc,
             int                             *underflow,
@@ -606,14 +880,6 @@ fill_arrays(vrna_fold_compound_t            *vc,
   vrna_md_t         *md;
   struct aux_arrays *helper_arrays;
 
-  int               olddm[7][7] = { { 0, 0, 0, 0, 0, 0, 0 },/* hamming distance between pairs */
-                                    { 0, 0, 2, 2, 1, 2, 2 } /* CG */,
-                                    { 0, 2, 0, 1, 2, 2, 2 } /* GC */,
-                                    { 0, 2, 1, 0, 2, 1, 2 } /* GU */,
-                                    { 0, 1, 2, 2, 0, 2, 1 } /* UG */,
-                                    { 0, 2, 2, 1, 2, 0, 2 } /* AU */,
-                                    { 0, 2, 2, 2, 1, 2, 0 } /* UA */ };
-
   n_seq         = (vc->type == VRNA_FC_TYPE_COMPARATIVE) ? vc->n_seq : 1;
   length        = vc->length;
   maxdist       = vc->window_size;
@@ -647,20 +913,7 @@ fill_arrays(vrna_fold_compound_t            *vc,
     }
 #endif
 
-    if (md->ribo) {
-      if (RibosumFile != NULL)
-        dm = readribosum(RibosumFile);
-      else
-        dm = get_ribosum((const char **)vc->sequences, n_seq, length);
-    } else {
-      /*use usual matrix*/
-      dm = (float **)vrna_alloc(7 * sizeof(float *));
-      for (i = 0; i < 7; i++) {
-        dm[i] = (float *)vrna_alloc(7 * sizeof(float));
-        for (j = 0; j < 7; j++)
-          dm[i][j] = (float)olddm[i][j];
-      }
-    }
+    dm = get_distance_matrix(vc);
   }
 
   c   = vc->matrices->c_local;
@@ -812,12 +1065,7 @@ fill_arrays(vrna_fold_compound_t            *vc,
   /* clean up memory */
   free_aux_arrays(helper_arrays);
   free_dp_matrices(vc);
-
-  if (dm) {
-    for (i = 0; i < 7; i++)
-      free(dm[i]);
-    free(dm);
-  }
+  free_distance_matrix(dm);
 
   return f3[1];
 }
@@ -118,6 +118,36 @@ vrna_mfe_window_cb(vrna_fold_compound_t     *vc,
                    void                     *data);
 
 
+/**
+ *  @brief Global MFE prediction with banded DP matrices of a sliding window #vrna_fold_compound_t
+ *
+ *  Computes the globally optimal secondary structure of the entire sequence (or alignment)
+ *  where base pairs may not span more than #vrna_md_t.window_size nucleotides. In contrast
+ *  to vrna_mfe() with the #vrna_md_t.max_bp_span attribute set, this function uses the
+ *  banded DP matrices of the sliding window approach, i.e. it only requires memory in the
+ *  order of @f$ n \cdot w @f$ instead of @f$ n^2 @f$ for sequence length @f$ n @f$ and window
+ *  size @f$ w @f$. This allows for the prediction of MFE structures for long sequences, e.g. entire
+ *  viral genomes, when a maximum base pair span is acceptable.
+ *
+ *  The #vrna_fold_compound_t must be obtained with option #VRNA_OPTION_WINDOW. Calling vrna_mfe()
+ *  on such a #vrna_fold_compound_t automatically re-directs to this function.
+ *
+ *  @note G-Quadruplexes, circular RNAs, and backtracking other than
+ *        #vrna_md_t.backtrack_type = 'F' are not supported.
+ *
+ *  @see  vrna_mfe(), vrna_mfe_window(), vrna_fold_compound(), #VRNA_OPTION_WINDOW,
+ *        #vrna_md_t.window_size, #vrna_md_t.max_bp_span
+ *
+ *  @param  fc        The #vrna_fold_compound_t obtained with option #VRNA_OPTION_WINDOW
+ *  @param  structure A pointer to the character array where the secondary structure in
+ *                    dot-bracket notation will be written to (Maybe NULL)
+ *  @return           The minimum free energy (MFE) in kcal/mol
+ */
+float
+vrna_mfe_window_global(vrna_fold_compound_t *fc,
+                       char                 *structure);
+
+
 #ifdef VRNA_WITH_SVM
 /**
  *  @brief Local MFE prediction using a sliding window approach (with z-score cut-off)
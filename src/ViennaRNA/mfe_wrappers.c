@@ -9,6 +9,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "ViennaRNA/fold_compound.h"
 #include "ViennaRNA/model.h"
@@ -54,6 +55,69 @@ vrna_circfold(const char  *string,
 }
 
 
+PUBLIC float *
+vrna_fold_batch(const char      **sequences,
+                const vrna_md_t *md_p,
+                char            **structures)
+{
+  char                  *structure;
+  unsigned int          i, n, num, n_max, longest;
+  float                 *energies;
+  vrna_fold_compound_t  *fc, *tmp;
+  vrna_md_t             md;
+
+  if (!sequences)
+    return NULL;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /*
+   *  find the longest sequence that can be re-bound, such that the DP
+   *  matrices of the shared fold compound are allocated only once
+   */
+  longest = 0;
+  n_max   = 0;
+
+  for (num = 0; sequences[num]; num++) {
+    if (strchr(sequences[num], '&'))
+      continue;
+
+    n = strlen(sequences[num]);
+    if (n > n_max) {
+      n_max   = n;
+      longest = num;
+    }
+  }
+
+  energies  = (float *)vrna_alloc(sizeof(float) * (num + 1));
+  fc        = (n_max > 0) ? vrna_fold_compound(sequences[longest], &md, VRNA_OPTION_MFE) : NULL;
+
+  for (i = 0; i < num; i++) {
+    structure = (structures) ? (char *)vrna_alloc(sizeof(char) * (strlen(sequences[i]) + 1)) : NULL;
+
+    if ((fc) && (vrna_fold_compound_rebind(fc, sequences[i]))) {
+      energies[i] = vrna_mfe(fc, structure);
+    } else if ((tmp = vrna_fold_compound(sequences[i], &md, VRNA_OPTION_MFE))) {
+      /* fall-back for sequences we can not bind to the shared fold compound */
+      energies[i] = vrna_mfe(tmp, structure);
+      vrna_fold_compound_free(tmp);
+    } else {
+      energies[i] = (float)(INF / 100.);
+    }
+
+    if (structures)
+      structures[i] = structure;
+  }
+
+  vrna_fold_compound_free(fc);
+
+  return energies;
+}
+
+
 /* wrappers for multiple sequence alignments */
 
 PUBLIC float
@@ -134,7 +134,9 @@ PRIVATE vrna_md_t defaults = {
     { 0,                            0,  0, 0, 0, 0, 2, 0 },
     { 0,                            0,  0, 0, 0, 1, 0, 0 },
     { 0,                            6,  0, 0, 5, 0, 0, 0 }
-  }
+  },
+  VRNA_MODEL_DEFAULT_NUM_THREADS,
+  VRNA_MODEL_DEFAULT_BPP_MT_LENGTH
 };
 
 /*
@@ -335,6 +337,8 @@ vrna_md_defaults_reset(vrna_md_t *md_p)
   defaults.betaScale        = VRNA_MODEL_DEFAULT_BETA_SCALE;
   defaults.pf_smooth        = VRNA_MODEL_DEFAULT_PF_SMOOTH;
   defaults.sfact            = 1.07;
+  defaults.num_threads      = VRNA_MODEL_DEFAULT_NUM_THREADS;
+  defaults.bpp_mt_length    = VRNA_MODEL_DEFAULT_BPP_MT_LENGTH;
   defaults.nonstandards[0]  = '\0';
 
   if (md_p) {
@@ -369,6 +373,8 @@ vrna_md_defaults_reset(vrna_md_t *md_p)
     vrna_md_defaults_betaScale(md_p->betaScale);
     vrna_md_defaults_pf_smooth(md_p->pf_smooth);
     vrna_md_defaults_sfact(md_p->sfact);
+    vrna_md_defaults_num_threads(md_p->num_threads);
+    vrna_md_defaults_bpp_mt_length(md_p->bpp_mt_length);
     copy_nonstandards(&defaults, &(md_p->nonstandards[0]));
   }
 
@@ -824,6 +830,34 @@ vrna_md_defaults_sfact_get(void)
 }
 
 
+PUBLIC void
+vrna_md_defaults_num_threads(int num_threads)
+{
+  defaults.num_threads = (num_threads < 1) ? 1 : num_threads;
+}
+
+
+PUBLIC int
+vrna_md_defaults_num_threads_get(void)
+{
+  return defaults.num_threads;
+}
+
+
+PUBLIC void
+vrna_md_defaults_bpp_mt_length(int length)
+{
+  defaults.bpp_mt_length = (length < 1) ? 0 : length;
+}
+
+
+PUBLIC int
+vrna_md_defaults_bpp_mt_length_get(void)
+{
+  return defaults.bpp_mt_length;
+}
+
+
 PUBLIC void
 vrna_md_update(vrna_md_t *md)
 {
@@ -993,6 +1027,8 @@ set_model_details(vrna_md_t *md)
     md->betaScale       = VRNA_MODEL_DEFAULT_BETA_SCALE;
     md->pf_smooth       = VRNA_MODEL_DEFAULT_PF_SMOOTH;
     md->sfact           = 1.07;
+    md->num_threads     = VRNA_MODEL_DEFAULT_NUM_THREADS;
+    md->bpp_mt_length   = VRNA_MODEL_DEFAULT_BPP_MT_LENGTH;
 
     if (nonstandards)
       copy_nonstandards(md, nonstandards);
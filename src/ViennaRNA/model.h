@@ -157,6 +157,25 @@ typedef struct vrna_md_s vrna_md_t;
 #define VRNA_MODEL_DEFAULT_PF_SMOOTH      1
 
 
+/**
+ *  @brief  Default number of threads used within a single DP matrix fill
+ *  @see    #vrna_md_t.num_threads, vrna_md_defaults_reset(), vrna_md_set_default()
+ */
+#define VRNA_MODEL_DEFAULT_NUM_THREADS    1
+
+
+/**
+ *  @brief  Default minimum sequence length for multi-threaded base pair probability computations
+ *
+ *  Base pair probabilities of sequences of at least this length are computed with
+ *  all available OpenMP threads. Applications that already parallelize on a higher
+ *  level may set #vrna_md_t.bpp_mt_length to 0 to deactivate this behavior.
+ *
+ *  @see    #vrna_md_t.bpp_mt_length, vrna_md_defaults_reset(), vrna_md_set_default()
+ */
+#define VRNA_MODEL_DEFAULT_BPP_MT_LENGTH  1000
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 #ifndef MAXALPHA
@@ -233,6 +252,24 @@ struct vrna_md_s {
   int     rtype[8];                         /**<  @brief  Reverse base pair type array */
   short   alias[MAXALPHA + 1];              /**<  @brief  alias of an integer nucleotide representation */
   int     pair[MAXALPHA + 1][MAXALPHA + 1]; /**<  @brief  Integer representation of a base pair */
+  int     num_threads;                      /**<  @brief  Number of threads used within a single DP matrix fill
+                                             *
+                                             *    Values larger than 1 activate the parallelization of the
+                                             *    forward recursions in vrna_mfe() and vrna_pf(), and of the outside recursions in
+                                             *    vrna_pairing_probs(). Results are identical to the
+                                             *    serial implementation. The breadth-first search of
+                                             *    vrna_path_findpath() and friends expands the entries of
+                                             *    its beam with this number of threads, too.
+                                             *    @note   Requires OpenMP support at compile time. Otherwise,
+                                             *            this setting is silently ignored.
+                                             */
+  int     bpp_mt_length;                    /**<  @brief  Minimum sequence length for multi-threaded base pair probability computation
+                                             *
+                                             *    Base pair probabilities of sequences with at least this
+                                             *    length are computed using all available OpenMP threads,
+                                             *    even if #vrna_md_t.num_threads is not larger than 1.
+                                             *    A value of 0 deactivates this behavior.
+                                             */
 };
 
 
@@ -742,6 +779,42 @@ double
 vrna_md_defaults_sfact_get(void);
 
 
+/**
+ *  @brief  Set the default number of threads used within a single DP matrix fill
+ *  @see vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_NUM_THREADS
+ *  @param  num_threads The number of threads (values below 1 are treated as 1)
+ */
+void
+vrna_md_defaults_num_threads(int num_threads);
+
+
+/**
+ *  @brief  Get the default number of threads used within a single DP matrix fill
+ *  @see vrna_md_defaults_num_threads(), vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_NUM_THREADS
+ *  @return The global default settings for the number of threads
+ */
+int
+vrna_md_defaults_num_threads_get(void);
+
+
+/**
+ *  @brief  Set the default minimum sequence length for multi-threaded base pair probability computation
+ *  @see vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_BPP_MT_LENGTH
+ *  @param  length  The minimum sequence length (values below 1 deactivate automatic multi-threading)
+ */
+void
+vrna_md_defaults_bpp_mt_length(int length);
+
+
+/**
+ *  @brief  Get the default minimum sequence length for multi-threaded base pair probability computation
+ *  @see vrna_md_defaults_bpp_mt_length(), vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_BPP_MT_LENGTH
+ *  @return The global default settings for the minimum sequence length
+ */
+int
+vrna_md_defaults_bpp_mt_length_get(void);
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 #define model_detailsT        vrna_md_t               /* restore compatibility of struct rename */
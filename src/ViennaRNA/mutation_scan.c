@@ -0,0 +1,461 @@
+/*
+ *                Scan all single point mutants of an RNA sequence
+ *
+ *                Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/datastructures/basic.h"
+#include "ViennaRNA/model.h"
+#include "ViennaRNA/alphabet.h"
+#include "ViennaRNA/fold_compound.h"
+#include "ViennaRNA/constraints/hard.h"
+#include "ViennaRNA/mfe.h"
+#include "ViennaRNA/part_func.h"
+#include "ViennaRNA/gquad.h"
+#include "ViennaRNA/mutation_scan.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/wavefront.inc"
+
+#define SCAN_NUCLEOTIDES  "ACGU"
+#define SCAN_VARIANTS     3
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+
+/* the MFE DP matrices of the wild type each worker restores after a position is done */
+struct wildtype {
+  char          *sequence;
+  unsigned int  size;
+  int           *c;
+  int           *fML;
+  int           *fM1;
+};
+
+struct data_collector {
+  vrna_mutant_t *data;
+  unsigned int  num_entries;
+  unsigned int  allocated_memory;
+  unsigned int  length;
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+
+PRIVATE vrna_fold_compound_t *
+get_worker(const char   *sequence,
+           vrna_md_t    *md_p,
+           unsigned int options);
+
+
+PRIVATE struct wildtype *
+get_wildtype(vrna_fold_compound_t *fc);
+
+
+PRIVATE void
+free_wildtype(struct wildtype *wt);
+
+
+PRIVATE void
+restore_wildtype(vrna_fold_compound_t *fc,
+                 struct wildtype      *wt);
+
+
+PRIVATE unsigned int
+scan_position(vrna_fold_compound_t  *fc,
+              unsigned int          i,
+              unsigned int          options,
+              vrna_mutant_t         *mutants);
+
+
+PRIVATE void
+unpaired_probabilities(vrna_fold_compound_t *fc,
+                       FLT_OR_DBL           *p_u);
+
+
+PRIVATE void
+store_mutant_cb(const vrna_mutant_t *mutant,
+                void                *data);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_mutant_t *
+vrna_mutation_scan(vrna_fold_compound_t *fc,
+                   unsigned int         options)
+{
+  vrna_mutant_t         *results = NULL;
+  struct data_collector d;
+
+  if (fc) {
+    d.num_entries       = 0;
+    d.allocated_memory  = 4 * fc->length + 1;
+    d.length            = fc->length;
+    d.data              = (vrna_mutant_t *)vrna_alloc(sizeof(vrna_mutant_t) * d.allocated_memory);
+
+    if (vrna_mutation_scan_cb(fc, options, &store_mutant_cb, (void *)&d) == 0) {
+      free(d.data);
+      return NULL;
+    }
+
+    results = (vrna_mutant_t *)vrna_realloc(d.data,
+                                            sizeof(vrna_mutant_t) *
+                                            (d.num_entries + 1));
+    memset(results + d.num_entries, 0, sizeof(vrna_mutant_t));
+  }
+
+  return results;
+}
+
+
+PUBLIC unsigned int
+vrna_mutation_scan_cb(vrna_fold_compound_t        *fc,
+                      unsigned int                options,
+                      vrna_mutation_scan_callback *cb,
+                      void                        *data)
+{
+  unsigned int          n, t, k, num, num_threads, *counts;
+  int                   i;
+  vrna_md_t             md;
+  vrna_mutant_t         **mutants;
+  vrna_fold_compound_t  **workers;
+  struct wildtype       *wt;
+
+  if ((!fc) || (!cb))
+    return 0;
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands != 1) ||
+      ((fc->hc) && ((fc->hc->type == VRNA_HC_WINDOW) || (fc->hc->depot) || (fc->hc->f))) ||
+      (fc->sc) ||
+      (fc->domains_up) ||
+      (fc->aux_grammar)) {
+    vrna_message_warning("vrna_mutation_scan_cb@mutation_scan.c: "
+                         "Point mutation scans are only available for single, unconstrained sequences");
+    return 0;
+  }
+
+  if (options & VRNA_MUTATION_SCAN_ACCESSIBILITY)
+    options |= VRNA_MUTATION_SCAN_PF;
+
+  n           = fc->length;
+  md          = fc->params->model_details;
+  num_threads = wavefront_threads(fc, &md);
+
+  /* we parallelize over positions, so each worker fills its DP matrices sequentially */
+  md.num_threads  = 1;
+  md.compute_bpp  = (options & VRNA_MUTATION_SCAN_ACCESSIBILITY) ? 1 : 0;
+  if (md.compute_bpp)
+    md.backtrack = 1;
+
+  workers = (vrna_fold_compound_t **)vrna_alloc(sizeof(vrna_fold_compound_t *) * num_threads);
+  mutants = (vrna_mutant_t **)vrna_alloc(sizeof(vrna_mutant_t *) * num_threads);
+  counts  = (unsigned int *)vrna_alloc(sizeof(unsigned int) * num_threads);
+
+  for (t = 0; t < num_threads; t++) {
+    workers[t]  = get_worker(fc->sequence, &md, options);
+    mutants[t]  = (vrna_mutant_t *)vrna_alloc(sizeof(vrna_mutant_t) * SCAN_VARIANTS);
+
+    if (options & VRNA_MUTATION_SCAN_ACCESSIBILITY)
+      for (k = 0; k < SCAN_VARIANTS; k++)
+        mutants[t][k].accessibility = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
+  }
+
+  /* fill the wild type DP matrices only once and distribute them among all workers */
+  (void)vrna_mfe(workers[0], NULL);
+  wt = get_wildtype(workers[0]);
+
+  for (t = 1; t < num_threads; t++)
+    restore_wildtype(workers[t], wt);
+
+  num = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for ordered schedule(dynamic, 1) num_threads(num_threads) private(t, k)
+#endif
+  for (i = 1; i <= (int)n; i++) {
+#ifdef _OPENMP
+    t = omp_get_thread_num();
+#else
+    t = 0;
+#endif
+
+    counts[t] = scan_position(workers[t], (unsigned int)i, options, mutants[t]);
+
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+    {
+      for (k = 0; k < counts[t]; k++)
+        cb(&(mutants[t][k]), data);
+
+      num += counts[t];
+    }
+
+    restore_wildtype(workers[t], wt);
+  }
+
+  for (t = 0; t < num_threads; t++) {
+    for (k = 0; k < SCAN_VARIANTS; k++)
+      free(mutants[t][k].accessibility);
+
+    free(mutants[t]);
+    vrna_fold_compound_free(workers[t]);
+  }
+
+  free_wildtype(wt);
+  free(counts);
+  free(mutants);
+  free(workers);
+
+  return num;
+}
+
+
+PUBLIC void
+vrna_mutation_scan_free(vrna_mutant_t *mutants)
+{
+  vrna_mutant_t *ptr;
+
+  if (mutants) {
+    for (ptr = mutants; ptr->i != 0; ptr++)
+      free(ptr->accessibility);
+
+    free(mutants);
+  }
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE vrna_fold_compound_t *
+get_worker(const char   *sequence,
+           vrna_md_t    *md_p,
+           unsigned int options)
+{
+  unsigned int fc_options = VRNA_OPTION_MFE;
+
+  if (options & VRNA_MUTATION_SCAN_PF)
+    fc_options |= VRNA_OPTION_PF;
+
+  return vrna_fold_compound(sequence, md_p, fc_options);
+}
+
+
+PRIVATE struct wildtype *
+get_wildtype(vrna_fold_compound_t *fc)
+{
+  struct wildtype *wt;
+
+  wt            = (struct wildtype *)vrna_alloc(sizeof(struct wildtype));
+  wt->sequence  = strdup(fc->sequence);
+  wt->size      = fc->jindx[fc->length] + fc->length + 1;
+  wt->c         = (int *)vrna_alloc(sizeof(int) * wt->size);
+  wt->fML       = (int *)vrna_alloc(sizeof(int) * wt->size);
+  wt->fM1       = NULL;
+
+  memcpy(wt->c, fc->matrices->c, sizeof(int) * wt->size);
+  memcpy(wt->fML, fc->matrices->fML, sizeof(int) * wt->size);
+
+  if (fc->matrices->fM1) {
+    wt->fM1 = (int *)vrna_alloc(sizeof(int) * wt->size);
+    memcpy(wt->fM1, fc->matrices->fM1, sizeof(int) * wt->size);
+  }
+
+  return wt;
+}
+
+
+PRIVATE void
+free_wildtype(struct wildtype *wt)
+{
+  free(wt->sequence);
+  free(wt->c);
+  free(wt->fML);
+  free(wt->fM1);
+  free(wt);
+}
+
+
+PRIVATE void
+restore_wildtype(vrna_fold_compound_t *fc,
+                 struct wildtype      *wt)
+{
+  if (strcmp(fc->sequence, wt->sequence))
+    (void)vrna_fold_compound_rebind(fc, wt->sequence);
+
+  memcpy(fc->matrices->c, wt->c, sizeof(int) * wt->size);
+  memcpy(fc->matrices->fML, wt->fML, sizeof(int) * wt->size);
+
+  if (wt->fM1)
+    memcpy(fc->matrices->fM1, wt->fM1, sizeof(int) * wt->size);
+}
+
+
+/*
+ *  Process all mutants at position i. Consecutive mutations of the same
+ *  position replace each other, so the DP matrices only need to be reset
+ *  to the wild type once all of them are done
+ */
+PRIVATE unsigned int
+scan_position(vrna_fold_compound_t  *fc,
+              unsigned int          i,
+              unsigned int          options,
+              vrna_mutant_t         *mutants)
+{
+  char          wt, *nt;
+  unsigned int  num;
+  double        mfe;
+
+  wt  = toupper(fc->sequence[i - 1]);
+  wt  = (wt == 'T') ? 'U' : wt;
+  num = 0;
+
+  /* ambiguous nucleotides have no well-defined set of variants */
+  if (!strchr(SCAN_NUCLEOTIDES, wt))
+    return 0;
+
+  for (nt = SCAN_NUCLEOTIDES; *nt; nt++) {
+    if (*nt == wt)
+      continue;
+
+    mutants[num].i                = i;
+    mutants[num].nucleotide       = *nt;
+    mutants[num].mfe              = vrna_mfe_mutate(fc, i, *nt, NULL);
+    mutants[num].ensemble_energy  = (float)(INF / 100.);
+
+    if (options & VRNA_MUTATION_SCAN_PF) {
+      mfe = (double)mutants[num].mfe;
+      vrna_exp_params_rescale(fc, &mfe);
+      mutants[num].ensemble_energy = vrna_pf(fc, NULL);
+
+      if (options & VRNA_MUTATION_SCAN_ACCESSIBILITY)
+        unpaired_probabilities(fc, mutants[num].accessibility);
+    }
+
+    num++;
+  }
+
+  return num;
+}
+
+
+PRIVATE void
+unpaired_probabilities(vrna_fold_compound_t *fc,
+                       FLT_OR_DBL           *p_u)
+{
+  short         *S;
+  unsigned int  i, j, j_max, n, span;
+  int           *iindx, gquad;
+  FLT_OR_DBL    p, p_row, *probs;
+  vrna_ep_t     *inner, *ptr;
+
+  n     = fc->length;
+  S     = fc->sequence_encoding2;
+  iindx = fc->iindx;
+  probs = fc->exp_matrices->probs;
+  gquad = fc->exp_params->model_details.gquad;
+  span  = (unsigned int)fc->exp_params->model_details.max_bp_span;
+
+  for (i = 1; i <= n; i++)
+    p_u[i] = 1.;
+
+  /*
+   *  Each row of the pair probability matrix is traversed only once, where the
+   *  row sum is subtracted from i and the single entries from their partners j
+   */
+  for (i = 1; i < n; i++) {
+    j_max = MIN2(n, i + span);
+    p_row = 0.;
+
+    for (j = i + 1; j <= j_max; j++) {
+      p = probs[iindx[i] - j];
+
+      if (p <= 0.)
+        continue;
+
+      if ((gquad) && (S[i] == 3) && (S[j] == 3)) {
+        /*
+         *  G-Quadruplexes store their probabilities in the (non-canonical) G-G entry
+         *  that delimits them. Each G within a quadruplex takes part in two of the
+         *  G-G interactions we obtain for it, one per neighboring layer
+         */
+        inner = vrna_get_plist_gquad_from_pr(fc, (int)i, (int)j);
+        for (ptr = inner; ptr->i != 0; ptr++) {
+          p_u[ptr->i] -= ptr->p / 2.;
+          p_u[ptr->j] -= ptr->p / 2.;
+        }
+        free(inner);
+      } else {
+        p_row   += p;
+        p_u[j]  -= p;
+      }
+    }
+
+    p_u[i] -= p_row;
+  }
+
+  for (i = 1; i <= n; i++)
+    if (p_u[i] < 0.)
+      p_u[i] = 0.;
+}
+
+
+PRIVATE void
+store_mutant_cb(const vrna_mutant_t *mutant,
+                void                *data)
+{
+  struct data_collector *d = (struct data_collector *)data;
+
+  if (d->num_entries == d->allocated_memory) {
+    d->allocated_memory *= 1.2;
+    d->data             = (vrna_mutant_t *)vrna_realloc(d->data,
+                                                        sizeof(vrna_mutant_t) *
+                                                        d->allocated_memory);
+  }
+
+  d->data[d->num_entries] = *mutant;
+
+  if (mutant->accessibility) {
+    d->data[d->num_entries].accessibility =
+      (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (d->length + 1));
+    memcpy(d->data[d->num_entries].accessibility,
+           mutant->accessibility,
+           sizeof(FLT_OR_DBL) * (d->length + 1));
+  }
+
+  d->num_entries++;
+}
@@ -0,0 +1,161 @@
+#ifndef VIENNA_RNA_PACKAGE_MUTATION_SCAN_H
+#define VIENNA_RNA_PACKAGE_MUTATION_SCAN_H
+
+#include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/fold_compound.h>
+
+/**
+ *
+ *  @file mutation_scan.h
+ *  @ingroup  mutation_scan
+ *
+ *  @brief Compute MFE, ensemble free energy, and accessibility for all single point mutants of an RNA
+ */
+
+/**
+ *  @addtogroup  mutation_scan
+ *  @{
+ *
+ *  @brief  Predict thermodynamic properties for each single point mutant of a sequence
+ *
+ *  A full saturation mutagenesis of an RNA sequence of length @f$n@f$ yields @f$3n@f$
+ *  single nucleotide variants. Instead of predicting each of them from scratch, the
+ *  functions below re-use everything that does not depend on the mutated position.
+ *  Energy parameters and DP matrices are prepared once per thread, and the MFE DP
+ *  matrices of the wild type are updated incrementally via vrna_mfe_mutate() for
+ *  each variant. Hence, only those entries whose sequence interval covers the mutated
+ *  position are re-computed, while all prefix and suffix sub-solutions are shared.
+ *
+ *  If #vrna_md_t.num_threads of the fold compound is larger than 1, the positions
+ *  are distributed among multiple threads.
+ */
+
+
+/**
+ *  @brief  Option flag to compute the MFE of all mutants only
+ *
+ *  @see vrna_mutation_scan(), vrna_mutation_scan_cb()
+ */
+#define VRNA_MUTATION_SCAN_DEFAULT        0U
+
+/**
+ *  @brief  Option flag to additionally compute the ensemble free energy of all mutants
+ *
+ *  @see vrna_mutation_scan(), vrna_mutation_scan_cb()
+ */
+#define VRNA_MUTATION_SCAN_PF             1U
+
+/**
+ *  @brief  Option flag to additionally compute the accessibility, i.e. the probability to be unpaired, of each nucleotide in all mutants
+ *
+ *  This option implies #VRNA_MUTATION_SCAN_PF.
+ *
+ *  @see vrna_mutation_scan(), vrna_mutation_scan_cb()
+ */
+#define VRNA_MUTATION_SCAN_ACCESSIBILITY  2U
+
+
+/**
+ *  @brief  A single result of a point mutation scan
+ *
+ *  This is a convenience typedef for #vrna_mutant_s, i.e. results as obtained from vrna_mutation_scan()
+ */
+typedef struct vrna_mutant_s vrna_mutant_t;
+
+
+/**
+ *  @brief  A single result of a point mutation scan
+ *
+ *  @see vrna_mutation_scan(), vrna_mutation_scan_cb()
+ */
+struct vrna_mutant_s {
+  unsigned int  i;                /**< @brief   The mutated position (1-based) */
+  char          nucleotide;       /**< @brief   The nucleotide at position @p i of the mutant */
+  float         mfe;              /**< @brief   The minimum free energy of the mutant in kcal/mol */
+  float         ensemble_energy;  /**< @brief   The ensemble free energy of the mutant in kcal/mol (only with #VRNA_MUTATION_SCAN_PF) */
+  FLT_OR_DBL    *accessibility;   /**< @brief   1-based array of probabilities to be unpaired for each nucleotide (only with #VRNA_MUTATION_SCAN_ACCESSIBILITY, @p NULL otherwise) */
+};
+
+
+/**
+ *  @brief  The callback for point mutation scans
+ *
+ *  @callback
+ *  @parblock
+ *  This function will be called once for each mutant. Mutants are reported sorted by
+ *  position, and within each position in alphabetical order of the nucleotides.
+ *  Even for multi-threaded scans, the callback is never executed concurrently.
+ *  Any memory the @p mutant refers to is only valid throughout the callback execution.
+ *  @endparblock
+ *  @see vrna_mutation_scan_cb()
+ *
+ *  @param mutant The mutant and its predicted properties
+ *  @param data   Some arbitrary data pointer passed through by the function executing the callback
+ */
+typedef void (vrna_mutation_scan_callback)(const vrna_mutant_t  *mutant,
+                                           void                 *data);
+
+
+/**
+ *  @brief  Predict MFE, and optionally ensemble free energy and accessibility, for all single point mutants
+ *
+ *  This function scans all single nucleotide variants of the sequence bound to @p fc and
+ *  returns a list of results sorted by position and nucleotide. The energies are identical
+ *  to those obtained with vrna_mfe() and vrna_pf() for a #vrna_fold_compound_t of the
+ *  mutant sequence and the same model settings. The fold compound itself is left unchanged.
+ *
+ *  @note This function only accepts #vrna_fold_compound_t of type #VRNA_FC_TYPE_SINGLE
+ *        for a single strand without any constraints, unstructured domains, or
+ *        auxiliary grammar extensions. Positions of ambiguous nucleotides, e.g. @p N,
+ *        are not scanned.
+ *
+ *  @see  vrna_mutation_scan_cb(), vrna_mutation_scan_free(), vrna_mfe_mutate(),
+ *        #VRNA_MUTATION_SCAN_DEFAULT, #VRNA_MUTATION_SCAN_PF, #VRNA_MUTATION_SCAN_ACCESSIBILITY
+ *
+ *  @param  fc      The #vrna_fold_compound_t with the wild type RNA sequence
+ *  @param  options Option flags to select the properties to compute
+ *  @return         A list of mutants, or @em NULL upon any failure. The last entry of the list
+ *                  is indicated by a position @b i of 0
+ */
+vrna_mutant_t *
+vrna_mutation_scan(vrna_fold_compound_t *fc,
+                   unsigned int         options);
+
+
+/**
+ *  @brief  Predict MFE, and optionally ensemble free energy and accessibility, for all single point mutants (callback variant)
+ *
+ *  Similar to vrna_mutation_scan(), but passes the result of each mutant to the callback
+ *  function @p cb along with the arbitrary data as provided through the @p data pointer argument.
+ *
+ *  @see  vrna_mutation_scan(), vrna_mutation_scan_callback
+ *
+ *  @param  fc      The #vrna_fold_compound_t with the wild type RNA sequence
+ *  @param  options Option flags to select the properties to compute
+ *  @param  cb      The user-defined callback function that receives the individual results
+ *  @param  data    An arbitrary data structure that will be passed to the callback in conjunction with the results
+ *  @return         The number of mutants processed, or 0 upon failure
+ */
+unsigned int
+vrna_mutation_scan_cb(vrna_fold_compound_t        *fc,
+                      unsigned int                options,
+                      vrna_mutation_scan_callback *cb,
+                      void                        *data);
+
+
+/**
+ *  @brief  Release memory occupied by a list of mutants
+ *
+ *  @see vrna_mutation_scan()
+ *
+ *  @param  mutants The list of mutants as obtained from vrna_mutation_scan()
+ */
+void
+vrna_mutation_scan_free(vrna_mutant_t *mutants);
+
+
+/**
+ * @}
+ */
+
+#endif
@@ -245,6 +245,129 @@ vrna_exp_param_t *
 vrna_exp_params_copy(vrna_exp_param_t *par);
 
 
+/**
+ *  @brief  Get a shared, immutable set of prescaled free energy parameters
+ *
+ *  Parameter sets obtained through this function are reference counted and shared
+ *  among all callers that request the same model details. Since the energy tables
+ *  do not depend on the sequence length, the attributes #vrna_md_t.window_size and
+ *  #vrna_md_t.max_bp_span are ignored for the look-up. The most recently used sets
+ *  are additionally kept in a small cache, such that vrna_params() merely copies
+ *  the pre-computed tables instead of re-computing them.
+ *
+ *  This function is thread-safe. Every set obtained must be handed back with
+ *  vrna_params_shared_release(), and must never be modified.
+ *
+ *  @see vrna_params_shared_release(), vrna_exp_params_shared(), vrna_params_shared_clear()
+ *
+ *  @param  md  A pointer to the model details (Maybe NULL)
+ *  @return     A pointer to the shared free energy parameters
+ */
+const vrna_param_t *
+vrna_params_shared(vrna_md_t *md);
+
+
+/**
+ *  @brief  Release a reference to a shared set of free energy parameters
+ *
+ *  @see vrna_params_shared()
+ *
+ *  @param  P   The shared parameter set obtained from vrna_params_shared()
+ */
+void
+vrna_params_shared_release(const vrna_param_t *P);
+
+
+/**
+ *  @brief  Get a shared, immutable set of Boltzmann factors
+ *
+ *  This is the Boltzmann factor counterpart of vrna_params_shared(). Note, that
+ *  the scaling factor #vrna_exp_param_t.pf_scale of shared sets is always unset.
+ *
+ *  @see vrna_exp_params_shared_release(), vrna_params_shared(), vrna_params_shared_clear()
+ *
+ *  @param  md  A pointer to the model details (Maybe NULL)
+ *  @return     A pointer to the shared Boltzmann factors
+ */
+const vrna_exp_param_t *
+vrna_exp_params_shared(vrna_md_t *md);
+
+
+/**
+ *  @brief  Release a reference to a shared set of Boltzmann factors
+ *
+ *  @see vrna_exp_params_shared()
+ *
+ *  @param  P   The shared parameter set obtained from vrna_exp_params_shared()
+ */
+void
+vrna_exp_params_shared_release(const vrna_exp_param_t *P);
+
+
+/**
+ *  @brief  Clear the cache of shared energy parameter sets
+ *
+ *  Shared parameter sets that are still referenced stay valid until their last
+ *  reference is released, but will not be handed out again. This function is
+ *  called automatically whenever a new energy parameter set is loaded. It only
+ *  needs to be called explicitly if the global energy parameter tables have been
+ *  modified directly.
+ *
+ *  @see vrna_params_shared(), vrna_exp_params_shared(), vrna_params_load()
+ */
+void
+vrna_params_shared_clear(void);
+
+
+/**
+ *  @brief  Let a #vrna_fold_compound_t use the shared free energy parameters for its model details
+ *
+ *  The private free energy parameters of @p fc are replaced by the shared set with identical
+ *  model details, including the length dependent settings, or become such a shared set
+ *  themselves. This is never done automatically, i.e. the energy parameters of a newly
+ *  constructed #vrna_fold_compound_t are always private. Opt in only if the parameters of
+ *  @p fc will not be modified in place, or call vrna_params_unshare() before doing so.
+ *
+ *  @see vrna_params_unshare(), vrna_params_free()
+ *
+ *  @param  fc  The fold compound
+ */
+void
+vrna_params_share(vrna_fold_compound_t *fc);
+
+
+/**
+ *  @brief  Obtain private, modifiable free energy parameters for a #vrna_fold_compound_t
+ *
+ *  Once a fold compound shares its free energy parameters with other fold compounds
+ *  of identical model details, see vrna_params_share(), #vrna_fold_compound_t.params
+ *  must not be modified in place, e.g. to temporarily change the model details. Call
+ *  this function first to replace a shared set by a private copy. For fold compounds
+ *  with private parameters, this function does nothing.
+ *
+ *  @see vrna_params_share(), vrna_params_free()
+ *
+ *  @param  fc  The fold compound
+ *  @return     The private free energy parameters of @p fc
+ */
+vrna_param_t *
+vrna_params_unshare(vrna_fold_compound_t *fc);
+
+
+/**
+ *  @brief  Free memory occupied by a set of free energy parameters
+ *
+ *  For shared sets, e.g. those attached to a #vrna_fold_compound_t, this merely
+ *  releases the reference. Any other set is freed.
+ *
+ *  @see vrna_params_share(), vrna_params_unshare()
+ *
+ *  @param  P   The free energy parameters to free
+ */
+void
+vrna_params_free(vrna_param_t *P);
+
+
 /**
  *  @brief  Update/Reset energy parameters data structure within a #vrna_fold_compound_t
  *
@@ -19,6 +19,7 @@
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/params/constants.h"
 #include "ViennaRNA/params/default.h"
+#include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/static/energy_parameter_sets.h"
 
@@ -674,6 +675,10 @@ set_parameters_from_string(char       **file_content,
   }
 
   check_symmetry();
+
+  /* previously computed parameter sets are outdated now */
+  vrna_params_shared_clear();
+
   return 1;
 }
 
@@ -13,6 +13,11 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+
+#if VRNA_WITH_PTHREADS
+# include <pthread.h>
+#endif
+
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/utils/basic.h"
@@ -29,6 +34,9 @@
 
 /*------------------------------------------------------------------------*/
 #define SCALE 10
+
+/* number of unreferenced parameter sets kept alive for later re-use */
+#define SHARED_PARAMS_CACHE_SIZE  8
 /**
  *** dangling ends should never be destabilizing, i.e. expdangle>=1<BR>
  *** specific heat needs smooth function (2nd derivative)<BR>
@@ -96,6 +104,35 @@ PRIVATE int               pf_id = -1;
 #pragma omp threadprivate(id, pf_id)
 #endif
 
+typedef enum {
+  SHARED_PARAMS_ENERGY,
+  SHARED_PARAMS_BOLTZMANN,
+  SHARED_PARAMS_BOLTZMANN_COMPARATIVE
+} shared_params_type;
+
+/*
+ *  Reference counted, immutable parameter sets. Each set is shared by
+ *  all requests for the same model details and parameter type. The most
+ *  recently used sets are additionally held by the cache itself, such
+ *  that they survive short periods without any other reference.
+ */
+struct shared_params {
+  shared_params_type    type;
+  unsigned int          n_seq;
+  vrna_md_t             md;       /* model details the set has been created for */
+  unsigned int          refs;
+  int                   cached;   /* whether the cache itself holds a reference */
+  int                   valid;    /* whether the set may still be handed out */
+  void                  *data;
+  struct shared_params  *next;
+};
+
+PRIVATE struct shared_params  *shared_list = NULL; /* ordered by most recent use */
+
+#if VRNA_WITH_PTHREADS
+PRIVATE pthread_mutex_t       shared_mtx = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -121,6 +158,32 @@ PRIVATE void
 rescale_params(vrna_fold_compound_t *vc);
 
 
+PRIVATE int
+md_equal(const vrna_md_t  *a,
+         const vrna_md_t  *b,
+         int              length_dependent);
+
+
+PRIVATE void *
+shared_params_get(shared_params_type  type,
+                  unsigned int        n_seq,
+                  vrna_md_t           *md,
+                  int                 length_dependent,
+                  void                *data);
+
+
+PRIVATE int
+shared_params_contains(const void *data);
+
+
+PRIVATE int
+shared_params_release(const void *data);
+
+
+PRIVATE void
+shared_params_free(struct shared_params *entry);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -129,26 +192,46 @@ rescale_params(vrna_fold_compound_t *vc);
 PUBLIC vrna_param_t *
 vrna_params(vrna_md_t *md)
 {
-  if (md) {
-    return get_scaled_params(md);
-  } else {
-    vrna_md_t md;
-    vrna_md_set_default(&md);
-    return get_scaled_params(&md);
+  const vrna_param_t  *shared;
+  vrna_param_t        *params;
+  vrna_md_t           md_default;
+
+  if (!md) {
+    vrna_md_set_default(&md_default);
+    md = &md_default;
   }
+
+  /* copy the pre-computed tables from the shared parameter set */
+  shared                = vrna_params_shared(md);
+  params                = vrna_params_copy((vrna_param_t *)shared);
+  params->model_details = *md;
+  params->id            = ++id;
+
+  vrna_params_shared_release(shared);
+
+  return params;
 }
 
 
 PUBLIC vrna_exp_param_t *
 vrna_exp_params(vrna_md_t *md)
 {
-  if (md) {
-    return get_scaled_exp_params(md, -1.);
-  } else {
-    vrna_md_t md;
-    vrna_md_set_default(&md);
-    return get_scaled_exp_params(&md, -1.);
+  const vrna_exp_param_t  *shared;
+  vrna_exp_param_t        *params;
+  vrna_md_t               md_default;
+
+  if (!md) {
+    vrna_md_set_default(&md_default);
+    md = &md_default;
   }
+
+  shared                = vrna_exp_params_shared(md);
+  params                = vrna_exp_params_copy((vrna_exp_param_t *)shared);
+  params->model_details = *md;
+
+  vrna_exp_params_shared_release(shared);
+
+  return params;
 }
 
 
@@ -156,13 +239,141 @@ PUBLIC vrna_exp_param_t *
 vrna_exp_params_comparative(unsigned int  n_seq,
                             vrna_md_t     *md)
 {
-  if (md) {
-    return get_exp_params_ali(md, n_seq, -1.);
-  } else {
-    vrna_md_t md;
-    vrna_md_set_default(&md);
-    return get_exp_params_ali(&md, n_seq, -1.);
+  vrna_exp_param_t  *shared, *params;
+  vrna_md_t         md_default;
+
+  if (!md) {
+    vrna_md_set_default(&md_default);
+    md = &md_default;
+  }
+
+  shared = (vrna_exp_param_t *)shared_params_get(SHARED_PARAMS_BOLTZMANN_COMPARATIVE,
+                                                 n_seq,
+                                                 md,
+                                                 0,
+                                                 NULL);
+  params                = vrna_exp_params_copy(shared);
+  params->model_details = *md;
+
+  shared_params_release(shared);
+
+  return params;
+}
+
+
+PUBLIC const vrna_param_t *
+vrna_params_shared(vrna_md_t *md)
+{
+  vrna_md_t md_default;
+
+  if (!md) {
+    vrna_md_set_default(&md_default);
+    md = &md_default;
+  }
+
+  return (const vrna_param_t *)shared_params_get(SHARED_PARAMS_ENERGY, 1, md, 0, NULL);
+}
+
+
+PUBLIC const vrna_exp_param_t *
+vrna_exp_params_shared(vrna_md_t *md)
+{
+  vrna_md_t md_default;
+
+  if (!md) {
+    vrna_md_set_default(&md_default);
+    md = &md_default;
+  }
+
+  return (const vrna_exp_param_t *)shared_params_get(SHARED_PARAMS_BOLTZMANN, 1, md, 0, NULL);
+}
+
+
+PUBLIC void
+vrna_params_shared_release(const vrna_param_t *P)
+{
+  (void)shared_params_release((const void *)P);
+}
+
+
+PUBLIC void
+vrna_params_share(vrna_fold_compound_t *fc)
+{
+  if ((fc) &&
+      (fc->params) &&
+      (!shared_params_contains(fc->params))) {
+    /* hand over the private set, which is released if an identical one exists already */
+    fc->params = (vrna_param_t *)shared_params_get(SHARED_PARAMS_ENERGY,
+                                                   1,
+                                                   &(fc->params->model_details),
+                                                   1,
+                                                   fc->params);
+  }
+}
+
+
+PUBLIC vrna_param_t *
+vrna_params_unshare(vrna_fold_compound_t *fc)
+{
+  vrna_param_t *P;
+
+  if (!fc)
+    return NULL;
+
+  if ((fc->params) &&
+      (shared_params_contains(fc->params))) {
+    /* our own reference keeps the shared set alive while copying */
+    P = vrna_params_copy(fc->params);
+    (void)shared_params_release(fc->params);
+    fc->params = P;
+  }
+
+  return fc->params;
+}
+
+
+PUBLIC void
+vrna_params_free(vrna_param_t *P)
+{
+  if ((P) &&
+      (!shared_params_release((const void *)P)))
+    free(P);
+}
+
+
+PUBLIC void
+vrna_exp_params_shared_release(const vrna_exp_param_t *P)
+{
+  (void)shared_params_release((const void *)P);
+}
+
+
+PUBLIC void
+vrna_params_shared_clear(void)
+{
+  struct shared_params *entry, **ptr;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&shared_mtx);
+#endif
+
+  /* drop all references held by the cache */
+  ptr = &shared_list;
+  while ((entry = *ptr)) {
+    entry->cached = 0;
+    entry->valid  = 0;
+
+    if (entry->refs == 0) {
+      *ptr = entry->next;
+      shared_params_free(entry);
+    } else {
+      ptr = &(entry->next);
+    }
   }
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&shared_mtx);
+#endif
 }
 
 
@@ -199,8 +410,9 @@ vrna_params_subst(vrna_fold_compound_t  *vc,
                   vrna_param_t          *parameters)
 {
   if (vc) {
-    if (vc->params)
-      free(vc->params);
+    vrna_loop_cache_free(vc);
+
+    vrna_params_free(vc->params);
 
     if (parameters) {
       vc->params = vrna_params_copy(parameters);
@@ -229,8 +441,9 @@ vrna_params_reset(vrna_fold_compound_t  *vc,
       case VRNA_FC_TYPE_SINGLE:     /* fall through */
 
       case VRNA_FC_TYPE_COMPARATIVE:
-        if (vc->params)
-          free(vc->params);
+        vrna_loop_cache_free(vc);
+
+        vrna_params_free(vc->params);
 
         vc->params = vrna_params(md_p);
 
@@ -258,6 +471,8 @@ vrna_exp_params_reset(vrna_fold_compound_t  *vc,
       case VRNA_FC_TYPE_SINGLE:     /* fall through */
 
       case VRNA_FC_TYPE_COMPARATIVE:
+        vrna_loop_cache_free(vc);
+
         if (vc->exp_params)
           free(vc->exp_params);
 
@@ -276,6 +491,8 @@ vrna_exp_params_subst(vrna_fold_compound_t  *vc,
                       vrna_exp_param_t      *params)
 {
   if (vc) {
+    vrna_loop_cache_free(vc);
+
     if (vc->exp_params)
       free(vc->exp_params);
 
@@ -929,6 +1146,234 @@ get_exp_params_ali(vrna_md_t    *md,
 }
 
 
+PRIVATE int
+md_equal(const vrna_md_t  *a,
+         const vrna_md_t  *b,
+         int              length_dependent)
+{
+  /* compare field by field, since padding bytes and string tails are undefined */
+  if ((length_dependent) &&
+      ((a->max_bp_span != b->max_bp_span) ||
+       (a->window_size != b->window_size)))
+    return 0;
+
+  return (a->temperature == b->temperature) &&
+         (a->betaScale == b->betaScale) &&
+         (a->pf_smooth == b->pf_smooth) &&
+         (a->dangles == b->dangles) &&
+         (a->special_hp == b->special_hp) &&
+         (a->noLP == b->noLP) &&
+         (a->noGU == b->noGU) &&
+         (a->noGUclosure == b->noGUclosure) &&
+         (a->logML == b->logML) &&
+         (a->circ == b->circ) &&
+         (a->gquad == b->gquad) &&
+         (a->uniq_ML == b->uniq_ML) &&
+         (a->energy_set == b->energy_set) &&
+         (a->backtrack == b->backtrack) &&
+         (a->backtrack_type == b->backtrack_type) &&
+         (a->compute_bpp == b->compute_bpp) &&
+         (strncmp(a->nonstandards, b->nonstandards, sizeof(a->nonstandards)) == 0) &&
+         (a->min_loop_size == b->min_loop_size) &&
+         (a->oldAliEn == b->oldAliEn) &&
+         (a->ribo == b->ribo) &&
+         (a->cv_fact == b->cv_fact) &&
+         (a->nc_fact == b->nc_fact) &&
+         (a->sfact == b->sfact) &&
+         (a->num_threads == b->num_threads) &&
+         (a->bpp_mt_length == b->bpp_mt_length) &&
+         (memcmp(a->rtype, b->rtype, sizeof(a->rtype)) == 0) &&
+         (memcmp(a->alias, b->alias, sizeof(a->alias)) == 0) &&
+         (memcmp(a->pair, b->pair, sizeof(a->pair)) == 0);
+}
+
+
+/*
+ *  Get a reference to the shared parameter set for model details md. The
+ *  length dependent settings are only considered if length_dependent is
+ *  set, since the parameter tables themselves do not depend on them. If
+ *  data is provided, it is added as new shared set unless an identical
+ *  one exists already, in which case data is released.
+ */
+PRIVATE void *
+shared_params_get(shared_params_type  type,
+                  unsigned int        n_seq,
+                  vrna_md_t           *md,
+                  int                 length_dependent,
+                  void                *data)
+{
+  unsigned int          cached;
+  void                  *ret;
+  vrna_md_t             key;
+  struct shared_params  *entry, *prev, *tmp;
+
+  key = *md;
+
+  for (;;) {
+#if VRNA_WITH_PTHREADS
+    pthread_mutex_lock(&shared_mtx);
+#endif
+
+    for (prev = NULL, entry = shared_list; entry; prev = entry, entry = entry->next)
+      if ((entry->valid) &&
+          (entry->type == type) &&
+          (entry->n_seq == n_seq) &&
+          (md_equal(&(entry->md), &key, length_dependent)))
+        break;
+
+    if ((!entry) && (data)) {
+      /* add the freshly computed parameter set */
+      entry         = (struct shared_params *)vrna_alloc(sizeof(struct shared_params));
+      entry->type   = type;
+      entry->n_seq  = n_seq;
+      entry->md     = key;
+      entry->refs   = 0;
+      entry->cached = 1;
+      entry->valid  = 1;
+      entry->data   = data;
+      entry->next   = shared_list;
+      shared_list   = entry;
+      prev          = NULL;
+      data          = NULL;
+    }
+
+    if (entry) {
+      entry->refs++;
+      entry->cached = 1;
+      ret           = entry->data;
+
+      /* move to front of the list */
+      if (prev) {
+        prev->next  = entry->next;
+        entry->next = shared_list;
+        shared_list = entry;
+      }
+
+      /* release cache references of the least recently used sets */
+      cached = 0;
+      prev   = NULL;
+      tmp    = shared_list;
+      while (tmp) {
+        if ((tmp->cached) && (++cached > SHARED_PARAMS_CACHE_SIZE))
+          tmp->cached = 0;
+
+        if ((!tmp->cached) && (tmp->refs == 0)) {
+          if (prev)
+            prev->next = tmp->next;
+          else
+            shared_list = tmp->next;
+
+          entry = tmp;
+          tmp   = tmp->next;
+          shared_params_free(entry);
+        } else {
+          prev  = tmp;
+          tmp   = tmp->next;
+        }
+      }
+
+#if VRNA_WITH_PTHREADS
+      pthread_mutex_unlock(&shared_mtx);
+#endif
+
+      /* another thread may have been faster in computing the same set */
+      free(data);
+
+      return ret;
+    }
+
+#if VRNA_WITH_PTHREADS
+    pthread_mutex_unlock(&shared_mtx);
+#endif
+
+    /* compute the parameter set outside the critical section */
+    switch (type) {
+      case SHARED_PARAMS_ENERGY:
+        data = (void *)get_scaled_params(&key);
+        break;
+
+      case SHARED_PARAMS_BOLTZMANN:
+        data = (void *)get_scaled_exp_params(&key, -1.);
+        break;
+
+      case SHARED_PARAMS_BOLTZMANN_COMPARATIVE:
+        data = (void *)get_exp_params_ali(&key, n_seq, -1.);
+        break;
+    }
+  }
+}
+
+
+PRIVATE int
+shared_params_contains(const void *data)
+{
+  int                   ret;
+  struct shared_params  *entry;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&shared_mtx);
+#endif
+
+  for (entry = shared_list; entry; entry = entry->next)
+    if (entry->data == data)
+      break;
+
+  ret = (entry) ? 1 : 0;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&shared_mtx);
+#endif
+
+  return ret;
+}
+
+
+/* returns 0 if data is not a shared parameter set */
+PRIVATE int
+shared_params_release(const void *data)
+{
+  struct shared_params *entry, *prev;
+
+  if (!data)
+    return 0;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&shared_mtx);
+#endif
+
+  for (prev = NULL, entry = shared_list; entry; prev = entry, entry = entry->next)
+    if (entry->data == data)
+      break;
+
+  if ((entry) && (entry->refs > 0)) {
+    entry->refs--;
+
+    if ((entry->refs == 0) && (!entry->cached)) {
+      if (prev)
+        prev->next = entry->next;
+      else
+        shared_list = entry->next;
+
+      shared_params_free(entry);
+    }
+  }
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&shared_mtx);
+#endif
+
+  return (entry) ? 1 : 0;
+}
+
+
+PRIVATE void
+shared_params_free(struct shared_params *entry)
+{
+  free(entry->data);
+  free(entry);
+}
+
+
 PRIVATE void
 rescale_params(vrna_fold_compound_t *vc)
 {
@@ -18,6 +18,7 @@
 
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/default.h"
+#include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/loops/all.h"
 #include "ViennaRNA/gquad.h"
@@ -25,11 +26,30 @@
 #include "ViennaRNA/constraints/soft.h"
 #include "ViennaRNA/mfe.h"
 #include "ViennaRNA/part_func.h"
+#include "ViennaRNA/part_func_window.h"
 
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/wavefront.inc"
+
+/* maximum number of re-computations with adapted pf_scale upon over-/underflow */
+#define MAX_RESCALE_ATTEMPTS  10
+
+/* largest scaled partition function q[i,j] encountered while filling the DP matrices */
+struct q_max {
+  FLT_OR_DBL  q;
+  int         i;
+  int         j;
+};
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -48,7 +68,36 @@
  #################################
  */
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc);
+fill_arrays_rescaled(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+fill_arrays(vrna_fold_compound_t  *fc,
+            struct q_max          *Qmax);
+
+
+PRIVATE int
+adapt_pf_scale(vrna_fold_compound_t *fc,
+               int                  last_column);
+
+
+PRIVATE void
+fill_arrays_parallel(vrna_fold_compound_t *fc,
+                     vrna_mx_pf_aux_el_t  aux_mx_el,
+                     vrna_mx_pf_aux_ml_t  aux_mx_ml,
+                     int                  num_threads);
+
+
+PRIVATE INLINE int
+check_overflow(FLT_OR_DBL   q,
+               int          i,
+               int          j,
+               struct q_max *Qmax,
+               double       max_real);
+
+
+PRIVATE void
+warn_close_to_overflow(struct q_max *Qmax);
 
 
 PRIVATE void
@@ -81,6 +130,10 @@ vrna_pf(vrna_fold_compound_t  *fc,
   free_energy = (float)(INF / 100.);
 
   if (fc) {
+    /* sliding window fold compounds only provide banded DP matrices */
+    if ((fc->hc) && (fc->hc->type == VRNA_HC_WINDOW))
+      return vrna_pf_window_global(fc, structure, NULL, NULL);
+
     /* make sure, everything is set up properly to start partition function computations */
     if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_PF)) {
       vrna_message_warning("vrna_pf@part_func.c: Failed to prepare vrna_fold_compound");
@@ -111,7 +164,7 @@ vrna_pf(vrna_fold_compound_t  *fc,
     if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
       fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_PRE, fc->aux_grammar->data);
 
-    if (!fill_arrays(fc)) {
+    if (!fill_arrays_rescaled(fc)) {
 #ifdef SUN4
       standard_arithmetic();
 #elif defined(HP9)
@@ -231,7 +284,7 @@ vrna_pf_dimer(vrna_fold_compound_t  *fc,
   if (fc->stat_cb)
     fc->stat_cb(VRNA_STATUS_PF_PRE, fc->auxdata);
 
-  if (!fill_arrays(fc)) {
+  if (!fill_arrays_rescaled(fc)) {
     X.FA    = X.FB = X.FAB = X.F0AB = (float)(INF / 100.);
     X.FcAB  = 0;
 
@@ -338,12 +391,134 @@ vrna_pf_float_precision(void)
  # STATIC helper functions below #
  #################################
  */
+/*
+ *  Fill the DP matrices and, in case of numeric over- or underflow,
+ *  adapt the scaling factor pf_scale and start over. This way, no
+ *  prior MFE prediction is required to obtain a suitable scaling
+ *  factor for long or highly structured sequences. We give up as
+ *  soon as re-scaling does not push the numeric problem any further
+ *  and restore the initial scaling factor in that case
+ */
+PRIVATE int
+fill_arrays_rescaled(vrna_fold_compound_t *fc)
+{
+  int           attempt, n, filled, filled_initially, reached, last_reached;
+  double        min_real, pf_scale, q1n, last_q1n;
+  struct q_max  Qmax;
+
+  n                 = (int)fc->length;
+  min_real          = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MIN : DBL_MIN;
+  pf_scale          = fc->exp_params->pf_scale;
+  filled_initially  = 0;
+  last_reached      = 0;
+  last_q1n          = 0.;
+
+  for (attempt = 0; ; attempt++) {
+    filled  = fill_arrays(fc, &Qmax);
+    q1n     = 0.;
+
+    if (filled) {
+      /* check for underflow of the exterior partition function */
+      q1n = (double)fc->exp_matrices->q[fc->iindx[1] - n];
+      if (q1n >= min_real) {
+        /* only report the matrices we eventually keep, not those of previous attempts */
+        warn_close_to_overflow(&Qmax);
+        return 1;
+      }
+
+      reached = n + 1;
+    } else {
+      reached = Qmax.j;
+    }
+
+    if (attempt == 0)
+      filled_initially = filled;
+    else if ((reached < last_reached) ||
+             ((reached == last_reached) && (q1n <= last_q1n)))
+      break;  /* the previous re-scaling did not improve anything */
+
+    if ((attempt == MAX_RESCALE_ATTEMPTS) ||
+        (!adapt_pf_scale(fc, reached - 1)))
+      break;
+
+    last_reached  = reached;
+    last_q1n      = q1n;
+  }
+
+  /* restore the initial scaling factor */
+  if (fc->exp_params->pf_scale != pf_scale) {
+    fc->exp_params->pf_scale = pf_scale;
+    vrna_exp_params_rescale(fc, NULL);
+
+    /* DP matrices must correspond to the initial scaling factor again */
+    if (filled_initially)
+      filled = fill_arrays(fc, &Qmax);
+  }
+
+  warn_close_to_overflow(&Qmax);
+
+  if (!filled)
+    vrna_message_warning("overflow while computing partition function for segment q[%d,%d]\n"
+                         "use larger pf_scale", Qmax.i, Qmax.j);
+  else
+    vrna_message_warning("underflow while computing partition function\n"
+                         "use smaller pf_scale");
+
+  return filled;
+}
+
+
+/*
+ *  Estimate a new scaling factor from the longest prefix q[1,j], j <= last_column,
+ *  whose (scaled) partition function is still a normal floating point number,
+ *  such that the scaled partition function of the entire sequence becomes close to 1
+ */
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc)
+adapt_pf_scale(vrna_fold_compound_t *fc,
+               int                  last_column)
+{
+  int         j, *my_iindx;
+  FLT_OR_DBL  q1j, *q;
+  double      min_real, max_real, pf_scale;
+
+  my_iindx  = fc->iindx;
+  q         = fc->exp_matrices->q;
+  min_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MIN : DBL_MIN;
+  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  q1j       = 0.;
+
+  for (j = last_column; j > 0; j--) {
+    q1j = q[my_iindx[1] - j];
+    if ((q1j >= min_real) && (q1j < max_real))
+      break;
+  }
+
+  if (j == 0)
+    return 0;
+
+  pf_scale = fc->exp_params->pf_scale * exp(log(q1j) / j);
+
+  /* unscaled partition functions never underflow */
+  if (pf_scale < 1.)
+    pf_scale = 1.;
+
+  if (pf_scale == fc->exp_params->pf_scale)
+    return 0;
+
+  fc->exp_params->pf_scale = pf_scale;
+  vrna_exp_params_rescale(fc, NULL);
+
+  return 1;
+}
+
+
+PRIVATE int
+fill_arrays(vrna_fold_compound_t  *fc,
+            struct q_max          *Qmax)
 {
   int                 n, i, j, k, ij, d, *my_iindx, *jindx, with_gquad, turn,
-                      with_ud;
-  FLT_OR_DBL          temp, Qmax, *q, *qb, *qm, *qm1, *q1k, *qln;
+                      with_ud, num_threads;
+  FLT_OR_DBL          temp, *q, *qb, *qm, *qm1, *q1k, *qln;
   double              max_real;
   vrna_ud_t           *domains_up;
   vrna_md_t           *md;
@@ -369,7 +544,9 @@ fill_arrays(vrna_fold_compound_t *fc)
   turn        = md->min_loop_size;
 
   with_ud = (domains_up && domains_up->exp_energy_cb && (!(fc->type == VRNA_FC_TYPE_COMPARATIVE)));
-  Qmax    = 0;
+  Qmax->q = 0.;
+  Qmax->i = 0;
+  Qmax->j = 0;
 
   max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
 
@@ -413,52 +590,60 @@ fill_arrays(vrna_fold_compound_t *fc)
       qb[ij]  = 0.0;
     }
 
-  for (j = turn + 2; j <= n; j++) {
-    for (i = j - turn - 1; i >= 1; i--) {
-      ij = my_iindx[i] - j;
+  num_threads = wavefront_threads(fc, md);
+
+  if (num_threads > 1) {
+    /* fill one column at a time, distributed over multiple threads */
+    fill_arrays_parallel(fc, aux_mx_el, aux_mx_ml, num_threads);
 
-      qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
+    /* check for overflows in the same order as the serial implementation does */
+    for (j = turn + 2; j <= n; j++)
+      for (i = j - turn - 1; i >= 1; i--)
+        if (!check_overflow(q[my_iindx[i] - j], i, j, Qmax, max_real)) {
+          vrna_exp_E_ml_fast_free(aux_mx_ml);
+          vrna_exp_E_ext_fast_free(aux_mx_el);
 
-      /* Multibranch loop */
-      qm[ij] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
+          return 0; /* failure */
+        }
+  } else {
+    for (j = turn + 2; j <= n; j++) {
+      for (i = j - turn - 1; i >= 1; i--) {
+        ij = my_iindx[i] - j;
 
-      if (qm1) {
-        temp = vrna_exp_E_ml_fast_qqm(aux_mx_ml)[i]; /* for stochastic backtracking and circfold */
+        qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
 
-        /* apply auxiliary grammar rule for multibranch loop (M1) case */
-        if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp_m1))
-          temp += fc->aux_grammar->cb_aux_exp_m1(fc, i, j, fc->aux_grammar->data);
+        /* Multibranch loop */
+        qm[ij] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
 
-        qm1[jindx[j] + i] = temp;
-      }
+        if (qm1) {
+          temp = vrna_exp_E_ml_fast_qqm(aux_mx_ml)[i]; /* for stochastic backtracking and circfold */
 
-      /* Exterior loop */
-      q[ij] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+          /* apply auxiliary grammar rule for multibranch loop (M1) case */
+          if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp_m1))
+            temp += fc->aux_grammar->cb_aux_exp_m1(fc, i, j, fc->aux_grammar->data);
 
-      /* apply auxiliary grammar rule (storage takes place in user-defined data structure */
-      if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp))
-        fc->aux_grammar->cb_aux_exp(fc, i, j, fc->aux_grammar->data);
+          qm1[jindx[j] + i] = temp;
+        }
 
-      if (q[ij] > Qmax) {
-        Qmax = q[ij];
-        if (Qmax > max_real / 10.)
-          vrna_message_warning("Q close to overflow: %d %d %g", i, j, q[ij]);
-      }
+        /* Exterior loop */
+        q[ij] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
 
-      if (q[ij] >= max_real) {
-        vrna_message_warning("overflow while computing partition function for segment q[%d,%d]\n"
-                             "use larger pf_scale", i, j);
+        /* apply auxiliary grammar rule (storage takes place in user-defined data structure */
+        if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp))
+          fc->aux_grammar->cb_aux_exp(fc, i, j, fc->aux_grammar->data);
 
-        vrna_exp_E_ml_fast_free(aux_mx_ml);
-        vrna_exp_E_ext_fast_free(aux_mx_el);
+        if (!check_overflow(q[ij], i, j, Qmax, max_real)) {
+          vrna_exp_E_ml_fast_free(aux_mx_ml);
+          vrna_exp_E_ext_fast_free(aux_mx_el);
 
-        return 0; /* failure */
+          return 0; /* failure */
+        }
       }
-    }
 
-    /* rotate auxiliary arrays */
-    vrna_exp_E_ext_fast_rotate(aux_mx_el);
-    vrna_exp_E_ml_fast_rotate(aux_mx_ml);
+      /* rotate auxiliary arrays */
+      vrna_exp_E_ext_fast_rotate(aux_mx_el);
+      vrna_exp_E_ml_fast_rotate(aux_mx_ml);
+    }
   }
 
   /* prefill linear qln, q1k arrays */
@@ -479,6 +664,136 @@ fill_arrays(vrna_fold_compound_t *fc)
 }
 
 
+/*
+ *  Keep track of the largest q[i,j] and report overflows. Since an
+ *  overflow always sets a new maximum, Qmax then points to the
+ *  offending cell. Warnings are issued by the caller, i.e. only for
+ *  the DP matrices that are actually kept
+ */
+PRIVATE INLINE int
+check_overflow(FLT_OR_DBL   q,
+               int          i,
+               int          j,
+               struct q_max *Qmax,
+               double       max_real)
+{
+  if (q > Qmax->q) {
+    Qmax->q = q;
+    Qmax->i = i;
+    Qmax->j = j;
+  }
+
+  if (q >= max_real)
+    return 0;
+
+  return 1;
+}
+
+
+PRIVATE void
+warn_close_to_overflow(struct q_max *Qmax)
+{
+  double max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+
+  if (Qmax->q > max_real / 10.)
+    vrna_message_warning("Q close to overflow: %d %d %g", Qmax->i, Qmax->j, Qmax->q);
+}
+
+
+/*
+ *  Fill the DP matrices qb, qm, qm1, and q column by column using
+ *  multiple threads.
+ *
+ *  Within a column j, the pair contributions qb[i,j] only depend on
+ *  previous columns and, thus, are distributed over all threads. The
+ *  multibranch and exterior loop parts qm[i,j] and q[i,j] on the other
+ *  hand depend on the auxiliary column of the very same j for all k > i,
+ *  so each of them is processed by a single thread, concurrently to the
+ *  other. This way, we get along with the O(n) auxiliary columns of the
+ *  serial implementation. Each cell is computed with exactly the same
+ *  sequence of operations as in the serial case, so the results are
+ *  identical.
+ *
+ *  Note, that only the qb part scales with num_threads. The qm and q parts
+ *  occupy at most 2 threads, while the remaining ones wait at the end of
+ *  the sections. Since both parts take O(n) time per cell, just like qb,
+ *  the overall speed-up is limited accordingly. A diagonal wavefront as
+ *  used for the MFE matrices would lift this limit, but requires O(n^2)
+ *  auxiliary arrays for the multibranch and exterior loop decompositions.
+ */
+PRIVATE void
+fill_arrays_parallel(vrna_fold_compound_t *fc,
+                     vrna_mx_pf_aux_el_t  aux_mx_el,
+                     vrna_mx_pf_aux_ml_t  aux_mx_ml,
+                     int                  num_threads)
+{
+  int           n, i, turn;
+  vrna_mx_pf_t  *matrices;
+
+  n         = (int)fc->length;
+  matrices  = fc->exp_matrices;
+  turn      = fc->exp_params->model_details.min_loop_size;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(num_threads) private(i)
+#endif
+  {
+    int         j, ij, *my_iindx, *jindx;
+    FLT_OR_DBL  *q, *qb, *qm, *qm1;
+
+    my_iindx  = fc->iindx;
+    jindx     = fc->jindx;
+    q         = matrices->q;
+    qb        = matrices->qb;
+    qm        = matrices->qm;
+    qm1       = matrices->qm1;
+
+    for (j = turn + 2; j <= n; j++) {
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (i = j - turn - 1; i >= 1; i--)
+        qb[my_iindx[i] - j] = decompose_pair(fc, i, j, aux_mx_ml);
+
+      /* implicit barrier at the end of the work-sharing loop */
+
+      /* qm and q of column j, one thread each, i.e. at most 2 threads are busy here */
+#ifdef _OPENMP
+#pragma omp sections
+#endif
+      {
+#ifdef _OPENMP
+#pragma omp section
+#endif
+        for (i = j - turn - 1; i >= 1; i--) {
+          ij      = my_iindx[i] - j;
+          qm[ij]  = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
+
+          if (qm1)
+            qm1[jindx[j] + i] = vrna_exp_E_ml_fast_qqm(aux_mx_ml)[i];
+        }
+
+#ifdef _OPENMP
+#pragma omp section
+#endif
+        for (i = j - turn - 1; i >= 1; i--) {
+          ij    = my_iindx[i] - j;
+          q[ij] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+        }
+      }
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+      {
+        vrna_exp_E_ext_fast_rotate(aux_mx_el);
+        vrna_exp_E_ml_fast_rotate(aux_mx_ml);
+      }
+    }
+  }
+}
+
+
 PRIVATE FLT_OR_DBL
 decompose_pair(vrna_fold_compound_t *fc,
                int                  i,
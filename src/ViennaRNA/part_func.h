@@ -127,9 +127,19 @@ struct vrna_dimer_pf_s {
  *        or numerical over-/underflow. In the latter case, a corresponding warning
  *        will be issued to @p stdout.
  *
+ *  @note Upon numerical over- or underflow, the scaling factor #vrna_exp_param_t.pf_scale
+ *        is adapted automatically and the partition function is re-computed. Hence, no
+ *        prior MFE prediction to estimate a suitable scaling factor is required. The
+ *        scaling factor eventually used is available through @p vc->exp_params->pf_scale
+ *        afterwards.
+ *
+ *  @note For a #vrna_fold_compound_t obtained with option #VRNA_OPTION_WINDOW, the
+ *        computations use banded DP matrices of width #vrna_md_t.window_size. See
+ *        vrna_pf_window_global() for details.
+ *
  *  @see #vrna_fold_compound_t, vrna_fold_compound(), vrna_pf_fold(), vrna_pf_circfold(),
  *        vrna_fold_compound_comparative(), vrna_pf_alifold(), vrna_pf_circalifold(),
- *        vrna_db_from_probs(), vrna_exp_params(), vrna_aln_pinfo()
+ *        vrna_db_from_probs(), vrna_exp_params(), vrna_aln_pinfo(), vrna_pf_window_global()
  *
  *  @param[in,out]  vc              The fold compound data structure
  *  @param[in,out]  structure       A pointer to the character array where position-wise pairing propensity
@@ -164,6 +174,46 @@ vrna_pf_dimer(vrna_fold_compound_t  *vc,
               char                  *structure);
 
 
+/**
+ *  @brief  Maximum sequence length for single precision partition function computations
+ *
+ *  @see  vrna_pf_float()
+ */
+#define VRNA_PF_FLOAT_MAX_LENGTH  500
+
+
+/**
+ *  @brief  Compute the ensemble free energy of a short RNA sequence in single precision
+ *
+ *  This function computes the same ensemble free energy as vrna_pf(), but uses
+ *  single precision floating point numbers for the dynamic programming matrices,
+ *  regardless of whether the library has been configured to use single or double
+ *  precision for #FLT_OR_DBL. This halves the memory requirements and speeds up
+ *  the computations, which makes it well suited for screening large numbers of
+ *  short sequences.
+ *
+ *  Single precision recursions are available for fold compounds of type
+ *  #VRNA_FC_TYPE_SINGLE with a sequence length of at most #VRNA_PF_FLOAT_MAX_LENGTH,
+ *  linear sequences, no G-Quadruplexes, and neither soft constraints, unstructured
+ *  domains, hard constraints callbacks, nor auxiliary grammar extensions. In any
+ *  other case, the function falls back to vrna_pf(). If the scaled partition
+ *  function leaves the range of single precision floating point numbers, the
+ *  same recursions are repeated in double precision, and vrna_pf() is only
+ *  used if that fails as well.
+ *
+ *  @note The single precision recursions neither fill the partition function
+ *        matrices of @p fc, nor compute base pair probabilities. Use vrna_pf()
+ *        if any subsequent post-processing is required.
+ *
+ *  @see  vrna_pf(), vrna_pf_float_precision(), #VRNA_PF_FLOAT_MAX_LENGTH
+ *
+ *  @param  fc  The fold compound data structure
+ *  @return     The ensemble free energy @f$G = -RT \cdot \log(Q) @f$ in kcal/mol
+ */
+float
+vrna_pf_float(vrna_fold_compound_t *fc);
+
+
 /* End basic global interface */
 /**@}*/
 
@@ -199,6 +249,31 @@ vrna_pf_fold(const char *sequence,
              vrna_ep_t  **pl);
 
 
+/**
+ *  @brief  Compute Partition functions @f$Q@f$ (and pairing propensities) for many RNA sequences
+ *
+ *  This simplified interface to vrna_pf() computes the ensemble free energy for each sequence
+ *  of a @p NULL terminated array of RNA sequences. A single #vrna_fold_compound_t is created and
+ *  re-used for all sequences via vrna_fold_compound_rebind(), such that energy parameters,
+ *  Boltzmann factors, and DP matrices are prepared only once. For each sequence, the scaling
+ *  factor is adapted to its MFE as in vrna_pf_fold().
+ *
+ *  If @p structures is not @p NULL, base pair probabilities are computed and each slot receives a
+ *  newly allocated string of position-wise pairing propensities that must be free'd by the caller.
+ *
+ *  @see vrna_pf_fold(), vrna_pf(), vrna_fold_compound_rebind(), vrna_fold_batch()
+ *
+ *  @param sequences  A @p NULL terminated array of RNA sequences
+ *  @param md_p       Model details to use for all predictions (Maybe @p NULL for defaults)
+ *  @param structures An array of pointers where the pairing propensities will be stored (Maybe @p NULL)
+ *  @return           An array of ensemble free energies in kcal/mol, one for each sequence (or @p NULL on error)
+ */
+float *
+vrna_pf_fold_batch(const char       **sequences,
+                   const vrna_md_t  *md_p,
+                   char             **structures);
+
+
 /**
  *  @brief  Compute Partition function @f$Q@f$ (and base pair probabilities) for a circular
  *          RNA sequences using a comparative method
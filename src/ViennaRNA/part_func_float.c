@@ -0,0 +1,158 @@
+/*
+ *  Single precision partition function of short RNA sequences
+ *
+ *  The recursions below evaluate the ensemble free energy with the
+ *  same decompositions as the default global partition function
+ *  (see part_func.c), but keep all DP matrices in single precision
+ *  floating point arithmetic, independent of the FLT_OR_DBL type
+ *  selected at configure time. This halves the memory required for
+ *  the DP matrices and doubles the number of Boltzmann factors that
+ *  are processed per SIMD instruction. Whenever the model settings
+ *  are not covered we fall back to vrna_pf(). If the scaled partition
+ *  functions leave the range of single precision floating point
+ *  numbers, we first repeat the computations with the same recursions
+ *  in double precision. Both variants are generated from the template
+ *  in part_func_float.inc.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/params/default.h"
+#include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/alphabet.h"
+#include "ViennaRNA/constraints/hard.h"
+#include "ViennaRNA/loops/all.h"
+#include "ViennaRNA/loops/cache.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
+#include "ViennaRNA/part_func.h"
+
+/* maximum number of re-computations with adapted scaling factor upon over-/underflow */
+#define MAX_RESCALE_ATTEMPTS  10
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE int
+float_pf_applicable(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+float_pf_prepare(vrna_fold_compound_t *fc);
+
+
+/* single precision recursions */
+#define PF_FLT            float
+#define PF_FLT_MIN        FLT_MIN
+#define PF_FLT_MAX        FLT_MAX
+#define PF_FUN(name)      float_ ## name
+#define PF_ZIP_MULT_SUM   vrna_fun_zip_mult_sum_float
+#include "ViennaRNA/part_func_float.inc"
+#undef PF_FLT
+#undef PF_FLT_MIN
+#undef PF_FLT_MAX
+#undef PF_FUN
+#undef PF_ZIP_MULT_SUM
+
+#ifndef USE_FLOAT_PF
+/* double precision recursions for scaled partition functions out of single precision range */
+#define PF_FLT            double
+#define PF_FLT_MIN        DBL_MIN
+#define PF_FLT_MAX        DBL_MAX
+#define PF_FUN(name)      double_ ## name
+#define PF_ZIP_MULT_SUM   vrna_fun_zip_mult_sum
+#include "ViennaRNA/part_func_float.inc"
+#undef PF_FLT
+#undef PF_FLT_MIN
+#undef PF_FLT_MAX
+#undef PF_FUN
+#undef PF_ZIP_MULT_SUM
+#endif
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC float
+vrna_pf_float(vrna_fold_compound_t *fc)
+{
+  double free_energy;
+
+  if (!fc)
+    return (float)(INF / 100.);
+
+  if ((!float_pf_applicable(fc)) ||
+      (!float_pf_prepare(fc)))
+    return vrna_pf(fc, NULL);
+
+  if (float_pf_energy(fc, &free_energy))
+    return (float)free_energy;
+
+#ifndef USE_FLOAT_PF
+  /* scaled partition function outside single precision range, use double precision instead */
+  if (double_pf_energy(fc, &free_energy))
+    return (float)free_energy;
+
+#endif
+
+  return vrna_pf(fc, NULL);
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE int
+float_pf_applicable(vrna_fold_compound_t *fc)
+{
+  vrna_md_t *md;
+
+  md = &(fc->params->model_details);
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands > 1) ||
+      (fc->length > VRNA_PF_FLOAT_MAX_LENGTH) ||
+      (fc->hc->type == VRNA_HC_WINDOW) ||
+      (fc->hc->f) ||
+      (fc->sc) ||
+      (fc->domains_up) ||
+      (fc->aux_grammar) ||
+      (md->circ) ||
+      (md->gquad) ||
+      (md->backtrack_type != 'F'))
+    return 0;
+
+  return 1;
+}
+
+
+/*
+ *  Set up everything vrna_fold_compound_prepare() would for partition
+ *  function computations, except for the double precision DP matrices
+ */
+PRIVATE int
+float_pf_prepare(vrna_fold_compound_t *fc)
+{
+  if (fc->length > vrna_sequence_length_max(VRNA_OPTION_PF))
+    return 0;
+
+  vrna_params_prepare(fc, VRNA_OPTION_PF);
+  vrna_ptypes_prepare(fc, VRNA_OPTION_PF);
+  vrna_hc_prepare(fc, VRNA_OPTION_PF);
+  vrna_loop_cache_prepare(fc, VRNA_OPTION_PF);
+
+  return 1;
+}
@@ -211,6 +211,44 @@ vrna_probs_window(vrna_fold_compound_t        *fc,
                   vrna_probs_window_callback  *cb,
                   void                        *data);
 
+
+/**
+ *  @brief  Global partition function and base pair probabilities with banded DP matrices
+ *
+ *  Computes the partition function of the entire sequence where base pairs may not span
+ *  more than #vrna_md_t.max_bp_span nucleotides. In contrast to vrna_pf() on a regular
+ *  #vrna_fold_compound_t, this function uses the banded DP matrices of the sliding window
+ *  approach, i.e. it requires memory in the order of @f$ n \cdot w @f$ instead of @f$ n^2 @f$
+ *  for sequence length @f$ n @f$ and window size @f$ w @f$. Other than vrna_probs_window(),
+ *  the ensemble is the global one, i.e. probabilities are not averaged over windows.
+ *
+ *  If #vrna_md_t.compute_bpp is set, base pair probabilities are computed as well. They are
+ *  passed row-wise to the callback @p cb using the #VRNA_PROBS_WINDOW_BPP type, just as for
+ *  vrna_probs_window(), and summarized as pseudo-bracket notation in @p structure. Since
+ *  they are not stored anywhere else, their computation is skipped with a warning if neither
+ *  @p cb nor @p structure is provided.
+ *
+ *  The #vrna_fold_compound_t must be obtained with option #VRNA_OPTION_WINDOW. Calling vrna_pf()
+ *  on such a #vrna_fold_compound_t automatically re-directs to this function.
+ *
+ *  @note Comparative predictions, G-Quadruplexes, circular RNAs, soft constraints, unstructured
+ *        domains, and hard constraint callbacks are not supported.
+ *
+ *  @see  vrna_pf(), vrna_probs_window(), vrna_mfe_window_global(), #VRNA_OPTION_WINDOW
+ *
+ *  @param  fc          The #vrna_fold_compound_t obtained with option #VRNA_OPTION_WINDOW
+ *  @param  structure   A pointer to the character array where the pseudo-bracket notation of the
+ *                      base pair probabilities will be written to (Maybe NULL)
+ *  @param  cb          The callback function which collects the pair probability data (Maybe NULL)
+ *  @param  data        Some arbitrary data structure that is passed to the callback @p cb
+ *  @return             The ensemble free energy in kcal/mol
+ */
+float
+vrna_pf_window_global(vrna_fold_compound_t        *fc,
+                      char                        *structure,
+                      vrna_probs_window_callback  *cb,
+                      void                        *data);
+
 /* End basic interface */
 /**@}*/
 
@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "ViennaRNA/fold_compound.h"
 #include "ViennaRNA/model.h"
@@ -46,6 +47,82 @@ vrna_pf_fold(const char *seq,
 }
 
 
+PUBLIC float *
+vrna_pf_fold_batch(const char       **sequences,
+                   const vrna_md_t  *md_p,
+                   char             **structures)
+{
+  char                  *structure;
+  unsigned int          i, n, num, n_max, longest;
+  float                 *energies;
+  double                mfe;
+  vrna_fold_compound_t  *fc, *tmp;
+  vrna_md_t             md;
+
+  if (!sequences)
+    return NULL;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /* no need to backtrack MFE structure */
+  md.backtrack = 0;
+
+  if (!structures) /* no need for pair probability computations if we do not store them somewhere */
+    md.compute_bpp = 0;
+
+  /*
+   *  find the longest sequence that can be re-bound, such that the DP
+   *  matrices of the shared fold compound are allocated only once
+   */
+  longest = 0;
+  n_max   = 0;
+
+  for (num = 0; sequences[num]; num++) {
+    if (strchr(sequences[num], '&'))
+      continue;
+
+    n = strlen(sequences[num]);
+    if (n > n_max) {
+      n_max   = n;
+      longest = num;
+    }
+  }
+
+  energies  = (float *)vrna_alloc(sizeof(float) * (num + 1));
+  fc        = (n_max > 0) ?
+              vrna_fold_compound(sequences[longest], &md, VRNA_OPTION_MFE | VRNA_OPTION_PF) :
+              NULL;
+
+  for (i = 0; i < num; i++) {
+    structure = (structures) ? (char *)vrna_alloc(sizeof(char) * (strlen(sequences[i]) + 1)) : NULL;
+
+    if ((fc) && (vrna_fold_compound_rebind(fc, sequences[i]))) {
+      mfe = (double)vrna_mfe(fc, NULL);
+      vrna_exp_params_rescale(fc, &mfe);
+      energies[i] = vrna_pf(fc, structure);
+    } else if ((tmp = vrna_fold_compound(sequences[i], &md, VRNA_OPTION_DEFAULT))) {
+      /* fall-back for sequences we can not bind to the shared fold compound */
+      mfe = (double)vrna_mfe(tmp, NULL);
+      vrna_exp_params_rescale(tmp, &mfe);
+      energies[i] = vrna_pf(tmp, structure);
+      vrna_fold_compound_free(tmp);
+    } else {
+      energies[i] = (float)(INF / 100.);
+    }
+
+    if (structures)
+      structures[i] = structure;
+  }
+
+  vrna_fold_compound_free(fc);
+
+  return energies;
+}
+
+
 PUBLIC float
 vrna_pf_circfold(const char *seq,
                  char       *structure,
@@ -113,8 +113,8 @@ evaluate_perturbation_vector_score(vrna_fold_compound_t *vc,
 
   addSoftConstraint(vc, epsilon, length);
 
-  vc->params->model_details.compute_bpp     = 1;
-  vc->exp_params->model_details.compute_bpp = 1;
+  vrna_params_unshare(vc)->model_details.compute_bpp = 1;
+  vc->exp_params->model_details.compute_bpp          = 1;
 
   /* get new (constrained) MFE to scale pf computations properly */
   double mfe = (double)vrna_mfe(vc, NULL);
@@ -154,8 +154,8 @@ pairing_probabilities_from_restricted_pf(vrna_fold_compound_t *vc,
   int i;
 
   addSoftConstraint(vc, epsilon, length);
-  vc->params->model_details.compute_bpp     = 1;
-  vc->exp_params->model_details.compute_bpp = 1;
+  vrna_params_unshare(vc)->model_details.compute_bpp = 1;
+  vc->exp_params->model_details.compute_bpp          = 1;
 
   /* get new (constrained) MFE to scale pf computations properly */
   double mfe = (double)vrna_mfe(vc, NULL);
@@ -216,8 +216,8 @@ pairing_probabilities_from_sampling(vrna_fold_compound_t  *vc,
   length = vc->length;
   addSoftConstraint(vc, epsilon, length);
 
-  vc->params->model_details.compute_bpp     = 0;
-  vc->exp_params->model_details.compute_bpp = 0;
+  vrna_params_unshare(vc)->model_details.compute_bpp = 0;
+  vc->exp_params->model_details.compute_bpp          = 0;
 
   /* get new (constrained) MFE to scale pf computations properly */
   mfe = (double)vrna_mfe(vc, NULL);
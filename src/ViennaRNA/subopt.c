@@ -37,6 +37,18 @@
 #include <omp.h>
 #endif
 
+#if VRNA_WITH_PTHREADS
+# include <pthread.h>
+#endif
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/wavefront.inc"
+
 #define true              1
 #define false             0
 
@@ -61,10 +73,20 @@ typedef struct {
   /* int best_energy;   */ /* best attainable energy */
 } STATE;
 
+/**
+ *  @brief  Stack of states that also allows for removing its bottom element in constant time
+ */
 typedef struct {
-  LIST  *Intervals;
-  LIST  *Stack;
-  int   nopush;
+  STATE         **states;   /* ring buffer of states */
+  unsigned int  size;       /* capacity of the ring buffer (power of 2) */
+  unsigned int  first;      /* position of the bottom element */
+  unsigned int  count;      /* number of states on the stack */
+} STATE_DEQUE;
+
+typedef struct {
+  LIST        *Intervals;
+  STATE_DEQUE *Stack;
+  int         nopush;
 } subopt_env;
 
 
@@ -76,6 +98,50 @@ struct old_subopt_dat {
   int           cp;
 };
 
+
+/* resource limits for the enumeration, 0 means unlimited */
+struct subopt_limits {
+  unsigned int  max_structures;
+  size_t        max_memory;
+  size_t        mem_stack;    /* approximate memory occupied by the backtracking stack */
+  size_t        mem_buffer;   /* approximate memory occupied by buffered solutions */
+  int           exhausted;    /* buffered solutions exceed the limit and can not be moved to disk */
+};
+
+
+/* everything required to report a solution to the callback */
+struct subopt_output {
+  vrna_subopt_callback  *cb;
+  void                  *data;
+  double                min_en;
+  double                eprint;
+  float                 correction;
+  int                   recalc;     /* re-evaluate energies, e.g. for logML or odd dangles */
+  int                   cut;        /* position of the cut point in the output (-1 for none) */
+  unsigned int          reported;   /* number of structures passed to the callback */
+};
+
+
+/* maximum number of sorted runs on disk before they are merged into a single one */
+#define MAX_SPILL_RUNS  128
+
+/* data for sorted, memory bounded output of suboptimal structures */
+struct subopt_stream_dat {
+  vrna_subopt_callback  *cb;
+  void                  *data;
+  int                   (*compare_fun)(const void *a,
+                                       const void *b);
+  struct subopt_limits  *limits;
+  size_t                length;       /* length of the (packed) structure strings */
+  int                   packed;       /* store structures in packed form, see vrna_db_pack() */
+  int                   cut;          /* position of the cut point in unpacked structures */
+  size_t                n_sol;
+  size_t                max_sol;
+  SOLUTION              *SolutionList;
+  FILE                  *runs[MAX_SPILL_RUNS];
+  unsigned int          n_runs;
+};
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -158,7 +224,7 @@ print_state(STATE *state);
 
 
 PRIVATE void
-UNUSED print_stack(LIST *list);
+UNUSED print_stack(STATE_DEQUE *stack);
 
 
 PRIVATE LIST *
@@ -174,6 +240,27 @@ PRIVATE void
 *pop(LIST *list);
 
 
+PRIVATE STATE_DEQUE *
+make_deque(void);
+
+
+PRIVATE void
+deque_push(STATE_DEQUE  *stack,
+           STATE        *state);
+
+
+PRIVATE STATE *
+deque_pop(STATE_DEQUE *stack);
+
+
+PRIVATE STATE *
+deque_pop_bottom(STATE_DEQUE *stack);
+
+
+PRIVATE void
+free_deque(STATE_DEQUE *stack);
+
+
 PRIVATE int
 best_attainable_energy(vrna_fold_compound_t *vc,
                        STATE                *state);
@@ -198,8 +285,8 @@ free_state_node(STATE *node);
 
 
 PRIVATE void
-push_back(LIST  *Stack,
-          STATE *state);
+push_back(STATE_DEQUE *Stack,
+          STATE       *state);
 
 
 PRIVATE char *
@@ -263,6 +350,71 @@ old_subopt_store_compressed(const char *structure,
                             void       *data);
 
 
+PRIVATE int
+subopt_enumerate(vrna_fold_compound_t *vc,
+                 int                  delta,
+                 struct subopt_limits *limits,
+                 vrna_subopt_callback *cb,
+                 void                 *data);
+
+
+#ifdef _OPENMP
+PRIVATE int
+subopt_enumerate_parallel(vrna_fold_compound_t  *vc,
+                          STATE_DEQUE           *initial,
+                          int                   threshold,
+                          size_t                mem_state,
+                          struct subopt_limits  *limits,
+                          struct subopt_output  *out,
+                          int                   num_threads);
+
+
+#endif
+
+
+PRIVATE char *
+get_solution(vrna_fold_compound_t *vc,
+             STATE                *state,
+             struct subopt_output *out,
+             double               *energy);
+
+
+PRIVATE void
+report_solution(char                  *structure,
+                double                energy,
+                struct subopt_output  *out);
+
+
+PRIVATE void
+stream_store(const char *structure,
+             float      energy,
+             void       *data);
+
+
+PRIVATE void
+stream_report(struct subopt_stream_dat  *d,
+              SOLUTION                  *sol);
+
+
+PRIVATE int
+stream_spill(struct subopt_stream_dat *d);
+
+
+PRIVATE int
+stream_read(struct subopt_stream_dat  *d,
+            FILE                      *run,
+            SOLUTION                  *sol);
+
+
+PRIVATE int
+stream_merge(struct subopt_stream_dat *d,
+             FILE                     *out);
+
+
+PRIVATE void
+stream_free(struct subopt_stream_dat *d);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -430,15 +582,15 @@ print_state(STATE *state)
 /*---------------------------------------------------------------------------*/
 
 /*@unused @*/ PRIVATE void
-print_stack(LIST *list)
+print_stack(STATE_DEQUE *stack)
 {
-  void *rec;
+  unsigned int k;
 
   printf("================\n");
-  printf("%d states\n", list->count);
-  for (rec = lst_first(list); rec; rec = lst_next(rec)) {
+  printf("%u states\n", stack->count);
+  for (k = stack->count; k > 0; k--) {
     printf("state-----------\n");
-    print_state(rec);
+    print_state(stack->states[(stack->first + k - 1) & (stack->size - 1)]);
   }
   printf("================\n");
 }
@@ -487,6 +639,80 @@ pop(LIST *list)
 }
 
 
+/*---------------------------------------------------------------------------*/
+
+PRIVATE STATE_DEQUE *
+make_deque(void)
+{
+  STATE_DEQUE *stack;
+
+  stack         = (STATE_DEQUE *)vrna_alloc(sizeof(STATE_DEQUE));
+  stack->size   = 64;
+  stack->states = (STATE **)vrna_alloc(sizeof(STATE *) * stack->size);
+
+  return stack;
+}
+
+
+PRIVATE void
+deque_push(STATE_DEQUE  *stack,
+           STATE        *state)
+{
+  unsigned int k;
+
+  if (stack->count == stack->size) {
+    /* double the capacity and unwrap the ring buffer */
+    stack->states = (STATE **)vrna_realloc(stack->states, sizeof(STATE *) * 2 * stack->size);
+    for (k = 0; k < stack->first; k++)
+      stack->states[stack->size + k] = stack->states[k];
+
+    stack->size *= 2;
+  }
+
+  stack->states[(stack->first + stack->count++) & (stack->size - 1)] = state;
+}
+
+
+PRIVATE STATE *
+deque_pop(STATE_DEQUE *stack)
+{
+  if (stack->count == 0)
+    return NULL;
+
+  return stack->states[(stack->first + --stack->count) & (stack->size - 1)];
+}
+
+
+/* remove the element at the bottom of a stack, i.e. the one pushed first */
+PRIVATE STATE *
+deque_pop_bottom(STATE_DEQUE *stack)
+{
+  STATE *state;
+
+  if (stack->count == 0)
+    return NULL;
+
+  state         = stack->states[stack->first];
+  stack->first  = (stack->first + 1) & (stack->size - 1);
+  stack->count--;
+
+  return state;
+}
+
+
+PRIVATE void
+free_deque(STATE_DEQUE *stack)
+{
+  STATE *state;
+
+  while ((state = deque_pop(stack)))
+    free_state_node(state);
+
+  free(stack->states);
+  free(stack);
+}
+
+
 /*---------------------------------------------------------------------------*/
 /*auxiliary routines---------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -533,10 +759,10 @@ best_attainable_energy(vrna_fold_compound_t *vc,
 /*---------------------------------------------------------------------------*/
 
 PRIVATE void
-push_back(LIST  *Stack,
-          STATE *state)
+push_back(STATE_DEQUE *Stack,
+          STATE       *state)
 {
-  push(Stack, copy_state(state));
+  deque_push(Stack, copy_state(state));
   return;
 }
 
@@ -632,7 +858,7 @@ fork_state(int        i,
 {
   STATE *s_new = derive_new_state(i, j, s, e, flag);
 
-  push(env->Stack, s_new);
+  deque_push(env->Stack, s_new);
   env->nopush = false;
 }
 
@@ -650,7 +876,7 @@ fork_int_state(int        i,
 
   make_pair(i, j, s_new);
   make_pair(p, q, s_new);
-  push(env->Stack, s_new);
+  deque_push(env->Stack, s_new);
   env->nopush = false;
 }
 
@@ -667,7 +893,7 @@ fork_state_pair(int         i,
   new_state = copy_state(s);
   make_pair(i, j, new_state);
   new_state->partial_energy += e;
-  push(env->Stack, new_state);
+  deque_push(env->Stack, new_state);
   env->nopush = false;
 }
 
@@ -700,7 +926,7 @@ fork_two_states_pair(int        i,
   make_pair(i, j, new_state);
   new_state->partial_energy += e;
 
-  push(env->Stack, new_state);
+  deque_push(env->Stack, new_state);
   env->nopush = false;
 }
 
@@ -733,7 +959,7 @@ fork_two_states(int         i,
 
   new_state->partial_energy += e;
 
-  push(env->Stack, new_state);
+  deque_push(env->Stack, new_state);
   env->nopush = false;
 }
 
@@ -765,20 +991,12 @@ vrna_subopt(vrna_fold_compound_t  *vc,
     /* end initialize ------------------------------------------------------- */
 
     if (fp) {
-      float min_en;
-      char  *SeQ, *energies = NULL;
-      if (vc->strands > 1)
-        min_en = vrna_mfe_dimer(vc, NULL);
-      else
-        min_en = vrna_mfe(vc, NULL);
+      char *SeQ, *energies = NULL;
 
-      SeQ       = vrna_cut_point_insert(vc->sequence, vc->cutpoint);
-      energies  = vrna_strdup_printf(" %6.2f %6.2f", min_en, (float)delta / 100.);
+      SeQ = vrna_subopt_header(vc, delta, &energies);
       print_structure(fp, SeQ, energies);
       free(SeQ);
       free(energies);
-
-      vrna_mx_mfe_free(vc);
     }
 
     cb = old_subopt_store;
@@ -825,26 +1043,122 @@ vrna_subopt(vrna_fold_compound_t  *vc,
 }
 
 
+PUBLIC char *
+vrna_subopt_header(vrna_fold_compound_t *fc,
+                   int                  delta,
+                   char                 **energies)
+{
+  float min_en;
+
+  if ((!fc) || (!energies))
+    return NULL;
+
+  if (fc->strands > 1)
+    min_en = vrna_mfe_dimer(fc, NULL);
+  else
+    min_en = vrna_mfe(fc, NULL);
+
+  /* the enumeration fills its own DP matrices */
+  vrna_mx_mfe_free(fc);
+
+  *energies = vrna_strdup_printf(" %6.2f %6.2f", min_en, (float)delta / 100.);
+
+  return vrna_cut_point_insert(fc->sequence, fc->cutpoint);
+}
+
+
 PUBLIC void
 vrna_subopt_cb(vrna_fold_compound_t *vc,
                int                  delta,
                vrna_subopt_callback *cb,
                void                 *data)
 {
-  subopt_env    *env;
-  STATE         *state;
-  INTERVAL      *interval;
-  unsigned int  *so, *ss, *se;
-  int           maxlevel, count, partial_energy, old_dangles, logML, dangle_model, length, circular,
-                threshold;
-  double        structure_energy, min_en, eprint;
-  char          *struc, *structure;
-  float         correction;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
-  int           minimal_energy;
-  int           Fc;
-  int           *f5;
+  (void)subopt_enumerate(vc, delta, NULL, cb, data);
+}
+
+
+PUBLIC int
+vrna_subopt_stream(vrna_fold_compound_t *fc,
+                   int                  delta,
+                   int                  sorted,
+                   unsigned int         max_structures,
+                   size_t               max_memory,
+                   vrna_subopt_callback *cb,
+                   void                 *data)
+{
+  int                       complete;
+  struct subopt_limits      limits;
+  struct subopt_stream_dat  d;
+
+  if ((!fc) || (!cb))
+    return 0;
+
+  limits.max_structures = max_structures;
+  limits.max_memory     = max_memory;
+  limits.mem_stack      = 0;
+  limits.mem_buffer     = 0;
+  limits.exhausted      = 0;
+
+  if (!sorted)
+    return subopt_enumerate(fc, delta, &limits, cb, data);
+
+  memset(&d, 0, sizeof(struct subopt_stream_dat));
+  d.cb          = cb;
+  d.data        = data;
+  d.limits      = &limits;
+  d.compare_fun = (sorted == VRNA_SORT_BY_ENERGY_ASC) ? compare_en : compare;
+  d.cut         = fc->cutpoint;
+  /* packed structures retain the lexicographic order, but do not support G-quadruplexes */
+  d.packed      = (fc->params->model_details.gquad) ? 0 : 1;
+
+  complete = subopt_enumerate(fc, delta, &limits, stream_store, (void *)&d);
+
+  if (d.n_runs == 0) {
+    /* everything fits into memory */
+    size_t k;
+
+    qsort(d.SolutionList, d.n_sol, sizeof(SOLUTION), d.compare_fun);
+
+    for (k = 0; k < d.n_sol; k++)
+      stream_report(&d, d.SolutionList + k);
+  } else if ((!stream_spill(&d)) ||
+             (!stream_merge(&d, NULL))) {
+    vrna_message_warning("vrna_subopt_stream: "
+                         "Failed to merge sorted suboptimal structures from temporary files");
+    complete = 0;
+  }
+
+  cb(NULL, 0, data);
+
+  stream_free(&d);
+
+  return complete;
+}
+
+
+PRIVATE int
+subopt_enumerate(vrna_fold_compound_t *vc,
+                 int                  delta,
+                 struct subopt_limits *limits,
+                 vrna_subopt_callback *cb,
+                 void                 *data)
+{
+  subopt_env            *env;
+  STATE                 *state;
+  INTERVAL              *interval;
+  unsigned int          *so, *ss, *se;
+  int                   maxlevel, count, partial_energy, old_dangles, logML, dangle_model, length,
+                        circular, threshold, complete, num_threads;
+  size_t                mem_state;
+  double                structure_energy, min_en, eprint;
+  char                  *struc, *structure;
+  float                 correction;
+  struct subopt_output  out;
+  vrna_param_t          *P;
+  vrna_md_t             *md;
+  int                   minimal_energy;
+  int                   Fc;
+  int                   *f5;
 
   vrna_fold_compound_prepare(vc, VRNA_OPTION_MFE | VRNA_OPTION_HYBRID);
 
@@ -852,7 +1166,7 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
   so      = vc->strand_order;
   ss      = vc->strand_start;
   se      = vc->strand_end;
-  P       = vc->params;
+  P       = vrna_params_unshare(vc); /* the model details are modified below */
   md      = &(P->model_details);
 
   /* do mfe folding to get fill arrays and get ground state energy  */
@@ -900,8 +1214,22 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
 
   maxlevel        = 0;
   count           = 0;
+  complete        = 1;
   partial_energy  = 0;
 
+  out.cb          = cb;
+  out.data        = data;
+  out.min_en      = min_en;
+  out.eprint      = eprint;
+  out.correction  = correction;
+  out.recalc      = (logML || (dangle_model == 1) || (dangle_model == 3)) ? 1 : 0;
+  out.cut         = (vc->strands > 1) ? (int)ss[so[1]] : -1;
+  out.reported    = 0;
+
+  /* rough estimate of the memory occupied by a single state on the stack */
+  mem_state = 3 * sizeof(LST_BUCKET) + sizeof(STATE) + sizeof(LIST) + length + 1 +
+              4 * (sizeof(LST_BUCKET) + sizeof(INTERVAL));
+
   /* Initialize the stack ------------------------------------------------- */
 
   minimal_energy  = (circular) ? Fc : f5[length];
@@ -915,74 +1243,91 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
   env             = (subopt_env *)vrna_alloc(sizeof(subopt_env));
   env->Stack      = NULL;
   env->nopush     = true;
-  env->Stack      = make_list();                      /* anchor */
+  env->Stack      = make_deque();                     /* anchor */
   env->Intervals  = make_list();                      /* initial state: */
   interval        = make_interval(1, length, 0);      /* interval [1,length,0] */
   push(env->Intervals, interval);
   env->nopush = false;
   state       = make_state(env->Intervals, NULL, partial_energy, 0, length);
   /* state->best_energy = minimal_energy; */
-  push(env->Stack, state);
+  deque_push(env->Stack, state);
   env->nopush = false;
 
   /* end initialize ------------------------------------------------------- */
 
+  num_threads = wavefront_threads(vc, md);
+
+#ifdef _OPENMP
+  if (num_threads > 1) {
+    /* the initial state becomes the first work package of the shared pool */
+    complete = subopt_enumerate_parallel(vc,
+                                         env->Stack,
+                                         threshold,
+                                         mem_state,
+                                         limits,
+                                         &out,
+                                         num_threads);
+
+    free_deque(env->Stack);
+
+    cb(NULL, 0, data);   /* NULL (last time to call callback function */
+
+    free(env);
+
+    return complete;
+  }
+
+#endif
 
   while (1) {
     /* forever, til nothing remains on stack */
 
     maxlevel = (env->Stack->count > maxlevel ? env->Stack->count : maxlevel);
 
-    if (LST_EMPTY(env->Stack)) {
+    if (env->Stack->count == 0) {
       /* we are done! clean up and quit */
       /* fprintf(stderr, "maxlevel: %d\n", maxlevel); */
 
-      lst_kill(env->Stack, free_state_node);
+      free_deque(env->Stack);
 
       cb(NULL, 0, data);   /* NULL (last time to call callback function */
 
       break;
     }
 
+    if (limits) {
+      limits->mem_stack = mem_state * env->Stack->count;
+
+      if ((limits->max_structures) &&
+          (out.reported >= limits->max_structures)) {
+        complete = 0;
+      } else if ((limits->max_memory) &&
+                 ((limits->mem_stack > limits->max_memory) || (limits->exhausted))) {
+        vrna_message_warning("Memory limit for suboptimal structures reached, "
+                             "stopping enumeration after %u structures",
+                             out.reported);
+        complete = 0;
+      }
+
+      if (!complete) {
+        free_deque(env->Stack);
+
+        cb(NULL, 0, data);
+
+        break;
+      }
+    }
+
     /* pop the last element ---------------------------------------------- */
 
-    state = pop(env->Stack);                       /* current state to work with */
+    state = deque_pop(env->Stack);                 /* current state to work with */
 
     if (LST_EMPTY(state->Intervals)) {
-      int e;
       /* state has no intervals left: we got a solution */
 
       count++;
-      structure         = get_structure(state);
-      structure_energy  = state->partial_energy / 100.;
-
-#ifdef CHECK_ENERGY
-      structure_energy = vrna_eval_structure(vc, structure);
-
-      if (!logML)
-        if ((double)(state->partial_energy / 100.) != structure_energy) {
-          vrna_message_error("%s %6.2f %6.2f",
-                             structure,
-                             state->partial_energy / 100.,
-                             structure_energy);
-          exit(1);
-        }
-
-#endif
-      if (logML || (dangle_model == 1) || (dangle_model == 3)) /* recalc energy */
-        structure_energy = vrna_eval_structure(vc, structure);
-
-      e = (int)((structure_energy - min_en) * 10. - correction); /* avoid rounding errors */
-      if (e > MAXDOS)
-        e = MAXDOS;
-
-      density_of_states[e]++;
-      if (structure_energy <= eprint) {
-        char *outstruct = vrna_cut_point_insert(structure, (vc->strands > 1) ? ss[so[1]] : -1);
-        cb((const char *)outstruct, structure_energy, data);
-        free(outstruct);
-      }
-
+      structure = get_solution(vc, state, &out, &structure_energy);
+      report_solution(structure, structure_energy, &out);
       free(structure);
     } else {
       /* get (and remove) next interval of state to analyze */
@@ -998,6 +1343,409 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
 
   /* cleanup memory */
   free(env);
+
+  return complete;
+}
+
+
+#ifdef _OPENMP
+/*
+ *  States shared among the threads of the parallel enumeration. Threads
+ *  that ran out of work wait for the pool to be filled by busy threads.
+ *  Without POSIX threads, waiting threads poll the pool instead
+ */
+struct state_pool {
+  STATE_DEQUE     *states;
+  unsigned int    max_states; /* maximum number of states in the pool */
+  int             busy;       /* number of threads that currently hold states */
+  int             waiting;    /* number of threads waiting for states */
+  int             done;       /* no more states will be shared */
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_t mtx;
+  pthread_cond_t  available;
+#else
+  omp_lock_t      lck;
+#endif
+};
+
+
+PRIVATE INLINE void
+pool_lock(struct state_pool *pool)
+{
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&(pool->mtx));
+#else
+  omp_set_lock(&(pool->lck));
+#endif
+}
+
+
+PRIVATE INLINE void
+pool_unlock(struct state_pool *pool)
+{
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&(pool->mtx));
+#else
+  omp_unset_lock(&(pool->lck));
+#endif
+}
+
+
+/* wait for a change of the pool, the pool must be locked by the calling thread */
+PRIVATE INLINE void
+pool_wait(struct state_pool *pool)
+{
+#if VRNA_WITH_PTHREADS
+  pthread_cond_wait(&(pool->available), &(pool->mtx));
+#else
+  omp_unset_lock(&(pool->lck));
+  omp_set_lock(&(pool->lck));
+#endif
+}
+
+
+PRIVATE INLINE void
+pool_notify(struct state_pool *pool,
+            int               all)
+{
+#if VRNA_WITH_PTHREADS
+  if (all)
+    pthread_cond_broadcast(&(pool->available));
+  else
+    pthread_cond_signal(&(pool->available));
+
+#endif
+}
+
+
+/*
+ *  Obtain a state from the pool. A thread whose stack ran empty waits until
+ *  another thread shares a state, or until no thread holds states anymore,
+ *  in which case the enumeration is complete and NULL is returned
+ */
+PRIVATE STATE *
+pool_get(struct state_pool  *pool,
+         int                *has_work)
+{
+  STATE *state;
+
+  state = NULL;
+
+  pool_lock(pool);
+
+  if (*has_work) {
+    pool->busy--;
+    *has_work = 0;
+  }
+
+  while (!pool->done) {
+    if (pool->states->count > 0) {
+      state = deque_pop(pool->states);
+      pool->busy++;
+      *has_work = 1;
+      break;
+    }
+
+    if (pool->busy == 0) {
+      /* nobody is left to share states */
+      pool->done = 1;
+      pool_notify(pool, 1);
+      break;
+    }
+
+#pragma omp atomic update
+    pool->waiting++;
+
+    pool_wait(pool);
+
+#pragma omp atomic update
+    pool->waiting--;
+  }
+
+  pool_unlock(pool);
+
+  return state;
+}
+
+
+/*
+ *  Move the bottom state of a thread's stack, i.e. the one closest to the root
+ *  of the enumeration tree, to the pool. States are only shared if there are
+ *  more waiting threads than states in the pool, which also limits its size
+ */
+PRIVATE int
+pool_share(struct state_pool  *pool,
+           STATE_DEQUE        *stack)
+{
+  int shared;
+
+  shared = 0;
+
+  pool_lock(pool);
+
+  if ((!pool->done) &&
+      (pool->states->count < pool->max_states) &&
+      (pool->states->count < (unsigned int)pool->waiting)) {
+    deque_push(pool->states, deque_pop_bottom(stack));
+    pool_notify(pool, 0);
+    shared = 1;
+  }
+
+  pool_unlock(pool);
+
+  return shared;
+}
+
+
+/* release all waiting threads upon premature termination */
+PRIVATE void
+pool_stop(struct state_pool *pool)
+{
+  pool_lock(pool);
+  pool->done = 1;
+  pool_notify(pool, 1);
+  pool_unlock(pool);
+}
+
+
+/*
+ *  Enumerate the suboptimal structures with multiple threads. Each thread
+ *  processes the states on its own, thread-local stack in the same depth-first
+ *  manner as the serial implementation above. As soon as other threads run
+ *  out of work, busy threads move the state at the bottom of their stack, i.e.
+ *  the one closest to the root of the enumeration tree, to a shared pool where
+ *  idle threads pick it up. Solutions are passed to the callback one at a time,
+ *  but in no particular order.
+ */
+PRIVATE int
+subopt_enumerate_parallel(vrna_fold_compound_t  *vc,
+                          STATE_DEQUE           *initial,
+                          int                   threshold,
+                          size_t                mem_state,
+                          struct subopt_limits  *limits,
+                          struct subopt_output  *out,
+                          int                   num_threads)
+{
+  int               stop, leftover;
+  long              n_states;
+  struct state_pool pool;
+
+  stop      = 0;        /* signal premature termination to all threads */
+  leftover  = 0;        /* whether states remained unprocessed upon termination */
+  n_states  = initial->count;
+
+  pool.states     = initial;
+  pool.max_states = (unsigned int)num_threads;
+  pool.busy       = 0;
+  pool.waiting    = 0;
+  pool.done       = 0;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_init(&(pool.mtx), NULL);
+  pthread_cond_init(&(pool.available), NULL);
+#else
+  omp_init_lock(&(pool.lck));
+#endif
+
+#pragma omp parallel num_threads(num_threads)
+  {
+    int         has_work, waiting, halt;
+    long        last_count, n;
+    STATE       *state;
+    INTERVAL    *interval;
+    subopt_env  env;
+    char        *structure;
+    double      structure_energy;
+
+    env.Stack     = make_deque();
+    env.Intervals = NULL;
+    env.nopush    = false;
+    has_work      = 0;
+    last_count    = 0;
+
+    while (1) {
+#pragma omp atomic read
+      halt = stop;
+
+      if (halt)
+        break;
+
+      if (env.Stack->count == 0) {
+        /* ran out of work, wait for a new state from the shared pool */
+        if (!(state = pool_get(&pool, &has_work)))
+          break;
+
+        /* the state was already accounted for while it resided in the pool */
+        deque_push(env.Stack, state);
+        last_count = env.Stack->count;
+      }
+
+      state = deque_pop(env.Stack);
+
+      if (LST_EMPTY(state->Intervals)) {
+        /* state has no intervals left: we got a solution */
+        structure = get_solution(vc, state, out, &structure_energy);
+
+#pragma omp critical (subopt_output)
+        {
+#pragma omp atomic read
+          halt = stop;
+
+          if (!halt) {
+            if (limits) {
+#pragma omp atomic read
+              n = n_states;
+              limits->mem_stack = mem_state * n;
+            }
+
+            report_solution(structure, structure_energy, out);
+
+            if ((limits) &&
+                (limits->max_structures) &&
+                (out->reported >= limits->max_structures)) {
+#pragma omp atomic write
+              stop = 1;
+            } else if ((limits) &&
+                       (limits->max_memory) &&
+                       (limits->exhausted)) {
+              vrna_message_warning("Memory limit for suboptimal structures reached, "
+                                   "stopping enumeration after %u structures",
+                                   out->reported);
+#pragma omp atomic write
+              stop = 1;
+            }
+
+#pragma omp atomic read
+            halt = stop;
+
+            if (halt)
+              pool_stop(&pool);
+          }
+        }
+
+        free(structure);
+      } else {
+        /* get (and remove) next interval of state to analyze */
+        interval = pop(state->Intervals);
+        scan_interval(vc, interval->i, interval->j, interval->array_flag, threshold, state, &env);
+
+        free_interval_node(interval);
+      }
+
+      free_state_node(state);
+
+      /* share work with waiting threads */
+#pragma omp atomic read
+      waiting = pool.waiting;
+
+      if ((waiting > 0) &&
+          (env.Stack->count > 1) &&
+          (pool_share(&pool, env.Stack))) {
+#pragma omp atomic update
+        n_states++;
+      }
+
+      /* keep track of the total number of states for the memory limit */
+      n = (long)env.Stack->count - last_count;
+#pragma omp atomic update
+      n_states += n;
+      last_count = env.Stack->count;
+
+      if ((limits) && (limits->max_memory)) {
+#pragma omp atomic read
+        n = n_states;
+
+        if (mem_state * n > limits->max_memory) {
+#pragma omp critical (subopt_output)
+          {
+#pragma omp atomic read
+            halt = stop;
+
+            if (!halt) {
+              vrna_message_warning("Memory limit for suboptimal structures reached, "
+                                   "stopping enumeration after %u structures",
+                                   out->reported);
+#pragma omp atomic write
+              stop = 1;
+
+              pool_stop(&pool);
+            }
+          }
+        }
+      }
+    }
+
+    if (env.Stack->count > 0) {
+#pragma omp atomic write
+      leftover = 1;
+    }
+
+    free_deque(env.Stack);
+  }
+
+#if VRNA_WITH_PTHREADS
+  pthread_cond_destroy(&(pool.available));
+  pthread_mutex_destroy(&(pool.mtx));
+#else
+  omp_destroy_lock(&(pool.lck));
+#endif
+
+  return ((leftover) || (pool.states->count > 0)) ? 0 : 1;
+}
+
+
+#endif
+
+
+PRIVATE char *
+get_solution(vrna_fold_compound_t *vc,
+             STATE                *state,
+             struct subopt_output *out,
+             double               *energy)
+{
+  char *structure;
+
+  structure = get_structure(state);
+  *energy   = state->partial_energy / 100.;
+
+#ifdef CHECK_ENERGY
+  *energy = vrna_eval_structure(vc, structure);
+
+  if (!vc->params->model_details.logML)
+    if ((double)(state->partial_energy / 100.) != *energy) {
+      vrna_message_error("%s %6.2f %6.2f",
+                         structure,
+                         state->partial_energy / 100.,
+                         *energy);
+      exit(1);
+    }
+
+#endif
+  if (out->recalc) /* recalc energy */
+    *energy = vrna_eval_structure(vc, structure);
+
+  return structure;
+}
+
+
+PRIVATE void
+report_solution(char                  *structure,
+                double                energy,
+                struct subopt_output  *out)
+{
+  int e;
+
+  e = (int)((energy - out->min_en) * 10. - out->correction); /* avoid rounding errors */
+  if (e > MAXDOS)
+    e = MAXDOS;
+
+  density_of_states[e]++;
+  if (energy <= out->eprint) {
+    char *outstruct = vrna_cut_point_insert(structure, out->cut);
+    out->cb((const char *)outstruct, energy, out->data);
+    free(outstruct);
+    out->reported++;
+  }
 }
 
 
@@ -1479,7 +2227,7 @@ scan_interval(vrna_fold_compound_t  *vc,
       if (tmp_en <= threshold) {
         new_state                 = derive_new_state(1, 2, state, 0, 0);
         new_state->partial_energy = 0;
-        push(env->Stack, new_state);
+        deque_push(env->Stack, new_state);
         env->nopush = false;
       }
     }
@@ -1634,7 +2382,7 @@ scan_interval(vrna_fold_compound_t  *vc,
                 /* mmh, we add the energy for closing the multiloop now... */
                 new_state->partial_energy += P->MLclosing;
                 /* next we push our state onto the R stack */
-                push(env->Stack, new_state);
+                deque_push(env->Stack, new_state);
                 env->nopush = false;
               }
 
@@ -1928,7 +2676,7 @@ repeat_gquad(vrna_fold_compound_t *vc,
         new_state->partial_energy += element_energy;
         /* new_state->best_energy =
          * hairpin[unpaired] + element_energy + best_energy; */
-        push(env->Stack, new_state);
+        deque_push(env->Stack, new_state);
         env->nopush = false;
       }
       free(L);
@@ -2039,7 +2787,7 @@ repeat(vrna_fold_compound_t *vc,
             make_pair(i + 1, j - 1, new_state);
 
             /* new_state->best_energy = new + best_energy; */
-            push(env->Stack, new_state);
+            deque_push(env->Stack, new_state);
             env->nopush = false;
             if (i == 1 || state->structure[i - 2] != '(' || state->structure[j] != ')')
               /* adding a stack is the only possible structure */
@@ -2240,7 +2988,7 @@ repeat(vrna_fold_compound_t *vc,
           make_pair(i, j, new_state);
 
           /* new_state->best_energy = new + best_energy; */
-          push(env->Stack, new_state);
+          deque_push(env->Stack, new_state);
           env->nopush = false;
         }
       }
@@ -2324,6 +3072,236 @@ old_subopt_store_compressed(const char *structure,
 }
 
 
+/*
+ *  Collect solutions for sorted output. Whenever the memory limit is
+ *  exceeded, the collected solutions are sorted and written to a
+ *  temporary file (a run), which are merged in the end
+ */
+PRIVATE void
+stream_store(const char *structure,
+             float      energy,
+             void       *data)
+{
+  char                      *s, *packed;
+  int                       cp;
+  struct subopt_stream_dat  *d;
+  struct subopt_limits      *limits;
+
+  d       = (struct subopt_stream_dat *)data;
+  limits  = d->limits;
+
+  if ((!structure) || (limits->exhausted))
+    return;
+
+  if (d->packed) {
+    if (d->cut > 0) {
+      s       = vrna_cut_point_remove(structure, &cp);
+      packed  = vrna_db_pack(s);
+      free(s);
+    } else {
+      packed = vrna_db_pack(structure);
+    }
+  } else {
+    packed = strdup(structure);
+  }
+
+  if (d->length == 0)
+    d->length = strlen(packed);
+
+  if (d->n_sol == d->max_sol) {
+    d->max_sol      = (d->max_sol) ? 2 * d->max_sol : 128;
+    d->SolutionList = (SOLUTION *)vrna_realloc(d->SolutionList, d->max_sol * sizeof(SOLUTION));
+  }
+
+  d->SolutionList[d->n_sol].energy      = energy;
+  d->SolutionList[d->n_sol++].structure = packed;
+
+  limits->mem_buffer += sizeof(SOLUTION) + d->length + 1;
+
+  if ((limits->max_memory) &&
+      (limits->mem_stack + limits->mem_buffer > limits->max_memory))
+    if (!stream_spill(d))
+      limits->exhausted = 1;  /* the enumeration stops due to the memory limit */
+}
+
+
+/* pass a stored solution to the callback in regular dot-bracket notation */
+PRIVATE void
+stream_report(struct subopt_stream_dat  *d,
+              SOLUTION                  *sol)
+{
+  char *ss, *s;
+
+  if (d->packed) {
+    ss  = vrna_db_unpack(sol->structure);
+    s   = vrna_cut_point_insert(ss, d->cut);
+    d->cb((const char *)s, sol->energy, d->data);
+    free(s);
+    free(ss);
+  } else {
+    d->cb((const char *)sol->structure, sol->energy, d->data);
+  }
+}
+
+
+/* sort the collected solutions and write them to a new temporary file */
+PRIVATE int
+stream_spill(struct subopt_stream_dat *d)
+{
+  size_t  k;
+  FILE    *run;
+
+  if (d->n_sol == 0)
+    return 1;
+
+  if (d->n_runs == MAX_SPILL_RUNS) {
+    /* merge all runs into a single one to limit the number of open files */
+    if (!(run = tmpfile()))
+      return 0;
+
+    if (!stream_merge(d, run)) {
+      fclose(run);
+      return 0;
+    }
+
+    d->runs[d->n_runs++] = run;
+  }
+
+  if (!(run = tmpfile())) {
+    vrna_message_warning("vrna_subopt_stream: Failed to create temporary file");
+    return 0;
+  }
+
+  qsort(d->SolutionList, d->n_sol, sizeof(SOLUTION), d->compare_fun);
+
+  for (k = 0; k < d->n_sol; k++)
+    if ((fwrite(&(d->SolutionList[k].energy), sizeof(float), 1, run) != 1) ||
+        (fwrite(d->SolutionList[k].structure, sizeof(char), d->length, run) != d->length)) {
+      /* the solutions remain in memory and are released by stream_free() */
+      fclose(run);
+      return 0;
+    }
+
+  /* release the solutions only after the entire run has been written */
+  for (k = 0; k < d->n_sol; k++)
+    free(d->SolutionList[k].structure);
+
+  d->runs[d->n_runs++]  = run;
+  d->n_sol              = 0;
+  d->limits->mem_buffer = 0;
+
+  return 1;
+}
+
+
+PRIVATE int
+stream_read(struct subopt_stream_dat  *d,
+            FILE                      *run,
+            SOLUTION                  *sol)
+{
+  if ((fread(&(sol->energy), sizeof(float), 1, run) != 1) ||
+      (fread(sol->structure, sizeof(char), d->length, run) != d->length))
+    return 0;
+
+  return 1;
+}
+
+
+/*
+ *  k-way merge of all runs on disk using a binary heap. The merged
+ *  solutions are either passed to the callback (out == NULL), or
+ *  written to another temporary file. All runs are closed afterwards
+ */
+PRIVATE int
+stream_merge(struct subopt_stream_dat *d,
+             FILE                     *out)
+{
+  unsigned int  k, n, p, c, r, *heap;
+  int           ret;
+  SOLUTION      *heads;
+
+  ret   = 1;
+  heads = (SOLUTION *)vrna_alloc(sizeof(SOLUTION) * d->n_runs);
+  heap  = (unsigned int *)vrna_alloc(sizeof(unsigned int) * d->n_runs);
+
+  for (n = k = 0; k < d->n_runs; k++) {
+    heads[k].structure = (char *)vrna_alloc(sizeof(char) * (d->length + 1));
+    rewind(d->runs[k]);
+
+    if (stream_read(d, d->runs[k], heads + k)) {
+      /* sift up */
+      for (c = n++; c > 0; c = p) {
+        p = (c - 1) / 2;
+        if (d->compare_fun(heads + k, heads + heap[p]) >= 0)
+          break;
+
+        heap[c] = heap[p];
+      }
+      heap[c] = k;
+    }
+  }
+
+  while (n > 0) {
+    r = heap[0];
+
+    if (out) {
+      if ((fwrite(&(heads[r].energy), sizeof(float), 1, out) != 1) ||
+          (fwrite(heads[r].structure, sizeof(char), d->length, out) != d->length)) {
+        ret = 0;
+        break;
+      }
+    } else {
+      stream_report(d, heads + r);
+    }
+
+    /* replace the top element by the next solution of its run, or the last heap element */
+    if (!stream_read(d, d->runs[r], heads + r))
+      r = heap[--n];
+
+    /* sift down */
+    for (p = 0; (c = 2 * p + 1) < n; p = c) {
+      if ((c + 1 < n) &&
+          (d->compare_fun(heads + heap[c + 1], heads + heap[c]) < 0))
+        c++;
+
+      if (d->compare_fun(heads + r, heads + heap[c]) <= 0)
+        break;
+
+      heap[p] = heap[c];
+    }
+    heap[p] = r;
+  }
+
+  for (k = 0; k < d->n_runs; k++) {
+    free(heads[k].structure);
+    fclose(d->runs[k]);
+  }
+
+  d->n_runs = 0;
+
+  free(heads);
+  free(heap);
+
+  return ret;
+}
+
+
+PRIVATE void
+stream_free(struct subopt_stream_dat *d)
+{
+  size_t        k;
+  unsigned int  r;
+
+  for (k = 0; k < d->n_sol; k++)
+    free(d->SolutionList[k].structure);
+
+  for (r = 0; r < d->n_runs; r++)
+    fclose(d->runs[r]);
+
+  free(d->SolutionList);
+}
+
+
 /*###########################################*/
 /*# deprecated functions below              #*/
 /*###########################################*/
@@ -2404,7 +3382,7 @@ wrap_subopt(char          *string,
 
   if (parameters) {
     /* replace params if necessary */
-    free(vc->params);
+    vrna_params_free(vc->params);
     vc->params = P;
   } else {
     free(P);
@@ -152,6 +152,10 @@ vrna_subopt(vrna_fold_compound_t *vc,
   vrna_fold_compound_t *vc=vrna_fold_compound("GGGGGGAAAAAACCCCCC", &md, VRNA_OPTION_DEFAULT);
  *        @endcode
  *
+ *  @note If the fold compound was created with #vrna_md_t.num_threads > 1, the enumeration
+ *        is distributed among multiple threads. The callback is then never executed
+ *        concurrently, but the order in which the structures are passed to it is arbitrary.
+ *
  *  @see vrna_subopt_callback, vrna_subopt(), vrna_subopt_zuker()
  *  @param  vc      fold compount with the sequence data
  *  @param  delta   Energy band arround the MFE in 10cal/mol, i.e. deka-calories
@@ -164,6 +168,78 @@ vrna_subopt_cb( vrna_fold_compound_t *vc,
                 vrna_subopt_callback *cb,
                 void *data);
 
+
+/**
+ *  @brief  Generate suboptimal structures within an energy band arround the MFE with bounded memory
+ *
+ *  Similar to vrna_subopt_cb(), this function passes all secondary structures within an
+ *  energy band @p delta arround the MFE to a user-provided callback function, and indicates
+ *  the end of the enumeration by passing NULL instead of a dot-bracket string. Additionally,
+ *  the enumeration can be limited to a maximum number of structures, and the memory used for
+ *  the enumeration can be bounded.
+ *
+ *  If the structures are requested in sorted order, they are collected in memory until the
+ *  limit @p max_memory is exceeded. The collected structures are then sorted and written to
+ *  a temporary file. After the enumeration, all sorted temporary files are merged and the
+ *  structures are passed to the callback in the requested order. Thus, even large sets of
+ *  suboptimal structures can be sorted without exhausting the available RAM.
+ *
+ *  If the backtracking stack alone exceeds @p max_memory, or the maximum number of structures
+ *  @p max_structures is reached, the enumeration stops and all structures obtained so far
+ *  are passed to the callback.
+ *
+ *  @ingroup subopt_wuchty
+ *
+ *  @note Memory consumption is only estimated. It does not include the dynamic programming
+ *        matrices required for the enumeration.
+ *
+ *  @note In sorted mode, @p max_structures limits the number of structures that are
+ *        enumerated, not the number of structures with lowest free energy.
+ *
+ *  @see vrna_subopt_cb(), vrna_subopt(), #VRNA_SORT_BY_ENERGY_ASC, #VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC
+ *
+ *  @param  fc              fold compound with the sequence data
+ *  @param  delta           Energy band arround the MFE in 10cal/mol, i.e. deka-calories
+ *  @param  sorted          Order of the structures, i.e. #VRNA_UNSORTED, #VRNA_SORT_BY_ENERGY_ASC, or #VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC
+ *  @param  max_structures  Maximum number of structures to enumerate (0 for no limit)
+ *  @param  max_memory      Approximate memory limit in bytes (0 for no limit)
+ *  @param  cb              Pointer to a callback function that handles the backtracked structure and its free energy in kcal/mol
+ *  @param  data            Pointer to some data structure that is passed along to the callback
+ *  @return                 1 if all structures have been enumerated, 0 if the enumeration stopped prematurely
+ */
+int
+vrna_subopt_stream(vrna_fold_compound_t *fc,
+                   int                  delta,
+                   int                  sorted,
+                   unsigned int         max_structures,
+                   size_t               max_memory,
+                   vrna_subopt_callback *cb,
+                   void                 *data);
+
+
+/**
+ *  @brief  Compose the first line of the suboptimal structure output
+ *
+ *  Predicts the MFE for the sequence(s) in @p fc and returns the sequence, including the
+ *  cut point of multi-strand fold compounds, that precedes the list of suboptimal structures
+ *  in the output of vrna_subopt(). The MFE and the energy band @p delta are formatted into
+ *  a newly allocated string stored at @p energies. Both strings must be free'd afterwards.
+ *
+ *  @ingroup subopt_wuchty
+ *
+ *  @see vrna_subopt(), vrna_subopt_stream()
+ *
+ *  @param  fc        fold compound with the sequence data
+ *  @param  delta     Energy band arround the MFE in 10cal/mol, i.e. deka-calories
+ *  @param  energies  A pointer to store the formatted MFE and energy band
+ *  @return           The sequence, or @p NULL on error
+ */
+char *
+vrna_subopt_header(vrna_fold_compound_t *fc,
+                   int                  delta,
+                   char                 **energies);
+
+
 /**
  *  @brief Compute Zuker type suboptimal structures
  *
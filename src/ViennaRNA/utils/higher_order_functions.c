@@ -15,6 +15,22 @@ typedef int (proto_fun_zip_reduce)(const int  *a,
                                    int        size);
 
 
+typedef int (proto_fun_zip_reduce_pos)(const int *a,
+                                       const int *b,
+                                       int       size,
+                                       int       *pos);
+
+
+typedef FLT_OR_DBL (proto_fun_zip_reduce_fp)(const FLT_OR_DBL *a,
+                                             const FLT_OR_DBL *b,
+                                             int              size);
+
+
+typedef float (proto_fun_zip_reduce_flt)(const float  *a,
+                                         const float  *b,
+                                         int          size);
+
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -25,12 +41,58 @@ static int zip_add_min_dispatcher(const int *a,
                                   int       size);
 
 
+static int zip_add_argmin_dispatcher(const int  *a,
+                                     const int  *b,
+                                     int        size,
+                                     int        *pos);
+
+
+static FLT_OR_DBL zip_mult_sum_dispatcher(const FLT_OR_DBL  *a,
+                                          const FLT_OR_DBL  *b,
+                                          int               size);
+
+
+static FLT_OR_DBL zip_mult_sum_rev_dispatcher(const FLT_OR_DBL  *a,
+                                              const FLT_OR_DBL  *b,
+                                              int               size);
+
+
+static float zip_mult_sum_float_dispatcher(const float  *a,
+                                           const float  *b,
+                                           int          size);
+
+
 static int
 fun_zip_add_min_default(const int *e1,
                         const int *e2,
                         int       count);
 
 
+static int
+fun_zip_add_argmin_default(const int  *e1,
+                           const int  *e2,
+                           int        count,
+                           int        *pos);
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_default(const FLT_OR_DBL *e1,
+                         const FLT_OR_DBL *e2,
+                         int              count);
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_rev_default(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count);
+
+
+static float
+fun_zip_mult_sum_float_default(const float  *e1,
+                               const float  *e2,
+                               int          count);
+
+
 #if VRNA_WITH_SIMD_AVX512
 int
 vrna_fun_zip_add_min_avx512(const int *e1,
@@ -38,6 +100,65 @@ vrna_fun_zip_add_min_avx512(const int *e1,
                             int       count);
 
 
+int
+vrna_fun_zip_add_argmin_avx512(const int  *e1,
+                               const int  *e2,
+                               int        count,
+                               int        *pos);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx512(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx512(const FLT_OR_DBL *e1,
+                                 const FLT_OR_DBL *e2,
+                                 int              count);
+
+
+float
+vrna_fun_zip_mult_sum_float_avx512(const float *e1,
+                                   const float *e2,
+                                   int         count);
+
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+int
+vrna_fun_zip_add_min_avx2(const int *e1,
+                          const int *e2,
+                          int       count);
+
+
+int
+vrna_fun_zip_add_argmin_avx2(const int  *e1,
+                             const int  *e2,
+                             int        count,
+                             int        *pos);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count);
+
+
+float
+vrna_fun_zip_mult_sum_float_avx2(const float *e1,
+                                 const float *e2,
+                                 int         count);
+
+
 #endif
 
 #if VRNA_WITH_SIMD_SSE41
@@ -47,10 +168,39 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
                            int        count);
 
 
+int
+vrna_fun_zip_add_argmin_sse41(const int *e1,
+                              const int *e2,
+                              int       count,
+                              int       *pos);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_sse41(const FLT_OR_DBL *e1,
+                            const FLT_OR_DBL *e2,
+                            int              count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_sse41(const FLT_OR_DBL *e1,
+                                const FLT_OR_DBL *e2,
+                                int              count);
+
+
+float
+vrna_fun_zip_mult_sum_float_sse41(const float *e1,
+                                  const float *e2,
+                                  int         count);
+
+
 #endif
 
 
-static proto_fun_zip_reduce *fun_zip_add_min = &zip_add_min_dispatcher;
+static proto_fun_zip_reduce     *fun_zip_add_min    = &zip_add_min_dispatcher;
+static proto_fun_zip_reduce_pos *fun_zip_add_argmin = &zip_add_argmin_dispatcher;
+static proto_fun_zip_reduce_fp  *fun_zip_mult_sum     = &zip_mult_sum_dispatcher;
+static proto_fun_zip_reduce_fp  *fun_zip_mult_sum_rev = &zip_mult_sum_rev_dispatcher;
+static proto_fun_zip_reduce_flt *fun_zip_mult_sum_flt = &zip_mult_sum_float_dispatcher;
 
 
 /*
@@ -61,14 +211,22 @@ static proto_fun_zip_reduce *fun_zip_add_min = &zip_add_min_dispatcher;
 PUBLIC void
 vrna_fun_dispatch_disable(void)
 {
-  fun_zip_add_min = &fun_zip_add_min_default;
+  fun_zip_add_min       = &fun_zip_add_min_default;
+  fun_zip_add_argmin    = &fun_zip_add_argmin_default;
+  fun_zip_mult_sum      = &fun_zip_mult_sum_default;
+  fun_zip_mult_sum_rev  = &fun_zip_mult_sum_rev_default;
+  fun_zip_mult_sum_flt  = &fun_zip_mult_sum_float_default;
 }
 
 
 PUBLIC void
 vrna_fun_dispatch_enable(void)
 {
-  fun_zip_add_min = &zip_add_min_dispatcher;
+  fun_zip_add_min       = &zip_add_min_dispatcher;
+  fun_zip_add_argmin    = &zip_add_argmin_dispatcher;
+  fun_zip_mult_sum      = &zip_mult_sum_dispatcher;
+  fun_zip_mult_sum_rev  = &zip_mult_sum_rev_dispatcher;
+  fun_zip_mult_sum_flt  = &zip_mult_sum_float_dispatcher;
 }
 
 
@@ -81,6 +239,43 @@ vrna_fun_zip_add_min(const int  *e1,
 }
 
 
+PUBLIC int
+vrna_fun_zip_add_argmin(const int *e1,
+                        const int *e2,
+                        int       count,
+                        int       *pos)
+{
+  return (*fun_zip_add_argmin)(e1, e2, count, pos);
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum(const FLT_OR_DBL  *e1,
+                      const FLT_OR_DBL  *e2,
+                      int               count)
+{
+  return (*fun_zip_mult_sum)(e1, e2, count);
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev(const FLT_OR_DBL  *e1,
+                          const FLT_OR_DBL  *e2,
+                          int               count)
+{
+  return (*fun_zip_mult_sum_rev)(e1, e2, count);
+}
+
+
+PUBLIC float
+vrna_fun_zip_mult_sum_float(const float *e1,
+                            const float *e2,
+                            int         count)
+{
+  return (*fun_zip_mult_sum_flt)(e1, e2, count);
+}
+
+
 /*
  #################################
  # STATIC helper functions below #
@@ -103,6 +298,14 @@ zip_add_min_dispatcher(const int  *a,
 
 #endif
 
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_min = &vrna_fun_zip_add_min_avx2;
+    goto exec_fun_zip_add_min;
+  }
+
+#endif
+
 #if VRNA_WITH_SIMD_SSE41
   if (features & VRNA_CPU_SIMD_SSE41) {
     fun_zip_add_min = &vrna_fun_zip_add_min_sse41;
@@ -119,6 +322,167 @@ exec_fun_zip_add_min:
 }
 
 
+/* zip_add_argmin() dispatcher */
+static int
+zip_add_argmin_dispatcher(const int *a,
+                          const int *b,
+                          int       size,
+                          int       *pos)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_add_argmin = &vrna_fun_zip_add_argmin_avx512;
+    goto exec_fun_zip_add_argmin;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_argmin = &vrna_fun_zip_add_argmin_avx2;
+    goto exec_fun_zip_add_argmin;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_zip_add_argmin = &vrna_fun_zip_add_argmin_sse41;
+    goto exec_fun_zip_add_argmin;
+  }
+
+#endif
+
+  fun_zip_add_argmin = &fun_zip_add_argmin_default;
+
+exec_fun_zip_add_argmin:
+
+  return (*fun_zip_add_argmin)(a, b, size, pos);
+}
+
+
+/* zip_mult_sum() dispatcher */
+static FLT_OR_DBL
+zip_mult_sum_dispatcher(const FLT_OR_DBL *a,
+                        const FLT_OR_DBL *b,
+                        int              size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_mult_sum = &vrna_fun_zip_mult_sum_avx512;
+    goto exec_fun_zip_mult_sum;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_mult_sum = &vrna_fun_zip_mult_sum_avx2;
+    goto exec_fun_zip_mult_sum;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_zip_mult_sum = &vrna_fun_zip_mult_sum_sse41;
+    goto exec_fun_zip_mult_sum;
+  }
+
+#endif
+
+  fun_zip_mult_sum = &fun_zip_mult_sum_default;
+
+exec_fun_zip_mult_sum:
+
+  return (*fun_zip_mult_sum)(a, b, size);
+}
+
+
+/* zip_mult_sum_rev() dispatcher */
+static FLT_OR_DBL
+zip_mult_sum_rev_dispatcher(const FLT_OR_DBL *a,
+                            const FLT_OR_DBL *b,
+                            int              size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_mult_sum_rev = &vrna_fun_zip_mult_sum_rev_avx512;
+    goto exec_fun_zip_mult_sum_rev;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_mult_sum_rev = &vrna_fun_zip_mult_sum_rev_avx2;
+    goto exec_fun_zip_mult_sum_rev;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_zip_mult_sum_rev = &vrna_fun_zip_mult_sum_rev_sse41;
+    goto exec_fun_zip_mult_sum_rev;
+  }
+
+#endif
+
+  fun_zip_mult_sum_rev = &fun_zip_mult_sum_rev_default;
+
+exec_fun_zip_mult_sum_rev:
+
+  return (*fun_zip_mult_sum_rev)(a, b, size);
+}
+
+
+/* zip_mult_sum_float() dispatcher */
+static float
+zip_mult_sum_float_dispatcher(const float *a,
+                              const float *b,
+                              int         size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_mult_sum_flt = &vrna_fun_zip_mult_sum_float_avx512;
+    goto exec_fun_zip_mult_sum_flt;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_mult_sum_flt = &vrna_fun_zip_mult_sum_float_avx2;
+    goto exec_fun_zip_mult_sum_flt;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_zip_mult_sum_flt = &vrna_fun_zip_mult_sum_float_sse41;
+    goto exec_fun_zip_mult_sum_flt;
+  }
+
+#endif
+
+  fun_zip_mult_sum_flt = &fun_zip_mult_sum_float_default;
+
+exec_fun_zip_mult_sum_flt:
+
+  return (*fun_zip_mult_sum_flt)(a, b, size);
+}
+
+
 static int
 fun_zip_add_min_default(const int *e1,
                         const int *e2,
@@ -136,3 +500,74 @@ fun_zip_add_min_default(const int *e1,
 
   return decomp;
 }
+
+
+static int
+fun_zip_add_argmin_default(const int  *e1,
+                           const int  *e2,
+                           int        count,
+                           int        *pos)
+{
+  int i, p;
+  int decomp = INF;
+
+  for (p = -1, i = 0; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        p       = i;
+      }
+    }
+  }
+
+  if (pos)
+    *pos = p;
+
+  return decomp;
+}
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_default(const FLT_OR_DBL *e1,
+                         const FLT_OR_DBL *e2,
+                         int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum = 0.;
+
+  for (i = 0; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_rev_default(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum = 0.;
+
+  for (i = 0; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
+
+
+static float
+fun_zip_mult_sum_float_default(const float  *e1,
+                               const float  *e2,
+                               int          count)
+{
+  int   i;
+  float sum = 0.;
+
+  for (i = 0; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
@@ -0,0 +1,277 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "ViennaRNA/utils/basic.h"
+
+#include <immintrin.h>
+
+static int
+horizontal_min_Vec8i(__m256i x);
+
+
+static float
+horizontal_sum_Vec8f(__m256 x);
+
+
+#ifndef USE_FLOAT_PF
+static FLT_OR_DBL
+horizontal_sum_Vec4d(__m256d x);
+
+
+#endif
+
+
+PUBLIC int
+vrna_fun_zip_add_min_avx2(const int *e1,
+                          const int *e2,
+                          int       count)
+{
+  int     i       = 0;
+  int     decomp  = INF;
+
+  __m256i inf = _mm256_set1_epi32(INF);
+  __m256i res = inf;
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256i a = _mm256_loadu_si256((__m256i *)&e1[i]);
+    __m256i b = _mm256_loadu_si256((__m256i *)&e2[i]);
+    __m256i c = _mm256_add_epi32(a, b);
+
+    /* create mask for non-INF values */
+    __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi32(inf, a),
+                                    _mm256_cmpgt_epi32(inf, b));
+
+    /* replace results where a or b has been INF before by INF */
+    c = _mm256_blendv_epi8(inf, c, mask);
+
+    /* keep track of minimum in each lane */
+    res = _mm256_min_epi32(res, c);
+  }
+
+  decomp = horizontal_min_Vec8i(res);
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_argmin_avx2(const int  *e1,
+                             const int  *e2,
+                             int        count,
+                             int        *pos)
+{
+  int     i, k, decomp, p, lane_min[8], lane_pos[8];
+
+  __m256i inf     = _mm256_set1_epi32(INF);
+  __m256i res     = inf;
+  __m256i res_pos = _mm256_set1_epi32(-1);
+  __m256i idx     = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256i step    = _mm256_set1_epi32(8);
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256i a = _mm256_loadu_si256((__m256i *)&e1[i]);
+    __m256i b = _mm256_loadu_si256((__m256i *)&e2[i]);
+    __m256i c = _mm256_add_epi32(a, b);
+
+    __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi32(inf, a),
+                                    _mm256_cmpgt_epi32(inf, b));
+
+    c = _mm256_blendv_epi8(inf, c, mask);
+
+    /*
+     *  only replace the lane minimum on strict improvement, such that
+     *  each lane keeps the first position of its minimum
+     */
+    __m256i lt = _mm256_cmpgt_epi32(res, c);
+    res     = _mm256_blendv_epi8(res, c, lt);
+    res_pos = _mm256_blendv_epi8(res_pos, idx, lt);
+    idx     = _mm256_add_epi32(idx, step);
+  }
+
+  _mm256_storeu_si256((__m256i *)&lane_min[0], res);
+  _mm256_storeu_si256((__m256i *)&lane_pos[0], res_pos);
+
+  decomp  = INF;
+  p       = -1;
+
+  for (k = 0; k < 8; k++) {
+    if ((lane_min[k] < decomp) ||
+        ((lane_min[k] == decomp) && (lane_min[k] != INF) && (lane_pos[k] < p))) {
+      decomp  = lane_min[k];
+      p       = lane_pos[k];
+    }
+  }
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        p       = i;
+      }
+    }
+  }
+
+  if (pos)
+    *pos = p;
+
+  return decomp;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count)
+{
+  int         i = 0;
+  FLT_OR_DBL  sum;
+
+#ifdef USE_FLOAT_PF
+  __m256      acc1  = _mm256_setzero_ps();
+  __m256      acc2  = _mm256_setzero_ps();
+
+  for (; i < count - 15; i += 16) {
+    acc1  = _mm256_add_ps(acc1,
+                          _mm256_mul_ps(_mm256_loadu_ps(&e1[i]), _mm256_loadu_ps(&e2[i])));
+    acc2  = _mm256_add_ps(acc2,
+                          _mm256_mul_ps(_mm256_loadu_ps(&e1[i + 8]), _mm256_loadu_ps(&e2[i + 8])));
+  }
+
+  sum = horizontal_sum_Vec8f(_mm256_add_ps(acc1, acc2));
+#else
+  __m256d     acc1  = _mm256_setzero_pd();
+  __m256d     acc2  = _mm256_setzero_pd();
+
+  for (; i < count - 7; i += 8) {
+    acc1  = _mm256_add_pd(acc1,
+                          _mm256_mul_pd(_mm256_loadu_pd(&e1[i]), _mm256_loadu_pd(&e2[i])));
+    acc2  = _mm256_add_pd(acc2,
+                          _mm256_mul_pd(_mm256_loadu_pd(&e1[i + 4]), _mm256_loadu_pd(&e2[i + 4])));
+  }
+
+  sum = horizontal_sum_Vec4d(_mm256_add_pd(acc1, acc2));
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count)
+{
+  int         i = 0;
+  FLT_OR_DBL  sum;
+
+  /* e1 is read in forward, e2 in backward direction, i.e. e2[count - 1 - i] */
+#ifdef USE_FLOAT_PF
+  __m256      acc = _mm256_setzero_ps();
+  __m256i     rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+  for (; i < count - 7; i += 8) {
+    __m256  a = _mm256_loadu_ps(&e1[i]);
+    __m256  b = _mm256_permutevar8x32_ps(_mm256_loadu_ps(&e2[count - 8 - i]), rev);
+
+    acc = _mm256_add_ps(acc, _mm256_mul_ps(a, b));
+  }
+
+  sum = horizontal_sum_Vec8f(acc);
+#else
+  __m256d     acc = _mm256_setzero_pd();
+
+  for (; i < count - 3; i += 4) {
+    __m256d a = _mm256_loadu_pd(&e1[i]);
+    __m256d b = _mm256_permute4x64_pd(_mm256_loadu_pd(&e2[count - 4 - i]),
+                                      _MM_SHUFFLE(0, 1, 2, 3));
+
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(a, b));
+  }
+
+  sum = horizontal_sum_Vec4d(acc);
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
+
+PUBLIC float
+vrna_fun_zip_mult_sum_float_avx2(const float  *e1,
+                                 const float  *e2,
+                                 int          count)
+{
+  int     i     = 0;
+  float   sum;
+  __m256  acc1  = _mm256_setzero_ps();
+  __m256  acc2  = _mm256_setzero_ps();
+
+  for (; i < count - 15; i += 16) {
+    acc1  = _mm256_add_ps(acc1,
+                          _mm256_mul_ps(_mm256_loadu_ps(&e1[i]), _mm256_loadu_ps(&e2[i])));
+    acc2  = _mm256_add_ps(acc2,
+                          _mm256_mul_ps(_mm256_loadu_ps(&e1[i + 8]), _mm256_loadu_ps(&e2[i + 8])));
+  }
+
+  sum = horizontal_sum_Vec8f(_mm256_add_ps(acc1, acc2));
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+static int
+horizontal_min_Vec8i(__m256i x)
+{
+  __m128i lo    = _mm256_castsi256_si128(x);
+  __m128i hi    = _mm256_extracti128_si256(x, 1);
+  __m128i min1  = _mm_min_epi32(lo, hi);
+  __m128i min2  = _mm_min_epi32(min1, _mm_shuffle_epi32(min1, _MM_SHUFFLE(0, 0, 3, 2)));
+  __m128i min3  = _mm_min_epi32(min2, _mm_shuffle_epi32(min2, _MM_SHUFFLE(0, 0, 0, 1)));
+
+  return _mm_cvtsi128_si32(min3);
+}
+
+
+static float
+horizontal_sum_Vec8f(__m256 x)
+{
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+
+  return _mm_cvtss_f32(sum);
+}
+
+
+#ifndef USE_FLOAT_PF
+static FLT_OR_DBL
+horizontal_sum_Vec4d(__m256d x)
+{
+  __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+
+  return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+
+#endif
@@ -48,3 +48,159 @@ vrna_fun_zip_add_min_avx512(const int *e1,
 
   return decomp;
 }
+
+
+PUBLIC int
+vrna_fun_zip_add_argmin_avx512(const int  *e1,
+                               const int  *e2,
+                               int        count,
+                               int        *pos)
+{
+  int     i, k, decomp, p, lane_min[16], lane_pos[16];
+
+  __m512i inf     = _mm512_set1_epi32(INF);
+  __m512i res     = inf;
+  __m512i res_pos = _mm512_set1_epi32(-1);
+  __m512i idx     = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  __m512i step    = _mm512_set1_epi32(16);
+
+  for (i = 0; i < count - 15; i += 16) {
+    __m512i   a = _mm512_loadu_si512((__m512i *)&e1[i]);
+    __m512i   b = _mm512_loadu_si512((__m512i *)&e2[i]);
+
+    /* compute mask for entries where both, a and b, are less than INF */
+    __mmask16 mask = _kand_mask16(_mm512_cmplt_epi32_mask(a, inf),
+                                  _mm512_cmplt_epi32_mask(b, inf));
+
+    __m512i   c = _mm512_add_epi32(a, b);
+
+    /*
+     *  only replace the lane minimum on strict improvement, such that
+     *  each lane keeps the first position of its minimum
+     */
+    __mmask16 lt = _kand_mask16(mask, _mm512_cmplt_epi32_mask(c, res));
+
+    res     = _mm512_mask_mov_epi32(res, lt, c);
+    res_pos = _mm512_mask_mov_epi32(res_pos, lt, idx);
+    idx     = _mm512_add_epi32(idx, step);
+  }
+
+  _mm512_storeu_si512((void *)&lane_min[0], res);
+  _mm512_storeu_si512((void *)&lane_pos[0], res_pos);
+
+  decomp  = INF;
+  p       = -1;
+
+  for (k = 0; k < 16; k++) {
+    if ((lane_min[k] < decomp) ||
+        ((lane_min[k] == decomp) && (lane_min[k] != INF) && (lane_pos[k] < p))) {
+      decomp  = lane_min[k];
+      p       = lane_pos[k];
+    }
+  }
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        p       = i;
+      }
+    }
+  }
+
+  if (pos)
+    *pos = p;
+
+  return decomp;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx512(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count)
+{
+  int         i = 0;
+  FLT_OR_DBL  sum;
+
+#ifdef USE_FLOAT_PF
+  __m512      acc = _mm512_setzero_ps();
+
+  for (; i < count - 15; i += 16)
+    acc = _mm512_fmadd_ps(_mm512_loadu_ps(&e1[i]), _mm512_loadu_ps(&e2[i]), acc);
+
+  sum = _mm512_reduce_add_ps(acc);
+#else
+  __m512d     acc = _mm512_setzero_pd();
+
+  for (; i < count - 7; i += 8)
+    acc = _mm512_fmadd_pd(_mm512_loadu_pd(&e1[i]), _mm512_loadu_pd(&e2[i]), acc);
+
+  sum = _mm512_reduce_add_pd(acc);
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx512(const FLT_OR_DBL *e1,
+                                 const FLT_OR_DBL *e2,
+                                 int              count)
+{
+  int         i = 0;
+  FLT_OR_DBL  sum;
+
+  /* e1 is read in forward, e2 in backward direction, i.e. e2[count - 1 - i] */
+#ifdef USE_FLOAT_PF
+  __m512      acc = _mm512_setzero_ps();
+  __m512i     rev = _mm512_set_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+  for (; i < count - 15; i += 16) {
+    __m512 b = _mm512_permutexvar_ps(rev, _mm512_loadu_ps(&e2[count - 16 - i]));
+    acc = _mm512_fmadd_ps(_mm512_loadu_ps(&e1[i]), b, acc);
+  }
+
+  sum = _mm512_reduce_add_ps(acc);
+#else
+  __m512d     acc = _mm512_setzero_pd();
+  __m512i     rev = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+
+  for (; i < count - 7; i += 8) {
+    __m512d b = _mm512_permutexvar_pd(rev, _mm512_loadu_pd(&e2[count - 8 - i]));
+    acc = _mm512_fmadd_pd(_mm512_loadu_pd(&e1[i]), b, acc);
+  }
+
+  sum = _mm512_reduce_add_pd(acc);
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
+
+
+PUBLIC float
+vrna_fun_zip_mult_sum_float_avx512(const float  *e1,
+                                   const float  *e2,
+                                   int          count)
+{
+  int     i   = 0;
+  float   sum;
+  __m512  acc = _mm512_setzero_ps();
+
+  for (; i < count - 15; i += 16)
+    acc = _mm512_fmadd_ps(_mm512_loadu_ps(&e1[i]), _mm512_loadu_ps(&e2[i]), acc);
+
+  sum = _mm512_reduce_add_ps(acc);
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
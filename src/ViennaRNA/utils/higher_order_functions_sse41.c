@@ -15,6 +15,18 @@ static int
 horizontal_min_Vec4i(__m128i x);
 
 
+static float
+horizontal_sum_Vec4f(__m128 x);
+
+
+#ifndef USE_FLOAT_PF
+static FLT_OR_DBL
+horizontal_sum_Vec2d(__m128d x);
+
+
+#endif
+
+
 PUBLIC int
 vrna_fun_zip_add_min_sse41(const int  *e1,
                            const int  *e2,
@@ -55,6 +67,173 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
 }
 
 
+PUBLIC int
+vrna_fun_zip_add_argmin_sse41(const int *e1,
+                              const int *e2,
+                              int       count,
+                              int       *pos)
+{
+  int     i, k, decomp, p, lane_min[4], lane_pos[4];
+
+  __m128i inf     = _mm_set1_epi32(INF);
+  __m128i res     = inf;
+  __m128i res_pos = _mm_set1_epi32(-1);
+  __m128i idx     = _mm_setr_epi32(0, 1, 2, 3);
+  __m128i step    = _mm_set1_epi32(4);
+
+  for (i = 0; i < count - 3; i += 4) {
+    __m128i a = _mm_loadu_si128((__m128i *)&e1[i]);
+    __m128i b = _mm_loadu_si128((__m128i *)&e2[i]);
+    __m128i c = _mm_add_epi32(a, b);
+
+    __m128i mask = _mm_and_si128(_mm_cmplt_epi32(a, inf),
+                                 _mm_cmplt_epi32(b, inf));
+
+    c = _mm_blendv_epi8(inf, c, mask);
+
+    /*
+     *  only replace the lane minimum on strict improvement, such that
+     *  each lane keeps the first position of its minimum
+     */
+    __m128i lt = _mm_cmplt_epi32(c, res);
+    res     = _mm_blendv_epi8(res, c, lt);
+    res_pos = _mm_blendv_epi8(res_pos, idx, lt);
+    idx     = _mm_add_epi32(idx, step);
+  }
+
+  _mm_storeu_si128((__m128i *)&lane_min[0], res);
+  _mm_storeu_si128((__m128i *)&lane_pos[0], res_pos);
+
+  decomp  = INF;
+  p       = -1;
+
+  for (k = 0; k < 4; k++) {
+    if ((lane_min[k] < decomp) ||
+        ((lane_min[k] == decomp) && (lane_min[k] != INF) && (lane_pos[k] < p))) {
+      decomp  = lane_min[k];
+      p       = lane_pos[k];
+    }
+  }
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        p       = i;
+      }
+    }
+  }
+
+  if (pos)
+    *pos = p;
+
+  return decomp;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_sse41(const FLT_OR_DBL  *e1,
+                            const FLT_OR_DBL  *e2,
+                            int               count)
+{
+  int         i = 0;
+  FLT_OR_DBL  sum;
+
+#ifdef USE_FLOAT_PF
+  __m128      acc1  = _mm_setzero_ps();
+  __m128      acc2  = _mm_setzero_ps();
+
+  for (; i < count - 7; i += 8) {
+    acc1  = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&e1[i]), _mm_loadu_ps(&e2[i])));
+    acc2  = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(&e1[i + 4]), _mm_loadu_ps(&e2[i + 4])));
+  }
+
+  sum = horizontal_sum_Vec4f(_mm_add_ps(acc1, acc2));
+#else
+  __m128d     acc1  = _mm_setzero_pd();
+  __m128d     acc2  = _mm_setzero_pd();
+
+  for (; i < count - 3; i += 4) {
+    acc1  = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(&e1[i]), _mm_loadu_pd(&e2[i])));
+    acc2  = _mm_add_pd(acc2, _mm_mul_pd(_mm_loadu_pd(&e1[i + 2]), _mm_loadu_pd(&e2[i + 2])));
+  }
+
+  sum = horizontal_sum_Vec2d(_mm_add_pd(acc1, acc2));
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_sse41(const FLT_OR_DBL  *e1,
+                                const FLT_OR_DBL  *e2,
+                                int               count)
+{
+  int         i = 0;
+  FLT_OR_DBL  sum;
+
+  /* e1 is read in forward, e2 in backward direction, i.e. e2[count - 1 - i] */
+#ifdef USE_FLOAT_PF
+  __m128      acc = _mm_setzero_ps();
+
+  for (; i < count - 3; i += 4) {
+    __m128  a = _mm_loadu_ps(&e1[i]);
+    __m128  b = _mm_loadu_ps(&e2[count - 4 - i]);
+
+    b   = _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3));
+    acc = _mm_add_ps(acc, _mm_mul_ps(a, b));
+  }
+
+  sum = horizontal_sum_Vec4f(acc);
+#else
+  __m128d     acc = _mm_setzero_pd();
+
+  for (; i < count - 1; i += 2) {
+    __m128d a = _mm_loadu_pd(&e1[i]);
+    __m128d b = _mm_loadu_pd(&e2[count - 2 - i]);
+
+    b   = _mm_shuffle_pd(b, b, 1);
+    acc = _mm_add_pd(acc, _mm_mul_pd(a, b));
+  }
+
+  sum = horizontal_sum_Vec2d(acc);
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
+
+PUBLIC float
+vrna_fun_zip_mult_sum_float_sse41(const float *e1,
+                                  const float *e2,
+                                  int         count)
+{
+  int     i     = 0;
+  float   sum;
+  __m128  acc1  = _mm_setzero_ps();
+  __m128  acc2  = _mm_setzero_ps();
+
+  for (; i < count - 7; i += 8) {
+    acc1  = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&e1[i]), _mm_loadu_ps(&e2[i])));
+    acc2  = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(&e1[i + 4]), _mm_loadu_ps(&e2[i + 4])));
+  }
+
+  sum = horizontal_sum_Vec4f(_mm_add_ps(acc1, acc2));
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
 /*
  *  SSE minimum
  *  see also: http://stackoverflow.com/questions/9877700/getting-max-value-in-a-m128i-vector-with-sse
@@ -69,3 +248,24 @@ horizontal_min_Vec4i(__m128i x)
 
   return _mm_cvtsi128_si32(min4);
 }
+
+
+static float
+horizontal_sum_Vec4f(__m128 x)
+{
+  x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+  x = _mm_add_ss(x, _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1)));
+
+  return _mm_cvtss_f32(x);
+}
+
+
+#ifndef USE_FLOAT_PF
+static FLT_OR_DBL
+horizontal_sum_Vec2d(__m128d x)
+{
+  return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+}
+
+
+#endif
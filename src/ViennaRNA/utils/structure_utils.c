@@ -153,6 +153,154 @@ vrna_db_unpack(const char *packed)
 }
 
 
+PUBLIC unsigned int
+vrna_pt_pack_size(unsigned int length)
+{
+  /* hash, length, and 32 nucleotides per word */
+  return 2 + (length + 31) / 32;
+}
+
+
+PUBLIC uint64_t *
+vrna_pt_pack(const short *pt)
+{
+  /* 2 bits per nucleotide, '.' = 0, '(' = 1, ')' = 2 */
+  unsigned int  i, n;
+  uint64_t      *packed, c, hash;
+
+  if (!pt)
+    return NULL;
+
+  n       = (unsigned int)pt[0];
+  packed  = (uint64_t *)vrna_alloc(sizeof(uint64_t) * vrna_pt_pack_size(n));
+  hash    = 0;
+
+  for (i = 1; i <= n; i++) {
+    if (pt[i] == 0) {
+      continue;
+    } else if ((unsigned int)pt[i] > i) {
+      c     = 1;
+      hash  ^= vrna_bp_zobrist(i, pt[i]);
+    } else {
+      c = 2;
+    }
+
+    packed[2 + (i - 1) / 32] |= c << (2 * ((i - 1) % 32));
+  }
+
+  packed[0] = hash;
+  packed[1] = (uint64_t)n;
+
+  return packed;
+}
+
+
+PUBLIC short *
+vrna_pt_unpack(const uint64_t *packed)
+{
+  unsigned int  i, n, c, sp, *stack;
+  short         *pt;
+
+  if (!packed)
+    return NULL;
+
+  n     = (unsigned int)packed[1];
+  pt    = (short *)vrna_alloc(sizeof(short) * (n + 2));
+  stack = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (n + 1));
+  pt[0] = (short)n;
+
+  for (sp = 0, i = 1; i <= n; i++) {
+    c = (unsigned int)((packed[2 + (i - 1) / 32] >> (2 * ((i - 1) % 32))) & 3);
+    if (c == 1) {
+      stack[sp++] = i;
+    } else if ((c == 2) && (sp > 0)) {
+      sp--;
+      pt[i]         = (short)stack[sp];
+      pt[stack[sp]] = (short)i;
+    }
+  }
+
+  free(stack);
+
+  return pt;
+}
+
+
+PUBLIC int
+vrna_pt_pack_cmp(const uint64_t *a,
+                 const uint64_t *b)
+{
+  unsigned int i, size;
+
+  if (a[0] != b[0])
+    return (a[0] < b[0]) ? -1 : 1;
+
+  if (a[1] != b[1])
+    return (a[1] < b[1]) ? -1 : 1;
+
+  size = vrna_pt_pack_size((unsigned int)a[1]);
+
+  for (i = 2; i < size; i++)
+    if (a[i] != b[i])
+      return (a[i] < b[i]) ? -1 : 1;
+
+  return 0;
+}
+
+
+PUBLIC void
+vrna_pt_pack_toggle(uint64_t  *packed,
+                    int       i,
+                    int       j)
+{
+  int k;
+
+  if ((!packed) || (i == j))
+    return;
+
+  if (i > j) {
+    k = i;
+    i = j;
+    j = k;
+  }
+
+  /* the codes of an opening and a closing bracket are flipped from and to '.' by XOR */
+  packed[0]                 ^= vrna_bp_zobrist(i, j);
+  packed[2 + (i - 1) / 32]  ^= (uint64_t)1 << (2 * ((i - 1) % 32));
+  packed[2 + (j - 1) / 32]  ^= (uint64_t)2 << (2 * ((j - 1) % 32));
+}
+
+
+PUBLIC uint64_t
+vrna_pt_zobrist(const short *pt)
+{
+  int       i;
+  uint64_t  hash = 0;
+
+  if (pt)
+    for (i = 1; i <= pt[0]; i++)
+      if (pt[i] > i)
+        hash ^= vrna_bp_zobrist(i, pt[i]);
+
+  return hash;
+}
+
+
+PUBLIC uint64_t
+vrna_bp_zobrist(int i,
+                int j)
+{
+  /* splitmix64 of the pair (i, j), i.e. no look-up table is required */
+  uint64_t x = ((uint64_t)(unsigned int)i << 32) | (uint64_t)(unsigned int)j;
+
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+
+  return x ^ (x >> 31);
+}
+
+
 PUBLIC short *
 vrna_ptable(const char *structure)
 {
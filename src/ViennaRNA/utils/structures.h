@@ -14,6 +14,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdint.h>
 
 #include <ViennaRNA/datastructures/basic.h>
 
@@ -151,6 +152,125 @@ char *
 vrna_db_unpack(const char *packed);
 
 
+/**
+ *  @brief Pack a secondary structure into a compact, canonical key
+ *
+ *  Encodes the pseudo-knot free structure given as pair table @p pt using
+ *  2 bits per nucleotide. The resulting array of 64bit words starts with
+ *  the Zobrist hash of the structure (see vrna_pt_zobrist()) followed by
+ *  the length of the structure and the actual encoding. All unused bits
+ *  are 0, such that two keys are equal if and only if they encode the same
+ *  structure. Hence, keys are well suited to store large sets of structures,
+ *  e.g. visited sets in energy landscape explorations, and the first word
+ *  can directly serve as hash value.
+ *
+ *  @see  vrna_pt_unpack(), vrna_pt_pack_size(), vrna_pt_pack_cmp(), vrna_pt_zobrist(),
+ *        vrna_ht_pk_hash_func()
+ *
+ *  @param  pt  The pair table of the secondary structure
+ *  @return     The packed structure key
+ */
+uint64_t *
+vrna_pt_pack(const short *pt);
+
+
+/**
+ *  @brief Unpack a secondary structure key previously packed with vrna_pt_pack()
+ *
+ *  @see  vrna_pt_pack()
+ *
+ *  @param  packed  The packed structure key
+ *  @return         The pair table of the secondary structure
+ */
+short *
+vrna_pt_unpack(const uint64_t *packed);
+
+
+/**
+ *  @brief Get the number of 64bit words of a packed structure key
+ *
+ *  @see  vrna_pt_pack()
+ *
+ *  @param  length  The length of the structure
+ *  @return         The number of words occupied by a key created with vrna_pt_pack()
+ */
+unsigned int
+vrna_pt_pack_size(unsigned int length);
+
+
+/**
+ *  @brief Compare two packed structure keys
+ *
+ *  Keys are compared by their hash value first, and by their length and
+ *  encoding afterwards. This yields an arbitrary but consistent order.
+ *
+ *  @see  vrna_pt_pack()
+ *
+ *  @param  a   A packed structure key
+ *  @param  b   A packed structure key
+ *  @return     0 if both keys are equal, -1 if @p a is smaller, +1 if @p a is larger than @p b
+ */
+int
+vrna_pt_pack_cmp(const uint64_t *a,
+                 const uint64_t *b);
+
+
+/**
+ *  @brief Insert or remove a base pair in a packed structure key
+ *
+ *  Toggles the base pair @f$ (i,j) @f$ in the key @p packed in constant
+ *  time, i.e. the pair is inserted if both nucleotides are unpaired, and
+ *  removed if they pair with each other. The Zobrist hash in the first
+ *  word of the key is updated accordingly. Thus, keys of neighboring
+ *  structures can be obtained without re-packing the entire structure.
+ *
+ *  @note The resulting key is only canonical if it encodes a valid
+ *        secondary structure, i.e. the caller must ensure that @p i and
+ *        @p j are either both unpaired or pair with each other.
+ *
+ *  @see  vrna_pt_pack(), vrna_move_apply_pk()
+ *
+ *  @param  packed  The packed structure key
+ *  @param  i       The 5' or 3' nucleotide of the base pair
+ *  @param  j       The other nucleotide of the base pair
+ */
+void
+vrna_pt_pack_toggle(uint64_t  *packed,
+                    int       i,
+                    int       j);
+
+
+/**
+ *  @brief Get the Zobrist hash of a secondary structure
+ *
+ *  The hash of a structure is the exclusive or of the keys of all
+ *  its base pairs as obtained from vrna_bp_zobrist(). Therefore, the
+ *  hash can be updated in constant time whenever a base pair is
+ *  inserted or removed.
+ *
+ *  @see  vrna_bp_zobrist(), vrna_pt_pack()
+ *
+ *  @param  pt  The pair table of the secondary structure
+ *  @return     The 64bit Zobrist hash of the structure
+ */
+uint64_t
+vrna_pt_zobrist(const short *pt);
+
+
+/**
+ *  @brief Get the Zobrist key of a single base pair
+ *
+ *  @see  vrna_pt_zobrist()
+ *
+ *  @param  i   The 5' nucleotide of the base pair
+ *  @param  j   The 3' nucleotide of the base pair
+ *  @return     The 64bit key of the base pair @f$ (i,j) @f$
+ */
+uint64_t
+vrna_bp_zobrist(int i,
+                int j);
+
+
 /**
  *  @brief Substitute pairs of brackets in a string with parenthesis
  *
@@ -840,6 +840,7 @@ process_record(struct record_data *record)
     pairing_propensity = (char *)vrna_alloc(sizeof(char) * (n + 1));
 
     if (opt->md.dangles == 1) {
+      vrna_params_unshare(vc);
       vc->params->model_details.dangles = 2;   /* recompute with dangles as in pf_fold() */
       min_en                            = vrna_eval_structure(vc, mfe_structure);
       vc->params->model_details.dangles = 1;
@@ -532,6 +532,11 @@ main(int  argc,
     }
 
     opt.jobs = MAX2(1, opt.jobs);
+
+    /* input is processed in parallel already, so do not spawn even more threads per sequence */
+    if (opt.jobs > 1)
+      opt.md.bpp_mt_length = 0;
+
 #else
     vrna_message_warning(
       "This version of RNAfold has been built without parallel input processing capabilities");
@@ -933,6 +938,7 @@ process_record(struct record_data *record)
   if (opt->pf) {
     char *pf_struc = (char *)vrna_alloc(sizeof(char) * (length + 1));
     if (vc->params->model_details.dangles % 2) {
+      vrna_params_unshare(vc);
       int dang_bak = vc->params->model_details.dangles;
       vc->params->model_details.dangles = 2;   /* recompute with dangles as in pf_fold() */
       min_en                            = vrna_eval_structure(vc, mfe_structure);
@@ -32,6 +32,7 @@
 #include "RNAplfold_cmdl.h"
 #include "gengetopt_helper.h"
 #include "input_id_helpers.h"
+#include "parallel_helpers.h"
 
 #include "ViennaRNA/color_output.inc"
 
@@ -86,8 +87,47 @@ typedef struct {
   double    kT;
 } plfold_data;
 
+struct options {
+  vrna_md_t   md;
+  float       cutoff;
+  int         winsize;
+  int         pairdist;
+  int         unpaired;
+  int         simply_putout;
+  int         plexoutput;
+  int         openenergies;
+  int         binaries;
+  int         noconv;
+  int         verbose;
+  int         filename_full;
+  char        *filename_delim;
+  vrna_cmd_t  commands;
+  dataset_id  id_control;
+
+  int         with_shapes;
+  char        *shape_file;
+  char        *shape_method;
+  char        *shape_conversion;
+
+  int         jobs;
+  int         failed;
+};
+
+struct record_data {
+  char            *id;
+  char            *sequence;
+  char            *SEQ_ID;
+  struct options  *options;
+  int             tty;
+};
+
 int unpaired;
 
+
+PRIVATE void
+process_record(struct record_data *record);
+
+
 PRIVATE void
 putoutphakim_u(vrna_fold_compound_t *fc,
                double               **pU,
@@ -137,41 +177,27 @@ int
 main(int  argc,
      char *argv[])
 {
-  FILE                        *pUfp;
   struct RNAplfold_args_info  args_info;
-  char                        *structure, *ParamFile, *ns_bases, *rec_sequence, *rec_id,
-                              **rec_rest, *orig_sequence, *filename_delim, *command_file,
-                              *shape_file, *shape_method, *shape_conversion;
+  char                        *ParamFile, *ns_bases, *rec_sequence, *rec_id, **rec_rest,
+                              *command_file;
   unsigned int                rec_type, read_opt;
-  int                         length, istty, winsize, pairdist, tempwin, temppair, tempunpaired,
-                              noconv, i, plexoutput, simply_putout, openenergies, binaries,
-                              filename_full, with_shapes, verbose;
-  float                       cutoff;
-  vrna_exp_param_t            *pf_parameters;
-  vrna_md_t                   md;
-  vrna_cmd_t                  commands;
-  dataset_id                  id_control;
-
-  pUfp          = NULL;
-  dangles       = 2;
-  cutoff        = 0.01;
-  winsize       = 70;
-  pairdist      = 0;
-  unpaired      = 0;
-  simply_putout = plexoutput = openenergies = noconv = 0;
-  binaries      = 0;
-  tempwin       = temppair = tempunpaired = 0;
-  structure     = ParamFile = ns_bases = NULL;
+  int                         i, istty;
+  struct options              opt;
+
+  ParamFile     = ns_bases = NULL;
   rec_type      = read_opt = 0;
-  rec_id        = rec_sequence = orig_sequence = NULL;
+  rec_id        = rec_sequence = NULL;
   rec_rest      = NULL;
-  pf_parameters = NULL;
-  filename_full = 0;
   command_file  = NULL;
-  commands      = NULL;
-  verbose       = 0;
+  dangles       = 2;
+  unpaired      = 0;
 
-  set_model_details(&md);
+  memset(&opt, 0, sizeof(struct options));
+  opt.cutoff  = 0.01;
+  opt.winsize = 70;
+  opt.jobs    = 1;
+
+  set_model_details(&(opt.md));
 
   /*
    #############################################
@@ -182,23 +208,27 @@ main(int  argc,
     exit(1);
 
   if (args_info.verbose_given)
-    verbose = 1;
+    opt.verbose = 1;
 
   /* SHAPE reactivity data */
-  ggo_get_SHAPE(args_info, with_shapes, shape_file, shape_method, shape_conversion);
+  ggo_get_SHAPE(args_info,
+                opt.with_shapes,
+                opt.shape_file,
+                opt.shape_method,
+                opt.shape_conversion);
 
   /* parse options for ID manipulation */
-  ggo_get_id_control(args_info, id_control, "Sequence", "sequence", "_", 4, 1);
+  ggo_get_id_control(args_info, opt.id_control, "Sequence", "sequence", "_", 4, 1);
 
-  ggo_get_md_part(args_info, md);
+  ggo_get_md_part(args_info, opt.md);
 
   /* temperature */
   if (args_info.temp_given)
-    md.temperature = temperature = args_info.temp_arg;
+    opt.md.temperature = temperature = args_info.temp_arg;
 
   /* do not take special tetra loop energies into account */
   if (args_info.noTetra_given)
-    md.special_hp = tetra_loop = 0;
+    opt.md.special_hp = tetra_loop = 0;
 
   /* set dangle model */
   if (args_info.dangles_given) {
@@ -206,28 +236,28 @@ main(int  argc,
       vrna_message_warning(
         "required dangle model not implemented, falling back to default dangles=2");
     else
-      md.dangles = dangles = args_info.dangles_arg;
+      opt.md.dangles = dangles = args_info.dangles_arg;
   }
 
   /* do not allow weak pairs */
   if (args_info.noLP_given)
-    md.noLP = noLonelyPairs = 1;
+    opt.md.noLP = noLonelyPairs = 1;
 
   /* do not allow wobble pairs (GU) */
   if (args_info.noGU_given)
-    md.noGU = noGU = 1;
+    opt.md.noGU = noGU = 1;
 
   /* do not allow weak closing pairs (AU,GU) */
   if (args_info.noClosingGU_given)
-    md.noGUclosure = no_closingGU = 1;
+    opt.md.noGUclosure = no_closingGU = 1;
 
   /* do not convert DNA nucleotide "T" to appropriate RNA "U" */
   if (args_info.noconv_given)
-    noconv = 1;
+    opt.noconv = 1;
 
   /* set energy model */
   if (args_info.energyModel_given)
-    md.energy_set = energy_set = args_info.energyModel_arg;
+    opt.md.energy_set = energy_set = args_info.energyModel_arg;
 
   /* take another energy parameter set */
   if (args_info.paramFile_given)
@@ -239,62 +269,86 @@ main(int  argc,
 
   /* set the maximum base pair span */
   if (args_info.span_given)
-    pairdist = args_info.span_arg;
+    opt.pairdist = args_info.span_arg;
 
   /* set the pair probability cutoff */
   if (args_info.cutoff_given)
-    cutoff = args_info.cutoff_arg;
+    opt.cutoff = args_info.cutoff_arg;
 
   /* set the windowsize */
   if (args_info.winsize_given)
-    winsize = args_info.winsize_arg;
+    opt.winsize = args_info.winsize_arg;
 
   /* set the length of unstructured region */
   if (args_info.ulength_given)
-    unpaired = args_info.ulength_arg;
+    opt.unpaired = args_info.ulength_arg;
 
   /* compute opening energies */
   if (args_info.opening_energies_given)
-    openenergies = 1;
+    opt.openenergies = 1;
 
   /* print output on the fly */
   if (args_info.print_onthefly_given)
-    simply_putout = 1;
+    opt.simply_putout = 1;
 
   /* turn on RNAplex output */
   if (args_info.plex_output_given)
-    plexoutput = 1;
+    opt.plexoutput = 1;
 
   /* turn on binary output*/
   if (args_info.binaries_given)
-    binaries = 1;
+    opt.binaries = 1;
 
   /* check for errorneous parameter options */
-  if ((pairdist < 0) || (cutoff < 0.) || (unpaired < 0) || (winsize < 0)) {
+  if ((opt.pairdist < 0) || (opt.cutoff < 0.) || (opt.unpaired < 0) || (opt.winsize < 0)) {
     RNAplfold_cmdline_parser_print_help();
     exit(EXIT_FAILURE);
   }
 
   /* filename sanitize delimiter */
   if (args_info.filename_delim_given)
-    filename_delim = strdup(args_info.filename_delim_arg);
-  else if (get_id_delim(id_control))
-    filename_delim = strdup(get_id_delim(id_control));
+    opt.filename_delim = strdup(args_info.filename_delim_arg);
+  else if (get_id_delim(opt.id_control))
+    opt.filename_delim = strdup(get_id_delim(opt.id_control));
   else
-    filename_delim = NULL;
+    opt.filename_delim = NULL;
 
-  if ((filename_delim) && isspace(*filename_delim)) {
-    free(filename_delim);
-    filename_delim = NULL;
+  if ((opt.filename_delim) && isspace(*opt.filename_delim)) {
+    free(opt.filename_delim);
+    opt.filename_delim = NULL;
   }
 
   /* full filename from FASTA header support */
   if (args_info.filename_full_given)
-    filename_full = 1;
+    opt.filename_full = 1;
 
   if (args_info.commands_given)
     command_file = strdup(args_info.commands_arg);
 
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAplfold has been built without parallel input processing capabilities");
+#endif
+  }
+
   /* free allocated memory of command line data structure */
   RNAplfold_cmdline_parser_free(&args_info);
 
@@ -311,30 +365,35 @@ main(int  argc,
   }
 
   if (ns_bases != NULL)
-    vrna_md_set_nonstandards(&md, ns_bases);
+    vrna_md_set_nonstandards(&(opt.md), ns_bases);
 
   if (command_file != NULL)
-    commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+    opt.commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
 
   /* check parameter options again and reset to reasonable values if needed */
-  if (openenergies && !unpaired)
-    unpaired = 31;
+  if (opt.openenergies && !opt.unpaired)
+    opt.unpaired = 31;
 
-  if (pairdist == 0)
-    pairdist = winsize;
+  if (opt.pairdist == 0)
+    opt.pairdist = opt.winsize;
 
-  if (pairdist > winsize) {
+  if (opt.pairdist > opt.winsize) {
     vrna_message_warning("pairdist (-L %d) should be <= winsize (-W %d);"
                          "Setting pairdist=winsize",
-                         pairdist, winsize);
-    pairdist = winsize;
+                         opt.pairdist, opt.winsize);
+    opt.pairdist = opt.winsize;
   }
 
-  if (dangles % 2) {
+  if (opt.md.dangles % 2) {
     vrna_message_warning("using default dangles = 2");
-    md.dangles = dangles = 2;
+    opt.md.dangles = dangles = 2;
   }
 
+  unpaired = opt.unpaired;
+
+  if ((opt.verbose) && (opt.jobs > 1))
+    vrna_message_info(stderr, "Preparing %d parallel computation slots", opt.jobs);
+
   istty     = isatty(fileno(stdout)) && isatty(fileno(stdin));
   read_opt  |= VRNA_INPUT_NO_REST;
   if (istty) {
@@ -342,6 +401,8 @@ main(int  argc,
     read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
   }
 
+  INIT_PARALLELIZATION(opt.jobs);
+
   /*
    #############################################
    # main loop: continue until end of file
@@ -350,7 +411,6 @@ main(int  argc,
   while (
     !((rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, NULL, read_opt))
       & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
-    char *SEQ_ID = NULL;
     /*
      ########################################################
      # init everything according to the data we've read
@@ -360,290 +420,308 @@ main(int  argc,
       rec_id = memmove(rec_id, rec_id + 1, strlen(rec_id));
 
     /* construct the sequence ID */
-    set_next_id(&rec_id, id_control);
-    SEQ_ID = fileprefix_from_id(rec_id, id_control, filename_full);
+    set_next_id(&rec_id, opt.id_control);
 
-    length    = (int)strlen(rec_sequence);
-    structure = (char *)vrna_alloc(sizeof(char) * (length + 1));
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    /* convert DNA alphabet to RNA if not explicitely switched off */
-    if (!noconv)
-      vrna_seq_toRNA(rec_sequence);
+    record->id        = rec_id;
+    record->sequence  = rec_sequence;
+    record->SEQ_ID    = fileprefix_from_id(rec_id, opt.id_control, opt.filename_full);
+    record->options   = &opt;
+    record->tty       = istty;
 
-    /* store case-unmodified sequence */
-    orig_sequence = strdup(rec_sequence);
-    /* convert sequence to uppercase letters only */
-    vrna_seq_toupper(rec_sequence);
+    RUN_IN_PARALLEL(process_record, record);
 
-    if (istty)
-      vrna_message_info(stdout, "length = %d", length);
+    /* free the rest of current dataset */
+    if (rec_rest) {
+      for (i = 0; rec_rest[i]; i++)
+        free(rec_rest[i]);
+      free(rec_rest);
+    }
 
-    /*
-     ########################################################
-     # done with 'stdin' handling
-     ########################################################
-     */
+    rec_id    = rec_sequence = NULL;
+    rec_rest  = NULL;
 
-    if (length > 1000000) {
-      if (!simply_putout && !unpaired) {
-        vrna_message_warning("Switched to simple output mode!!!");
-        simply_putout = 1;
-      }
-    }
+    if ((opt.with_shapes) || (opt.failed))
+      break;
 
-    if ((simply_putout) && (plexoutput)) {
-      vrna_message_warning("plexoutput not available in simple output mode!\n"
-                           "Switching back to full mode instead!");
-      simply_putout = 0;
-    }
+    /* print user help for the next round if we get input from tty */
+    if (istty)
+      vrna_message_input_seq_simple();
+  }
 
-    if ((simply_putout) && (binaries)) {
-      vrna_message_warning("binary output not available in simple output mode!\n"
-                           "Switching back to full mode instead!");
-      simply_putout = 0;
-    }
+  UNINIT_PARALLELIZATION
 
-    /* restore winsize if altered before */
-    if (tempwin != 0) {
-      winsize = tempwin;
-      tempwin = 0;
-    }
+  free(ParamFile);
+  free(ns_bases);
+  free(opt.filename_delim);
+  free(command_file);
+  free(opt.shape_file);
+  free(opt.shape_method);
+  free(opt.shape_conversion);
+  vrna_commands_free(opt.commands);
 
-    /* restore pairdist if altered before */
-    if (temppair != 0) {
-      pairdist  = temppair;
-      temppair  = 0;
-    }
+  free_id_data(opt.id_control);
 
-    /* restore ulength if altered before */
-    if (tempunpaired != 0) {
-      unpaired      = tempunpaired;
-      tempunpaired  = 0;
-    }
+  return EXIT_SUCCESS;
+}
 
-    /* adjust winsize, pairdist and ulength if necessary */
-    if (length < winsize) {
-      vrna_message_warning("window size %d larger than sequence length %d", winsize, length);
-      tempwin = winsize;
-      winsize = length;
-      if (pairdist > winsize) {
-        temppair  = pairdist;
-        pairdist  = winsize;
-      }
 
-      if (unpaired > winsize) {
-        tempunpaired  = unpaired;
-        unpaired      = winsize;
-      }
-    }
+PRIVATE void
+process_record(struct record_data *record)
+{
+  FILE            *pUfp;
+  char            *rec_sequence, *orig_sequence, *SEQ_ID;
+  int             i, length, winsize, pairdist, ulength, simply_putout;
+  vrna_md_t       md;
+  struct options  *opt;
+
+  opt           = record->options;
+  rec_sequence  = record->sequence;
+  SEQ_ID        = record->SEQ_ID;
+  md            = opt->md;
+  winsize       = opt->winsize;
+  pairdist      = opt->pairdist;
+  ulength       = opt->unpaired;
+  simply_putout = opt->simply_putout;
+
+  length = (int)strlen(rec_sequence);
+
+  /* convert DNA alphabet to RNA if not explicitely switched off */
+  if (!opt->noconv)
+    vrna_seq_toRNA(rec_sequence);
+
+  /* store case-unmodified sequence */
+  orig_sequence = strdup(rec_sequence);
+  /* convert sequence to uppercase letters only */
+  vrna_seq_toupper(rec_sequence);
+
+  if (record->tty)
+    vrna_message_info(stdout, "length = %d", length);
 
-    /*
-     ########################################################
-     # begin actual computations
-     ########################################################
-     */
+  /*
+   ########################################################
+   # done with 'stdin' handling
+   ########################################################
+   */
 
-    if (length > 0) {
-      /* construct output file names */
-      char *fname1, *fname2, *fname3, *fname4, *ffname, *tmp_string;
-
-      if (!SEQ_ID)
-        SEQ_ID = strdup("plfold");
-
-      fname1  = vrna_strdup_printf("%s%slunp", SEQ_ID, filename_delim);
-      fname2  = vrna_strdup_printf("%s%sbasepairs", SEQ_ID, filename_delim);
-      fname3  = vrna_strdup_printf("%s%suplex", SEQ_ID, filename_delim);
-      fname4  = (binaries) ?
-                vrna_strdup_printf("%s%sopenen%sbin",
-                                   SEQ_ID,
-                                   filename_delim,
-                                   filename_delim) :
-                vrna_strdup_printf("%s%sopenen",
-                                   SEQ_ID,
-                                   filename_delim);
-      ffname = vrna_strdup_printf("%s%sdp.ps", SEQ_ID, filename_delim);
-
-      /* sanitize filenames */
-      tmp_string = vrna_filename_sanitize(fname1, filename_delim);
-      free(fname1);
-      fname1      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(fname2, filename_delim);
-      free(fname2);
-      fname2      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(fname3, filename_delim);
-      free(fname3);
-      fname3      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(fname4, filename_delim);
-      free(fname4);
-      fname4      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(ffname, filename_delim);
-      free(ffname);
-      ffname = tmp_string;
-
-
-      md.compute_bpp  = 1;
-      md.window_size  = winsize;
-      md.max_bp_span  = pairdist;
-
-      vrna_fold_compound_t *fc = vrna_fold_compound(rec_sequence, &md, VRNA_OPTION_WINDOW);
-
-      if (with_shapes) {
-        vrna_constraints_add_SHAPE(fc,
-                                   shape_file,
-                                   shape_method,
-                                   shape_conversion,
-                                   verbose,
-                                   VRNA_OPTION_DEFAULT | VRNA_OPTION_WINDOW);
-      }
+  if (length > 1000000) {
+    if (!simply_putout && !ulength) {
+      vrna_message_warning("Switched to simple output mode!!!");
+      simply_putout = 1;
+    }
+  }
 
-      if (commands)
-        vrna_commands_apply(fc, commands, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
-
-      pf_parameters = vrna_exp_params(&md);
-
-      /* prepare data structure for callback */
-      plfold_data data;
-
-      data.cutoff         = cutoff;
-      data.spup           = (simply_putout) ? fopen(fname2, "w") : NULL;
-      data.plexoutput     = plexoutput;
-      data.simply_putout  = simply_putout;
-      data.openenergies   = openenergies;
-      data.plist          = NULL;
-      data.plist_cnt      = 0;
-      data.ulength        = unpaired;
-      data.n              = length;
-      data.kT             = pf_parameters->kT;
-
-      if (unpaired > 0) {
-        if (simply_putout) {
-          data.pup  = NULL;
-          data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
-          prepare_up_file(&data);
-        } else {
-          /* if we don't print on-the-fly we store unpaired probabilities for later */
-          data.pup        = (double **)vrna_alloc(MAX2(unpaired, length + 1) * sizeof(double *));
-          data.pup[0]     = (double *)vrna_alloc(sizeof(double));   /*I only need entry 0*/
-          data.pup[0][0]  = unpaired;
-          data.pUfp       = NULL;
-        }
-      } else {
-        data.pup  = NULL;
-        data.pUfp = NULL;
-      }
+  if ((simply_putout) && (opt->plexoutput)) {
+    vrna_message_warning("plexoutput not available in simple output mode!\n"
+                         "Switching back to full mode instead!");
+    simply_putout = 0;
+  }
 
-      /* prepare option flags */
-      unsigned int plfold_opt = 0;
+  if ((simply_putout) && (opt->binaries)) {
+    vrna_message_warning("binary output not available in simple output mode!\n"
+                         "Switching back to full mode instead!");
+    simply_putout = 0;
+  }
 
-      /* always compute base pair probabilities */
-      plfold_opt |= VRNA_PROBS_WINDOW_BPP;
+  /* adjust winsize, pairdist and ulength if necessary */
+  if (length < winsize) {
+    vrna_message_warning("window size %d larger than sequence length %d", winsize, length);
+    winsize = length;
+    if (pairdist > winsize)
+      pairdist = winsize;
 
-      if (unpaired > 0)
-        plfold_opt |= VRNA_PROBS_WINDOW_UP;
+    if (ulength > winsize)
+      ulength = winsize;
+  }
 
-      /* perform recursions */
-      int r = vrna_probs_window(fc, unpaired, plfold_opt, &plfold_callback, (void *)&data);
+  /*
+   ########################################################
+   # begin actual computations
+   ########################################################
+   */
 
-      if (!r) {
-        vrna_message_warning("Something bad happened while processing the input! "
-                             "Aborting now...");
-        goto rnaplfold_exit;
-      }
+  if (length > 0) {
+    /* construct output file names */
+    char              *fname1, *fname2, *fname3, *fname4, *ffname, *tmp_string;
+    vrna_exp_param_t  *pf_parameters;
+
+    if (!SEQ_ID)
+      SEQ_ID = strdup("plfold");
+
+    fname1  = vrna_strdup_printf("%s%slunp", SEQ_ID, opt->filename_delim);
+    fname2  = vrna_strdup_printf("%s%sbasepairs", SEQ_ID, opt->filename_delim);
+    fname3  = vrna_strdup_printf("%s%suplex", SEQ_ID, opt->filename_delim);
+    fname4  = (opt->binaries) ?
+              vrna_strdup_printf("%s%sopenen%sbin",
+                                 SEQ_ID,
+                                 opt->filename_delim,
+                                 opt->filename_delim) :
+              vrna_strdup_printf("%s%sopenen",
+                                 SEQ_ID,
+                                 opt->filename_delim);
+    ffname = vrna_strdup_printf("%s%sdp.ps", SEQ_ID, opt->filename_delim);
+
+    /* sanitize filenames */
+    tmp_string = vrna_filename_sanitize(fname1, opt->filename_delim);
+    free(fname1);
+    fname1      = tmp_string;
+    tmp_string  = vrna_filename_sanitize(fname2, opt->filename_delim);
+    free(fname2);
+    fname2      = tmp_string;
+    tmp_string  = vrna_filename_sanitize(fname3, opt->filename_delim);
+    free(fname3);
+    fname3      = tmp_string;
+    tmp_string  = vrna_filename_sanitize(fname4, opt->filename_delim);
+    free(fname4);
+    fname4      = tmp_string;
+    tmp_string  = vrna_filename_sanitize(ffname, opt->filename_delim);
+    free(ffname);
+    ffname = tmp_string;
+
+
+    md.compute_bpp  = 1;
+    md.window_size  = winsize;
+    md.max_bp_span  = pairdist;
+
+    vrna_fold_compound_t *fc = vrna_fold_compound(rec_sequence, &md, VRNA_OPTION_WINDOW);
+
+    if (opt->with_shapes) {
+      vrna_constraints_add_SHAPE(fc,
+                                 opt->shape_file,
+                                 opt->shape_method,
+                                 opt->shape_conversion,
+                                 opt->verbose,
+                                 VRNA_OPTION_DEFAULT | VRNA_OPTION_WINDOW);
+    }
 
-      if (!simply_putout) {
-        /* create dot plot output */
-        PS_dot_plot_turn(orig_sequence, data.plist, ffname, pairdist);
+    if (opt->commands)
+      vrna_commands_apply(fc, opt->commands, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
 
-        /* print unpaired probabilities */
-        if (unpaired > 0) {
-          if (plexoutput) {
-            pUfp = fopen(fname3, "w");
-            putoutphakim_u(fc, data.pup, length, unpaired, pUfp);
-            fclose(pUfp);
-          }
+    pf_parameters = vrna_exp_params(&md);
 
-          /* print unpaired probabilities to file */
+    /* prepare data structure for callback */
+    plfold_data data;
 
-          data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
-          if (binaries) {
-            print_pu_bin(fc, &data, unpaired);
-          } else {
-            prepare_up_file(&data);
-            if (openenergies) {
-              for (i = 1; i <= length; i++)
-                print_up_open(data.pUfp,
-                              i,
-                              data.pup[i],
-                              (i > unpaired) ? unpaired : i,
-                              unpaired,
-                              data.kT / 1000.);
-            } else {
-              for (i = 1; i <= length; i++)
-                print_up(data.pUfp, i, data.pup[i], (i > unpaired) ? unpaired : i, unpaired);
-            }
-          }
+    data.cutoff         = opt->cutoff;
+    data.spup           = (simply_putout) ? fopen(fname2, "w") : NULL;
+    data.plexoutput     = opt->plexoutput;
+    data.simply_putout  = simply_putout;
+    data.openenergies   = opt->openenergies;
+    data.plist          = NULL;
+    data.plist_cnt      = 0;
+    data.ulength        = ulength;
+    data.n              = length;
+    data.kT             = pf_parameters->kT;
 
-          fclose(data.pUfp);
-          data.pUfp = NULL;
+    if (ulength > 0) {
+      if (simply_putout) {
+        data.pup  = NULL;
+        data.pUfp = fopen(opt->openenergies ? fname4 : fname1, "w");
+        prepare_up_file(&data);
+      } else {
+        /* if we don't print on-the-fly we store unpaired probabilities for later */
+        data.pup        = (double **)vrna_alloc(MAX2(ulength, length + 1) * sizeof(double *));
+        data.pup[0]     = (double *)vrna_alloc(sizeof(double));   /*I only need entry 0*/
+        data.pup[0][0]  = ulength;
+        data.pUfp       = NULL;
+      }
+    } else {
+      data.pup  = NULL;
+      data.pUfp = NULL;
+    }
 
-          for (i = 0; i <= length; i++)
-            free(data.pup[i]);
-          free(data.pup);
+    /* prepare option flags */
+    unsigned int plfold_opt = 0;
+
+    /* always compute base pair probabilities */
+    plfold_opt |= VRNA_PROBS_WINDOW_BPP;
+
+    if (ulength > 0)
+      plfold_opt |= VRNA_PROBS_WINDOW_UP;
+
+    /* perform recursions */
+    int r = vrna_probs_window(fc, ulength, plfold_opt, &plfold_callback, (void *)&data);
+
+    if (!r) {
+      vrna_message_warning("Something bad happened while processing the input! "
+                           "Aborting now...");
+      /* stop reading further input */
+      opt->failed = 1;
+    } else if (!simply_putout) {
+      /* create dot plot output */
+      THREADSAFE_FILE_OUTPUT(
+        PS_dot_plot_turn(orig_sequence, data.plist, ffname, pairdist));
+
+      /* print unpaired probabilities */
+      if (ulength > 0) {
+        if (opt->plexoutput) {
+          pUfp = fopen(fname3, "w");
+          putoutphakim_u(fc, data.pup, length, ulength, pUfp);
+          fclose(pUfp);
         }
-      }
 
-      vrna_fold_compound_free(fc);
+        /* print unpaired probabilities to file */
 
-      free(pf_parameters);
+        data.pUfp = fopen(opt->openenergies ? fname4 : fname1, "w");
+        if (opt->binaries) {
+          print_pu_bin(fc, &data, ulength);
+        } else {
+          prepare_up_file(&data);
+          if (opt->openenergies) {
+            for (i = 1; i <= length; i++)
+              print_up_open(data.pUfp,
+                            i,
+                            data.pup[i],
+                            (i > ulength) ? ulength : i,
+                            ulength,
+                            data.kT / 1000.);
+          } else {
+            for (i = 1; i <= length; i++)
+              print_up(data.pUfp, i, data.pup[i], (i > ulength) ? ulength : i, ulength);
+          }
+        }
 
-      /* clean up data */
-      if (data.pUfp)
         fclose(data.pUfp);
+        data.pUfp = NULL;
+      }
+    }
 
-      if (data.spup)
-        fclose(data.spup);
-
-      free(data.plist);
-
-
-      free(fname1);
-      free(fname2);
-      free(fname3);
-      free(fname4);
-      free(ffname);
+    if ((data.pup) && (!simply_putout)) {
+      for (i = 0; i <= length; i++)
+        free(data.pup[i]);
+      free(data.pup);
     }
 
-    (void)fflush(stdout);
+    vrna_fold_compound_free(fc);
 
-    /* clean up */
-    free(rec_id);
-    free(rec_sequence);
-    free(orig_sequence);
-    free(structure);
-    free(SEQ_ID);
+    free(pf_parameters);
 
-    if (with_shapes)
-      break;
+    /* clean up data */
+    if (data.pUfp)
+      fclose(data.pUfp);
 
-    rec_id    = rec_sequence = orig_sequence = NULL;
-    rec_rest  = NULL;
+    if (data.spup)
+      fclose(data.spup);
 
-    /* print user help for the next round if we get input from tty */
-    if (istty)
-      vrna_message_input_seq_simple();
-  }
+    free(data.plist);
 
-rnaplfold_exit:
 
-  free(filename_delim);
-  free(command_file);
-  free(shape_method);
-  free(shape_conversion);
-  vrna_commands_free(commands);
+    free(fname1);
+    free(fname2);
+    free(fname3);
+    free(fname4);
+    free(ffname);
+  }
 
-  free_id_data(id_control);
+  (void)fflush(stdout);
 
-  return EXIT_SUCCESS;
+  /* clean up */
+  free(record->id);
+  free(rec_sequence);
+  free(orig_sequence);
+  free(SEQ_ID);
+  free(record);
 }
 
 
@@ -7,6 +7,10 @@
  *
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -18,6 +22,180 @@
 #include <string.h>
 #include <errno.h>
 
+#if VRNA_WITH_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "ViennaRNA/utils/basic.h"
+
+#if VRNA_WITH_PTHREADS
+
+/*
+ *  Atomic operations on unsigned integers. We use the compiler builtins where
+ *  available, and fall back to a global mutex otherwise
+ */
+#if defined(__ATOMIC_SEQ_CST)
+#define ATOMIC_LOAD(p)          __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define ATOMIC_STORE(p, v)      __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define ATOMIC_ADD(p, v)        __atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST)
+#define ATOMIC_SUB(p, v)        __atomic_sub_fetch((p), (v), __ATOMIC_SEQ_CST)
+#define ATOMIC_CAS(p, e, v)     __atomic_compare_exchange_n((p), &(e), (v), 0, \
+                                                            __ATOMIC_SEQ_CST, \
+                                                            __ATOMIC_SEQ_CST)
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#define ATOMIC_LOAD(p)          __sync_add_and_fetch((p), 0)
+#define ATOMIC_STORE(p, v)      { __sync_synchronize(); *(p) = (v); __sync_synchronize(); }
+#define ATOMIC_ADD(p, v)        __sync_add_and_fetch((p), (v))
+#define ATOMIC_SUB(p, v)        __sync_sub_and_fetch((p), (v))
+#define ATOMIC_CAS(p, e, v)     atomic_cas_sync((p), &(e), (v))
+
+static int
+atomic_cas_sync(unsigned int  *p,
+                unsigned int  *expected,
+                unsigned int  v)
+{
+  unsigned int old = __sync_val_compare_and_swap(p, *expected, v);
+
+  if (old == *expected)
+    return 1;
+
+  *expected = old;
+  return 0;
+}
+
+
+#else
+#define ATOMIC_LOAD(p)          atomic_op((p), 0, 0, 0)
+#define ATOMIC_STORE(p, v)      (void)atomic_op((p), 0, (v), 1)
+#define ATOMIC_ADD(p, v)        atomic_op((p), 0, (v), 2)
+#define ATOMIC_SUB(p, v)        atomic_op((p), 0, (v), 3)
+#define ATOMIC_CAS(p, e, v)     atomic_op((p), &(e), (v), 4)
+
+static pthread_mutex_t atomic_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int
+atomic_op(unsigned int  *p,
+          unsigned int  *expected,
+          unsigned int  v,
+          int           op)
+{
+  unsigned int ret;
+
+  pthread_mutex_lock(&atomic_mtx);
+
+  switch (op) {
+    case 1:
+      *p = v;
+      break;
+    case 2:
+      *p += v;
+      break;
+    case 3:
+      *p -= v;
+      break;
+    case 4:
+      if (*p == *expected) {
+        *p = v;
+      } else {
+        *expected = *p;
+        pthread_mutex_unlock(&atomic_mtx);
+        return 0;
+      }
+
+      pthread_mutex_unlock(&atomic_mtx);
+      return 1;
+  }
+
+  ret = *p;
+
+  pthread_mutex_unlock(&atomic_mtx);
+
+  return ret;
+}
+
+
+#endif
+
+typedef struct work_scheduler_s work_scheduler;
+
+typedef struct {
+  void (*fun)(void *);
+  void  *data;
+} job;
+
+
+/*
+ *  Bounded, lock-free FIFO queue of pending jobs that belongs to a single
+ *  worker. Jobs are only pushed by the thread that feeds the scheduler, but
+ *  may be popped by any worker. Each slot carries a sequence number that
+ *  tells whether it holds a published job or may be (re-)used, see
+ *  D. Vyukov's bounded MPMC queue
+ */
+typedef struct {
+  job           *jobs;
+  unsigned int  *seq;
+  unsigned int  mask;
+  unsigned int  head;       /* next slot to pop from */
+  unsigned int  tail;       /* next slot to push to, only used by the producer */
+  unsigned int  unclaimed;  /* published jobs that have not been claimed by a worker yet */
+} job_queue;
+
+
+struct work_scheduler_s {
+  unsigned int    num_threads;
+  pthread_t       *threads;
+  job_queue       *queues;
+  unsigned int    next_queue;   /* queue that receives the next job */
+
+  unsigned int    max_pending;
+  unsigned int    pending;      /* jobs that are queued or currently executed */
+  unsigned int    idle;         /* workers that are (about to go) asleep */
+  unsigned int    waiting;      /* threads that wait for jobs to finish */
+  unsigned int    shutdown;
+
+  pthread_mutex_t mtx;          /* only used to sleep on the conditions below */
+  pthread_cond_t  work_available;
+  pthread_cond_t  job_done;
+};
+
+
+struct worker_data {
+  work_scheduler  *scheduler;
+  unsigned int    id;
+};
+
+
+static int
+queue_push(job_queue  *q,
+           job        j);
+
+
+static int
+queue_claim(job_queue *q);
+
+
+static void
+queue_pop(job_queue *q,
+          job       *j);
+
+
+static int
+get_job(work_scheduler  *scheduler,
+        unsigned int    id,
+        job             *j);
+
+
+static void
+wait_for_jobs(work_scheduler  *scheduler,
+              unsigned int    max_pending);
+
+
+static void *
+worker_thread(void *arg);
+
+
+#endif
+
 
 int
 num_proc_cores(int  *num_cores,
@@ -134,3 +312,311 @@ max_user_threads(void)
 
   return threadm;
 }
+
+
+#if VRNA_WITH_PTHREADS
+
+work_scheduler *
+scheduler_init(unsigned int num_threads,
+               unsigned int max_pending)
+{
+  unsigned int        i, k, size;
+  work_scheduler      *scheduler;
+  struct worker_data  *wd;
+
+  if (num_threads < 1)
+    num_threads = 1;
+
+  if (max_pending < num_threads)
+    max_pending = num_threads;
+
+  /* a single queue never holds more than all pending jobs */
+  for (size = 1; size < max_pending; size <<= 1);
+
+  scheduler = (work_scheduler *)vrna_alloc(sizeof(work_scheduler));
+
+  scheduler->num_threads  = num_threads;
+  scheduler->max_pending  = max_pending;
+  scheduler->pending      = 0;
+  scheduler->idle         = 0;
+  scheduler->waiting      = 0;
+  scheduler->shutdown     = 0;
+  scheduler->next_queue   = 0;
+  scheduler->threads      = (pthread_t *)vrna_alloc(sizeof(pthread_t) * num_threads);
+  scheduler->queues       = (job_queue *)vrna_alloc(sizeof(job_queue) * num_threads);
+
+  pthread_mutex_init(&(scheduler->mtx), NULL);
+  pthread_cond_init(&(scheduler->work_available), NULL);
+  pthread_cond_init(&(scheduler->job_done), NULL);
+
+  for (i = 0; i < num_threads; i++) {
+    scheduler->queues[i].jobs       = (job *)vrna_alloc(sizeof(job) * size);
+    scheduler->queues[i].seq        = (unsigned int *)vrna_alloc(sizeof(unsigned int) * size);
+    scheduler->queues[i].mask       = size - 1;
+    scheduler->queues[i].head       = 0;
+    scheduler->queues[i].tail       = 0;
+    scheduler->queues[i].unclaimed  = 0;
+
+    for (k = 0; k < size; k++)
+      scheduler->queues[i].seq[k] = k;
+  }
+
+  for (i = 0; i < num_threads; i++) {
+    wd            = (struct worker_data *)vrna_alloc(sizeof(struct worker_data));
+    wd->scheduler = scheduler;
+    wd->id        = i;
+
+    if (pthread_create(&(scheduler->threads[i]), NULL, &worker_thread, (void *)wd) != 0)
+      vrna_message_error("Failed to create worker thread");
+  }
+
+  return scheduler;
+}
+
+
+void
+scheduler_add_work(work_scheduler *scheduler,
+                   void (*fun)(void *),
+                   void           *data)
+{
+  unsigned int  i, q;
+  job           j;
+
+  j.fun   = fun;
+  j.data  = data;
+
+  /* block until there is room for another job */
+  wait_for_jobs(scheduler, scheduler->max_pending - 1);
+
+  (void)ATOMIC_ADD(&(scheduler->pending), 1);
+
+  /*
+   *  distribute jobs round-robin, but skip over queues whose next slot is
+   *  still in the process of being released by a worker
+   */
+  q                     = scheduler->next_queue;
+  scheduler->next_queue = (q + 1) % scheduler->num_threads;
+
+  for (i = 0; !queue_push(&(scheduler->queues[(q + i) % scheduler->num_threads]), j); i++);
+
+  /* wake up a sleeping worker, if any */
+  if (ATOMIC_LOAD(&(scheduler->idle)) > 0) {
+    pthread_mutex_lock(&(scheduler->mtx));
+    pthread_cond_signal(&(scheduler->work_available));
+    pthread_mutex_unlock(&(scheduler->mtx));
+  }
+}
+
+
+void
+scheduler_wait_free_slot(work_scheduler *scheduler)
+{
+  wait_for_jobs(scheduler, scheduler->max_pending - 1);
+}
+
+
+void
+scheduler_wait(work_scheduler *scheduler)
+{
+  wait_for_jobs(scheduler, 0);
+}
+
+
+void
+scheduler_destroy(work_scheduler *scheduler)
+{
+  unsigned int i;
+
+  if (!scheduler)
+    return;
+
+  /* finish all pending jobs first */
+  scheduler_wait(scheduler);
+
+  pthread_mutex_lock(&(scheduler->mtx));
+  ATOMIC_STORE(&(scheduler->shutdown), 1);
+  pthread_cond_broadcast(&(scheduler->work_available));
+  pthread_mutex_unlock(&(scheduler->mtx));
+
+  for (i = 0; i < scheduler->num_threads; i++)
+    pthread_join(scheduler->threads[i], NULL);
+
+  for (i = 0; i < scheduler->num_threads; i++) {
+    free(scheduler->queues[i].jobs);
+    free(scheduler->queues[i].seq);
+  }
+
+  pthread_mutex_destroy(&(scheduler->mtx));
+  pthread_cond_destroy(&(scheduler->work_available));
+  pthread_cond_destroy(&(scheduler->job_done));
+
+  free(scheduler->queues);
+  free(scheduler->threads);
+  free(scheduler);
+}
+
+
+static int
+queue_push(job_queue  *q,
+           job        j)
+{
+  unsigned int pos, slot;
+
+  pos   = q->tail;
+  slot  = pos & q->mask;
+
+  /* the slot is still occupied, or its previous job is just being popped */
+  if (ATOMIC_LOAD(&(q->seq[slot])) != pos)
+    return 0;
+
+  q->jobs[slot] = j;
+  ATOMIC_STORE(&(q->seq[slot]), pos + 1);
+  q->tail = pos + 1;
+
+  /* make the job available for claiming only after it has been published */
+  (void)ATOMIC_ADD(&(q->unclaimed), 1);
+
+  return 1;
+}
+
+
+static int
+queue_claim(job_queue *q)
+{
+  unsigned int n = ATOMIC_LOAD(&(q->unclaimed));
+
+  while (n > 0)
+    if (ATOMIC_CAS(&(q->unclaimed), n, n - 1))
+      return 1;
+
+  return 0;
+}
+
+
+static void
+queue_pop(job_queue *q,
+          job       *j)
+{
+  unsigned int pos, slot;
+
+  /*
+   *  A successful claim guarantees that a published job is left in the
+   *  queue, so we only have to compete with other workers for the head
+   */
+  pos = ATOMIC_LOAD(&(q->head));
+
+  while (1) {
+    slot = pos & q->mask;
+
+    if ((ATOMIC_LOAD(&(q->seq[slot])) == pos + 1) &&
+        (ATOMIC_CAS(&(q->head), pos, pos + 1)))
+      break;
+
+    pos = ATOMIC_LOAD(&(q->head));
+  }
+
+  *j = q->jobs[slot];
+
+  /* release the slot for the next round */
+  ATOMIC_STORE(&(q->seq[slot]), pos + q->mask + 1);
+}
+
+
+static int
+get_job(work_scheduler  *scheduler,
+        unsigned int    id,
+        job             *j)
+{
+  unsigned int i, q;
+
+  /* process own jobs first, then try to steal from the other workers */
+  for (i = 0; i < scheduler->num_threads; i++) {
+    q = (id + i) % scheduler->num_threads;
+    if (queue_claim(&(scheduler->queues[q]))) {
+      queue_pop(&(scheduler->queues[q]), j);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+
+/* block until at most max_pending jobs are queued or executed */
+static void
+wait_for_jobs(work_scheduler  *scheduler,
+              unsigned int    max_pending)
+{
+  if (ATOMIC_LOAD(&(scheduler->pending)) <= max_pending)
+    return;
+
+  pthread_mutex_lock(&(scheduler->mtx));
+
+  (void)ATOMIC_ADD(&(scheduler->waiting), 1);
+
+  while (ATOMIC_LOAD(&(scheduler->pending)) > max_pending)
+    pthread_cond_wait(&(scheduler->job_done), &(scheduler->mtx));
+
+  (void)ATOMIC_SUB(&(scheduler->waiting), 1);
+
+  pthread_mutex_unlock(&(scheduler->mtx));
+}
+
+
+static void *
+worker_thread(void *arg)
+{
+  unsigned int        id;
+  work_scheduler      *scheduler;
+  struct worker_data  *wd;
+  job                 j;
+
+  wd        = (struct worker_data *)arg;
+  scheduler = wd->scheduler;
+  id        = wd->id;
+
+  free(wd);
+
+  while (1) {
+    if (!get_job(scheduler, id, &j)) {
+      /*
+       *  Nothing to do, so go to sleep. We announce that before checking
+       *  the queues again, such that scheduler_add_work() either sees us
+       *  sleeping, or we see its job
+       */
+      pthread_mutex_lock(&(scheduler->mtx));
+
+      (void)ATOMIC_ADD(&(scheduler->idle), 1);
+
+      while (!get_job(scheduler, id, &j)) {
+        if (ATOMIC_LOAD(&(scheduler->shutdown))) {
+          (void)ATOMIC_SUB(&(scheduler->idle), 1);
+          pthread_mutex_unlock(&(scheduler->mtx));
+          return NULL;
+        }
+
+        pthread_cond_wait(&(scheduler->work_available), &(scheduler->mtx));
+      }
+
+      (void)ATOMIC_SUB(&(scheduler->idle), 1);
+
+      pthread_mutex_unlock(&(scheduler->mtx));
+    }
+
+    j.fun(j.data);
+
+    (void)ATOMIC_SUB(&(scheduler->pending), 1);
+
+    /* wake up the threads that wait for free slots or completion */
+    if (ATOMIC_LOAD(&(scheduler->waiting)) > 0) {
+      pthread_mutex_lock(&(scheduler->mtx));
+      pthread_cond_broadcast(&(scheduler->job_done));
+      pthread_mutex_unlock(&(scheduler->mtx));
+    }
+  }
+
+  return NULL;
+}
+
+
+#endif
@@ -4,12 +4,19 @@
 #if VRNA_WITH_PTHREADS
 
 #include <pthread.h>
-#include "thpool.h"
+
+/*
+ *  Number of pending jobs per worker thread that may be queued before
+ *  the input processing blocks
+ */
+#define SCHEDULER_JOBS_PER_THREAD 4
+
+typedef struct work_scheduler_s work_scheduler;
 
 pthread_mutex_t output_mutex;
 pthread_mutex_t output_file_mutex;
 unsigned int    max_threads;
-threadpool      worker_pool;
+work_scheduler  *worker_pool;
 
 #define ATOMIC_BLOCK(a) { \
     if (max_threads > 1) { \
@@ -47,29 +54,28 @@ threadpool      worker_pool;
     if (max_threads > 1) { \
       pthread_mutex_init(&output_mutex, NULL); \
       pthread_mutex_init(&output_file_mutex, NULL); \
-      worker_pool = thpool_init(max_threads); \
+      worker_pool = scheduler_init(max_threads, \
+                                   SCHEDULER_JOBS_PER_THREAD * max_threads); \
     } \
 }
 
 #define UNINIT_PARALLELIZATION  { \
     if (max_threads > 1) \
-      thpool_wait(worker_pool); \
+      scheduler_wait(worker_pool); \
     pthread_mutex_destroy(&output_mutex); \
     pthread_mutex_destroy(&output_file_mutex); \
     if (max_threads > 1) \
-      thpool_destroy(worker_pool); \
+      scheduler_destroy(worker_pool); \
 }
 
 #define RUN_IN_PARALLEL(fun, data)  { \
-    if (max_threads > 1) { thpool_add_work(worker_pool, (void *)&fun, (void *)data); } \
+    if (max_threads > 1) { scheduler_add_work(worker_pool, (void (*)(void *))&fun, (void *)data); } \
     else { fun(data); } \
 }
 
 #define WAIT_FOR_FREE_SLOT(a) { \
-    if (max_threads > 1) { \
-      while (thpool_num_threads_working(worker_pool) == (a)) \
-        sleep(1); \
-    } \
+    if (max_threads > 1) \
+      scheduler_wait_free_slot(worker_pool); \
 }
 
 #else
@@ -82,6 +88,47 @@ threadpool      worker_pool;
 #define RUN_IN_PARALLEL(fun, data)  { fun(data); }
 #define WAIT_FOR_FREE_SLOT(a)
 
+#endif
+
+#if VRNA_WITH_PTHREADS
+
+/*
+ *  A simple work scheduler for parallel input processing
+ *
+ *  Each worker thread maintains its own lock-free queue of pending jobs.
+ *  Jobs are distributed in a round-robin fashion, and idle workers steal
+ *  pending jobs from the queues of other workers. Workers without any job
+ *  to process sleep on a condition variable. The total number of pending
+ *  jobs is bounded, i.e. scheduler_add_work() blocks until a slot becomes
+ *  available. This keeps memory consumption and the number of out-of-order
+ *  results that await output bounded, even for huge input streams.
+ *
+ *  Jobs must only be added by a single thread, usually the one that reads
+ *  the input.
+ */
+work_scheduler *
+scheduler_init(unsigned int num_threads,
+               unsigned int max_pending);
+
+
+void
+scheduler_add_work(work_scheduler *scheduler,
+                   void (*fun)(void *),
+                   void           *data);
+
+
+void
+scheduler_wait_free_slot(work_scheduler *scheduler);
+
+
+void
+scheduler_wait(work_scheduler *scheduler);
+
+
+void
+scheduler_destroy(work_scheduler *scheduler);
+
+
 #endif
 
 int
@@ -0,0 +1,30 @@
+echo "Testing RNAplfold (general features):"
+
+RETURN=0
+
+function failed {
+    RETURN=1
+    echo " [ NOT OK ]"
+}
+
+function passed {
+    echo " [ OK ]"
+}
+
+function testline {
+  echo -en "...testing $1:\t\t"
+}
+
+# Test parallel processing support, output files must be identical to serial processing
+testline "Parallel processing of input data"
+mkdir -p rnaplfold_serial rnaplfold_parallel
+(cd rnaplfold_serial && RNAplfold -W 80 -L 60 -u 10 --auto-id --id-prefix="rnaplfold_test" < ${DATADIR}/rnafold.small.seq)
+(cd rnaplfold_parallel && RNAplfold -W 80 -L 60 -u 10 --auto-id --id-prefix="rnaplfold_test" -j4 < ${DATADIR}/rnafold.small.seq)
+diff=$(${DIFF} -r -I CreationDate rnaplfold_serial rnaplfold_parallel)
+if [ "x$(ls rnaplfold_parallel)" == "x" ] ; then diff="no output files"; fi
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# clean up
+rm -rf rnaplfold_serial rnaplfold_parallel
+
+exit ${RETURN}
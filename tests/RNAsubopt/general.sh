@@ -0,0 +1,38 @@
+echo "Testing RNAsubopt (general features):"
+
+RETURN=0
+
+function failed {
+    RETURN=1
+    echo " [ NOT OK ]"
+}
+
+function passed {
+    echo " [ OK ]"
+}
+
+function testline {
+  echo -en "...testing $1:\t\t"
+}
+
+# Test parallel processing support, output must be identical to serial processing
+for options in "-e 1" "-e 1 -s" "-e 1 -d3" "-z"
+do
+  testline "Parallel processing of input data (RNAsubopt ${options})"
+  RNAsubopt ${options} < ${DATADIR}/rnafold.small.seq > rnasubopt.serial.sub
+  RNAsubopt ${options} -j4 < ${DATADIR}/rnafold.small.seq > rnasubopt.sub
+  diff=$(${DIFF} rnasubopt.serial.sub rnasubopt.sub)
+  if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+done
+
+# Test unordered parallel processing, output must consist of the same lines
+testline "Unordered parallel processing of input data"
+RNAsubopt -e 1 < ${DATADIR}/rnafold.small.seq | sort > rnasubopt.serial.sub
+RNAsubopt -e 1 -j4 --unordered < ${DATADIR}/rnafold.small.seq | sort > rnasubopt.sub
+diff=$(${DIFF} rnasubopt.serial.sub rnasubopt.sub)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# clean up
+rm rnasubopt.serial.sub rnasubopt.sub
+
+exit ${RETURN}
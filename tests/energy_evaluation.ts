@@ -1,6 +1,7 @@
 #include <ViennaRNA/params/basic.h>
 #include <ViennaRNA/utils/basic.h>
 #include <ViennaRNA/loops/all.h>
+#include <ViennaRNA/eval.h>
 
 #suite Energy_Evaluating_Functions
 
@@ -208,3 +209,90 @@
   ck_assert_int_eq(E_IntLoop(3, 5, 1, 2, 1, 2, 3, 4, &param), 235);
   ck_assert_int_eq(E_IntLoop(5, 3, 1, 2, 1, 2, 3, 4, &param), 235);
 }
+
+
+/*
+ * check for properly shared energy parameter sets
+ */
+
+#test params_shared
+{
+  vrna_md_t           md;
+  const vrna_param_t  *P1, *P2, *P3;
+  vrna_param_t        *P;
+
+  vrna_md_set_default(&md);
+
+  P1  = vrna_params_shared(&md);
+  md.max_bp_span = 100;
+  P2  = vrna_params_shared(&md);
+
+  /* same tables irrespective of the length dependent settings */
+  ck_assert(P1 == P2);
+
+  md.temperature  = 42.;
+  P3              = vrna_params_shared(&md);
+
+  ck_assert(P1 != P3);
+  ck_assert(P3->temperature == 42.);
+
+  /* copies must not differ from the shared set */
+  P = vrna_params(&md);
+  ck_assert(P->model_details.max_bp_span == 100);
+  ck_assert(memcmp(&(P->stack[0][0]), &(P3->stack[0][0]), sizeof(P->stack)) == 0);
+  ck_assert(memcmp(P->int22, P3->int22, sizeof(P->int22)) == 0);
+  free(P);
+
+  vrna_params_shared_release(P1);
+  vrna_params_shared_release(P2);
+
+  /* referenced sets stay valid, but are not handed out after clearing the cache */
+  vrna_params_shared_clear();
+  ck_assert(P3->temperature == 42.);
+  P2 = vrna_params_shared(&md);
+  ck_assert(P2 != P3);
+
+  vrna_params_shared_release(P2);
+  vrna_params_shared_release(P3);
+}
+
+
+#test params_shared_fold_compound
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc1, *fc2, *fc3;
+  vrna_param_t          *P;
+  float                 e;
+
+  vrna_md_set_default(&md);
+
+  fc1 = vrna_fold_compound("AGGGAAACCCA", &md, VRNA_OPTION_DEFAULT);
+  fc2 = vrna_fold_compound("AGGGAAUCCCA", &md, VRNA_OPTION_DEFAULT);
+  fc3 = vrna_fold_compound("GGGAAACCC", &md, VRNA_OPTION_DEFAULT);
+
+  /* energy parameters are private unless sharing is requested */
+  ck_assert(fc1->params != fc2->params);
+  ck_assert(vrna_params_unshare(fc1) == fc1->params);
+
+  vrna_params_share(fc1);
+  vrna_params_share(fc2);
+  vrna_params_share(fc3);
+
+  /* identical model details share one parameter set */
+  ck_assert(fc1->params == fc2->params);
+  ck_assert(fc1->params != fc3->params);
+
+  /* modifications require a private copy */
+  e = vrna_eval_structure(fc1, ".(((...))).");
+  P = vrna_params_unshare(fc1);
+  ck_assert(P == fc1->params);
+  ck_assert(P != fc2->params);
+
+  P->model_details.dangles = 0;
+  ck_assert(fc2->params->model_details.dangles == 2);
+  ck_assert(vrna_eval_structure(fc1, ".(((...))).") != e);
+
+  vrna_fold_compound_free(fc1);
+  vrna_fold_compound_free(fc2);
+  vrna_fold_compound_free(fc3);
+}
@@ -1,5 +1,7 @@
 #include <stdio.h>      /* printf, scanf, NULL */
 #include <stdlib.h>     /* malloc, free, rand */
+#include <math.h>       /* fabs */
+#include <string.h>     /* strcmp, strdup */
 
 #include <ViennaRNA/fold_vars.h>
 #include <ViennaRNA/data_structures.h>
@@ -8,6 +10,68 @@
 #include <ViennaRNA/constraints/basic.h>
 #include <ViennaRNA/fold.h>
 #include <ViennaRNA/part_func.h>
+#include <ViennaRNA/boltzmann_sampling.h>
+#include <ViennaRNA/equilibrium_probs.h>
+#include <ViennaRNA/mutation_scan.h>
+#include <ViennaRNA/loops/all.h>
+#include <ViennaRNA/utils/higher_order_functions.h>
+#include <ViennaRNA/subopt.h>
+
+/* hard constraint callback that permits every decomposition */
+static unsigned char
+hc_permit_all(int           i,
+              int           j,
+              int           k,
+              int           l,
+              unsigned char d,
+              void          *data)
+{
+  return (unsigned char)1;
+}
+
+
+/* collect suboptimal structures passed to a vrna_subopt_callback */
+struct subopt_collector {
+  vrna_subopt_solution_t  *list;
+  unsigned int            num;
+  unsigned int            size;
+};
+
+
+static void
+collect_subopt(const char *structure,
+               float      energy,
+               void       *data)
+{
+  struct subopt_collector *d = (struct subopt_collector *)data;
+
+  if (!structure)
+    return;
+
+  if (d->num == d->size) {
+    d->size = (d->size) ? 2 * d->size : 128;
+    d->list = (vrna_subopt_solution_t *)vrna_realloc(d->list,
+                                                     sizeof(vrna_subopt_solution_t) * d->size);
+  }
+
+  d->list[d->num].energy      = energy;
+  d->list[d->num++].structure = strdup(structure);
+}
+
+
+static int
+compare_subopt(const void *a,
+               const void *b)
+{
+  const vrna_subopt_solution_t  *s1 = (const vrna_subopt_solution_t *)a;
+  const vrna_subopt_solution_t  *s2 = (const vrna_subopt_solution_t *)b;
+
+  if (s1->energy != s2->energy)
+    return (s1->energy < s2->energy) ? -1 : 1;
+
+  return strcmp(s1->structure, s2->structure);
+}
+
 
 #suite  MFE_Prediction
 
@@ -24,6 +88,437 @@
   free(structure);
 }
 
+#tcase  Wavefront_Parallelization
+
+#test test_mfe_wavefront
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  structure_serial[sizeof(sequence)];
+  char                  structure_parallel[sizeof(sequence)];
+  float                 en_serial, en_parallel;
+  int                   d, noLP;
+
+  for (noLP = 0; noLP <= 1; noLP++)
+    for (d = 0; d <= 3; d++) {
+      vrna_md_set_default(&md);
+      md.dangles  = d;
+      md.noLP     = noLP;
+
+      fc        = vrna_fold_compound(sequence, &md, VRNA_OPTION_MFE);
+      en_serial = vrna_mfe(fc, structure_serial);
+      vrna_fold_compound_free(fc);
+
+      md.num_threads  = 4;
+      fc              = vrna_fold_compound(sequence, &md, VRNA_OPTION_MFE);
+      en_parallel     = vrna_mfe(fc, structure_parallel);
+      vrna_fold_compound_free(fc);
+
+      ck_assert(en_serial == en_parallel);
+      ck_assert(strcmp(structure_serial, structure_parallel) == 0);
+    }
+}
+
+#tcase  SIMD_Dispatch
+
+#test test_mfe_simd
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  structure_default[sizeof(sequence)];
+  char                  structure_simd[sizeof(sequence)];
+  float                 en_default, en_simd;
+  int                   d, noLP;
+
+  for (noLP = 0; noLP <= 1; noLP++)
+    for (d = 0; d <= 3; d++) {
+      vrna_md_set_default(&md);
+      md.dangles  = d;
+      md.noLP     = noLP;
+
+      vrna_fun_dispatch_disable();
+      fc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_MFE);
+      en_default  = vrna_mfe(fc, structure_default);
+      vrna_fold_compound_free(fc);
+
+      vrna_fun_dispatch_enable();
+      fc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_MFE);
+      en_simd = vrna_mfe(fc, structure_simd);
+      vrna_fold_compound_free(fc);
+
+      ck_assert(en_default == en_simd);
+      ck_assert(strcmp(structure_default, structure_simd) == 0);
+    }
+}
+
+#tcase  Batch_Folding
+
+#test test_fold_batch
+{
+  const char  *sequences[] = {
+    "CGCAGGGAUACCCGCG",
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGG",
+    "GGGGAAAACCCC",
+    "GCGCUUCGCCGCGCGAAAGCGCAGCCAUUCCAUUUGGAUGGACUA",
+    NULL
+  };
+  char        *structures[4], *structure;
+  float       *en, en_single;
+  int         i;
+
+  en = vrna_fold_batch(sequences, NULL, structures);
+
+  for (i = 0; sequences[i]; i++) {
+    structure = (char *)vrna_alloc(sizeof(char) * (strlen(sequences[i]) + 1));
+    en_single = vrna_fold(sequences[i], structure);
+
+    ck_assert(en[i] == en_single);
+    ck_assert(strcmp(structures[i], structure) == 0);
+
+    free(structure);
+    free(structures[i]);
+  }
+
+  free(en);
+
+  en = vrna_pf_fold_batch(sequences, NULL, NULL);
+
+  for (i = 0; sequences[i]; i++)
+    ck_assert(fabs(en[i] - vrna_pf_fold(sequences[i], NULL, NULL)) < 1e-4);
+
+  free(en);
+}
+
+#tcase  Banded_Window_Storage
+
+#test test_mfe_window_global
+{
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  *s1, *s2;
+  float                 e1, e2;
+  int                   d;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  s1  = (char *)vrna_alloc(sizeof(char) * (strlen(sequence) + 1));
+  s2  = (char *)vrna_alloc(sizeof(char) * (strlen(sequence) + 1));
+
+  for (d = 0; d < 3; d++) {
+    vrna_md_set_default(&md);
+    md.dangles      = d;
+    md.max_bp_span  = 50;
+    md.window_size  = 50;
+
+    fc  = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    e1  = vrna_mfe(fc, s1);
+
+    /* regular fold compounds keep their DP matrices for subsequent backtracking */
+    ck_assert(fc->matrices != NULL);
+    vrna_fold_compound_free(fc);
+
+    /* sliding window fold compounds are folded with banded DP matrices */
+    fc  = vrna_fold_compound(sequence, &md, VRNA_OPTION_WINDOW);
+    e2  = vrna_mfe(fc, s2);
+    vrna_fold_compound_free(fc);
+
+    ck_assert(e1 == e2);
+    ck_assert(strcmp(s1, s2) == 0);
+  }
+
+  free(s1);
+  free(s2);
+}
+
+
+#test test_pf_window_global
+{
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  *s1, *s2;
+  float                 e1, e2;
+  int                   d;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  s1  = (char *)vrna_alloc(sizeof(char) * (strlen(sequence) + 1));
+  s2  = (char *)vrna_alloc(sizeof(char) * (strlen(sequence) + 1));
+
+  for (d = 0; d < 3; d++) {
+    vrna_md_set_default(&md);
+    md.dangles      = d;
+    md.max_bp_span  = 50;
+    md.window_size  = 50;
+
+    fc  = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    e1  = vrna_pf(fc, s1);
+
+    /* regular fold compounds keep their DP matrices for subsequent post-processing */
+    ck_assert(fc->exp_matrices != NULL);
+    vrna_fold_compound_free(fc);
+
+    /* global ensemble of sliding window fold compounds with banded DP matrices */
+    fc  = vrna_fold_compound(sequence, &md, VRNA_OPTION_WINDOW);
+    e2  = vrna_pf(fc, s2);
+    vrna_fold_compound_free(fc);
+
+    ck_assert(fabs(e1 - e2) < 1e-4);
+    ck_assert(strcmp(s1, s2) == 0);
+  }
+
+  free(s1);
+  free(s2);
+}
+
+#tcase  Incremental_Mutation
+
+#test test_mfe_mutate
+{
+  char                  sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGG";
+  const char            nucleotides[] = "ACGU";
+  char                  *s1, *s2;
+  float                 e1, e2;
+  unsigned int          i, n, d;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_mutant;
+
+  n   = strlen(sequence);
+  s1  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s2  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  for (d = 0; d < 4; d++) {
+    vrna_md_set_default(&md);
+    md.dangles = d;
+
+    fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    (void)vrna_mfe(fc, NULL);
+
+    /* mutations accumulate, so each one is applied to the previous mutant */
+    for (i = 1; i <= n; i += 7) {
+      sequence[i - 1] = nucleotides[(i + d) % 4];
+
+      e1 = vrna_mfe_mutate(fc, i, sequence[i - 1], s1);
+
+      fc_mutant = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+      e2        = vrna_mfe(fc_mutant, s2);
+      vrna_fold_compound_free(fc_mutant);
+
+      ck_assert(e1 == e2);
+      ck_assert(strcmp(s1, s2) == 0);
+    }
+
+    vrna_fold_compound_free(fc);
+  }
+
+  free(s1);
+  free(s2);
+}
+
+#test test_mutation_scan
+{
+  const char            sequence[] = "GCGCUUCGCCGCGCGAAAGCGCAGCCAUUCCAUUUGGAUGGACUA";
+  char                  *mutant;
+  unsigned int          n, num;
+  vrna_md_t             md;
+  vrna_mutant_t         *mutants, *ptr;
+  vrna_fold_compound_t  *fc;
+
+  n       = strlen(sequence);
+  mutant  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  vrna_md_set_default(&md);
+  md.num_threads = 2;
+
+  fc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  mutants = vrna_mutation_scan(fc, VRNA_MUTATION_SCAN_PF);
+
+  ck_assert(mutants != NULL);
+
+  for (num = 0, ptr = mutants; ptr->i != 0; ptr++, num++) {
+    strcpy(mutant, sequence);
+    mutant[ptr->i - 1] = ptr->nucleotide;
+
+    ck_assert(ptr->nucleotide != sequence[ptr->i - 1]);
+    ck_assert(ptr->mfe == vrna_fold(mutant, NULL));
+    ck_assert(fabs(ptr->ensemble_energy - vrna_pf_fold(mutant, NULL, NULL)) < 1e-4);
+  }
+
+  ck_assert(num == 3 * n);
+  /* the wild type fold compound remains untouched */
+  ck_assert(strcmp(fc->sequence, sequence) == 0);
+
+  vrna_mutation_scan_free(mutants);
+  vrna_fold_compound_free(fc);
+  free(mutant);
+}
+
+#test test_mutation_scan_accessibility
+{
+  /* the accessibilities must include nucleotides that are part of G-Quadruplexes */
+  const char            sequence[] = "GGAGGAGGAGGAAAGCGCAAAAGCGCA";
+  char                  mutant[sizeof(sequence)];
+  unsigned int          n, k, x;
+  double                kT, w, Z, p_u[sizeof(sequence)];
+  vrna_md_t             md;
+  vrna_mutant_t         *mutants, *ptr;
+  vrna_subopt_solution_t  *sol;
+  vrna_fold_compound_t  *fc, *fc_mutant;
+
+  n = strlen(sequence);
+
+  vrna_md_set_default(&md);
+  md.gquad    = 1;
+  md.uniq_ML  = 1;
+  kT          = (md.temperature + K0) * GASCONST / 1000.;
+
+  fc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  mutants = vrna_mutation_scan(fc, VRNA_MUTATION_SCAN_ACCESSIBILITY);
+
+  ck_assert(mutants != NULL);
+
+  for (ptr = mutants; ptr->i != 0; ptr++) {
+    strcpy(mutant, sequence);
+    mutant[ptr->i - 1] = ptr->nucleotide;
+
+    /* compare against the complete enumeration of the ensemble */
+    fc_mutant = vrna_fold_compound(mutant, &md, VRNA_OPTION_DEFAULT);
+    sol       = vrna_subopt(fc_mutant, 10000, 0, NULL);
+    Z         = 0.;
+
+    for (x = 1; x <= n; x++)
+      p_u[x] = 0.;
+
+    for (k = 0; sol[k].structure; k++) {
+      w   = exp(-sol[k].energy / kT);
+      Z   += w;
+      for (x = 1; x <= n; x++)
+        if (sol[k].structure[x - 1] == '.')
+          p_u[x] += w;
+
+      free(sol[k].structure);
+    }
+
+    for (x = 1; x <= n; x++)
+      ck_assert(fabs(p_u[x] / Z - ptr->accessibility[x]) < 1e-4);
+
+    free(sol);
+    vrna_fold_compound_free(fc_mutant);
+  }
+
+  vrna_mutation_scan_free(mutants);
+  vrna_fold_compound_free(fc);
+}
+
+#tcase  Loop_Energy_Cache
+
+#test test_loop_cache
+{
+  /* contains a tetraloop, a triloop, and hairpins beyond the tabulated loop sizes */
+  const char            sequence[] =
+    "GGGGAAACCCCGCGCGAAAGCGCAGCCAUUCCAUUUGGAUGGACUAGGCUUCGGCCUAAUGGCAUCGAUCGAUCGAGCUAGCAUCGAUGC";
+  char                  *structure;
+  int                   i, j, k, l, c, n, *e, *e_int;
+  float                 mfe, e_structure;
+  FLT_OR_DBL            *q, *q_int;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  n         = strlen(sequence);
+  structure = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  e         = (int *)vrna_alloc(sizeof(int) * (n + 1) * (n + 1));
+  q         = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1) * (n + 1));
+  e_int     = (int *)vrna_alloc(sizeof(int) * (n + 1) * (n + 1) * 16);
+  q_int     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1) * (n + 1) * 16);
+
+  vrna_md_set_default(&md);
+  fc  = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  mfe = vrna_mfe(fc, structure);
+  vrna_exp_params_rescale(fc, &(double){ mfe });
+  vrna_pf(fc, NULL);
+
+  ck_assert(fc->loop_cache != NULL);
+
+  e_structure = vrna_eval_structure(fc, structure);
+
+  for (c = 0, i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++) {
+      e[i * (n + 1) + j]  = vrna_eval_hp_loop(fc, i, j);
+      q[i * (n + 1) + j]  = vrna_exp_E_hp_loop(fc, i, j);
+
+      /* all interior loops with up to 3 unpaired nucleotides on either side */
+      for (k = i + 1; (k < j) && (k <= i + 4); k++)
+        for (l = j - 1; (l > k) && (l >= j - 4); l--, c++) {
+          e_int[c]  = vrna_eval_int_loop(fc, i, j, k, l);
+          q_int[c]  = vrna_exp_E_interior_loop(fc, i, j, k, l);
+        }
+    }
+
+  /* energies must not differ from those obtained without look-up tables */
+  vrna_loop_cache_free(fc);
+  ck_assert(fc->loop_cache == NULL);
+
+  for (c = 0, i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++) {
+      ck_assert(e[i * (n + 1) + j] == vrna_eval_hp_loop(fc, i, j));
+      ck_assert(q[i * (n + 1) + j] == vrna_exp_E_hp_loop(fc, i, j));
+
+      for (k = i + 1; (k < j) && (k <= i + 4); k++)
+        for (l = j - 1; (l > k) && (l >= j - 4); l--, c++) {
+          ck_assert(e_int[c] == vrna_eval_int_loop(fc, i, j, k, l));
+          ck_assert(q_int[c] == vrna_exp_E_interior_loop(fc, i, j, k, l));
+        }
+    }
+
+  ck_assert(e_structure == vrna_eval_structure(fc, structure));
+  ck_assert(mfe == vrna_mfe(fc, NULL));
+
+  vrna_fold_compound_free(fc);
+  free(structure);
+  free(e);
+  free(q);
+  free(e_int);
+  free(q_int);
+}
+
+#tcase  Default_Model_Kernel
+
+#test test_mfe_default_kernel
+{
+  const char            sequence[] =
+    "GGGAGCUCAACUCGGUAGGAGAGCAUUGCACUCGUAUGCAAUGCUCUUACCUAGCUUGGACCGUAGGCGAUUCGCCUAGCCUAGGUGUCCCGUAUCGACG";
+  char                  structure_default[sizeof(sequence)];
+  char                  structure_generic[sizeof(sequence)];
+  float                 en_default, en_generic;
+  int                   c;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  /* a (trivial) hard constraints callback enforces the generic decompositions */
+  for (c = 0; c < 4; c++) {
+    vrna_md_set_default(&md);
+    md.noGUclosure  = c & 1;
+    md.circ         = (c & 2) ? 1 : 0;
+    md.uniq_ML      = 1;
+
+    fc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_MFE);
+    en_default  = vrna_mfe(fc, structure_default);
+    vrna_fold_compound_free(fc);
+
+    fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_MFE);
+    vrna_hc_add_f(fc, &hc_permit_all);
+    en_generic = vrna_mfe(fc, structure_generic);
+    vrna_fold_compound_free(fc);
+
+    ck_assert(en_default == en_generic);
+    ck_assert(strcmp(structure_default, structure_generic) == 0);
+  }
+}
+
 #suite  Partition_Function
 
 #tcase Stochastic_Backtracking
@@ -55,6 +550,496 @@
   vrna_fold_compound_free(vc);
 }
 
+#test test_sample_parallel
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  **samples[2];
+  int                   i, t;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+
+  /* samples must not depend on the number of threads */
+  for (t = 0; t < 2; t++) {
+    md.num_threads = 2 + 2 * t;
+
+    fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+
+    vrna_pf(fc, NULL);
+
+    xsubi[0]    = 1;
+    xsubi[1]    = 2;
+    xsubi[2]    = 3;
+    samples[t]  = vrna_pbacktrack_num(fc, 100, VRNA_PBACKTRACK_DEFAULT);
+
+    vrna_fold_compound_free(fc);
+  }
+
+  for (i = 0; i < 100; i++) {
+    ck_assert(samples[0][i] != NULL);
+    ck_assert(samples[1][i] != NULL);
+    ck_assert_str_eq(samples[0][i], samples[1][i]);
+    free(samples[0][i]);
+    free(samples[1][i]);
+  }
+
+  ck_assert(samples[0][100] == NULL);
+  ck_assert(samples[1][100] == NULL);
+
+  free(samples[0]);
+  free(samples[1]);
+}
+
+#test test_sample_nr_parallel
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  vrna_pbacktrack_mem_t nr_mem;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  const char            small[] = "GGGGAAAACCCCAUGC";
+  char                  **samples, **more, *mfe_structure;
+  double                mfe, p_mfe;
+  unsigned int          i, j, n, hits, runs;
+  vrna_subopt_solution_t  *all;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+  md.num_threads  = 4;
+
+  /* samples drawn concurrently are unique, also after resuming */
+  fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  vrna_pf(fc, NULL);
+
+  nr_mem  = NULL;
+  samples = vrna_pbacktrack_resume(fc, 200, &nr_mem, VRNA_PBACKTRACK_NON_REDUNDANT);
+  more    = vrna_pbacktrack_resume(fc, 200, &nr_mem, VRNA_PBACKTRACK_NON_REDUNDANT);
+
+  for (n = 0; samples[n]; n++);
+  ck_assert_int_eq(n, 200);
+
+  for (n = 0; more[n]; n++);
+  ck_assert_int_eq(n, 200);
+
+  for (i = 0; i < 200; i++)
+    for (j = 0; j < 200; j++) {
+      ck_assert_str_ne(samples[i], more[j]);
+      if (i < j)
+        ck_assert_str_ne(samples[i], samples[j]);
+      if (i < j)
+        ck_assert_str_ne(more[i], more[j]);
+    }
+
+  for (i = 0; i < 200; i++) {
+    free(samples[i]);
+    free(more[i]);
+  }
+  free(samples);
+  free(more);
+  vrna_pbacktrack_mem_free(nr_mem);
+  vrna_fold_compound_free(fc);
+
+  /* samples from a small ensemble are unique and valid structures */
+  fc  = vrna_fold_compound(small, &md, VRNA_OPTION_DEFAULT);
+  all = vrna_subopt(fc, 10000, 0, NULL);
+
+  vrna_pf(fc, NULL);
+
+  nr_mem  = NULL;
+  samples = vrna_pbacktrack_resume(fc, 15, &nr_mem, VRNA_PBACKTRACK_NON_REDUNDANT);
+
+  for (i = 0; samples[i]; i++) {
+    for (j = i + 1; samples[j]; j++)
+      ck_assert_str_ne(samples[i], samples[j]);
+
+    for (n = 0; all[n].structure; n++)
+      if (!strcmp(samples[i], all[n].structure))
+        break;
+
+    ck_assert_ptr_ne(all[n].structure, NULL);
+  }
+
+  ck_assert_int_eq(i, 15);
+
+  for (i = 0; samples[i]; i++)
+    free(samples[i]);
+  free(samples);
+  vrna_pbacktrack_mem_free(nr_mem);
+
+  for (n = 0; all[n].structure; n++)
+    free(all[n].structure);
+  free(all);
+
+  /* the first non-redundant sample follows the Boltzmann distribution */
+  mfe_structure = (char *)vrna_alloc(sizeof(char) * (sizeof(small)));
+  mfe           = (double)vrna_mfe(fc, mfe_structure);
+  p_mfe         = vrna_pr_structure(fc, mfe_structure);
+  runs          = 2000;
+  hits          = 0;
+
+  for (i = 0; i < runs; i++) {
+    nr_mem  = NULL;
+    samples = vrna_pbacktrack_resume(fc, 1, &nr_mem, VRNA_PBACKTRACK_NON_REDUNDANT);
+    if (!strcmp(samples[0], mfe_structure))
+      hits++;
+
+    free(samples[0]);
+    free(samples);
+    vrna_pbacktrack_mem_free(nr_mem);
+  }
+
+  ck_assert(fabs((double)hits / runs - p_mfe) < 4. * sqrt(p_mfe * (1. - p_mfe) / runs));
+
+  (void)mfe;
+  free(mfe_structure);
+  vrna_fold_compound_free(fc);
+}
+
+#tcase Wavefront_Parallelization
+
+#test test_pf_wavefront
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  float                 en_serial, en_parallel;
+  int                   d, uniq_ML;
+
+  for (uniq_ML = 0; uniq_ML <= 1; uniq_ML++)
+    for (d = 0; d <= 2; d += 2) {
+      vrna_md_set_default(&md);
+      md.dangles      = d;
+      md.uniq_ML      = uniq_ML;
+      md.compute_bpp  = 0;
+
+      fc        = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+      en_serial = vrna_pf(fc, NULL);
+      vrna_fold_compound_free(fc);
+
+      md.num_threads  = 4;
+      fc              = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+      en_parallel     = vrna_pf(fc, NULL);
+      vrna_fold_compound_free(fc);
+
+      ck_assert(en_serial == en_parallel);
+    }
+}
+
+#test test_bpp_wavefront
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  FLT_OR_DBL            *probs_serial, *probs_parallel;
+  int                   d, i, j, *iindx;
+  const int             length = sizeof(sequence) - 1;
+
+  for (d = 0; d <= 2; d += 2) {
+    vrna_md_set_default(&md);
+    md.dangles        = d;
+    md.bpp_mt_length  = 0;
+
+    fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+    (void)vrna_pf(fc, NULL);
+    probs_serial              = fc->exp_matrices->probs;
+    fc->exp_matrices->probs   = NULL;
+    vrna_fold_compound_free(fc);
+
+    md.num_threads  = 4;
+    fc              = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+    (void)vrna_pf(fc, NULL);
+    probs_parallel  = fc->exp_matrices->probs;
+    iindx           = fc->iindx;
+
+    for (i = 1; i < length; i++)
+      for (j = i + 1; j <= length; j++)
+        ck_assert(probs_serial[iindx[i] - j] == probs_parallel[iindx[i] - j]);
+
+    vrna_fold_compound_free(fc);
+    free(probs_serial);
+  }
+}
+
+#tcase  SIMD_Dispatch
+
+#test test_pf_simd
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  double                en_default, en_simd;
+  int                   d, uniq_ML;
+
+  for (uniq_ML = 0; uniq_ML <= 1; uniq_ML++)
+    for (d = 0; d <= 2; d += 2) {
+      vrna_md_set_default(&md);
+      md.dangles      = d;
+      md.uniq_ML      = uniq_ML;
+      md.compute_bpp  = 0;
+
+      vrna_fun_dispatch_disable();
+      fc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+      en_default  = vrna_pf(fc, NULL);
+      vrna_fold_compound_free(fc);
+
+      vrna_fun_dispatch_enable();
+      fc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+      en_simd = vrna_pf(fc, NULL);
+      vrna_fold_compound_free(fc);
+
+      /* summation order differs, so allow for rounding errors */
+      ck_assert(fabs(en_default - en_simd) < 1e-4);
+    }
+}
+
+#tcase  Adaptive_Scaling
+
+#test test_pf_rescale
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  char                  *sequence;
+  const char            *unit = "GGGGCGCCGAAAGGCGCCCC";
+  double                mfe, en_ref, en;
+  int                   i, n;
+
+  n         = 600;
+  sequence  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  for (i = 0; i < n; i++)
+    sequence[i] = unit[i % 20];
+
+  vrna_md_set_default(&md);
+  md.compute_bpp = 0;
+
+  /* reference with scaling factor estimated from the MFE */
+  fc  = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  mfe = (double)vrna_mfe(fc, NULL);
+  vrna_exp_params_rescale(fc, &mfe);
+  en_ref = vrna_pf(fc, NULL);
+  vrna_fold_compound_free(fc);
+
+  /* no scaling at all leads to overflow */
+  fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+  fc->exp_params->pf_scale = 1.;
+  vrna_exp_params_rescale(fc, NULL);
+  en = vrna_pf(fc, NULL);
+  ck_assert(fabs(en - en_ref) < 1e-3);
+  ck_assert(fc->exp_params->pf_scale > 1.);
+  vrna_fold_compound_free(fc);
+
+  /* a too large scaling factor leads to underflow */
+  fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+  fc->exp_params->pf_scale = 40.;
+  vrna_exp_params_rescale(fc, NULL);
+  en = vrna_pf(fc, NULL);
+  ck_assert(fabs(en - en_ref) < 1e-3);
+  ck_assert(fc->exp_params->pf_scale < 40.);
+  vrna_fold_compound_free(fc);
+
+  free(sequence);
+}
+
+#tcase  Single_Precision
+
+#test test_pf_float
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  char                  *sequence;
+  const char            *unit = "GGGGCGCCGAAAGGCGCCCC";
+  const char            *sequences[] = {
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU",
+    NULL, /* highly stable helices that require re-scaling in single precision */
+    NULL
+  };
+  double                en_ref, en;
+  int                   i, n, s, d, noGUclosure;
+
+  n         = 400;
+  sequence  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  for (i = 0; i < n; i++)
+    sequence[i] = unit[i % 20];
+
+  sequences[1] = sequence;
+
+  for (s = 0; sequences[s]; s++)
+    for (noGUclosure = 0; noGUclosure <= 1; noGUclosure++)
+      for (d = 0; d <= 2; d += 2) {
+        vrna_md_set_default(&md);
+        md.dangles      = d;
+        md.noGUclosure  = noGUclosure;
+        md.compute_bpp  = 0;
+
+        fc      = vrna_fold_compound(sequences[s], &md, VRNA_OPTION_DEFAULT);
+        en_ref  = vrna_pf(fc, NULL);
+        vrna_fold_compound_free(fc);
+
+        fc  = vrna_fold_compound(sequences[s], &md, VRNA_OPTION_DEFAULT);
+        en  = vrna_pf_float(fc);
+
+        /* the double precision fallback has not been used */
+        ck_assert(fc->exp_matrices == NULL);
+        ck_assert(fabs(en - en_ref) < 1e-3);
+        vrna_fold_compound_free(fc);
+      }
+
+  /* circular RNAs are computed in double precision */
+  vrna_md_set_default(&md);
+  md.circ         = 1;
+  md.compute_bpp  = 0;
+
+  fc      = vrna_fold_compound(sequences[0], &md, VRNA_OPTION_DEFAULT);
+  en_ref  = vrna_pf(fc, NULL);
+  vrna_fold_compound_free(fc);
+
+  fc  = vrna_fold_compound(sequences[0], &md, VRNA_OPTION_DEFAULT);
+  en  = vrna_pf_float(fc);
+  ck_assert(fc->exp_matrices != NULL);
+  ck_assert(en == en_ref);
+  vrna_fold_compound_free(fc);
+
+  free(sequence);
+}
+
+#suite  Suboptimal_Structures
+
+#tcase  Memory_Bounded_Enumeration
+
+#test test_subopt_stream
+{
+  const char              sequence[] =
+    "GGGCUAUUAGCUCAGUUGGUUAGAGCGCACCCCUGAUAAGGGUGAGGUCGCUGAUUCGAAUUCAGCAUAGCCCA";
+  int                     delta, complete;
+  unsigned int            i, n;
+  vrna_md_t               md;
+  vrna_fold_compound_t    *fc;
+  vrna_subopt_solution_t  *ref;
+  struct subopt_collector d;
+
+  delta = 500;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML = 1;
+
+  fc  = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  ref = vrna_subopt(fc, delta, VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, NULL);
+
+  for (n = 0; ref[n].structure; n++);
+
+  ck_assert(n > 1000);
+
+  /* a memory limit of a few kB forces the sorted structures to be spilled to disk many times */
+  memset(&d, 0, sizeof(struct subopt_collector));
+  complete = vrna_subopt_stream(fc,
+                                delta,
+                                VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC,
+                                0,
+                                16 * 1024,
+                                &collect_subopt,
+                                (void *)&d);
+
+  ck_assert_int_eq(complete, 1);
+  ck_assert_int_eq(d.num, n);
+
+  for (i = 0; i < n; i++) {
+    ck_assert(d.list[i].energy == ref[i].energy);
+    ck_assert_str_eq(d.list[i].structure, ref[i].structure);
+    free(d.list[i].structure);
+  }
+
+  /* stop after a maximum number of structures */
+  d.num     = 0;
+  complete  = vrna_subopt_stream(fc,
+                                 delta,
+                                 VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC,
+                                 100,
+                                 0,
+                                 &collect_subopt,
+                                 (void *)&d);
+
+  ck_assert_int_eq(complete, 0);
+  ck_assert_int_eq(d.num, 100);
+
+  for (i = 1; i < d.num; i++)
+    ck_assert(d.list[i - 1].energy <= d.list[i].energy);
+
+  for (i = 0; i < d.num; i++)
+    free(d.list[i].structure);
+
+  free(d.list);
+
+  for (i = 0; i < n; i++)
+    free(ref[i].structure);
+
+  free(ref);
+  vrna_fold_compound_free(fc);
+}
+
+
+#tcase  Parallel_Enumeration
+
+#test test_subopt_parallel
+{
+  const char              *sequences[] = {
+    "GGGCUAUUAGCUCAGUUGGUUAGAGCGCACCCCUGAUAAGGGUGAGGUCGCUGAUUCGAAUUCAGCAUAGCCCA",
+    "AUGCUAGCUAGCUAGCAUCGAUCGAUGCAU&AUGCAUCGAUCGAUGCUAGCUAGCUAGCAU",
+    NULL
+  };
+  unsigned int            i, k, n, t;
+  vrna_md_t               md;
+  vrna_fold_compound_t    *fc;
+  vrna_subopt_solution_t  *ref;
+  struct subopt_collector d;
+
+  for (k = 0; sequences[k]; k++) {
+    vrna_md_set_default(&md);
+    md.uniq_ML = 1;
+
+    fc  = vrna_fold_compound(sequences[k], &md, VRNA_OPTION_DEFAULT | VRNA_OPTION_HYBRID);
+    ref = vrna_subopt(fc, 500, VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, NULL);
+    vrna_fold_compound_free(fc);
+
+    for (n = 0; ref[n].structure; n++);
+
+    ck_assert(n > 10);
+
+    for (t = 2; t <= 8; t *= 2) {
+      md.num_threads = t;
+      fc = vrna_fold_compound(sequences[k], &md, VRNA_OPTION_DEFAULT | VRNA_OPTION_HYBRID);
+
+      memset(&d, 0, sizeof(struct subopt_collector));
+      vrna_subopt_cb(fc, 500, &collect_subopt, (void *)&d);
+
+      /* the parallel enumeration yields the structures in arbitrary order */
+      ck_assert_int_eq(d.num, n);
+      qsort(d.list, d.num, sizeof(vrna_subopt_solution_t), &compare_subopt);
+
+      for (i = 0; i < n; i++) {
+        ck_assert(d.list[i].energy == ref[i].energy);
+        ck_assert_str_eq(d.list[i].structure, ref[i].structure);
+        free(d.list[i].structure);
+      }
+
+      free(d.list);
+      vrna_fold_compound_free(fc);
+    }
+
+    for (i = 0; i < n; i++)
+      free(ref[i].structure);
+
+    free(ref);
+  }
+}
+
+
 #suite  Constraints_Implementation
 
 #tcase  Soft_Constraints
@@ -12,6 +12,14 @@ hash_function_test(void           *hash_entry,
 }
 
 
+static unsigned
+hash_function_value(void          *hash_entry,
+                    unsigned long hashtable_size)
+{
+  return *((unsigned int *)hash_entry) % hashtable_size;
+}
+
+
 static int
 hash_comparison_test(void *x,
                      void *y)
@@ -77,3 +85,40 @@ free_dummy(void *x)
   //vrna_ht_clear(ht);
   vrna_ht_free(ht);
 }
+
+
+#test test_vrna_hash_table_growth
+{
+  unsigned int      i, *res_p, *vals;
+  vrna_hash_table_t ht;
+
+  vals = (unsigned int *)malloc(sizeof(unsigned int) * 10000);
+  for (i = 0; i < 10000; i++)
+    vals[i] = 3 * i + 1;
+
+  /* start with 4 slots only */
+  ht = vrna_ht_init_concurrent(2, hash_comparison_test, hash_function_value, free_dummy);
+  ck_assert_ptr_ne(ht, NULL);
+
+  for (i = 0; i < 10000; i++)
+    ck_assert_int_eq(vrna_ht_insert(ht, (void *)&vals[i]), 0);
+
+  ck_assert(vrna_ht_size(ht) >= 10000);
+
+  /* remove every other entry */
+  for (i = 0; i < 10000; i += 2)
+    vrna_ht_remove(ht, (void *)&vals[i]);
+
+  for (i = 0; i < 10000; i++) {
+    res_p = vrna_ht_get(ht, (void *)&vals[i]);
+    if (i % 2) {
+      ck_assert_ptr_ne(res_p, NULL);
+      ck_assert_int_eq(*res_p, vals[i]);
+    } else {
+      ck_assert_ptr_eq(res_p, NULL);
+    }
+  }
+
+  vrna_ht_free(ht);
+  free(vals);
+}
@@ -293,6 +293,66 @@ test_RNA2_move_it(vrna_fold_compound_t  *vc,
 }
 
 
+#test test_vrna_move_apply_zobrist
+{
+  char                  *sequence   = "GGGAAACCCAAGGAAACCAGGAAACCU";
+  char                  *structure  = "(((...)))..((...)).........";
+  vrna_md_t             md;
+  vrna_move_t           *neighbors, *m;
+  short                 *pt, *pt_n;
+  uint64_t              hash, hash_n, *packed, *packed_n, *packed_full;
+  int                   steps;
+
+  vrna_md_set_default(&md);
+  vrna_fold_compound_t  *vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_EVAL_ONLY);
+
+  pt      = vrna_ptable(structure);
+  hash    = vrna_pt_zobrist(pt);
+  packed  = vrna_pt_pack(pt);
+
+  /* walk through the landscape and compare incremental and full fingerprints and keys */
+  for (steps = 0; steps < 20; steps++) {
+    neighbors = vrna_neighbors(vc, pt, VRNA_MOVESET_DEFAULT | VRNA_MOVESET_SHIFT);
+    ck_assert(neighbors[0].pos_5 != 0);
+
+    for (m = neighbors; m->pos_5 != 0; m++) {
+      pt_n    = vrna_ptable_copy(pt);
+      hash_n  = hash;
+      vrna_move_apply_zobrist(pt_n, m, &hash_n);
+      ck_assert(hash_n == vrna_pt_zobrist(pt_n));
+      ck_assert(hash_n == (hash ^ vrna_move_zobrist(pt, m)));
+      free(pt_n);
+
+      pt_n      = vrna_ptable_copy(pt);
+      packed_n  = vrna_pt_pack(pt);
+      vrna_move_apply_pk(pt_n, m, packed_n);
+      packed_full = vrna_pt_pack(pt_n);
+      ck_assert_int_eq(vrna_pt_pack_cmp(packed_n, packed_full), 0);
+      ck_assert(packed_n[0] == hash_n);
+      free(packed_full);
+      free(packed_n);
+      free(pt_n);
+    }
+
+    /* proceed with some neighbor */
+    m     = neighbors + (steps * 7) % (int)(m - neighbors);
+    pt_n  = vrna_ptable_copy(pt);
+    vrna_move_apply_pk(pt_n, m, packed);
+    vrna_move_apply_zobrist(pt, m, &hash);
+    packed_full = vrna_pt_pack(pt);
+    ck_assert_int_eq(vrna_pt_pack_cmp(packed, packed_full), 0);
+    ck_assert(packed[0] == hash);
+    free(packed_full);
+    free(pt_n);
+
+    free(neighbors);
+  }
+
+  vrna_fold_compound_free(vc);
+  free(packed);
+  free(pt);
+}
+
 #test test_update_loop_indices_deletion
 {
   char        *sequence   = "GGGAAACCCAACCUUU";
@@ -4,6 +4,7 @@
 #include <ViennaRNA/model.h>
 #include <ViennaRNA/utils/basic.h>
 #include <ViennaRNA/utils/strings.h>
+#include <ViennaRNA/utils/structures.h>
 #include <ViennaRNA/alphabet.h>
 #include <ViennaRNA/mfe.h>
 
@@ -299,6 +300,52 @@ compare_str(const void  *a,
 }
 
 
+#test test_pack_structure_key
+{
+  int       i, j, k;
+  short     *pt, *pt_unpacked;
+  uint64_t  *key, *key2;
+
+  vrna_init_rand();
+  for (i = 0; i < 16; i++) {
+    char  *seq  = vrna_random_string(100 + 7 * i, "ACGU");
+    char  *ss   = (char *)vrna_alloc(sizeof(char) * (strlen(seq) + 1));
+
+    (void)vrna_fold(seq, ss);
+
+    pt          = vrna_ptable(ss);
+    key         = vrna_pt_pack(pt);
+    pt_unpacked = vrna_pt_unpack(key);
+
+    /* compare original and packed/unpacked structure */
+    for (j = 0; j <= pt[0]; j++)
+      ck_assert_int_eq(pt[j], pt_unpacked[j]);
+
+    ck_assert(key[0] == vrna_pt_zobrist(pt));
+    ck_assert_int_eq(vrna_pt_pack_cmp(key, key), 0);
+
+    /* remove the first base pair and update the hash incrementally */
+    for (j = 1; j <= pt[0]; j++)
+      if (pt[j] > j)
+        break;
+
+    if (j <= pt[0]) {
+      k         = pt[j];
+      pt[j]     = pt[k] = 0;
+      key2      = vrna_pt_pack(pt);
+      ck_assert(key2[0] == (key[0] ^ vrna_bp_zobrist(j, k)));
+      ck_assert_int_ne(vrna_pt_pack_cmp(key, key2), 0);
+      free(key2);
+    }
+
+    free(pt_unpacked);
+    free(key);
+    free(pt);
+    free(ss);
+    free(seq);
+  }
+}
+
 //@TODO: extend alphabeth
 //@TODO: details.noLP = 1
 //@TODO: idx_type = 1
@@ -1,9 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <ViennaRNA/landscape/walk.h>
+#include <ViennaRNA/landscape/findpath.h>
+#include <ViennaRNA/landscape/paths.h>
 #include <ViennaRNA/model.h>
 #include <ViennaRNA/utils/structures.h>
 #include <ViennaRNA/data_structures.h>
+#include <ViennaRNA/eval.h>
+#include <ViennaRNA/utils/basic.h>
 
 #suite Walks
 
@@ -48,3 +53,115 @@
   free(resultMoves);
   free(resultStructure);
 }
+
+
+#test Findpath_Saddle
+{
+  char                  *sequence = "GGGGAAAACCCCAAAGGGGAAAACCCC";
+  char                  *s1       = "((((....))))...((((....))))";
+  char                  *s2       = "((((((((..........)))))))).";
+  /* saddle energy of the best direct path, obtained by exhaustive enumeration */
+  int                   expectedSaddle  = 370;
+  int                   widths[3]       = { 1, 10, 100 };
+  int                   threads[2]      = { 1, 4 };
+  int                   i, t, en, max_en;
+  short                 *pt;
+  vrna_path_t           *path, *r;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+
+  for (t = 0; t < 2; t++) {
+    vrna_md_set_default(&md);
+    md.num_threads  = threads[t];
+    vc              = vrna_fold_compound(sequence, &md, VRNA_OPTION_EVAL_ONLY);
+
+    for (i = 0; i < 3; i++) {
+      ck_assert_int_eq(vrna_path_findpath_saddle(vc, s1, s2, widths[i]), expectedSaddle);
+      ck_assert_int_eq(vrna_path_findpath_saddle(vc, s2, s1, widths[i]), expectedSaddle);
+    }
+
+    path = vrna_path_findpath(vc, s1, s2, 10);
+    ck_assert(path != NULL);
+    ck_assert_str_eq(path[0].s, s1);
+
+    max_en = INT_MIN;
+    for (r = path; r->s; r++) {
+      en = (int)(r->en * 100. + (r->en < 0 ? -0.5 : 0.5));
+      ck_assert_int_eq(en, vrna_eval_structure_pt(vc, (pt = vrna_ptable(r->s))));
+      max_en = MAX2(max_en, en);
+      free(pt);
+
+      /* consecutive structures differ by exactly one base pair */
+      if (r != path)
+        ck_assert_int_eq(vrna_bp_distance((r - 1)->s, r->s), 1);
+    }
+
+    ck_assert_str_eq((r - 1)->s, s2);
+    ck_assert_int_eq(max_en, expectedSaddle);
+
+    vrna_path_free(path);
+    vrna_fold_compound_free(vc);
+  }
+}
+
+
+#test Findpath_Saddle_Matrix
+{
+  char                  *sequence       = "GGGGAAAACCCCAAAGGGGAAAACCCC";
+  /* the eight lowest suboptimals, where several saddles are lowered by indirect paths */
+  const char            *structures[9] = {
+    "((((....))))...((((....))))",
+    "((((....((((...))))....))))",
+    "((((....))))...(((.....))).",
+    "((((....))))....(((....))).",
+    "((((....))))...(((......)))",
+    "(((......)))...((((....))))",
+    "((((....(((....))).....))))",
+    "(((.....((((...))))....))).",
+    NULL
+  };
+  int                   k           = 8;
+  int                   width       = 10;
+  int                   threads[2]  = { 1, 4 };
+  int                   a, b, c, t, *S, *R;
+  short                 *pt;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+
+  for (t = 0; t < 2; t++) {
+    vrna_md_set_default(&md);
+    md.num_threads  = threads[t];
+    vc              = vrna_fold_compound(sequence, &md, VRNA_OPTION_EVAL_ONLY);
+
+    /* reference: pairwise saddles of direct paths, closed under min-max composition */
+    R = (int *)vrna_alloc(sizeof(int) * k * k);
+    for (a = 0; a < k; a++)
+      for (b = 0; b < k; b++) {
+        if (a == b) {
+          pt            = vrna_ptable(structures[a]);
+          R[a * k + b]  = vrna_eval_structure_pt(vc, pt);
+          free(pt);
+        } else {
+          R[a * k + b] = vrna_path_findpath_saddle(vc, structures[a], structures[b], width);
+        }
+      }
+
+    for (c = 0; c < k; c++)
+      for (a = 0; a < k; a++)
+        for (b = 0; b < k; b++)
+          R[a * k + b] = MIN2(R[a * k + b], MAX2(R[a * k + c], R[c * k + b]));
+
+    S = vrna_path_findpath_saddle_matrix(vc, structures, width, INT_MAX - 1);
+    ck_assert(S != NULL);
+
+    for (a = 0; a < k; a++)
+      for (b = 0; b < k; b++) {
+        ck_assert_int_eq(S[a * k + b], S[b * k + a]);
+        ck_assert_int_eq(S[a * k + b], R[a * k + b]);
+      }
+
+    free(S);
+    free(R);
+    vrna_fold_compound_free(vc);
+  }
+}